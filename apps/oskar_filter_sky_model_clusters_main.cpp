@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2014-2019, The University of Oxford
+ * Copyright (c) 2014-2020, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -26,7 +26,6 @@
  * POSSIBILITY OF SUCH DAMAGE.
  */
 
-#include "convert/oskar_convert_healpix_ring_to_theta_phi.h"
 #include "log/oskar_log.h"
 #include "math/oskar_angular_distance.h"
 #include "math/oskar_bearing_angle.h"
@@ -42,25 +41,18 @@
 #include <cfloat>
 #include <cstdio>
 #include <string>
+#include <utility>
 #include <vector>
 
 #define D2R (M_PI / 180.0)
 #define R2D (180.0 / M_PI)
 #define FWHM_TO_SIGMA 0.4246609
 
-using std::distance;
 using std::reverse;
 using std::sort;
 using std::string;
-using std::unique;
 using std::vector;
 
-template<typename T>
-bool contains(const std::vector<T>& v, const T& val)
-{
-    return std::find(v.begin(), v.end(), val) != v.end();
-}
-
 template<typename T>
 struct sort_indices
 {
@@ -69,69 +61,117 @@ struct sort_indices
     bool operator() (int a, int b) const {return p[a] < p[b];}
 };
 
-static void check_overlap(int start_component,
-        const double* ra, const double* dec, const double* major,
-        const double* minor, const double* pa_rad, const double sigma,
-        const double max_separation_rad, vector<int>& cluster_components,
-        vector<int>& components_removed, const vector<double>& bin_ra,
-        const vector<double>& bin_dec, const vector<vector<int> >& bin_indices)
+// Static k-d tree of points on the unit sphere, using Cartesian coordinates.
+// The tree is stored implicitly in the index array: each sub-range is split
+// at its midpoint along the axis with the largest spread.
+class PointTree
 {
-    // Get data for the reference component.
-    double ra0  = ra[start_component];
-    double dec0 = dec[start_component];
-    double major0 = sigma * FWHM_TO_SIGMA * major[start_component];
-    double minor0 = sigma * FWHM_TO_SIGMA * minor[start_component];
-    double pa0 = pa_rad[start_component];
-
-    // Find distances to the nearest bin centres.
-    const int num_bins = (int)bin_ra.size();
-    vector<double> bin_dist(num_bins);
-    vector<int> bin_index(num_bins);
-    for (int i = 0; i < num_bins; ++i)
+public:
+    PointTree(int num_points, const double* ra, const double* dec)
+    : xyz_(3 * num_points), index_(num_points), axis_(num_points)
     {
-        bin_index[i] = i;
-        bin_dist[i] = oskar_angular_distance(ra0, bin_ra[i], dec0, bin_dec[i]);
+        for (int i = 0; i < num_points; ++i)
+        {
+            const double cos_dec = cos(dec[i]);
+            xyz_[3 * i + 0] = cos_dec * cos(ra[i]);
+            xyz_[3 * i + 1] = cos_dec * sin(ra[i]);
+            xyz_[3 * i + 2] = sin(dec[i]);
+            index_[i] = i;
+        }
+        build(0, num_points);
     }
-    sort(bin_index.begin(), bin_index.end(),
-            sort_indices<double>(&bin_dist[0]));
 
-    // Loop over all unchecked sources in nearby bins (4 bins is worst case).
-    for (int b = 0; b < 4; ++b)
+    // Appends indices of all points within the given angular distance.
+    void query(int point, double max_distance_rad, vector<int>& out) const
     {
-        int bin = bin_index[b];
-        int num_components_to_check = (int)bin_indices[bin].size();
-        for (int i = 0; i < num_components_to_check; ++i)
-        {
-            // Get the component index.
-            int c = bin_indices[bin][i];
+        const double chord = 2.0 * sin(0.5 * std::min(max_distance_rad, M_PI));
+        query(0, (int)index_.size(), &xyz_[3 * point], chord * chord, out);
+    }
 
-            // Calculate component separation and Gaussian ellipse radii.
-            double d = oskar_angular_distance(ra0, ra[c], dec0, dec[c]);
-            if (d > max_separation_rad) continue;
+private:
+    void build(int start, int end)
+    {
+        if (end - start < 2) return;
+        double lo[3] = {DBL_MAX, DBL_MAX, DBL_MAX};
+        double hi[3] = {-DBL_MAX, -DBL_MAX, -DBL_MAX};
+        for (int i = start; i < end; ++i)
+        {
+            for (int k = 0; k < 3; ++k)
+            {
+                const double v = xyz_[3 * index_[i] + k];
+                if (v < lo[k]) lo[k] = v;
+                if (v > hi[k]) hi[k] = v;
+            }
+        }
+        int axis = 0;
+        for (int k = 1; k < 3; ++k)
+            if (hi[k] - lo[k] > hi[axis] - lo[axis]) axis = k;
+        const int mid = start + (end - start) / 2;
+        std::nth_element(index_.begin() + start, index_.begin() + mid,
+                index_.begin() + end, compare_axis(&xyz_[0], axis));
+        axis_[mid] = axis;
+        build(start, mid);
+        build(mid + 1, end);
+    }
 
-            // Don't check for overlap if the component to check against
-            // is already marked for removal.
-            if (contains(cluster_components, c)) continue;
+    void query(int start, int end, const double* p, double max_dist2,
+            vector<int>& out) const
+    {
+        if (start >= end) return;
+        const int mid = start + (end - start) / 2;
+        const double* q = &xyz_[3 * index_[mid]];
+        const double dx = p[0] - q[0], dy = p[1] - q[1], dz = p[2] - q[2];
+        if (dx * dx + dy * dy + dz * dz <= max_dist2)
+            out.push_back(index_[mid]);
+        if (end - start == 1) return;
+        const double delta = p[axis_[mid]] - q[axis_[mid]];
+        if (delta <= 0.0 || delta * delta <= max_dist2)
+            query(start, mid, p, max_dist2, out);
+        if (delta >= 0.0 || delta * delta <= max_dist2)
+            query(mid + 1, end, p, max_dist2, out);
+    }
 
-            double a0 = oskar_bearing_angle(ra0, ra[c], dec0, dec[c]);
-            double r0 = oskar_ellipse_radius(major0, minor0, pa0, a0);
-            double a1 = oskar_bearing_angle(ra[c], ra0, dec[c], dec0);
-            double r1 = oskar_ellipse_radius(sigma * FWHM_TO_SIGMA * major[c],
-                    sigma * FWHM_TO_SIGMA * minor[c], pa_rad[c], a1);
+    struct compare_axis
+    {
+        const double* xyz;
+        int axis;
+        compare_axis(const double* xyz, int axis) : xyz(xyz), axis(axis) {}
+        bool operator() (int a, int b) const
+        {
+            return xyz[3 * a + axis] < xyz[3 * b + axis];
+        }
+    };
 
-            // Mark for removal if components are overlapping.
-            if (r0 + r1 > d || c == start_component)
-            {
-                components_removed.push_back(c);
-                cluster_components.push_back(c);
+    vector<double> xyz_;
+    vector<int> index_, axis_;
+};
 
-                // Recursively check for overlap from component being removed.
-                check_overlap(c, ra, dec, major, minor, pa_rad, sigma,
-                        max_separation_rad, cluster_components,
-                        components_removed, bin_ra, bin_dec, bin_indices);
-            }
-        }
+// Returns the root of the set containing the given component,
+// compressing the path as it goes.
+static int find_root(vector<int>& parent, int i)
+{
+    while (parent[i] != i)
+    {
+        parent[i] = parent[parent[i]];
+        i = parent[i];
     }
+    return i;
+}
+
+// Returns true if the Gaussian ellipses of two components overlap.
+static bool overlapping(int c0, int c1,
+        const double* ra, const double* dec, const double* major,
+        const double* minor, const double* pa_rad, const double sigma)
+{
+    const double s = sigma * FWHM_TO_SIGMA;
+    const double d = oskar_angular_distance(ra[c0], ra[c1], dec[c0], dec[c1]);
+    const double a0 = oskar_bearing_angle(ra[c0], ra[c1], dec[c0], dec[c1]);
+    const double r0 = oskar_ellipse_radius(s * major[c0], s * minor[c0],
+            pa_rad[c0], a0);
+    const double a1 = oskar_bearing_angle(ra[c1], ra[c0], dec[c1], dec[c0]);
+    const double r1 = oskar_ellipse_radius(s * major[c1], s * minor[c1],
+            pa_rad[c1], a1);
+    return r0 + r1 > d;
 }
 
 
@@ -262,65 +302,64 @@ int main(int argc, char** argv)
             num_input, 0, &max_size_rad, 0, 0, &status);
     max_size_rad *= 1.1 * sigma;
 
-    // Create spatial bins.
-    int nside = 5;
-    int num_bins = 12 * nside * nside;
-    vector<double> bin_ra(num_bins), bin_dec(num_bins), bin_dist(num_bins);
-    vector< vector<int> > bin_indices(num_bins);
-    for (int i = 0; i < num_bins; ++i)
-    {
-        oskar_convert_healpix_ring_to_theta_phi_d(nside, i,
-                &bin_dec[i], &bin_ra[i]);
-        bin_dec[i] = 0.5 * M_PI - bin_dec[i];
-    }
-
-    // Spatially bin the input data.
-    for (int i = 0, bin = 0; i < num_input; ++i)
+    // Build a spatial index of component positions.
+    oskar_log_message(log, 'M', 0, "Grouping overlapping components...");
+    oskar_Timer* timer = oskar_timer_create(OSKAR_TIMER_NATIVE);
+    oskar_timer_start(timer);
+    PointTree tree(num_input, sky_ra, sky_dec);
+
+    // Find all pairs of overlapping components, in parallel, and join
+    // the sets they belong to. Overlap is symmetric, so each pair of
+    // components needs to be checked only once.
+    vector<int> parent(num_input);
+    for (int i = 0; i < num_input; ++i) parent[i] = i;
+#pragma omp parallel
     {
-        double min_d = DBL_MAX;
-        for (int j = 0; j < num_bins; ++j)
+        vector<int> neighbours;
+        vector<std::pair<int, int> > pairs;
+#pragma omp for schedule(dynamic, 256) nowait
+        for (int i = 0; i < num_input; ++i)
+        {
+            neighbours.clear();
+            tree.query(i, max_size_rad, neighbours);
+            const int num_neighbours = (int)neighbours.size();
+            for (int j = 0; j < num_neighbours; ++j)
+            {
+                const int c = neighbours[j];
+                if (c > i && overlapping(i, c, sky_ra, sky_dec,
+                        filter_maj, filter_min, filter_pa, sigma))
+                    pairs.push_back(std::make_pair(i, c));
+            }
+        }
+#pragma omp critical
         {
-            double d = oskar_angular_distance(sky_ra[i], bin_ra[j],
-                    sky_dec[i], bin_dec[j]);
-            if (d < min_d)
+            const int num_pairs = (int)pairs.size();
+            for (int j = 0; j < num_pairs; ++j)
             {
-                bin = j;
-                min_d = d;
+                const int r0 = find_root(parent, pairs[j].first);
+                const int r1 = find_root(parent, pairs[j].second);
+                if (r0 != r1) parent[std::max(r0, r1)] = std::min(r0, r1);
             }
         }
-        bin_indices[bin].push_back(i);
     }
 
-    // Loop over input sources.
+    // Collect the components in each cluster, in order of their
+    // lowest component index.
     vector< vector<int> > output_source_components;
-    vector<int> components_removed;
-    oskar_log_message(log, 'M', 0, "Grouping using %d bins...", num_bins);
-    oskar_Timer* timer = oskar_timer_create(OSKAR_TIMER_NATIVE);
-    oskar_timer_start(timer);
-    for (int i = 0, progress = -num_input; i < num_input; ++i)
+    vector<int> cluster_index(num_input, -1);
+    for (int i = 0; i < num_input; ++i)
     {
-        // Update progress display.
-        if ((num_input > 500) && (i > progress + num_input / 20))
+        const int root = find_root(parent, i);
+        if (cluster_index[root] < 0)
         {
-            progress = i;
-            oskar_log_message(log, 'M', 1, "%3.0f%% done after %6.1f sec.",
-                    100.0 * i / (num_input - 1),
-                    oskar_timer_elapsed(timer));
+            cluster_index[root] = (int)output_source_components.size();
+            output_source_components.push_back(vector<int>());
         }
-
-        // Don't check for overlap if the component is already marked
-        // for removal.
-        if (contains(components_removed, i)) continue;
-
-        vector<int> components;
-        check_overlap(i, sky_ra, sky_dec, filter_maj, filter_min, filter_pa,
-                sigma, max_size_rad,  components, components_removed,
-                bin_ra, bin_dec, bin_indices);
-        output_source_components.push_back(components);
+        output_source_components[cluster_index[root]].push_back(i);
     }
     int num_output = (int)output_source_components.size();
-    oskar_log_message(log, 'M', 1, "100%% done after %6.1f sec.",
-            oskar_timer_elapsed(timer));
+    oskar_log_message(log, 'M', 1, "Found %d clusters after %.1f sec.",
+            num_output, oskar_timer_elapsed(timer));
     oskar_timer_free(timer);
 
     // Check that all components have been grouped.
@@ -336,14 +375,6 @@ int main(int argc, char** argv)
             oskar_sky_free(sky_as_filter, &status);
             return EXIT_FAILURE;
         }
-        if (num_input != (int)components_removed.size())
-        {
-            oskar_log_error(log, "Inconsistent component counts: %d input, "
-                    "%d removed.",  num_input, (int)components_removed.size());
-            oskar_sky_free(sky_to_filter, &status);
-            oskar_sky_free(sky_as_filter, &status);
-            return EXIT_FAILURE;
-        }
     }
 
     // Add together flux from cluster components.
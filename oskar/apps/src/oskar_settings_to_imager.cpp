@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2017-2019, The University of Oxford
+ * Copyright (c) 2017-2020, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -77,6 +77,8 @@ oskar_Imager* oskar_settings_to_imager(oskar::SettingsTree* s,
             s->to_int("scale_norm_with_num_input_files", status));
     oskar_imager_set_ms_column(h,
             s->to_string("ms_column", status), status);
+    oskar_imager_set_coord_cache_mem_mb(h,
+            s->to_int("coord_cache_mem_mb", status));
     oskar_imager_set_output_root(h, s->to_string("root_path", status));
 
     // Set remaining imager options.
@@ -114,6 +116,8 @@ oskar_Imager* oskar_settings_to_imager(oskar::SettingsTree* s,
     oskar_imager_set_grid_on_gpu(h, s->to_int("fft/grid_on_gpu", status));
     oskar_imager_set_generate_w_kernels_on_gpu(h,
             s->to_int("wproj/generate_w_kernels_on_gpu", status));
+    oskar_imager_set_w_kernel_cache_dir(h,
+            s->to_string("wproj/w_kernel_cache_dir", status));
     if (s->first_letter("direction", status) == 'R')
         oskar_imager_set_direction(h,
                 s->to_double("direction/ra_deg", status),
@@ -110,6 +110,8 @@ oskar_Interferometer* oskar_settings_to_interferometer(oskar::SettingsTree* s,
             s->to_string("correlation_type", status), status);
     oskar_interferometer_set_max_times_per_block(h,
             s->to_int("max_time_samples_per_block", status));
+    oskar_interferometer_set_num_vis_buffers(h,
+            s->to_int("num_output_buffers", status));
     oskar_interferometer_set_output_vis_file(h,
             s->to_string("oskar_vis_filename", status));
     oskar_interferometer_set_output_measurement_set(h,
@@ -118,6 +120,10 @@ oskar_Interferometer* oskar_settings_to_interferometer(oskar::SettingsTree* s,
             s->to_int("force_polarised_ms", status));
     oskar_interferometer_set_ignore_w_components(h,
             s->to_int("ignore_w_components", status));
+    oskar_interferometer_set_bda(h, s->to_int("bda/enable", status),
+            s->to_double("bda/max_fact", status),
+            s->to_double("bda/fov_deg", status),
+            s->to_double("bda/max_time_sec", status));
     s->end_group();
 
     // Return handle to interferometer simulator.
@@ -162,6 +162,7 @@ static void load_osm(oskar_Sky* sky, SettingsTree* s,
 {
     int num_files = 0;
     s->begin_group("oskar_sky_model");
+    const int use_cache = s->to_int("use_binary_cache", status);
     const char* const* files = s->to_string_list("file", &num_files, status);
     for (int i = 0; i < num_files; ++i)
     {
@@ -178,8 +179,11 @@ static void load_osm(oskar_Sky* sky, SettingsTree* s,
         oskar_Sky* t = oskar_sky_read(files[i],
                 OSKAR_CPU, &binary_file_error);
         if (binary_file_error)
-            t = oskar_sky_load(files[i],
-                    oskar_sky_precision(sky), status);
+            t = use_cache ?
+                    oskar_sky_load_cached(files[i], 0,
+                            oskar_sky_precision(sky), status) :
+                    oskar_sky_load(files[i],
+                            oskar_sky_precision(sky), status);
 
         /* Apply filters and extended source over-ride. */
         set_up_filter(t, s, ra0, dec0, status);
@@ -113,6 +113,8 @@ oskar_Telescope* oskar_settings_to_telescope(SettingsTree* s,
                 s->to_double("channel_bandwidth_hz", status));
         oskar_telescope_set_time_average(t,
                 s->to_double("time_average_sec", status));
+        oskar_telescope_set_smearing_cull_tolerance(t,
+                s->to_double("smearing_cull_tolerance_jy", status));
         oskar_telescope_set_uv_filter(t,
                 s->to_double("uv_filter_min", status),
                 s->to_double("uv_filter_max", status),
@@ -41,24 +41,23 @@
 extern "C" {
 #endif
 
+/* Host memory for the results of one (chunk, time, channel) task.
+ * Chunks have dimension max_chunk_size * num_active_stations.
+ * Cross power beams have dimension max_chunk_size. */
+struct HostBuffer
+{
+    oskar_Mem* jones_data_cpu;
+    oskar_Mem* auto_power_cpu[4]; /* Per Stokes parameter. */
+    oskar_Mem* cross_power_cpu[4]; /* Per Stokes parameter. */
+    oskar_Mem** pix; /* Pixel values, per non-averaged data product. */
+    oskar_Mem* ctemp; /* Complex-valued array used for reordering. */
+    volatile int task_index; /* Task held in the buffer, or -1 if none. */
+};
+typedef struct HostBuffer HostBuffer;
+
 /* Memory allocated per device. */
 struct DeviceData
 {
-    /* Host memory. */
-    /* Chunks have dimension max_chunk_size * num_active_stations. */
-    /* Cross power beams have dimension max_chunk_size. */
-    oskar_Mem* jones_data_cpu[2]; /* On host, for copy back & write. */
-
-    /* Per Stokes parameter. */
-    oskar_Mem* auto_power_cpu[4][2]; /* On host, for copy back & write. */
-    oskar_Mem* auto_power_time_avg[4];
-    oskar_Mem* auto_power_channel_avg[4];
-    oskar_Mem* auto_power_channel_and_time_avg[4];
-    oskar_Mem* cross_power_cpu[4][2]; /* On host, for copy back & write. */
-    oskar_Mem* cross_power_time_avg[4];
-    oskar_Mem* cross_power_channel_avg[4];
-    oskar_Mem* cross_power_channel_and_time_avg[4];
-
     /* Device memory. */
     int previous_chunk_index;
     oskar_Telescope* tel;
@@ -111,18 +110,31 @@ struct oskar_BeamPattern
 
     /* State. */
     oskar_Mutex* mutex;
-    oskar_Barrier* barrier;
     oskar_Log* log;
-    int i_global, status;
+    int status;
 
     /* Input data. */
     oskar_Mem *x, *y, *z;
     oskar_Telescope* tel;
 
-    /* Temporary arrays. */
-    oskar_Mem* pix; /* Real-valued pixel array to write to file. */
+    /* Temporary arrays, used only by the writer. */
+    oskar_Mem** pix; /* Pixel values, per averaged data product. */
     oskar_Mem* ctemp; /* Complex-valued array used for reordering. */
 
+    /* Ring of host buffers, filled by the devices in any order
+     * and emptied by the writer in task order. */
+    int num_buffers;
+    HostBuffer* buffers;
+
+    /* Averages of the chunk being written, per Stokes parameter.
+     * These are accessed only by the writer. */
+    oskar_Mem* auto_power_time_avg[4];
+    oskar_Mem* auto_power_channel_avg[4];
+    oskar_Mem* auto_power_channel_and_time_avg[4];
+    oskar_Mem* cross_power_time_avg[4];
+    oskar_Mem* cross_power_channel_avg[4];
+    oskar_Mem* cross_power_channel_and_time_avg[4];
+
     /* Settings log data. */
     char* settings_log;
     size_t settings_log_length;
@@ -54,6 +54,8 @@ static void set_up_host_data(oskar_BeamPattern* h, int *status);
 static void create_averaged_products(oskar_BeamPattern* h, int ta, int ca,
         int* status);
 static void set_up_device_data(oskar_BeamPattern* h, int* status);
+static oskar_Mem** create_pixel_arrays(const oskar_BeamPattern* h,
+        int averaged, int* status);
 static void write_axis(fitsfile* fptr, int axis_id, const char* ctype,
         const char* ctype_comment, double crval, double cdelt, double crpix,
         int* status);
@@ -110,14 +112,10 @@ static void set_up_host_data(oskar_BeamPattern* h, int *status)
     /* Work out how many pixel chunks have to be processed. */
     h->num_chunks = (h->num_pixels + h->max_chunk_size - 1) / h->max_chunk_size;
 
-    /* Create scratch arrays for output pixel data. */
-    if (!h->pix)
-    {
-        h->pix = oskar_mem_create(h->prec, OSKAR_CPU,
-                h->max_chunk_size, status);
+    /* Create scratch array for output pixel data. */
+    if (!h->ctemp)
         h->ctemp = oskar_mem_create(h->prec | OSKAR_COMPLEX, OSKAR_CPU,
                 h->max_chunk_size, status);
-    }
 
     /* Get the contents of the log at this point so we can write a
      * reasonable file header. Replace newlines with zeros. */
@@ -572,6 +570,29 @@ static const char* stokes_type_to_string(int type)
 }
 
 
+static oskar_Mem** create_pixel_arrays(const oskar_BeamPattern* h,
+        int averaged, int* status)
+{
+    int i;
+    oskar_Mem** pix = (oskar_Mem**) calloc(
+            h->num_data_products, sizeof(oskar_Mem*));
+
+    /* Create an array for each averaged (or non-averaged) data product,
+     * except raw complex data, which is written directly. */
+    for (i = 0; i < h->num_data_products; ++i)
+    {
+        const DataProduct* p = &h->data_products[i];
+        if (p->type == RAW_COMPLEX || p->type == CROSS_POWER_RAW_COMPLEX)
+            continue;
+        if ((p->time_average || p->channel_average) != averaged)
+            continue;
+        pix[i] = oskar_mem_create(h->prec, OSKAR_CPU,
+                h->max_chunk_size, status);
+    }
+    return pix;
+}
+
+
 static void set_up_device_data(oskar_BeamPattern* h, int* status)
 {
     int i, beam_type, max_src, max_size, auto_power, cross_power, raw_data;
@@ -637,43 +658,15 @@ static void set_up_device_data(oskar_BeamPattern* h, int* status)
                         oskar_telescope_tec_screen_path(d->tel));
         }
 
-        /* Host memory. */
-        if (!d->jones_data_cpu[0] && raw_data)
-        {
-            d->jones_data_cpu[0] = oskar_mem_create(beam_type, OSKAR_CPU,
-                    max_size, status);
-            d->jones_data_cpu[1] = oskar_mem_create(beam_type, OSKAR_CPU,
-                    max_size, status);
-        }
-
         /* Auto-correlation beam output arrays. */
         for (i_stokes = 0; i_stokes < 4; ++i_stokes)
         {
             if (!h->stokes[i_stokes]) continue;
 
             if (!d->auto_power[i_stokes] && auto_power)
-            {
-                /* Device memory. */
                 d->auto_power[i_stokes] = oskar_mem_create(beam_type, dev_loc,
                         max_size, status);
 
-                /* Host memory. */
-                d->auto_power_cpu[i_stokes][0] = oskar_mem_create(
-                        beam_type, OSKAR_CPU, max_size, status);
-                d->auto_power_cpu[i_stokes][1] = oskar_mem_create(
-                        beam_type, OSKAR_CPU, max_size, status);
-                if (h->average_single_axis == 'T')
-                    d->auto_power_time_avg[i_stokes] = oskar_mem_create(
-                            beam_type, OSKAR_CPU, max_size, status);
-                if (h->average_single_axis == 'C')
-                    d->auto_power_channel_avg[i_stokes] = oskar_mem_create(
-                            beam_type, OSKAR_CPU, max_size, status);
-                if (h->average_time_and_channel)
-                    d->auto_power_channel_and_time_avg[i_stokes] =
-                            oskar_mem_create(beam_type, OSKAR_CPU,
-                                    max_size, status);
-            }
-
             /* Cross-correlation beam output arrays. */
             if (!d->cross_power[i_stokes] && cross_power)
             {
@@ -688,22 +681,6 @@ static void set_up_device_data(oskar_BeamPattern* h, int* status)
                 /* Device memory. */
                 d->cross_power[i_stokes] = oskar_mem_create(
                         beam_type, dev_loc, max_src, status);
-
-                /* Host memory. */
-                d->cross_power_cpu[i_stokes][0] = oskar_mem_create(
-                        beam_type, OSKAR_CPU, max_src, status);
-                d->cross_power_cpu[i_stokes][1] = oskar_mem_create(
-                        beam_type, OSKAR_CPU, max_src, status);
-                if (h->average_single_axis == 'T')
-                    d->cross_power_time_avg[i_stokes] = oskar_mem_create(
-                            beam_type, OSKAR_CPU, max_src, status);
-                if (h->average_single_axis == 'C')
-                    d->cross_power_channel_avg[i_stokes] = oskar_mem_create(
-                            beam_type, OSKAR_CPU, max_src, status);
-                if (h->average_time_and_channel)
-                    d->cross_power_channel_and_time_avg[i_stokes] =
-                            oskar_mem_create(beam_type, OSKAR_CPU,
-                                    max_src, status);
             }
             if (d->auto_power[i_stokes])
                 oskar_mem_clear_contents(d->auto_power[i_stokes], status);
@@ -715,6 +692,74 @@ static void set_up_device_data(oskar_BeamPattern* h, int* status)
         if (!d->tmr_compute)
             d->tmr_compute = oskar_timer_create(OSKAR_TIMER_NATIVE);
     }
+    if (*status) return;
+
+    /* Host memory: a ring of buffers, two per device, so that each device
+     * can fill one while the writer empties another. */
+    if (!h->buffers)
+    {
+        h->num_buffers = 2 * h->num_devices;
+        h->buffers = (HostBuffer*) calloc(h->num_buffers, sizeof(HostBuffer));
+        for (i = 0; i < h->num_buffers; ++i)
+        {
+            int i_stokes;
+            HostBuffer* b = &h->buffers[i];
+            if (raw_data)
+                b->jones_data_cpu = oskar_mem_create(beam_type, OSKAR_CPU,
+                        max_size, status);
+            b->ctemp = oskar_mem_create(h->prec | OSKAR_COMPLEX, OSKAR_CPU,
+                    max_src, status);
+            b->pix = create_pixel_arrays(h, 0, status);
+            for (i_stokes = 0; i_stokes < 4; ++i_stokes)
+            {
+                if (!h->stokes[i_stokes]) continue;
+                if (auto_power)
+                    b->auto_power_cpu[i_stokes] = oskar_mem_create(
+                            beam_type, OSKAR_CPU, max_size, status);
+                if (cross_power)
+                    b->cross_power_cpu[i_stokes] = oskar_mem_create(
+                            beam_type, OSKAR_CPU, max_src, status);
+            }
+        }
+    }
+    for (i = 0; i < h->num_buffers; ++i)
+        h->buffers[i].task_index = -1;
+    if (!h->pix)
+        h->pix = create_pixel_arrays(h, 1, status);
+
+    /* Averaged beam arrays, used only by the writer. */
+    for (i = 0; i < 4; ++i)
+    {
+        if (!h->stokes[i]) continue;
+        if (auto_power && !h->auto_power_time_avg[i] &&
+                !h->auto_power_channel_avg[i] &&
+                !h->auto_power_channel_and_time_avg[i])
+        {
+            if (h->average_single_axis == 'T')
+                h->auto_power_time_avg[i] = oskar_mem_create(
+                        beam_type, OSKAR_CPU, max_size, status);
+            if (h->average_single_axis == 'C')
+                h->auto_power_channel_avg[i] = oskar_mem_create(
+                        beam_type, OSKAR_CPU, max_size, status);
+            if (h->average_time_and_channel)
+                h->auto_power_channel_and_time_avg[i] = oskar_mem_create(
+                        beam_type, OSKAR_CPU, max_size, status);
+        }
+        if (cross_power && !h->cross_power_time_avg[i] &&
+                !h->cross_power_channel_avg[i] &&
+                !h->cross_power_channel_and_time_avg[i])
+        {
+            if (h->average_single_axis == 'T')
+                h->cross_power_time_avg[i] = oskar_mem_create(
+                        beam_type, OSKAR_CPU, max_src, status);
+            if (h->average_single_axis == 'C')
+                h->cross_power_channel_avg[i] = oskar_mem_create(
+                        beam_type, OSKAR_CPU, max_src, status);
+            if (h->average_time_and_channel)
+                h->cross_power_channel_and_time_avg[i] = oskar_mem_create(
+                        beam_type, OSKAR_CPU, max_src, status);
+        }
+    }
 }
 
 #ifdef __cplusplus
@@ -46,9 +46,12 @@ void oskar_beam_pattern_reset_cache(oskar_BeamPattern* h, int* status)
     oskar_mem_free(h->x, status);
     oskar_mem_free(h->y, status);
     oskar_mem_free(h->z, status);
-    oskar_mem_free(h->pix, status);
     oskar_mem_free(h->ctemp, status);
-    h->x = h->y = h->z = h->pix = h->ctemp = NULL;
+    h->x = h->y = h->z = h->ctemp = NULL;
+    for (i = 0; i < h->num_data_products; ++i)
+        if (h->pix) oskar_mem_free(h->pix[i], status);
+    free(h->pix);
+    h->pix = NULL;
 
     /* Close files and free data products. */
     for (i = 0; i < h->num_data_products; ++i)
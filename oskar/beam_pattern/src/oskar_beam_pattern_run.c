@@ -54,21 +54,32 @@ extern "C" {
 #endif
 
 static void* run_blocks(void* arg);
-static void sim_chunks(oskar_BeamPattern* h, int i_chunk_start, int i_time,
-        int i_channel, int i_active, int device_id, int* status);
-static void write_chunks(oskar_BeamPattern* h, int i_chunk_start, int i_time,
-        int i_channel, int i_active, int* status);
-static void write_pixels(oskar_BeamPattern* h, int i_chunk, int i_time,
+static void task_indices(const oskar_BeamPattern* h, int task_index,
+        int* i_chunk, int* i_time, int* i_channel);
+static void sim_chunk(oskar_BeamPattern* h, int task_index, HostBuffer* buf,
+        int device_id, int* status);
+static void write_chunk(oskar_BeamPattern* h, int task_index,
+        const HostBuffer* buf, int* status);
+static void write_averaged(oskar_BeamPattern* h, int i_chunk, int i_time,
         int i_channel, int num_pix, int channel_average, int time_average,
         const oskar_Mem* in, int chunk_desc, int stokes_in, int* status);
-static void complex_to_amp(const oskar_Mem* complex_in, const int offset,
-        const int stride, const int num_points, oskar_Mem* output, int* status);
-static void complex_to_phase(const oskar_Mem* complex_in, const int offset,
-        const int stride, const int num_points, oskar_Mem* output, int* status);
-static void complex_to_real(const oskar_Mem* complex_in, const int offset,
-        const int stride, const int num_points, oskar_Mem* output, int* status);
-static void complex_to_imag(const oskar_Mem* complex_in, const int offset,
-        const int stride, const int num_points, oskar_Mem* output, int* status);
+static void write_pixels(oskar_BeamPattern* h, int i_chunk, int i_time,
+        int i_channel, int num_pix, int channel_average, int time_average,
+        const oskar_Mem* in, int chunk_desc, int stokes_in,
+        oskar_Mem* const* pix, int* status);
+static int product_wanted(const DataProduct* p, int channel_average,
+        int time_average, int chunk_desc, int stokes_in);
+static int product_kind(const DataProduct* p);
+static void convert_pixels(const oskar_BeamPattern* h, int num_pix,
+        int channel_average, int time_average, const oskar_Mem* in,
+        int chunk_desc, int stokes_in, oskar_Mem* ctemp,
+        oskar_Mem* const* pix, int* status);
+static void complex_to_pixels(const oskar_Mem* complex_in, const int offset,
+        const int stride, const int num_points, oskar_Mem* const* out,
+        int* status);
+static int power_to_stokes(const oskar_Mem* power_in, const int offset,
+        const int num_points, const int stokes, oskar_Mem* output,
+        int* status);
 static void jones_to_ixr(const oskar_Mem* complex_in, const int offset,
         const int num_points, oskar_Mem* output, int* status);
 static void power_to_stokes_I(const oskar_Mem* power_in, const int offset,
@@ -83,10 +94,20 @@ static void record_timing(oskar_BeamPattern* h);
 static unsigned int disp_width(unsigned int value);
 
 
+struct Schedule
+{
+    oskar_ConditionVar* var;
+    int num_tasks;            /* Total number of (chunk, time, channel). */
+    int next_task;            /* Index of the next task to simulate. */
+    int num_tasks_written;    /* Number of tasks written, in order. */
+};
+typedef struct Schedule Schedule;
+
 struct ThreadArgs
 {
     oskar_BeamPattern* h;
-    int num_threads, thread_id;
+    Schedule* schedule;
+    int thread_id;
 };
 typedef struct ThreadArgs ThreadArgs;
 
@@ -96,6 +117,7 @@ void oskar_beam_pattern_run(oskar_BeamPattern* h, int* status)
     oskar_Timer* tmr;
     oskar_Thread** threads = 0;
     ThreadArgs* args = 0;
+    Schedule schedule;
     if (*status || !h) return;
 
     /* Check root name exists. */
@@ -111,15 +133,19 @@ void oskar_beam_pattern_run(oskar_BeamPattern* h, int* status)
     tmr = oskar_timer_create(OSKAR_TIMER_NATIVE);
     oskar_timer_resume(tmr);
 
-    /* Set up worker threads. */
+    /* Set up worker threads: one for file writes, and one per device. */
+    schedule.var = oskar_condition_create();
+    schedule.num_tasks = *status ? 0 :
+            h->num_chunks * h->num_time_steps * h->num_channels;
+    schedule.next_task = 0;
+    schedule.num_tasks_written = 0;
     const int num_threads = h->num_devices + 1;
-    oskar_barrier_set_num_threads(h->barrier, num_threads);
     threads = (oskar_Thread**) calloc(num_threads, sizeof(oskar_Thread*));
     args = (ThreadArgs*) calloc(num_threads, sizeof(ThreadArgs));
     for (i = 0; i < num_threads; ++i)
     {
         args[i].h = h;
-        args[i].num_threads = num_threads;
+        args[i].schedule = &schedule;
         args[i].thread_id = i;
     }
 
@@ -152,6 +178,7 @@ void oskar_beam_pattern_run(oskar_BeamPattern* h, int* status)
     }
     free(threads);
     free(args);
+    oskar_condition_free(schedule.var);
 
     /* Get status code. */
     *status = h->status;
@@ -191,17 +218,17 @@ void oskar_beam_pattern_run(oskar_BeamPattern* h, int* status)
 static void* run_blocks(void* arg)
 {
     oskar_BeamPattern* h;
-    int i_inner, i_outer, num_inner, num_outer, c, t, f, *status;
-
-    /* Loop indices for previous iteration (accessed only by thread 0). */
-    int cp = 0, tp = 0, fp = 0;
+    Schedule* schedule;
+    int k, *status;
 
     /* Get thread function arguments. */
     h = ((ThreadArgs*)arg)->h;
+    schedule = ((ThreadArgs*)arg)->schedule;
     status = &(h->status);
-    const int num_threads = ((ThreadArgs*)arg)->num_threads;
     const int thread_id = ((ThreadArgs*)arg)->thread_id;
     const int device_id = thread_id - 1;
+    const int num_buffers = h->num_buffers;
+    const int num_tasks = schedule->num_tasks;
 
 #ifdef _OPENMP
     /* Disable any nested parallelism. */
@@ -212,85 +239,98 @@ static void* run_blocks(void* arg)
     if (device_id >= 0 && device_id < h->num_gpus)
         oskar_device_set(h->dev_loc, h->gpu_ids[device_id], status);
 
-    /* Set ranges of inner and outer loops based on averaging mode. */
-    if (h->average_single_axis != 'T')
-    {
-        num_outer = h->num_time_steps;
-        num_inner = h->num_channels; /* Channel on inner loop. */
-    }
-    else
-    {
-        num_outer = h->num_channels;
-        num_inner = h->num_time_steps; /* Time on inner loop. */
-    }
-
-    /* Loop over image pixel chunks, running simulation and file writing one
-     * chunk at a time. Simulation and file output are overlapped by using
-     * double buffering, and a dedicated thread is used for file output.
+    /* Loop over tasks, each of which is one pixel chunk at one time and
+     * channel. Simulation and file output are overlapped by using a ring
+     * of host buffers, one for each task in flight.
      *
      * Thread 0 is used for file writes.
      * Threads 1 to n (mapped to compute devices) do the simulation.
+     *
+     * There is no barrier between tasks. Each device claims the next task
+     * from a shared counter as soon as it has finished its previous one,
+     * so faster devices (or devices with smaller chunks) simply process
+     * more of them. A device waits only if the host buffer for its task is
+     * still waiting to be written. The writer takes the tasks in order,
+     * so that text files and averages are the same as a serial run.
      */
-    for (c = 0; c < h->num_chunks; c += h->num_devices)
+    if (thread_id > 0)
     {
-        for (i_outer = 0; i_outer < num_outer; ++i_outer)
+        for (;;)
         {
-            for (i_inner = 0; i_inner < num_inner; ++i_inner)
-            {
-                /* Set time and channel indices based on averaging mode. */
-                if (h->average_single_axis != 'T')
-                {
-                    t = i_outer;
-                    f = i_inner;
-                }
-                else
-                {
-                    f = i_outer;
-                    t = i_inner;
-                }
-                if (thread_id > 0 || num_threads == 1)
-                    sim_chunks(h, c, t, f, h->i_global & 1, device_id, status);
-                if (thread_id == 0 && h->i_global > 0)
-                    write_chunks(h, cp, tp, fp, h->i_global & 1, status);
-
-                /* Barrier 1: Set indices of the previous chunk(s). */
-                oskar_barrier_wait(h->barrier);
-                if (thread_id == 0)
-                {
-                    cp = c;
-                    tp = t;
-                    fp = f;
-                    h->i_global++;
-                }
-
-                /* Barrier 2: Check sim and write are done. */
-                oskar_barrier_wait(h->barrier);
-            }
+            /* Claim the next task, and wait until its buffer is free. */
+            oskar_condition_lock(schedule->var);
+            k = schedule->next_task++;
+            while (k < num_tasks &&
+                    schedule->num_tasks_written < k - (num_buffers - 1))
+                oskar_condition_wait(schedule->var);
+            oskar_condition_unlock(schedule->var);
+            if (k >= num_tasks) break;
+
+            /* Simulate the task, and tell the writer it is ready. */
+            sim_chunk(h, k, &h->buffers[k % num_buffers], device_id, status);
+            oskar_condition_lock(schedule->var);
+            h->buffers[k % num_buffers].task_index = k;
+            oskar_condition_notify_all(schedule->var);
+            oskar_condition_unlock(schedule->var);
+        }
+    }
+    else
+    {
+        for (k = 0; k < num_tasks; ++k)
+        {
+            /* Wait for the task to be simulated. */
+            HostBuffer* buf = &h->buffers[k % num_buffers];
+            oskar_condition_lock(schedule->var);
+            while (buf->task_index != k)
+                oskar_condition_wait(schedule->var);
+            oskar_condition_unlock(schedule->var);
+
+            /* Write the task, and release its buffer. */
+            write_chunk(h, k, buf, status);
+            oskar_condition_lock(schedule->var);
+            schedule->num_tasks_written = k + 1;
+            oskar_condition_notify_all(schedule->var);
+            oskar_condition_unlock(schedule->var);
         }
     }
+    return 0;
+}
 
-    /* Write the very last chunk(s). */
-    if (thread_id == 0)
-        write_chunks(h, cp, tp, fp, h->i_global & 1, status);
 
-    return 0;
+static void task_indices(const oskar_BeamPattern* h, int task_index,
+        int* i_chunk, int* i_time, int* i_channel)
+{
+    /* Set time and channel indices based on averaging mode.
+     * The chunk is on the outer loop, so that each chunk is finished
+     * (and its averages written) before the next one is started. */
+    const int num_per_chunk = h->num_time_steps * h->num_channels;
+    const int i = task_index % num_per_chunk;
+    *i_chunk = task_index / num_per_chunk;
+    if (h->average_single_axis != 'T')
+    {
+        *i_time = i / h->num_channels;
+        *i_channel = i % h->num_channels; /* Channel on inner loop. */
+    }
+    else
+    {
+        *i_channel = i / h->num_time_steps;
+        *i_time = i % h->num_time_steps; /* Time on inner loop. */
+    }
 }
 
 
-static void sim_chunks(oskar_BeamPattern* h, int i_chunk_start, int i_time,
-        int i_channel, int i_active, int device_id, int* status)
+static void sim_chunk(oskar_BeamPattern* h, int task_index, HostBuffer* buf,
+        int device_id, int* status)
 {
-    int chunk_size, i;
+    int chunk_size, i, i_chunk, i_time, i_channel;
     DeviceData* d;
 
     /* Check if safe to proceed. */
     if (*status) return;
 
-    /* Get chunk index from GPU ID and chunk start,
-     * and return immediately if it's out of range. */
+    /* Get chunk, time and channel indices from the task index. */
     d = &h->d[device_id];
-    const int i_chunk = i_chunk_start + device_id;
-    if (i_chunk >= h->num_chunks) return;
+    task_indices(h, task_index, &i_chunk, &i_time, &i_channel);
 
     /* Get time and frequency values. */
     oskar_timer_resume(d->tmr_compute);
@@ -348,19 +388,31 @@ static void sim_chunks(oskar_BeamPattern* h, int i_chunk_start, int i_time,
                 d->jones_data, 0, d->cross_power[I], status);
 
     /* Copy the output data into host memory. */
-    if (d->jones_data_cpu[i_active])
-        oskar_mem_copy_contents(d->jones_data_cpu[i_active], d->jones_data,
+    if (buf->jones_data_cpu)
+        oskar_mem_copy_contents(buf->jones_data_cpu, d->jones_data,
                 0, 0, chunk_size * h->num_active_stations, status);
     for (i = 0; i < 4; ++i)
     {
         if (d->auto_power[i])
-            oskar_mem_copy_contents(d->auto_power_cpu[i][i_active],
+            oskar_mem_copy_contents(buf->auto_power_cpu[i],
                     d->auto_power[i], 0, 0,
                     chunk_size * h->num_active_stations, status);
         if (d->cross_power[i])
-            oskar_mem_copy_contents(d->cross_power_cpu[i][i_active],
+            oskar_mem_copy_contents(buf->cross_power_cpu[i],
                     d->cross_power[i], 0, 0, chunk_size, status);
     }
+
+    /* Convert the data to pixel values for all non-averaged data products,
+     * so that the writer thread only has to write them. */
+    convert_pixels(h, chunk_size, 0, 0, buf->jones_data_cpu,
+            JONES_DATA, -1, buf->ctemp, buf->pix, status);
+    for (i = 0; i < 4; ++i)
+    {
+        convert_pixels(h, chunk_size, 0, 0, buf->auto_power_cpu[i],
+                AUTO_POWER_DATA, i, buf->ctemp, buf->pix, status);
+        convert_pixels(h, chunk_size, 0, 0, buf->cross_power_cpu[i],
+                CROSS_POWER_DATA, i, buf->ctemp, buf->pix, status);
+    }
     oskar_mutex_lock(h->mutex);
     oskar_log_message(h->log, 'S', 1, "Chunk %*i/%i, "
             "Time %*i/%i, Channel %*i/%i [Device %i]",
@@ -373,271 +425,204 @@ static void sim_chunks(oskar_BeamPattern* h, int i_chunk_start, int i_time,
 }
 
 
-static void write_chunks(oskar_BeamPattern* h, int i_chunk_start,
-        int i_time, int i_channel, int i_active, int* status)
+static void write_chunk(oskar_BeamPattern* h, int task_index,
+        const HostBuffer* buf, int* status)
 {
-    int i, chunk_sources, stokes;
+    int chunk_sources, stokes, i_chunk, i_time, i_channel;
     if (*status) return;
 
-    /* Write inactive chunk(s) from all GPUs. */
+    /* Get chunk, time and channel indices from the task index. */
+    task_indices(h, task_index, &i_chunk, &i_time, &i_channel);
     oskar_timer_resume(h->tmr_write);
-    for (i = 0; i < h->num_devices; ++i)
-    {
-        DeviceData* d = &h->d[i];
 
-        /* Get chunk index from GPU ID & chunk start. Stop if out of range. */
-        const int i_chunk = i_chunk_start + i;
-        if (i_chunk >= h->num_chunks || *status) break;
+    /* Get the size of the chunk. */
+    chunk_sources = h->max_chunk_size;
+    if ((i_chunk + 1) * h->max_chunk_size > h->num_pixels)
+        chunk_sources = h->num_pixels - i_chunk * h->max_chunk_size;
+    const int chunk_size = chunk_sources * h->num_active_stations;
 
-        /* Get the size of the chunk. */
-        chunk_sources = h->max_chunk_size;
-        if ((i_chunk + 1) * h->max_chunk_size > h->num_pixels)
-            chunk_sources = h->num_pixels - i_chunk * h->max_chunk_size;
-        const int chunk_size = chunk_sources * h->num_active_stations;
+    /* Write non-averaged raw data, if required. */
+    write_pixels(h, i_chunk, i_time, i_channel, chunk_sources, 0, 0,
+            buf->jones_data_cpu, JONES_DATA, -1, buf->pix, status);
 
-        /* Write non-averaged raw data, if required. */
+    /* Loop over Stokes parameters. */
+    for (stokes = 0; stokes < 4; ++stokes)
+    {
+        /* Write non-averaged data, if required. */
         write_pixels(h, i_chunk, i_time, i_channel, chunk_sources, 0, 0,
-                d->jones_data_cpu[!i_active], JONES_DATA, -1, status);
-
-        /* Loop over Stokes parameters. */
-        for (stokes = 0; stokes < 4; ++stokes)
+                buf->auto_power_cpu[stokes],
+                AUTO_POWER_DATA, stokes, buf->pix, status);
+        write_pixels(h, i_chunk, i_time, i_channel, chunk_sources, 0, 0,
+                buf->cross_power_cpu[stokes],
+                CROSS_POWER_DATA, stokes, buf->pix, status);
+
+        /* Time-average the data if required. */
+        if (h->auto_power_time_avg[stokes])
+            oskar_mem_add(h->auto_power_time_avg[stokes],
+                    h->auto_power_time_avg[stokes],
+                    buf->auto_power_cpu[stokes],
+                    0, 0, 0, chunk_size, status);
+        if (h->cross_power_time_avg[stokes])
+            oskar_mem_add(h->cross_power_time_avg[stokes],
+                    h->cross_power_time_avg[stokes],
+                    buf->cross_power_cpu[stokes],
+                    0, 0, 0, chunk_sources, status);
+
+        /* Channel-average the data if required. */
+        if (h->auto_power_channel_avg[stokes])
+            oskar_mem_add(h->auto_power_channel_avg[stokes],
+                    h->auto_power_channel_avg[stokes],
+                    buf->auto_power_cpu[stokes],
+                    0, 0, 0, chunk_size, status);
+        if (h->cross_power_channel_avg[stokes])
+            oskar_mem_add(h->cross_power_channel_avg[stokes],
+                    h->cross_power_channel_avg[stokes],
+                    buf->cross_power_cpu[stokes],
+                    0, 0, 0, chunk_sources, status);
+
+        /* Channel- and time-average the data if required. */
+        if (h->auto_power_channel_and_time_avg[stokes])
+            oskar_mem_add(h->auto_power_channel_and_time_avg[stokes],
+                    h->auto_power_channel_and_time_avg[stokes],
+                    buf->auto_power_cpu[stokes],
+                    0, 0, 0, chunk_size, status);
+        if (h->cross_power_channel_and_time_avg[stokes])
+            oskar_mem_add(h->cross_power_channel_and_time_avg[stokes],
+                    h->cross_power_channel_and_time_avg[stokes],
+                    buf->cross_power_cpu[stokes],
+                    0, 0, 0, chunk_sources, status);
+
+        /* Write time-averaged data. */
+        if (i_time == h->num_time_steps - 1)
         {
-            /* Write non-averaged data, if required. */
-            write_pixels(h, i_chunk, i_time, i_channel, chunk_sources, 0, 0,
-                    d->auto_power_cpu[stokes][!i_active],
-                    AUTO_POWER_DATA, stokes, status);
-            write_pixels(h, i_chunk, i_time, i_channel, chunk_sources, 0, 0,
-                    d->cross_power_cpu[stokes][!i_active],
-                    CROSS_POWER_DATA, stokes, status);
-
-            /* Time-average the data if required. */
-            if (d->auto_power_time_avg[stokes])
-                oskar_mem_add(d->auto_power_time_avg[stokes],
-                        d->auto_power_time_avg[stokes],
-                        d->auto_power_cpu[stokes][!i_active],
-                        0, 0, 0, chunk_size, status);
-            if (d->cross_power_time_avg[stokes])
-                oskar_mem_add(d->cross_power_time_avg[stokes],
-                        d->cross_power_time_avg[stokes],
-                        d->cross_power_cpu[stokes][!i_active],
-                        0, 0, 0, chunk_sources, status);
-
-            /* Channel-average the data if required. */
-            if (d->auto_power_channel_avg[stokes])
-                oskar_mem_add(d->auto_power_channel_avg[stokes],
-                        d->auto_power_channel_avg[stokes],
-                        d->auto_power_cpu[stokes][!i_active],
-                        0, 0, 0, chunk_size, status);
-            if (d->cross_power_channel_avg[stokes])
-                oskar_mem_add(d->cross_power_channel_avg[stokes],
-                        d->cross_power_channel_avg[stokes],
-                        d->cross_power_cpu[stokes][!i_active],
-                        0, 0, 0, chunk_sources, status);
-
-            /* Channel- and time-average the data if required. */
-            if (d->auto_power_channel_and_time_avg[stokes])
-                oskar_mem_add(d->auto_power_channel_and_time_avg[stokes],
-                        d->auto_power_channel_and_time_avg[stokes],
-                        d->auto_power_cpu[stokes][!i_active],
-                        0, 0, 0, chunk_size, status);
-            if (d->cross_power_channel_and_time_avg[stokes])
-                oskar_mem_add(d->cross_power_channel_and_time_avg[stokes],
-                        d->cross_power_channel_and_time_avg[stokes],
-                        d->cross_power_cpu[stokes][!i_active],
-                        0, 0, 0, chunk_sources, status);
-
-            /* Write time-averaged data. */
-            if (i_time == h->num_time_steps - 1)
+            if (h->auto_power_time_avg[stokes])
+            {
+                oskar_mem_scale_real(h->auto_power_time_avg[stokes],
+                        1.0 / h->num_time_steps, 0, chunk_size, status);
+                write_averaged(h, i_chunk, 0, i_channel, chunk_sources, 0, 1,
+                        h->auto_power_time_avg[stokes],
+                        AUTO_POWER_DATA, stokes, status);
+                oskar_mem_clear_contents(h->auto_power_time_avg[stokes],
+                        status);
+            }
+            if (h->cross_power_time_avg[stokes])
             {
-                if (d->auto_power_time_avg[stokes])
-                {
-                    oskar_mem_scale_real(d->auto_power_time_avg[stokes],
-                            1.0 / h->num_time_steps, 0, chunk_size, status);
-                    write_pixels(h, i_chunk, 0, i_channel, chunk_sources, 0, 1,
-                            d->auto_power_time_avg[stokes],
-                            AUTO_POWER_DATA, stokes, status);
-                    oskar_mem_clear_contents(d->auto_power_time_avg[stokes],
-                            status);
-                }
-                if (d->cross_power_time_avg[stokes])
-                {
-                    oskar_mem_scale_real(d->cross_power_time_avg[stokes],
-                            1.0 / h->num_time_steps, 0, chunk_sources, status);
-                    write_pixels(h, i_chunk, 0, i_channel, chunk_sources, 0, 1,
-                            d->cross_power_time_avg[stokes],
-                            CROSS_POWER_DATA, stokes, status);
-                    oskar_mem_clear_contents(d->cross_power_time_avg[stokes],
-                            status);
-                }
+                oskar_mem_scale_real(h->cross_power_time_avg[stokes],
+                        1.0 / h->num_time_steps, 0, chunk_sources, status);
+                write_averaged(h, i_chunk, 0, i_channel, chunk_sources, 0, 1,
+                        h->cross_power_time_avg[stokes],
+                        CROSS_POWER_DATA, stokes, status);
+                oskar_mem_clear_contents(h->cross_power_time_avg[stokes],
+                        status);
             }
+        }
 
-            /* Write channel-averaged data. */
-            if (i_channel == h->num_channels - 1)
+        /* Write channel-averaged data. */
+        if (i_channel == h->num_channels - 1)
+        {
+            if (h->auto_power_channel_avg[stokes])
+            {
+                oskar_mem_scale_real(h->auto_power_channel_avg[stokes],
+                        1.0 / h->num_channels, 0, chunk_size, status);
+                write_averaged(h, i_chunk, i_time, 0, chunk_sources, 1, 0,
+                        h->auto_power_channel_avg[stokes],
+                        AUTO_POWER_DATA, stokes, status);
+                oskar_mem_clear_contents(h->auto_power_channel_avg[stokes],
+                        status);
+            }
+            if (h->cross_power_channel_avg[stokes])
             {
-                if (d->auto_power_channel_avg[stokes])
-                {
-                    oskar_mem_scale_real(d->auto_power_channel_avg[stokes],
-                            1.0 / h->num_channels, 0, chunk_size, status);
-                    write_pixels(h, i_chunk, i_time, 0, chunk_sources, 1, 0,
-                            d->auto_power_channel_avg[stokes],
-                            AUTO_POWER_DATA, stokes, status);
-                    oskar_mem_clear_contents(d->auto_power_channel_avg[stokes],
-                            status);
-                }
-                if (d->cross_power_channel_avg[stokes])
-                {
-                    oskar_mem_scale_real(d->cross_power_channel_avg[stokes],
-                            1.0 / h->num_channels, 0, chunk_sources, status);
-                    write_pixels(h, i_chunk, i_time, 0, chunk_sources, 1, 0,
-                            d->cross_power_channel_avg[stokes],
-                            CROSS_POWER_DATA, stokes, status);
-                    oskar_mem_clear_contents(
-                            d->cross_power_channel_avg[stokes], status);
-                }
+                oskar_mem_scale_real(h->cross_power_channel_avg[stokes],
+                        1.0 / h->num_channels, 0, chunk_sources, status);
+                write_averaged(h, i_chunk, i_time, 0, chunk_sources, 1, 0,
+                        h->cross_power_channel_avg[stokes],
+                        CROSS_POWER_DATA, stokes, status);
+                oskar_mem_clear_contents(
+                        h->cross_power_channel_avg[stokes], status);
             }
+        }
 
-            /* Write channel- and time-averaged data. */
-            if ((i_time == h->num_time_steps - 1) &&
-                    (i_channel == h->num_channels - 1))
+        /* Write channel- and time-averaged data. */
+        if ((i_time == h->num_time_steps - 1) &&
+                (i_channel == h->num_channels - 1))
+        {
+            if (h->auto_power_channel_and_time_avg[stokes])
+            {
+                oskar_mem_scale_real(
+                        h->auto_power_channel_and_time_avg[stokes],
+                        1.0 / (h->num_channels * h->num_time_steps),
+                        0, chunk_size, status);
+                write_averaged(h, i_chunk, 0, 0, chunk_sources, 1, 1,
+                        h->auto_power_channel_and_time_avg[stokes],
+                        AUTO_POWER_DATA, stokes, status);
+                oskar_mem_clear_contents(
+                        h->auto_power_channel_and_time_avg[stokes],
+                        status);
+            }
+            if (h->cross_power_channel_and_time_avg[stokes])
             {
-                if (d->auto_power_channel_and_time_avg[stokes])
-                {
-                    oskar_mem_scale_real(
-                            d->auto_power_channel_and_time_avg[stokes],
-                            1.0 / (h->num_channels * h->num_time_steps),
-                            0, chunk_size, status);
-                    write_pixels(h, i_chunk, 0, 0, chunk_sources, 1, 1,
-                            d->auto_power_channel_and_time_avg[stokes],
-                            AUTO_POWER_DATA, stokes, status);
-                    oskar_mem_clear_contents(
-                            d->auto_power_channel_and_time_avg[stokes],
-                            status);
-                }
-                if (d->cross_power_channel_and_time_avg[stokes])
-                {
-                    oskar_mem_scale_real(
-                            d->cross_power_channel_and_time_avg[stokes],
-                            1.0 / (h->num_channels * h->num_time_steps),
-                            0, chunk_sources, status);
-                    write_pixels(h, i_chunk, 0, 0, chunk_sources, 1, 1,
-                            d->cross_power_channel_and_time_avg[stokes],
-                            CROSS_POWER_DATA, stokes, status);
-                    oskar_mem_clear_contents(
-                            d->cross_power_channel_and_time_avg[stokes],
-                            status);
-                }
+                oskar_mem_scale_real(
+                        h->cross_power_channel_and_time_avg[stokes],
+                        1.0 / (h->num_channels * h->num_time_steps),
+                        0, chunk_sources, status);
+                write_averaged(h, i_chunk, 0, 0, chunk_sources, 1, 1,
+                        h->cross_power_channel_and_time_avg[stokes],
+                        CROSS_POWER_DATA, stokes, status);
+                oskar_mem_clear_contents(
+                        h->cross_power_channel_and_time_avg[stokes],
+                        status);
             }
         }
     }
     oskar_timer_pause(h->tmr_write);
 }
 
+static void write_averaged(oskar_BeamPattern* h, int i_chunk, int i_time,
+        int i_channel, int num_pix, int channel_average, int time_average,
+        const oskar_Mem* in, int chunk_desc, int stokes_in, int* status)
+{
+    /* Averages are only available to the writer, so convert them here. */
+    convert_pixels(h, num_pix, channel_average, time_average, in,
+            chunk_desc, stokes_in, h->ctemp, h->pix, status);
+    write_pixels(h, i_chunk, i_time, i_channel, num_pix, channel_average,
+            time_average, in, chunk_desc, stokes_in, h->pix, status);
+}
+
 
 static void write_pixels(oskar_BeamPattern* h, int i_chunk, int i_time,
         int i_channel, int num_pix, int channel_average, int time_average,
-        const oskar_Mem* in, int chunk_desc, int stokes_in, int* status)
+        const oskar_Mem* in, int chunk_desc, int stokes_in,
+        oskar_Mem* const* pix, int* status)
 {
     int i;
     if (!in) return;
 
     /* Loop over data products. */
-    const int num_pol = h->pol_mode == OSKAR_POL_MODE_FULL ? 4 : 1;
     for (i = 0; i < h->num_data_products; ++i)
     {
-        fitsfile* f;
-        FILE* t;
-        int dp, stokes_out, i_station, off;
-
-        /* Get data product info. */
-        f          = h->data_products[i].fits_file;
-        t          = h->data_products[i].text_file;
-        dp         = h->data_products[i].type;
-        stokes_out = h->data_products[i].stokes_out;
-        i_station  = h->data_products[i].i_station;
-
-        /* Check averaging mode and polarisation input type. */
-        if (h->data_products[i].time_average != time_average ||
-                h->data_products[i].channel_average != channel_average ||
-                h->data_products[i].stokes_in != stokes_in)
+        const DataProduct* p = &h->data_products[i];
+        fitsfile* f = p->fits_file;
+        FILE* t = p->text_file;
+        if (!product_wanted(p, channel_average, time_average,
+                chunk_desc, stokes_in))
             continue;
 
         /* Treat raw data output as special case, as it doesn't go via pix. */
-        if (dp == RAW_COMPLEX && chunk_desc == JONES_DATA && t)
+        if (p->type == RAW_COMPLEX)
         {
             oskar_Mem* station_data;
-            station_data = oskar_mem_create_alias(in, i_station * num_pix,
+            station_data = oskar_mem_create_alias(in, p->i_station * num_pix,
                     num_pix, status);
             oskar_mem_save_ascii(t, 1, 0, num_pix, status, station_data);
             oskar_mem_free(station_data, status);
             continue;
         }
-        if (dp == CROSS_POWER_RAW_COMPLEX &&
-                chunk_desc == CROSS_POWER_DATA && t)
+        if (p->type == CROSS_POWER_RAW_COMPLEX)
         {
             oskar_mem_save_ascii(t, 1, 0, num_pix, status, in);
             continue;
         }
 
-        /* Convert complex values to pixel data. */
-        oskar_mem_clear_contents(h->pix, status);
-        if (chunk_desc == JONES_DATA && dp == AMP)
-        {
-            off = i_station * num_pix * num_pol;
-            if (stokes_out == XX || stokes_out == -1)
-                complex_to_amp(in, off, num_pol, num_pix, h->pix, status);
-            else if (stokes_out == XY)
-                complex_to_amp(in, off + 1, num_pol, num_pix, h->pix, status);
-            else if (stokes_out == YX)
-                complex_to_amp(in, off + 2, num_pol, num_pix, h->pix, status);
-            else if (stokes_out == YY)
-                complex_to_amp(in, off + 3, num_pol, num_pix, h->pix, status);
-            else continue;
-        }
-        else if (chunk_desc == JONES_DATA && dp == PHASE)
-        {
-            off = i_station * num_pix * num_pol;
-            if (stokes_out == XX || stokes_out == -1)
-                complex_to_phase(in, off, num_pol, num_pix, h->pix, status);
-            else if (stokes_out == XY)
-                complex_to_phase(in, off + 1, num_pol, num_pix, h->pix, status);
-            else if (stokes_out == YX)
-                complex_to_phase(in, off + 2, num_pol, num_pix, h->pix, status);
-            else if (stokes_out == YY)
-                complex_to_phase(in, off + 3, num_pol, num_pix, h->pix, status);
-            else continue;
-        }
-        else if (chunk_desc == JONES_DATA && dp == IXR)
-            jones_to_ixr(in, i_station * num_pix, num_pix, h->pix, status);
-        else if (chunk_desc == AUTO_POWER_DATA ||
-                chunk_desc == CROSS_POWER_DATA)
-        {
-            off = i_station * num_pix; /* Station offset. */
-            if (off < 0 || chunk_desc == CROSS_POWER_DATA) off = 0;
-            if (chunk_desc == CROSS_POWER_DATA && (dp & AUTO_POWER))
-                continue;
-            if (chunk_desc == AUTO_POWER_DATA && (dp & CROSS_POWER))
-                continue;
-            if (stokes_out == I)
-                power_to_stokes_I(in, off, num_pix, h->ctemp, status);
-            else if (stokes_out == Q)
-                power_to_stokes_Q(in, off, num_pix, h->ctemp, status);
-            else if (stokes_out == U)
-                power_to_stokes_U(in, off, num_pix, h->ctemp, status);
-            else if (stokes_out == V)
-                power_to_stokes_V(in, off, num_pix, h->ctemp, status);
-            else continue;
-            if (dp & AMP)
-                complex_to_amp(h->ctemp, 0, 1, num_pix, h->pix, status);
-            else if (dp & PHASE)
-                complex_to_phase(h->ctemp, 0, 1, num_pix, h->pix, status);
-            else if (dp & REAL)
-                complex_to_real(h->ctemp, 0, 1, num_pix, h->pix, status);
-            else if (dp & IMAG)
-                complex_to_imag(h->ctemp, 0, 1, num_pix, h->pix, status);
-            else continue;
-        }
-        else continue;
-
         /* Check for FITS file. */
         if (f && h->width && h->height)
         {
@@ -647,127 +632,211 @@ static void write_pixels(oskar_BeamPattern* h, int i_chunk, int i_time,
             firstpix[2] = 1 + i_channel;
             firstpix[3] = 1 + i_time;
             fits_write_pix(f, (h->prec == OSKAR_DOUBLE ? TDOUBLE : TFLOAT),
-                    firstpix, num_pix, oskar_mem_void(h->pix), status);
+                    firstpix, num_pix, oskar_mem_void(pix[i]), status);
         }
 
         /* Check for text file. */
-        if (t) oskar_mem_save_ascii(t, 1, 0, num_pix, status, h->pix);
+        if (t) oskar_mem_save_ascii(t, 1, 0, num_pix, status, pix[i]);
     }
 }
 
 
-static void complex_to_amp(const oskar_Mem* complex_in, const int offset,
-        const int stride, const int num_points, oskar_Mem* output, int* status)
+static int product_wanted(const DataProduct* p, int channel_average,
+        int time_average, int chunk_desc, int stokes_in)
 {
-    int i, j;
-    if (oskar_mem_precision(output) == OSKAR_SINGLE)
-    {
-        float *out, x, y;
-        const float2* in;
-        in = oskar_mem_float2_const(complex_in, status) + offset;
-        out = oskar_mem_float(output, status);
-        for (i = 0; i < num_points; ++i)
-        {
-            j = i * stride;
-            x = in[j].x;
-            y = in[j].y;
-            out[i] = sqrt(x*x + y*y);
-        }
-    }
-    else
+    const int dp = p->type;
+    const int stokes_out = p->stokes_out;
+
+    /* Check averaging mode and polarisation input type. */
+    if (p->time_average != time_average ||
+            p->channel_average != channel_average ||
+            p->stokes_in != stokes_in)
+        return 0;
+
+    /* Check the data product can be made from this type of data. */
+    switch (chunk_desc)
     {
-        double *out, x, y;
-        const double2* in;
-        in = oskar_mem_double2_const(complex_in, status) + offset;
-        out = oskar_mem_double(output, status);
-        for (i = 0; i < num_points; ++i)
-        {
-            j = i * stride;
-            x = in[j].x;
-            y = in[j].y;
-            out[i] = sqrt(x*x + y*y);
-        }
+    case JONES_DATA:
+        if (dp == RAW_COMPLEX)
+            return p->text_file != 0;
+        if (dp == AMP || dp == PHASE)
+            return stokes_out == -1 || (stokes_out >= XX && stokes_out <= YY);
+        return dp == IXR;
+    case AUTO_POWER_DATA:
+    case CROSS_POWER_DATA:
+        if (dp == CROSS_POWER_RAW_COMPLEX)
+            return chunk_desc == CROSS_POWER_DATA && p->text_file != 0;
+        if (chunk_desc == CROSS_POWER_DATA && (dp & AUTO_POWER))
+            return 0;
+        if (chunk_desc == AUTO_POWER_DATA && (dp & CROSS_POWER))
+            return 0;
+        return (dp & (AMP | PHASE | REAL | IMAG)) &&
+                stokes_out >= I && stokes_out <= V;
+    default:
+        return 0;
     }
 }
 
 
-static void complex_to_phase(const oskar_Mem* complex_in, const int offset,
-        const int stride, const int num_points, oskar_Mem* output, int* status)
+/* Returns the index of the pixel value a data product needs:
+ * 0 = amplitude, 1 = phase, 2 = real, 3 = imaginary, 4 = IXR. */
+static int product_kind(const DataProduct* p)
 {
-    int i, j;
-    if (oskar_mem_precision(output) == OSKAR_SINGLE)
+    if (p->type == IXR) return 4;
+    if (p->type & AMP) return 0;
+    if (p->type & PHASE) return 1;
+    if (p->type & REAL) return 2;
+    return 3;
+}
+
+
+static void convert_pixels(const oskar_BeamPattern* h, int num_pix,
+        int channel_average, int time_average, const oskar_Mem* in,
+        int chunk_desc, int stokes_in, oskar_Mem* ctemp,
+        oskar_Mem* const* pix, int* status)
+{
+    int i, j, k;
+    if (!in || *status) return;
+
+    /* Data products with the same station and output polarisation are
+     * made in one pass through the input data, which fills the pixel
+     * arrays of all of them. */
+    const int num_pol = h->pol_mode == OSKAR_POL_MODE_FULL ? 4 : 1;
+    const int num_products = h->num_data_products;
+    for (i = 0; i < num_products; ++i)
     {
-        float *out;
-        const float2* in;
-        in = oskar_mem_float2_const(complex_in, status) + offset;
-        out = oskar_mem_float(output, status);
-        for (i = 0; i < num_points; ++i)
+        oskar_Mem* out[5] = {0, 0, 0, 0, 0};
+        const DataProduct* p = &h->data_products[i];
+        if (!pix[i] || !product_wanted(p, channel_average, time_average,
+                chunk_desc, stokes_in))
+            continue;
+
+        /* Find all the data products made from the same input values,
+         * and skip this one if it was made with an earlier one. */
+        for (j = 0; j < num_products; ++j)
         {
-            j = i * stride;
-            out[i] = atan2(in[j].y, in[j].x);
+            const DataProduct* q = &h->data_products[j];
+            if (!pix[j] || q->i_station != p->i_station ||
+                    q->stokes_out != p->stokes_out ||
+                    !product_wanted(q, channel_average, time_average,
+                            chunk_desc, stokes_in))
+                continue;
+            if (j < i) break;
+            k = product_kind(q);
+            if (!out[k]) out[k] = pix[j];
         }
-    }
-    else
-    {
-        double *out;
-        const double2* in;
-        in = oskar_mem_double2_const(complex_in, status) + offset;
-        out = oskar_mem_double(output, status);
-        for (i = 0; i < num_points; ++i)
+        if (j < i) continue;
+
+        /* Make the pixel values. */
+        if (chunk_desc == JONES_DATA)
+        {
+            int off = p->i_station * num_pix * num_pol;
+            if (p->stokes_out >= XX) off += p->stokes_out - XX;
+            complex_to_pixels(in, off, num_pol, num_pix, out, status);
+            if (out[4])
+                jones_to_ixr(in, p->i_station * num_pix, num_pix,
+                        out[4], status);
+        }
+        else
         {
-            j = i * stride;
-            out[i] = atan2(in[j].y, in[j].x);
+            int off = p->i_station * num_pix; /* Station offset. */
+            if (off < 0 || chunk_desc == CROSS_POWER_DATA) off = 0;
+            if (power_to_stokes(in, off, num_pix, p->stokes_out,
+                    ctemp, status))
+                complex_to_pixels(ctemp, 0, 1, num_pix, out, status);
+            else
+            {
+                /* Polarisation not available: pixels are zero. */
+                for (k = 0; k < 4; ++k)
+                    if (out[k]) oskar_mem_clear_contents(out[k], status);
+            }
+        }
+
+        /* Copy to any other data products of the same kind. */
+        for (j = i + 1; j < num_products; ++j)
+        {
+            const DataProduct* q = &h->data_products[j];
+            if (!pix[j] || q->i_station != p->i_station ||
+                    q->stokes_out != p->stokes_out ||
+                    !product_wanted(q, channel_average, time_average,
+                            chunk_desc, stokes_in))
+                continue;
+            k = product_kind(q);
+            if (pix[j] != out[k])
+                oskar_mem_copy_contents(pix[j], out[k], 0, 0, num_pix, status);
         }
     }
 }
 
 
-static void complex_to_real(const oskar_Mem* complex_in, const int offset,
-        const int stride, const int num_points, oskar_Mem* output, int* status)
+static void complex_to_pixels(const oskar_Mem* complex_in, const int offset,
+        const int stride, const int num_points, oskar_Mem* const* out,
+        int* status)
 {
     int i;
-    if (oskar_mem_precision(output) == OSKAR_SINGLE)
+    if (!out[0] && !out[1] && !out[2] && !out[3]) return;
+    if (oskar_mem_precision(complex_in) == OSKAR_SINGLE)
     {
-        float *out;
-        const float2* in;
-        in = oskar_mem_float2_const(complex_in, status) + offset;
-        out = oskar_mem_float(output, status);
-        for (i = 0; i < num_points; ++i) out[i] = in[i * stride].x;
+        const float2* in = oskar_mem_float2_const(complex_in, status) + offset;
+        float* amp   = out[0] ? oskar_mem_float(out[0], status) : 0;
+        float* phase = out[1] ? oskar_mem_float(out[1], status) : 0;
+        float* re    = out[2] ? oskar_mem_float(out[2], status) : 0;
+        float* im    = out[3] ? oskar_mem_float(out[3], status) : 0;
+        for (i = 0; i < num_points; ++i)
+        {
+            const float x = in[i * stride].x, y = in[i * stride].y;
+            if (amp) amp[i] = sqrt(x*x + y*y);
+            if (phase) phase[i] = atan2(y, x);
+            if (re) re[i] = x;
+            if (im) im[i] = y;
+        }
     }
     else
     {
-        double *out;
-        const double2* in;
-        in = oskar_mem_double2_const(complex_in, status) + offset;
-        out = oskar_mem_double(output, status);
-        for (i = 0; i < num_points; ++i) out[i] = in[i * stride].x;
+        const double2* in = oskar_mem_double2_const(complex_in, status) +
+                offset;
+        double* amp   = out[0] ? oskar_mem_double(out[0], status) : 0;
+        double* phase = out[1] ? oskar_mem_double(out[1], status) : 0;
+        double* re    = out[2] ? oskar_mem_double(out[2], status) : 0;
+        double* im    = out[3] ? oskar_mem_double(out[3], status) : 0;
+        for (i = 0; i < num_points; ++i)
+        {
+            const double x = in[i * stride].x, y = in[i * stride].y;
+            if (amp) amp[i] = sqrt(x*x + y*y);
+            if (phase) phase[i] = atan2(y, x);
+            if (re) re[i] = x;
+            if (im) im[i] = y;
+        }
     }
 }
 
 
-static void complex_to_imag(const oskar_Mem* complex_in, const int offset,
-        const int stride, const int num_points, oskar_Mem* output, int* status)
+static int power_to_stokes(const oskar_Mem* power_in, const int offset,
+        const int num_points, const int stokes, oskar_Mem* output,
+        int* status)
 {
-    int i;
-    if (oskar_mem_precision(output) == OSKAR_SINGLE)
-    {
-        float *out;
-        const float2* in;
-        in = oskar_mem_float2_const(complex_in, status) + offset;
-        out = oskar_mem_float(output, status);
-        for (i = 0; i < num_points; ++i) out[i] = in[i * stride].y;
-    }
-    else
+    /* Only Stokes I is available from scalar data. */
+    if (stokes != I && !oskar_mem_is_matrix(power_in)) return 0;
+    switch (stokes)
     {
-        double *out;
-        const double2* in;
-        in = oskar_mem_double2_const(complex_in, status) + offset;
-        out = oskar_mem_double(output, status);
-        for (i = 0; i < num_points; ++i) out[i] = in[i * stride].y;
+    case I:
+        power_to_stokes_I(power_in, offset, num_points, output, status);
+        break;
+    case Q:
+        power_to_stokes_Q(power_in, offset, num_points, output, status);
+        break;
+    case U:
+        power_to_stokes_U(power_in, offset, num_points, output, status);
+        break;
+    case V:
+        power_to_stokes_V(power_in, offset, num_points, output, status);
+        break;
+    default:
+        return 0;
     }
+    return 1;
 }
 
-
 static void jones_to_ixr(const oskar_Mem* jones, const int offset,
         const int num_points, oskar_Mem* output, int* status)
 {
@@ -30,6 +30,7 @@
 #include "beam_pattern/private_beam_pattern_free_device_data.h"
 #include "utility/oskar_device.h"
 
+#include <stdlib.h>
 #include <string.h>
 
 #ifdef __cplusplus
@@ -45,25 +46,13 @@ void oskar_beam_pattern_free_device_data(oskar_BeamPattern* h, int* status)
         if (!d) continue;
         if (i < h->num_gpus)
             oskar_device_set(h->dev_loc, h->gpu_ids[i], status);
-        oskar_mem_free(d->jones_data_cpu[0], status);
-        oskar_mem_free(d->jones_data_cpu[1], status);
         oskar_mem_free(d->jones_data, status);
         oskar_mem_free(d->x, status);
         oskar_mem_free(d->y, status);
         oskar_mem_free(d->z, status);
         for (j = 0; j < 4; ++j)
         {
-            oskar_mem_free(d->auto_power_cpu[j][0], status);
-            oskar_mem_free(d->auto_power_cpu[j][1], status);
-            oskar_mem_free(d->auto_power_time_avg[j], status);
-            oskar_mem_free(d->auto_power_channel_avg[j], status);
-            oskar_mem_free(d->auto_power_channel_and_time_avg[j], status);
             oskar_mem_free(d->auto_power[j], status);
-            oskar_mem_free(d->cross_power_cpu[j][0], status);
-            oskar_mem_free(d->cross_power_cpu[j][1], status);
-            oskar_mem_free(d->cross_power_time_avg[j], status);
-            oskar_mem_free(d->cross_power_channel_avg[j], status);
-            oskar_mem_free(d->cross_power_channel_and_time_avg[j], status);
             oskar_mem_free(d->cross_power[j], status);
         }
         oskar_telescope_free(d->tel, status);
@@ -71,6 +60,40 @@ void oskar_beam_pattern_free_device_data(oskar_BeamPattern* h, int* status)
         oskar_timer_free(d->tmr_compute);
         memset(d, 0, sizeof(DeviceData));
     }
+
+    /* Free the host buffers, which are sized by the number of devices. */
+    for (i = 0; i < h->num_buffers; ++i)
+    {
+        HostBuffer* b = &h->buffers[i];
+        oskar_mem_free(b->jones_data_cpu, status);
+        oskar_mem_free(b->ctemp, status);
+        for (j = 0; j < h->num_data_products; ++j)
+            if (b->pix) oskar_mem_free(b->pix[j], status);
+        free(b->pix);
+        for (j = 0; j < 4; ++j)
+        {
+            oskar_mem_free(b->auto_power_cpu[j], status);
+            oskar_mem_free(b->cross_power_cpu[j], status);
+        }
+    }
+    free(h->buffers);
+    h->buffers = 0;
+    h->num_buffers = 0;
+    for (j = 0; j < 4; ++j)
+    {
+        oskar_mem_free(h->auto_power_time_avg[j], status);
+        oskar_mem_free(h->auto_power_channel_avg[j], status);
+        oskar_mem_free(h->auto_power_channel_and_time_avg[j], status);
+        oskar_mem_free(h->cross_power_time_avg[j], status);
+        oskar_mem_free(h->cross_power_channel_avg[j], status);
+        oskar_mem_free(h->cross_power_channel_and_time_avg[j], status);
+        h->auto_power_time_avg[j] = 0;
+        h->auto_power_channel_avg[j] = 0;
+        h->auto_power_channel_and_time_avg[j] = 0;
+        h->cross_power_time_avg[j] = 0;
+        h->cross_power_channel_avg[j] = 0;
+        h->cross_power_channel_and_time_avg[j] = 0;
+    }
 }
 
 #ifdef __cplusplus
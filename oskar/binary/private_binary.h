@@ -190,6 +190,12 @@ struct oskar_Binary
     unsigned long* crc;         /* CRC-32C code. */
     unsigned long* crc_header;  /* CRC-32C code of payload identifier. */
 
+    int max_chunks;             /* Number of tags allocated in the index. */
+
+    /* Write state. */
+    int64_t write_offset;       /* Offset of the next tag to be written. */
+    int write_index;            /* If set, write the tag index when closed. */
+
     /* Data tables used for CRC computation. */
     oskar_CRC* crc_data;
 };
@@ -199,6 +205,65 @@ struct oskar_Binary
 typedef struct oskar_Binary oskar_Binary;
 #endif /* OSKAR_BINARY_TYPEDEF_ */
 
+/*
+ * When a file written by this library is closed, a copy of the tag index is
+ * written as the last chunk in the file, using an extended tag with the
+ * group name OSKAR_BINARY_INDEX_GROUP and the tag name
+ * OSKAR_BINARY_INDEX_TAG. This lets a reader build the index without
+ * reading every tag in the file. The payload is a character array
+ * containing one 32-byte record for each chunk in the file (excluding the
+ * index itself), all as little-endian values:
+ *
+ * Offset  Length  Description
+ * ----------------------------------------------------------------------------
+ *  0      1       1 if the tag is extended, else 0.
+ *  1      1       Data type code of the payload.
+ *  2      1       The group ID, or the group name size in bytes if extended.
+ *  3      1       The tag ID, or the tag name size in bytes if extended.
+ *  4      4       User-specified index.
+ *  8      8       Payload offset from the start of the file, in bytes.
+ * 16      8       Payload size in bytes.
+ * 24      4       CRC-32C code of the chunk.
+ * 28      4       CRC-32C code of the tag and tag names.
+ *
+ * The group and tag names of extended tags (including null terminators)
+ * follow immediately after the record.
+ *
+ * The payload ends with a 24-byte trailer, so that the index can be found
+ * from the end of the file:
+ *
+ * Offset  Length  Description
+ * ----------------------------------------------------------------------------
+ *  0      4       Number of records.
+ *  4      4       Reserved. (Must be 0.)
+ *  8      8       Offset of the index tag from the start of the file.
+ * 16      8       The ASCII string "OSKARIDX" (no trailing zero).
+ *
+ * Files that do not end with a valid index (for example, if the writer
+ * did not finish) are indexed by reading all the tags instead.
+ */
+#define OSKAR_BINARY_INDEX_GROUP "OSKAR_BINARY"
+#define OSKAR_BINARY_INDEX_TAG "TAG_INDEX"
+
+/* Makes sure there is space for at least the given number of tags. */
+void oskar_binary_index_reserve(oskar_Binary* handle, int num_chunks);
+
+/* Adds a tag to the index, returning 0 if memory allocation failed. */
+int oskar_binary_index_add(oskar_Binary* handle, unsigned char data_type,
+        int extended, int id_group, int id_tag, const char* name_group,
+        const char* name_tag, int user_index, int64_t payload_offset_bytes,
+        size_t payload_size_bytes, unsigned long crc, unsigned long crc_header);
+
+/* Returns true if the extended tag names are those of the tag index. */
+int oskar_binary_index_is_index_tag(const char* name_group,
+        const char* name_tag);
+
+/* Reads the tag index from the end of the file, returning 1 if successful. */
+int oskar_binary_index_read(oskar_Binary* handle);
+
+/* Writes the tag index to the end of the file. */
+void oskar_binary_index_write(oskar_Binary* handle, int* status);
+
 #ifdef __cplusplus
 }
 #endif
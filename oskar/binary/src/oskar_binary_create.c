@@ -39,7 +39,6 @@ extern "C" {
 
 #define MIN(X,Y) ((X) < (Y) ? (X) : (Y))
 
-static void oskar_binary_resize(oskar_Binary* handle, int m);
 static void oskar_binary_read_header(FILE* stream, oskar_BinaryHeader* header,
         int* status);
 static void oskar_binary_write_header(FILE* stream, oskar_BinaryHeader* header,
@@ -56,7 +55,7 @@ oskar_Binary* oskar_binary_create(const char* filename, char mode, int* status)
     oskar_Binary* handle;
     oskar_BinaryHeader header;
     FILE* stream;
-    int i;
+    int i, scan = 1;
 
     /* Open the file and check or write the header, depending on the mode. */
     if (mode == 'r')
@@ -116,11 +115,21 @@ oskar_Binary* oskar_binary_create(const char* filename, char mode, int* status)
     handle->bin_version = header.bin_version;
 
     /* Finish if writing. */
+    handle->write_offset = (int64_t) sizeof(oskar_BinaryHeader);
+    handle->write_index = (mode == 'w' && !*status);
     if (mode == 'w')
         return handle;
 
-    /* Read all tags in the stream. */
-    for (i = 0;; ++i)
+    /* Use the tag index at the end of the file, if there is one.
+     * Otherwise, read all tags in the stream. */
+    if (!*status && oskar_binary_index_read(handle))
+        scan = 0;
+    else if (fseek(stream, (long) sizeof(oskar_BinaryHeader), SEEK_SET))
+    {
+        *status = OSKAR_ERR_BINARY_SEEK_FAIL;
+        scan = 0;
+    }
+    for (i = 0; scan; ++i)
     {
         oskar_BinaryTag tag;
         unsigned long crc;
@@ -189,8 +198,7 @@ oskar_Binary* oskar_binary_create(const char* filename, char mode, int* status)
         }
 
         /* Check if we need to allocate more storage for the tag data. */
-        if (i % 10 == 0)
-            oskar_binary_resize(handle, i + 10);
+        oskar_binary_index_reserve(handle, i + 1);
 
         /* Initialise the tag index data. */
         handle->extended[i] = 0;
@@ -255,6 +263,29 @@ oskar_Binary* oskar_binary_create(const char* filename, char mode, int* status)
                     handle->name_group[i], tag.group.bytes);
             crc = oskar_crc_update(handle->crc_data, crc,
                     handle->name_tag[i], tag.tag.bytes);
+
+            /* Skip over any old copies of the tag index. */
+            if (oskar_binary_index_is_index_tag(
+                    handle->name_group[i], handle->name_tag[i]))
+            {
+                free(handle->name_group[i]);
+                free(handle->name_tag[i]);
+                handle->name_group[i] = 0;
+                handle->name_tag[i] = 0;
+#ifdef _MSC_VER
+                if (_fseeki64(stream, handle->payload_size_bytes[i] +
+                        (tag.flags & (1 << 6) ? 4 : 0), SEEK_CUR))
+#else
+                if (fseeko(stream, (off_t) (handle->payload_size_bytes[i] +
+                        (tag.flags & (1 << 6) ? 4 : 0)), SEEK_CUR))
+#endif
+                {
+                    *status = OSKAR_ERR_BINARY_SEEK_FAIL;
+                    break;
+                }
+                --i;
+                continue;
+            }
         }
 
         /* Store the current stream pointer as the payload offset. */
@@ -295,29 +326,18 @@ oskar_Binary* oskar_binary_create(const char* filename, char mode, int* status)
         handle->num_chunks = i + 1;
     }
 
+    /* Appended tags go at the end of the file.
+     * If the existing tags could not be read, return the error, and
+     * do not write a tag index. */
+    if (mode == 'a')
+    {
+        handle->write_index = !*status;
+        fseek(stream, 0, SEEK_END);
+        handle->write_offset = (int64_t) FTELL(stream);
+    }
     return handle;
 }
 
-static void oskar_binary_resize(oskar_Binary* handle, int m)
-{
-    handle->extended = (int*) realloc(handle->extended, m * sizeof(int));
-    handle->data_type = (int*) realloc(handle->data_type, m * sizeof(int));
-    handle->id_group = (int*) realloc(handle->id_group, m * sizeof(int));
-    handle->id_tag = (int*) realloc(handle->id_tag, m * sizeof(int));
-    handle->name_group = (char**) realloc(
-            handle->name_group, m * sizeof(char*));
-    handle->name_tag = (char**) realloc(handle->name_tag, m * sizeof(char*));
-    handle->user_index = (int*) realloc(handle->user_index, m * sizeof(int));
-    handle->payload_offset_bytes = (int64_t*) realloc(
-            handle->payload_offset_bytes, m * sizeof(int64_t));
-    handle->payload_size_bytes = (size_t*) realloc(
-            handle->payload_size_bytes, m * sizeof(size_t));
-    handle->crc = (unsigned long*) realloc(
-            handle->crc, m * sizeof(unsigned long));
-    handle->crc_header = (unsigned long*) realloc(
-            handle->crc_header, m * sizeof(unsigned long));
-}
-
 static void oskar_binary_write_header(FILE* stream, oskar_BinaryHeader* header,
         int* status)
 {
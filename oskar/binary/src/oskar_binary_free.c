@@ -39,6 +39,13 @@ void oskar_binary_free(oskar_Binary* handle)
     int i;
     if (!handle) return;
 
+    /* Write the tag index to the end of the file, if required. */
+    if (handle->stream && handle->write_index)
+    {
+        int status = 0;
+        oskar_binary_index_write(handle, &status);
+    }
+
     /* Close the file. */
     if (handle->stream)
         fclose(handle->stream);
@@ -0,0 +1,308 @@
+/*
+ * Copyright (c) 2020, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "binary/oskar_binary.h"
+#include "binary/private_binary.h"
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifdef _MSC_VER
+#define FSEEK _fseeki64
+#define FTELL _ftelli64
+#else
+#define FSEEK(F, O, W) fseeko(F, (off_t) (O), W)
+#define FTELL ftello
+#endif
+
+#define RECORD_SIZE 32
+#define TRAILER_SIZE 24
+static const char trailer_magic[] = "OSKARIDX";
+
+/* Little-endian encoding and decoding, independent of host byte order. */
+static void put_le(unsigned char* p, uint64_t value, int num_bytes)
+{
+    int i;
+    for (i = 0; i < num_bytes; ++i, value >>= 8)
+        p[i] = (unsigned char) (value & 0xFF);
+}
+
+static uint64_t get_le(const unsigned char* p, int num_bytes)
+{
+    int i;
+    uint64_t value = 0;
+    for (i = num_bytes - 1; i >= 0; --i)
+        value = (value << 8) | p[i];
+    return value;
+}
+
+static void clear_index(oskar_Binary* handle)
+{
+    int i;
+    for (i = 0; i < handle->num_chunks; ++i)
+    {
+        free(handle->name_group[i]);
+        free(handle->name_tag[i]);
+        handle->name_group[i] = 0;
+        handle->name_tag[i] = 0;
+    }
+    handle->num_chunks = 0;
+}
+
+static char* copy_string(const char* str)
+{
+    char* copy = 0;
+    if (!str) return 0;
+    copy = (char*) malloc(strlen(str) + 1);
+    if (copy) strcpy(copy, str);
+    return copy;
+}
+
+void oskar_binary_index_reserve(oskar_Binary* handle, int num_chunks)
+{
+    int m = 2 * handle->max_chunks;
+    if (num_chunks <= handle->max_chunks) return;
+    if (m < num_chunks) m = num_chunks;
+    if (m < 16) m = 16;
+    handle->extended = (int*) realloc(handle->extended, m * sizeof(int));
+    handle->data_type = (int*) realloc(handle->data_type, m * sizeof(int));
+    handle->id_group = (int*) realloc(handle->id_group, m * sizeof(int));
+    handle->id_tag = (int*) realloc(handle->id_tag, m * sizeof(int));
+    handle->name_group = (char**) realloc(
+            handle->name_group, m * sizeof(char*));
+    handle->name_tag = (char**) realloc(handle->name_tag, m * sizeof(char*));
+    handle->user_index = (int*) realloc(handle->user_index, m * sizeof(int));
+    handle->payload_offset_bytes = (int64_t*) realloc(
+            handle->payload_offset_bytes, m * sizeof(int64_t));
+    handle->payload_size_bytes = (size_t*) realloc(
+            handle->payload_size_bytes, m * sizeof(size_t));
+    handle->crc = (unsigned long*) realloc(
+            handle->crc, m * sizeof(unsigned long));
+    handle->crc_header = (unsigned long*) realloc(
+            handle->crc_header, m * sizeof(unsigned long));
+    handle->max_chunks = m;
+}
+
+int oskar_binary_index_add(oskar_Binary* handle, unsigned char data_type,
+        int extended, int id_group, int id_tag, const char* name_group,
+        const char* name_tag, int user_index, int64_t payload_offset_bytes,
+        size_t payload_size_bytes, unsigned long crc, unsigned long crc_header)
+{
+    const int i = handle->num_chunks;
+    oskar_binary_index_reserve(handle, i + 1);
+    handle->extended[i] = extended;
+    handle->data_type[i] = (int) data_type;
+    handle->id_group[i] = id_group;
+    handle->id_tag[i] = id_tag;
+    handle->name_group[i] = extended ? copy_string(name_group) : 0;
+    handle->name_tag[i] = extended ? copy_string(name_tag) : 0;
+    handle->user_index[i] = user_index;
+    handle->payload_offset_bytes[i] = payload_offset_bytes;
+    handle->payload_size_bytes[i] = payload_size_bytes;
+    handle->crc[i] = crc;
+    handle->crc_header[i] = crc_header;
+    handle->num_chunks = i + 1;
+    return !extended || (handle->name_group[i] && handle->name_tag[i]);
+}
+
+int oskar_binary_index_is_index_tag(const char* name_group,
+        const char* name_tag)
+{
+    return name_group && name_tag &&
+            !strcmp(name_group, OSKAR_BINARY_INDEX_GROUP) &&
+            !strcmp(name_tag, OSKAR_BINARY_INDEX_TAG);
+}
+
+int oskar_binary_index_read(oskar_Binary* handle)
+{
+    oskar_BinaryTag tag;
+    unsigned char trailer[TRAILER_SIZE], crc_bytes[4];
+    unsigned char* payload = 0;
+    const unsigned char* p = 0;
+    const size_t lgroup = sizeof(OSKAR_BINARY_INDEX_GROUP);
+    const size_t ltag = sizeof(OSKAR_BINARY_INDEX_TAG);
+    char names[sizeof(OSKAR_BINARY_INDEX_GROUP) +
+               sizeof(OSKAR_BINARY_INDEX_TAG)];
+    int64_t file_size = 0, index_offset = 0;
+    uint64_t block_size = 0, payload_size = 0;
+    unsigned long crc = 0;
+    unsigned int i, num_records = 0;
+    FILE* stream = handle->stream;
+
+    /* Read the trailer at the end of the file. */
+    if (FSEEK(stream, 0, SEEK_END)) return 0;
+    file_size = (int64_t) FTELL(stream);
+    if (file_size < (int64_t) (sizeof(oskar_BinaryHeader) +
+            sizeof(oskar_BinaryTag) + lgroup + ltag + TRAILER_SIZE + 4))
+        return 0;
+    if (FSEEK(stream, file_size - TRAILER_SIZE - 4, SEEK_SET) ||
+            fread(trailer, TRAILER_SIZE, 1, stream) != 1 ||
+            memcmp(trailer + 16, trailer_magic, 8) != 0)
+        return 0;
+    num_records = (unsigned int) get_le(trailer, 4);
+    index_offset = (int64_t) get_le(trailer + 8, 8);
+    if (index_offset < (int64_t) sizeof(oskar_BinaryHeader) ||
+            index_offset >= file_size)
+        return 0;
+
+    /* Read and check the index tag. */
+    if (FSEEK(stream, index_offset, SEEK_SET) ||
+            fread(&tag, sizeof(oskar_BinaryTag), 1, stream) != 1 ||
+            tag.magic[0] != 'T' || tag.magic[2] != 'G' ||
+            tag.magic[1] - 0x40 != OSKAR_BINARY_FORMAT_VERSION ||
+            tag.flags != ((1 << 7) | (1 << 6)) ||
+            tag.data_type != OSKAR_CHAR ||
+            tag.group.bytes != lgroup || tag.tag.bytes != ltag ||
+            fread(names, lgroup + ltag, 1, stream) != 1 ||
+            memcmp(names, OSKAR_BINARY_INDEX_GROUP, lgroup) != 0 ||
+            memcmp(names + lgroup, OSKAR_BINARY_INDEX_TAG, ltag) != 0)
+        return 0;
+    block_size = get_le((const unsigned char*) tag.size_bytes, 8);
+    if (block_size != (uint64_t) (file_size - index_offset -
+            (int64_t) sizeof(oskar_BinaryTag)))
+        return 0;
+    payload_size = block_size - lgroup - ltag - 4;
+    if (payload_size < TRAILER_SIZE + (uint64_t) num_records * RECORD_SIZE)
+        return 0;
+
+    /* Read the payload and check its CRC code. */
+    payload = (unsigned char*) malloc((size_t) payload_size);
+    if (!payload) return 0;
+    if (fread(payload, (size_t) payload_size, 1, stream) != 1 ||
+            fread(crc_bytes, 4, 1, stream) != 1)
+    {
+        free(payload);
+        return 0;
+    }
+    crc = oskar_crc_compute(handle->crc_data, &tag, sizeof(oskar_BinaryTag));
+    crc = oskar_crc_update(handle->crc_data, crc, names, lgroup + ltag);
+    crc = oskar_crc_update(handle->crc_data, crc, payload,
+            (size_t) payload_size);
+    if ((crc & 0xFFFFFFFFul) != (unsigned long) get_le(crc_bytes, 4))
+    {
+        free(payload);
+        return 0;
+    }
+
+    /* Build the index from the records. */
+    oskar_binary_index_reserve(handle, (int) num_records);
+    for (i = 0, p = payload; i < num_records; ++i)
+    {
+        const int extended = p[0];
+        const size_t lg = extended ? p[2] : 0, lt = extended ? p[3] : 0;
+        const int64_t offset = (int64_t) get_le(p + 8, 8);
+        const uint64_t size = get_le(p + 16, 8);
+        const char* name_group = (const char*) p + RECORD_SIZE;
+        const char* name_tag = name_group + lg;
+        if ((uint64_t) (p - payload) + RECORD_SIZE + lg + lt >
+                        payload_size - TRAILER_SIZE ||
+                (extended && (lg == 0 || lt == 0 ||
+                        name_group[lg - 1] != 0 || name_tag[lt - 1] != 0)) ||
+                offset < (int64_t) sizeof(oskar_BinaryHeader) ||
+                size > (uint64_t) (index_offset - offset) ||
+                !oskar_binary_index_add(handle, p[1], extended, p[2], p[3],
+                        name_group, name_tag, (int) get_le(p + 4, 4),
+                        offset, (size_t) size,
+                        (unsigned long) get_le(p + 24, 4),
+                        (unsigned long) get_le(p + 28, 4)))
+        {
+            clear_index(handle);
+            free(payload);
+            return 0;
+        }
+        p += RECORD_SIZE + lg + lt;
+    }
+    free(payload);
+    return 1;
+}
+
+void oskar_binary_index_write(oskar_Binary* handle, int* status)
+{
+    int i;
+    size_t payload_size = TRAILER_SIZE;
+    unsigned char *payload = 0, *p = 0;
+    if (*status) return;
+
+    /* Get the size of the payload. */
+    for (i = 0; i < handle->num_chunks; ++i)
+    {
+        payload_size += RECORD_SIZE;
+        if (handle->extended[i])
+            payload_size += strlen(handle->name_group[i]) + 1 +
+                    strlen(handle->name_tag[i]) + 1;
+    }
+    payload = (unsigned char*) calloc(payload_size, 1);
+    if (!payload)
+    {
+        *status = OSKAR_ERR_BINARY_MEMORY_NOT_ALLOCATED;
+        return;
+    }
+
+    /* Fill the records. */
+    for (i = 0, p = payload; i < handle->num_chunks; ++i)
+    {
+        size_t lg = 0, lt = 0;
+        if (handle->extended[i])
+        {
+            lg = strlen(handle->name_group[i]) + 1;
+            lt = strlen(handle->name_tag[i]) + 1;
+        }
+        p[0] = (unsigned char) handle->extended[i];
+        p[1] = (unsigned char) handle->data_type[i];
+        p[2] = (unsigned char) handle->id_group[i];
+        p[3] = (unsigned char) handle->id_tag[i];
+        put_le(p + 4, (uint32_t) handle->user_index[i], 4);
+        put_le(p + 8, (uint64_t) handle->payload_offset_bytes[i], 8);
+        put_le(p + 16, (uint64_t) handle->payload_size_bytes[i], 8);
+        put_le(p + 24, (uint64_t) handle->crc[i], 4);
+        put_le(p + 28, (uint64_t) handle->crc_header[i], 4);
+        p += RECORD_SIZE;
+        if (handle->extended[i])
+        {
+            memcpy(p, handle->name_group[i], lg);
+            memcpy(p + lg, handle->name_tag[i], lt);
+            p += lg + lt;
+        }
+    }
+
+    /* Fill the trailer and write the index. */
+    put_le(p, (uint32_t) handle->num_chunks, 4);
+    put_le(p + 8, (uint64_t) handle->write_offset, 8);
+    memcpy(p + 16, trailer_magic, 8);
+    oskar_binary_write_ext(handle, OSKAR_CHAR, OSKAR_BINARY_INDEX_GROUP,
+            OSKAR_BINARY_INDEX_TAG, 0, payload_size, payload, status);
+    free(payload);
+}
+
+#ifdef __cplusplus
+}
+#endif
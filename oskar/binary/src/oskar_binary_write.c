@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2012-2015, The University of Oxford
+ * Copyright (c) 2012-2020, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -36,13 +36,28 @@
 extern "C" {
 #endif
 
+static void add_to_index(oskar_Binary* handle, unsigned char data_type,
+        int extended, int id_group, int id_tag, const char* name_group,
+        const char* name_tag, int user_index, size_t header_bytes,
+        size_t data_size, unsigned long crc, unsigned long crc_header)
+{
+    const int64_t payload_offset =
+            handle->write_offset + (int64_t) header_bytes;
+    handle->write_offset = payload_offset + (int64_t) data_size + 4;
+    if (!oskar_binary_index_add(handle, data_type, extended, id_group, id_tag,
+            name_group, name_tag, user_index, payload_offset, data_size,
+            crc, crc_header))
+        handle->write_index = 0;
+}
+
 void oskar_binary_write(oskar_Binary* handle, unsigned char data_type,
         unsigned char id_group, unsigned char id_tag, int user_index,
         size_t data_size, const void* data, int* status)
 {
     oskar_BinaryTag tag;
     size_t block_size;
-    unsigned long crc = 0;
+    unsigned long crc = 0, crc_header = 0;
+    const int index = user_index;
 
     /* Check if safe to proceed. */
     if (*status) return;
@@ -107,8 +122,9 @@ void oskar_binary_write(oskar_Binary* handle, unsigned char data_type,
     memcpy(tag.size_bytes, &block_size, sizeof(size_t));
 
     /* Tag is complete at this point, so calculate CRC. */
-    crc = oskar_crc_compute(handle->crc_data, &tag, sizeof(oskar_BinaryTag));
-    crc = oskar_crc_update(handle->crc_data, crc, data, data_size);
+    crc_header = oskar_crc_compute(handle->crc_data, &tag,
+            sizeof(oskar_BinaryTag));
+    crc = oskar_crc_update(handle->crc_data, crc_header, data, data_size);
     if (oskar_endian() != OSKAR_LITTLE_ENDIAN)
         oskar_endian_swap(&crc, sizeof(unsigned long));
 
@@ -116,6 +132,7 @@ void oskar_binary_write(oskar_Binary* handle, unsigned char data_type,
     if (fwrite(&tag, sizeof(oskar_BinaryTag), 1, handle->stream) != 1)
     {
         *status = OSKAR_ERR_BINARY_WRITE_FAIL;
+        handle->write_index = 0;
         return;
     }
 
@@ -126,13 +143,24 @@ void oskar_binary_write(oskar_Binary* handle, unsigned char data_type,
         if (fwrite(data, 1, data_size, handle->stream) != data_size)
         {
             *status = OSKAR_ERR_BINARY_WRITE_FAIL;
+            handle->write_index = 0;
             return;
         }
     }
 
     /* Write the 4-byte CRC-32C code. */
     if (fwrite(&crc, 4, 1, handle->stream) != 1)
+    {
         *status = OSKAR_ERR_BINARY_WRITE_FAIL;
+        handle->write_index = 0;
+        return;
+    }
+
+    /* Add the chunk to the tag index. */
+    if (oskar_endian() != OSKAR_LITTLE_ENDIAN)
+        oskar_endian_swap(&crc, sizeof(unsigned long));
+    add_to_index(handle, data_type, 0, id_group, id_tag, 0, 0, index,
+            sizeof(oskar_BinaryTag), data_size, crc, crc_header);
 }
 
 void oskar_binary_write_double(oskar_Binary* handle, unsigned char id_group,
@@ -155,7 +183,8 @@ void oskar_binary_write_ext(oskar_Binary* handle, unsigned char data_type,
 {
     oskar_BinaryTag tag;
     size_t block_size, lgroup, ltag;
-    unsigned long crc = 0;
+    unsigned long crc = 0, crc_header = 0;
+    const int index = user_index;
 
     /* Check if safe to proceed. */
     if (*status) return;
@@ -230,10 +259,13 @@ void oskar_binary_write_ext(oskar_Binary* handle, unsigned char data_type,
     memcpy(tag.size_bytes, &block_size, sizeof(size_t));
 
     /* Tag is complete at this point, so calculate CRC. */
-    crc = oskar_crc_compute(handle->crc_data, &tag, sizeof(oskar_BinaryTag));
-    crc = oskar_crc_update(handle->crc_data, crc, name_group, tag.group.bytes);
-    crc = oskar_crc_update(handle->crc_data, crc, name_tag, tag.tag.bytes);
-    crc = oskar_crc_update(handle->crc_data, crc, data, data_size);
+    crc_header = oskar_crc_compute(handle->crc_data, &tag,
+            sizeof(oskar_BinaryTag));
+    crc_header = oskar_crc_update(handle->crc_data, crc_header,
+            name_group, tag.group.bytes);
+    crc_header = oskar_crc_update(handle->crc_data, crc_header,
+            name_tag, tag.tag.bytes);
+    crc = oskar_crc_update(handle->crc_data, crc_header, data, data_size);
     if (oskar_endian() != OSKAR_LITTLE_ENDIAN)
         oskar_endian_swap(&crc, sizeof(unsigned long));
 
@@ -241,6 +273,7 @@ void oskar_binary_write_ext(oskar_Binary* handle, unsigned char data_type,
     if (fwrite(&tag, sizeof(oskar_BinaryTag), 1, handle->stream) != 1)
     {
         *status = OSKAR_ERR_BINARY_WRITE_FAIL;
+        handle->write_index = 0;
         return;
     }
 
@@ -248,11 +281,13 @@ void oskar_binary_write_ext(oskar_Binary* handle, unsigned char data_type,
     if (fwrite(name_group, tag.group.bytes, 1, handle->stream) != 1)
     {
         *status = OSKAR_ERR_BINARY_WRITE_FAIL;
+        handle->write_index = 0;
         return;
     }
     if (fwrite(name_tag, tag.tag.bytes, 1, handle->stream) != 1)
     {
         *status = OSKAR_ERR_BINARY_WRITE_FAIL;
+        handle->write_index = 0;
         return;
     }
 
@@ -263,13 +298,26 @@ void oskar_binary_write_ext(oskar_Binary* handle, unsigned char data_type,
         if (fwrite(data, 1, data_size, handle->stream) != data_size)
         {
             *status = OSKAR_ERR_BINARY_WRITE_FAIL;
+            handle->write_index = 0;
             return;
         }
     }
 
     /* Write the 4-byte CRC-32C code. */
     if (fwrite(&crc, 4, 1, handle->stream) != 1)
+    {
         *status = OSKAR_ERR_BINARY_WRITE_FAIL;
+        handle->write_index = 0;
+        return;
+    }
+
+    /* Add the chunk to the tag index. */
+    if (oskar_endian() != OSKAR_LITTLE_ENDIAN)
+        oskar_endian_swap(&crc, sizeof(unsigned long));
+    add_to_index(handle, data_type, 1, tag.group.bytes, tag.tag.bytes,
+            name_group, name_tag, index,
+            sizeof(oskar_BinaryTag) + tag.group.bytes + tag.tag.bytes,
+            data_size, crc, crc_header);
 }
 
 void oskar_binary_write_ext_double(oskar_Binary* handle, const char* name_group,
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2012-2019, The University of Oxford
+ * Copyright (c) 2012-2020, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -172,10 +172,61 @@ int main(void)
         status = 0;
     }
 
+    /* Check the tag index does not appear as a tag. */
+    ASSERT_INT_EQ(7, oskar_binary_num_tags(h));
+
     /* Free the handle. */
     oskar_binary_free(h);
     ASSERT_INT_EQ(0, status);
 
+    /* Append a tag, and check all the tags can be read. */
+    h = oskar_binary_create(filename, 'a', &status);
+    oskar_binary_write_int(h, 20, 1, 0, 99, &status);
+    ASSERT_INT_EQ(0, status);
+    oskar_binary_free(h);
+    h = oskar_binary_create(filename, 'r', &status);
+    ASSERT_INT_EQ(0, status);
+    ASSERT_INT_EQ(8, oskar_binary_num_tags(h));
+    oskar_binary_read_int(h, 20, 1, 0, &a, &status);
+    ASSERT_INT_EQ(0, status);
+    ASSERT_INT_EQ(99, a);
+    oskar_binary_read_int(h, 12, 0, 0, &b, &status);
+    ASSERT_INT_EQ(0, status);
+    ASSERT_INT_EQ(b1, b);
+    oskar_binary_free(h);
+
+    /* Break the first tag: it should still be readable using the index. */
+    {
+        FILE* file = fopen(filename, "r+b");
+        fseek(file, 64, SEEK_SET);
+        fputc('X', file);
+        fclose(file);
+    }
+    h = oskar_binary_create(filename, 'r', &status);
+    ASSERT_INT_EQ(0, status);
+    oskar_binary_read_int(h, 0, 0, 12345, &a, &status);
+    ASSERT_INT_EQ(0, status);
+    ASSERT_INT_EQ(a1, a);
+    oskar_binary_free(h);
+
+    /* Break the index: the file should now be read tag by tag, and fail. */
+    {
+        FILE* file = fopen(filename, "r+b");
+        fseek(file, -5, SEEK_END);
+        fputc('Y', file);
+        fclose(file);
+    }
+    h = oskar_binary_create(filename, 'r', &status);
+    ASSERT_INT_EQ((int) OSKAR_ERR_BINARY_FILE_INVALID, status);
+    oskar_binary_free(h);
+    status = 0;
+
+    /* Appending to the broken file should also fail. */
+    h = oskar_binary_create(filename, 'a', &status);
+    ASSERT_INT_EQ((int) OSKAR_ERR_BINARY_FILE_INVALID, status);
+    oskar_binary_free(h);
+    status = 0;
+
     /* Remove the file. */
     remove(filename);
 
@@ -41,3 +41,9 @@
 /* Evaluates 1D linear baseline index for stations P and Q. */
 #define OSKAR_BASELINE_INDEX(NUM_STATIONS, P, Q) \
     (Q * (NUM_STATIONS - 1) - (Q - 1) * Q / 2 + P - Q - 1)
+
+/* Smallest eigenvalue of the Gaussian source quadratic form
+ * a*u^2 + 2*b*u*v + c*v^2 (the "uuvv" term holds the factor of 2). */
+#define OSKAR_GAUSSIAN_MIN_EIGENVALUE(FP, A, B, C) \
+    ( ((FP)0.5) * ((A) + (C)) - sqrt( ((FP)0.25) * ((A) - (C)) * ((A) - (C)) + \
+    (B) * (B) ) )
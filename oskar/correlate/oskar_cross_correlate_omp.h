@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2013-2019, The University of Oxford
+ * Copyright (c) 2013-2020, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -73,6 +73,10 @@ extern "C" {
  * @param[in] time_int_sec   Time averaging interval, in seconds.
  * @param[in] gha0_rad       Greenwich Hour Angle of phase centre, in radians.
  * @param[in] dec0_rad       Declination of phase centre, in radians.
+ * @param[in] cull_tolerance_jy Sources whose smeared flux is below this
+ *                              on a block of baselines are skipped.
+ * @param[in] station_order  Order in which to group stations into blocks
+ *                           (may be NULL to use the natural order).
  * @param[in,out] vis        Modified output complex visibilities.
  */
 OSKAR_EXPORT
@@ -86,7 +90,8 @@ void oskar_cross_correlate_point_omp_f(
         const float* station_x, const float* station_y,
         float uv_min_lambda, float uv_max_lambda, float inv_wavelength,
         float frac_bandwidth, float time_int_sec, float gha0_rad,
-        float dec0_rad, float4c* vis);
+        float dec0_rad, float cull_tolerance_jy,
+        const int* station_order, float4c* vis);
 
 /**
  * @brief
@@ -121,6 +126,10 @@ void oskar_cross_correlate_point_omp_f(
  * @param[in] time_int_sec   Time averaging interval, in seconds.
  * @param[in] gha0_rad       Greenwich Hour Angle of phase centre, in radians.
  * @param[in] dec0_rad       Declination of phase centre, in radians.
+ * @param[in] cull_tolerance_jy Sources whose smeared flux is below this
+ *                              on a block of baselines are skipped.
+ * @param[in] station_order  Order in which to group stations into blocks
+ *                           (may be NULL to use the natural order).
  * @param[in,out] vis        Modified output complex visibilities.
  */
 OSKAR_EXPORT
@@ -134,7 +143,8 @@ void oskar_cross_correlate_point_omp_d(
         const double* station_x, const double* station_y,
         double uv_min_lambda, double uv_max_lambda, double inv_wavelength,
         double frac_bandwidth, double time_int_sec, double gha0_rad,
-        double dec0_rad, double4c* vis);
+        double dec0_rad, double cull_tolerance_jy,
+        const int* station_order, double4c* vis);
 
 /**
  * @brief
@@ -175,6 +185,10 @@ void oskar_cross_correlate_point_omp_d(
  * @param[in] time_int_sec   Time averaging interval, in seconds.
  * @param[in] gha0_rad       Greenwich Hour Angle of phase centre, in radians.
  * @param[in] dec0_rad       Declination of phase centre, in radians.
+ * @param[in] cull_tolerance_jy Sources whose smeared flux is below this
+ *                              on a block of baselines are skipped.
+ * @param[in] station_order  Order in which to group stations into blocks
+ *                           (may be NULL to use the natural order).
  * @param[in,out] vis        Modified output complex visibilities.
  */
 OSKAR_EXPORT
@@ -188,7 +202,8 @@ void oskar_cross_correlate_gaussian_omp_f(
         const float* station_w, const float* station_x,
         const float* station_y, float uv_min_lambda, float uv_max_lambda,
         float inv_wavelength, float frac_bandwidth, float time_int_sec,
-        float gha0_rad, float dec0_rad, float4c* vis);
+        float gha0_rad, float dec0_rad, float cull_tolerance_jy,
+        const int* station_order, float4c* vis);
 
 /**
  * @brief
@@ -229,6 +244,10 @@ void oskar_cross_correlate_gaussian_omp_f(
  * @param[in] time_int_sec   Time averaging interval, in seconds.
  * @param[in] gha0_rad       Greenwich Hour Angle of phase centre, in radians.
  * @param[in] dec0_rad       Declination of phase centre, in radians.
+ * @param[in] cull_tolerance_jy Sources whose smeared flux is below this
+ *                              on a block of baselines are skipped.
+ * @param[in] station_order  Order in which to group stations into blocks
+ *                           (may be NULL to use the natural order).
  * @param[in,out] vis        Modified output complex visibilities.
  */
 OSKAR_EXPORT
@@ -242,7 +261,8 @@ void oskar_cross_correlate_gaussian_omp_d(
         const double* station_w, const double* station_x,
         const double* station_y, double uv_min_lambda, double uv_max_lambda,
         double inv_wavelength, double frac_bandwidth, double time_int_sec,
-        double gha0_rad, double dec0_rad, double4c* vis);
+        double gha0_rad, double dec0_rad, double cull_tolerance_jy,
+        const int* station_order, double4c* vis);
 
 #ifdef __cplusplus
 }
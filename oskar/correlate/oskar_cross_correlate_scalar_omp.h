@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2014-2019, The University of Oxford
+ * Copyright (c) 2014-2020, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -70,6 +70,10 @@ extern "C" {
  * @param[in] time_int_sec   Time averaging interval, in seconds.
  * @param[in] gha0_rad       Greenwich Hour Angle of phase centre, in radians.
  * @param[in] dec0_rad       Declination of phase centre, in radians.
+ * @param[in] cull_tolerance_jy Sources whose smeared flux is below this
+ *                              on a block of baselines are skipped.
+ * @param[in] station_order  Order in which to group stations into blocks
+ *                           (may be NULL to use the natural order).
  * @param[in,out] vis        Modified output complex visibilities.
  */
 OSKAR_EXPORT
@@ -81,7 +85,9 @@ void oskar_cross_correlate_scalar_point_omp_f(
         const float* station_w, const float* station_x,
         const float* station_y, float uv_min_lambda, float uv_max_lambda,
         float inv_wavelength, float frac_bandwidth, const float time_int_sec,
-        const float gha0_rad, const float dec0_rad, float2* vis);
+        const float gha0_rad, const float dec0_rad,
+        const float cull_tolerance_jy,
+        const int* station_order, float2* vis);
 
 /**
  * @brief
@@ -113,6 +119,10 @@ void oskar_cross_correlate_scalar_point_omp_f(
  * @param[in] time_int_sec   Time averaging interval, in seconds.
  * @param[in] gha0_rad       Greenwich Hour Angle of phase centre, in radians.
  * @param[in] dec0_rad       Declination of phase centre, in radians.
+ * @param[in] cull_tolerance_jy Sources whose smeared flux is below this
+ *                              on a block of baselines are skipped.
+ * @param[in] station_order  Order in which to group stations into blocks
+ *                           (may be NULL to use the natural order).
  * @param[in,out] vis        Modified output complex visibilities.
  */
 OSKAR_EXPORT
@@ -124,7 +134,9 @@ void oskar_cross_correlate_scalar_point_omp_d(
         const double* station_w, const double* station_x,
         const double* station_y, double uv_min_lambda, double uv_max_lambda,
         double inv_wavelength, double frac_bandwidth, const double time_int_sec,
-        const double gha0_rad, const double dec0_rad, double2* vis);
+        const double gha0_rad, const double dec0_rad,
+        const double cull_tolerance_jy,
+        const int* station_order, double2* vis);
 
 /**
  * @brief
@@ -162,6 +174,10 @@ void oskar_cross_correlate_scalar_point_omp_d(
  * @param[in] time_int_sec   Time averaging interval, in seconds.
  * @param[in] gha0_rad       Greenwich Hour Angle of phase centre, in radians.
  * @param[in] dec0_rad       Declination of phase centre, in radians.
+ * @param[in] cull_tolerance_jy Sources whose smeared flux is below this
+ *                              on a block of baselines are skipped.
+ * @param[in] station_order  Order in which to group stations into blocks
+ *                           (may be NULL to use the natural order).
  * @param[in,out] vis        Modified output complex visibilities.
  */
 OSKAR_EXPORT
@@ -175,7 +191,8 @@ void oskar_cross_correlate_scalar_gaussian_omp_f(
         const float* station_x, const float* station_y,
         float uv_min_lambda, float uv_max_lambda, float inv_wavelength,
         float frac_bandwidth, float time_int_sec, float gha0_rad,
-        float dec0_rad, float2* vis);
+        float dec0_rad, float cull_tolerance_jy,
+        const int* station_order, float2* vis);
 
 /**
  * @brief
@@ -213,6 +230,10 @@ void oskar_cross_correlate_scalar_gaussian_omp_f(
  * @param[in] time_int_sec   Time averaging interval, in seconds.
  * @param[in] gha0_rad       Greenwich Hour Angle of phase centre, in radians.
  * @param[in] dec0_rad       Declination of phase centre, in radians.
+ * @param[in] cull_tolerance_jy Sources whose smeared flux is below this
+ *                              on a block of baselines are skipped.
+ * @param[in] station_order  Order in which to group stations into blocks
+ *                           (may be NULL to use the natural order).
  * @param[in,out] vis        Modified output complex visibilities.
  */
 OSKAR_EXPORT
@@ -226,7 +247,8 @@ void oskar_cross_correlate_scalar_gaussian_omp_d(
         const double* station_x, const double* station_y,
         double uv_min_lambda, double uv_max_lambda, double inv_wavelength,
         double frac_bandwidth, double time_int_sec, double gha0_rad,
-        double dec0_rad, double2* vis);
+        double dec0_rad, double cull_tolerance_jy,
+        const int* station_order, double2* vis);
 
 #ifdef __cplusplus
 }
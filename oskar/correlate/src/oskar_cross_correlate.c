@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2011-2019, The University of Oxford
+ * Copyright (c) 2011-2020, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -35,11 +35,70 @@
 
 #include <float.h>
 #include <math.h>
+#include <stdlib.h>
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+typedef struct
+{
+    unsigned int code;
+    int index;
+} StationKey;
+
+static int compare_station_keys(const void* a, const void* b)
+{
+    const unsigned int code_a = ((const StationKey*)a)->code;
+    const unsigned int code_b = ((const StationKey*)b)->code;
+    if (code_a != code_b) return code_a < code_b ? -1 : 1;
+    return ((const StationKey*)a)->index - ((const StationKey*)b)->index;
+}
+
+/* Returns the stations in Morton (Z-curve) order of their (u,v) coordinates,
+ * so that the blocks of stations used by the correlator are compact
+ * and the smearing bound over each block of baselines is tight. */
+static int* station_spatial_order(int num_stations, const oskar_Mem* u,
+        const oskar_Mem* v, int* status)
+{
+    int i, j;
+    double u_min, u_max, v_min, v_max, scale;
+    StationKey* keys;
+    int* order;
+    if (*status || num_stations == 0) return 0;
+    keys = (StationKey*) malloc(num_stations * sizeof(StationKey));
+    order = (int*) malloc(num_stations * sizeof(int));
+    u_min = u_max = oskar_mem_get_element(u, 0, status);
+    v_min = v_max = oskar_mem_get_element(v, 0, status);
+    for (i = 1; i < num_stations; ++i)
+    {
+        const double uu = oskar_mem_get_element(u, i, status);
+        const double vv = oskar_mem_get_element(v, i, status);
+        if (uu < u_min) u_min = uu;
+        if (uu > u_max) u_max = uu;
+        if (vv < v_min) v_min = vv;
+        if (vv > v_max) v_max = vv;
+    }
+    scale = (u_max - u_min > v_max - v_min) ? u_max - u_min : v_max - v_min;
+    scale = (scale > 0.0) ? 65535.0 / scale : 0.0;
+    for (i = 0; i < num_stations; ++i)
+    {
+        const unsigned int x = (unsigned int) (scale *
+                (oskar_mem_get_element(u, i, status) - u_min));
+        const unsigned int y = (unsigned int) (scale *
+                (oskar_mem_get_element(v, i, status) - v_min));
+        keys[i].code = 0;
+        keys[i].index = i;
+        for (j = 0; j < 16; ++j)
+            keys[i].code |= (((x >> j) & 1u) << (2 * j)) |
+                    (((y >> j) & 1u) << (2 * j + 1));
+    }
+    qsort(keys, num_stations, sizeof(StationKey), compare_station_keys);
+    for (i = 0; i < num_stations; ++i) order[i] = keys[i].index;
+    free(keys);
+    return order;
+}
+
 void oskar_cross_correlate(int num_sources,  const oskar_Jones* jones,
         const oskar_Sky* sky, const oskar_Telescope* tel,
         const oskar_Mem* u, const oskar_Mem* v, const oskar_Mem* w,
@@ -68,6 +127,10 @@ void oskar_cross_correlate(int num_sources,  const oskar_Jones* jones,
     const double gha0 = gast - oskar_telescope_phase_centre_ra_rad(tel);
     const double dec0 = oskar_telescope_phase_centre_dec_rad(tel);
 
+    /* Get the tolerance for skipping sources made faint by smearing. */
+    const double cull_tolerance =
+            oskar_telescope_smearing_cull_tolerance_jy(tel);
+
     /* Get UV filter parameters in wavelengths. */
     uv_filter_min = oskar_telescope_uv_filter_min(tel);
     uv_filter_max = oskar_telescope_uv_filter_max(tel);
@@ -137,6 +200,10 @@ void oskar_cross_correlate(int num_sources,  const oskar_Jones* jones,
     /* Select kernel. */
     if (location == OSKAR_CPU)
     {
+        /* Group nearby stations together if sources may be skipped. */
+        int* order = 0;
+        if (cull_tolerance > 0.0)
+            order = station_spatial_order(num_stations, u, v, status);
         if (use_extended)
         {
             switch (oskar_mem_type(vis))
@@ -162,6 +229,7 @@ void oskar_cross_correlate(int num_sources,  const oskar_Jones* jones,
                         oskar_mem_float_const(y, status),
                         uv_filter_min, uv_filter_max, inv_wavelength,
                         frac_bandwidth, time_avg, gha0, dec0,
+                        cull_tolerance, order,
                         oskar_mem_float4c(vis, status));
                 break;
             case OSKAR_DOUBLE_COMPLEX_MATRIX:
@@ -185,6 +253,7 @@ void oskar_cross_correlate(int num_sources,  const oskar_Jones* jones,
                         oskar_mem_double_const(y, status),
                         uv_filter_min, uv_filter_max, inv_wavelength,
                         frac_bandwidth, time_avg, gha0, dec0,
+                        cull_tolerance, order,
                         oskar_mem_double4c(vis, status));
                 break;
             case OSKAR_SINGLE_COMPLEX:
@@ -205,6 +274,7 @@ void oskar_cross_correlate(int num_sources,  const oskar_Jones* jones,
                         oskar_mem_float_const(y, status),
                         uv_filter_min, uv_filter_max, inv_wavelength,
                         frac_bandwidth, time_avg, gha0, dec0,
+                        cull_tolerance, order,
                         oskar_mem_float2(vis, status));
                 break;
             case OSKAR_DOUBLE_COMPLEX:
@@ -225,11 +295,12 @@ void oskar_cross_correlate(int num_sources,  const oskar_Jones* jones,
                         oskar_mem_double_const(y, status),
                         uv_filter_min, uv_filter_max, inv_wavelength,
                         frac_bandwidth, time_avg, gha0, dec0,
+                        cull_tolerance, order,
                         oskar_mem_double2(vis, status));
                 break;
             default:
                 *status = OSKAR_ERR_BAD_DATA_TYPE;
-                return;
+                break;
             }
         }
         else
@@ -254,6 +325,7 @@ void oskar_cross_correlate(int num_sources,  const oskar_Jones* jones,
                         oskar_mem_float_const(y, status),
                         uv_filter_min, uv_filter_max, inv_wavelength,
                         frac_bandwidth, time_avg, gha0, dec0,
+                        cull_tolerance, order,
                         oskar_mem_float4c(vis, status));
                 break;
             case OSKAR_DOUBLE_COMPLEX_MATRIX:
@@ -274,6 +346,7 @@ void oskar_cross_correlate(int num_sources,  const oskar_Jones* jones,
                         oskar_mem_double_const(y, status),
                         uv_filter_min, uv_filter_max, inv_wavelength,
                         frac_bandwidth, time_avg, gha0, dec0,
+                        cull_tolerance, order,
                         oskar_mem_double4c(vis, status));
                 break;
             case OSKAR_SINGLE_COMPLEX:
@@ -291,6 +364,7 @@ void oskar_cross_correlate(int num_sources,  const oskar_Jones* jones,
                         oskar_mem_float_const(y, status),
                         uv_filter_min, uv_filter_max, inv_wavelength,
                         frac_bandwidth, time_avg, gha0, dec0,
+                        cull_tolerance, order,
                         oskar_mem_float2(vis, status));
                 break;
             case OSKAR_DOUBLE_COMPLEX:
@@ -308,13 +382,15 @@ void oskar_cross_correlate(int num_sources,  const oskar_Jones* jones,
                         oskar_mem_double_const(y, status),
                         uv_filter_min, uv_filter_max, inv_wavelength,
                         frac_bandwidth, time_avg, gha0, dec0,
+                        cull_tolerance, order,
                         oskar_mem_double2(vis, status));
                 break;
             default:
                 *status = OSKAR_ERR_BAD_DATA_TYPE;
-                return;
+                break;
             }
         }
+        free(order);
     }
     else if (location == OSKAR_GPU)
     {
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2013-2019, The University of Oxford
+ * Copyright (c) 2013-2020, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -30,9 +30,12 @@
 #include "correlate/oskar_cross_correlate_omp.h"
 #include "math/define_multiply.h"
 #include "math/oskar_kahan_sum.h"
+#include "utility/oskar_cpu_simd_level.h"
 #include "utility/oskar_kernel_macros.h"
 #include "utility/oskar_vector_types.h"
 
+#include <cstdlib>
+
 template<typename T1, typename T2>
 struct is_same
 {
@@ -47,6 +50,97 @@ struct is_same<T,T>
     typedef is_same<T,T> type;
 };
 
+// Number of stations in each block, and number of sources in each block.
+// The Jones matrices for two station blocks over one source block
+// should fit comfortably in the L2 cache.
+#define XCORR_STATION_BLOCK 8
+#define XCORR_SOURCE_BLOCK 128
+#define XCORR_NUM_BASELINES (XCORR_STATION_BLOCK * XCORR_STATION_BLOCK)
+
+#ifdef OSKAR_HAVE_CPU_SIMD
+// Correlates one block of sources for one baseline, using Jones matrices
+// staged as structure-of-arrays (with components a.x, a.y, b.x, b.y, c.x,
+// c.y, d.x, d.y each XCORR_SOURCE_BLOCK apart), so that the source loop
+// can be vectorised for the instruction set given by TARGET.
+// If INDEXED is true, only the n staged sources in the keep list are used.
+#define XCORR_SOA(NAME, TARGET)                                             \
+template <bool SMEARING, bool INDEXED,                                      \
+        typename REAL, typename REAL2, typename REAL4c>                     \
+TARGET static void NAME(                                                    \
+        const int                  n,                                       \
+        const int* const RESTRICT  keep,                                    \
+        const REAL* const RESTRICT source_I,                                \
+        const REAL* const RESTRICT source_Q,                                \
+        const REAL* const RESTRICT source_U,                                \
+        const REAL* const RESTRICT source_V,                                \
+        const REAL* const RESTRICT jones_p,                                 \
+        const REAL* const RESTRICT jones_q,                                 \
+        const REAL* const RESTRICT smearing,                                \
+        REAL4c&                    block_sum)                               \
+{                                                                           \
+    const int S = XCORR_SOURCE_BLOCK;                                       \
+    REAL s0 = 0, s1 = 0, s2 = 0, s3 = 0, s4 = 0, s5 = 0, s6 = 0, s7 = 0;    \
+    DO_PRAGMA(omp simd reduction(+:s0,s1,s2,s3,s4,s5,s6,s7))                \
+    for (int i = 0; i < n; ++i)                                             \
+    {                                                                       \
+        REAL4c m1, m2;                                                      \
+        const int j = INDEXED ? keep[i] : i;                                \
+        OSKAR_CONSTRUCT_B(REAL, m2,                                         \
+                source_I[j], source_Q[j], source_U[j], source_V[j])         \
+        m1.a.x = jones_p[j];         m1.a.y = jones_p[j + S];               \
+        m1.b.x = jones_p[j + 2 * S]; m1.b.y = jones_p[j + 3 * S];           \
+        m1.c.x = jones_p[j + 4 * S]; m1.c.y = jones_p[j + 5 * S];           \
+        m1.d.x = jones_p[j + 6 * S]; m1.d.y = jones_p[j + 7 * S];           \
+        OSKAR_MUL_COMPLEX_MATRIX_HERMITIAN_IN_PLACE(REAL2, m1, m2)          \
+        m2.a.x = jones_q[j];         m2.a.y = jones_q[j + S];               \
+        m2.b.x = jones_q[j + 2 * S]; m2.b.y = jones_q[j + 3 * S];           \
+        m2.c.x = jones_q[j + 4 * S]; m2.c.y = jones_q[j + 5 * S];           \
+        m2.d.x = jones_q[j + 6 * S]; m2.d.y = jones_q[j + 7 * S];           \
+        OSKAR_MUL_COMPLEX_MATRIX_CONJUGATE_TRANSPOSE_IN_PLACE(REAL2, m1, m2)\
+        const REAL f = SMEARING ? smearing[i] : (REAL) 1;                   \
+        s0 += m1.a.x * f; s1 += m1.a.y * f;                                 \
+        s2 += m1.b.x * f; s3 += m1.b.y * f;                                 \
+        s4 += m1.c.x * f; s5 += m1.c.y * f;                                 \
+        s6 += m1.d.x * f; s7 += m1.d.y * f;                                 \
+    }                                                                       \
+    block_sum.a.x = s0; block_sum.a.y = s1;                                 \
+    block_sum.b.x = s2; block_sum.b.y = s3;                                 \
+    block_sum.c.x = s4; block_sum.c.y = s5;                                 \
+    block_sum.d.x = s6; block_sum.d.y = s7;                                 \
+}
+
+XCORR_SOA(xcorr_soa_avx2, OSKAR_TARGET_AVX2)
+XCORR_SOA(xcorr_soa_avx512, OSKAR_TARGET_AVX512)
+
+// Copies Jones matrices for a block of stations and the n sources given
+// in the index list into structure-of-arrays order.
+template <typename REAL, typename REAL4c>
+static void xcorr_stage_jones(
+        const int                    num_sources,
+        const int                    num_block_stations,
+        const int*    const RESTRICT block_stations,
+        const int                    n,
+        const int*    const RESTRICT index,
+        const REAL4c* const RESTRICT jones,
+        REAL*               RESTRICT stage)
+{
+    const int S = XCORR_SOURCE_BLOCK;
+    for (int s = 0; s < num_block_stations; ++s)
+    {
+        const REAL4c* const in = &jones[block_stations[s] * num_sources];
+        REAL* const out = &stage[s * 8 * S];
+        for (int i = 0; i < n; ++i)
+        {
+            const REAL4c& j = in[index[i]];
+            out[i]         = j.a.x; out[i + S]     = j.a.y;
+            out[i + 2 * S] = j.b.x; out[i + 3 * S] = j.b.y;
+            out[i + 4 * S] = j.c.x; out[i + 5 * S] = j.c.y;
+            out[i + 6 * S] = j.d.x; out[i + 7 * S] = j.d.y;
+        }
+    }
+}
+#endif
+
 template
 <
 // Compile-time parameters.
@@ -80,97 +174,377 @@ void oskar_xcorr_omp(
         const REAL                   time_int_sec,
         const REAL                   gha0_rad,
         const REAL                   dec0_rad,
+        const REAL                   cull_tolerance_jy,
+        const int*    const RESTRICT station_order,
         REAL4c*             RESTRICT vis)
 {
-    // Loop over stations.
-#pragma omp parallel for schedule(dynamic, 1)
-    for (int SQ = 0; SQ < num_stations; ++SQ)
+    // Divide the baselines into pairs of station blocks, and loop over them.
+    // Pairs are not all the same size: a pair on the diagonal has at most
+    // 28 baselines, against 64 for other pairs, and pairs with the last
+    // block may have fewer. Pairs are therefore handed out one at a time.
+    const int num_blocks = (num_stations + XCORR_STATION_BLOCK - 1) /
+            XCORR_STATION_BLOCK;
+    const int num_block_pairs = num_blocks * (num_blocks + 1) / 2;
+    const bool SMEARING = GAUSSIAN || BANDWIDTH_SMEARING || TIME_SMEARING;
+    const bool cull = SMEARING && cull_tolerance_jy > (REAL) 0;
+#ifdef OSKAR_HAVE_CPU_SIMD
+    const int simd_level = oskar_cpu_simd_level();
+#endif
+#pragma omp parallel
+    {
+    REAL* stage = 0;
+#ifdef OSKAR_HAVE_CPU_SIMD
+    // Per-thread buffer for Jones matrices of both station blocks,
+    // for the smearing factors of one baseline, and for the Stokes
+    // parameters of sources that remain after culling.
+    const int stage_block = 8 * XCORR_STATION_BLOCK * XCORR_SOURCE_BLOCK;
+    if (simd_level > OSKAR_CPU_SIMD_NONE)
+        stage = (REAL*) malloc(
+                (2 * stage_block + 5 * XCORR_SOURCE_BLOCK) * sizeof(REAL));
+#endif
+#pragma omp for schedule(dynamic, 1)
+    for (int b = 0; b < num_block_pairs; ++b)
     {
-        // Pointer to source vector for station q.
-        const REAL4c* const station_q = &jones[SQ * num_sources];
+        REAL uu[XCORR_NUM_BASELINES], vv[XCORR_NUM_BASELINES];
+        REAL ww[XCORR_NUM_BASELINES], uu2[XCORR_NUM_BASELINES];
+        REAL vv2[XCORR_NUM_BASELINES], uuvv[XCORR_NUM_BASELINES];
+        REAL du[XCORR_NUM_BASELINES], dv[XCORR_NUM_BASELINES];
+        REAL dw[XCORR_NUM_BASELINES];
+        REAL4c sum[XCORR_NUM_BASELINES], guard[XCORR_NUM_BASELINES];
+        int SP[XCORR_NUM_BASELINES], SQ[XCORR_NUM_BASELINES];
+        int AP[XCORR_NUM_BASELINES], AQ[XCORR_NUM_BASELINES];
+        int stations_p[XCORR_STATION_BLOCK], stations_q[XCORR_STATION_BLOCK];
+        int num_baselines = 0, num_p = 0, num_q = 0, BQ = 0, BP = b;
+
+        // Get the block indices, with BQ <= BP.
+        while (BP >= num_blocks - BQ)
+        {
+            BP -= (num_blocks - BQ);
+            ++BQ;
+        }
+        BP += BQ;
+
+        // Get the stations in each block.
+        for (int i = BQ * XCORR_STATION_BLOCK;
+                i < (BQ + 1) * XCORR_STATION_BLOCK && i < num_stations; ++i)
+            stations_q[num_q++] = station_order ? station_order[i] : i;
+        for (int i = BP * XCORR_STATION_BLOCK;
+                i < (BP + 1) * XCORR_STATION_BLOCK && i < num_stations; ++i)
+            stations_p[num_p++] = station_order ? station_order[i] : i;
 
-        // Loop over baselines for this station.
-        for (int SP = SQ + 1; SP < num_stations; ++SP)
+        // Set up all baselines between stations in the two blocks.
+        // The slot of each station in the staged Jones matrices is also
+        // stored, with the second block following the first.
+        for (int iq = 0; iq < num_q; ++iq)
         {
-            REAL uv_len, uu, vv, ww, uu2, vv2, uuvv, du, dv, dw;
-            REAL4c m1, m2, sum, guard;
-            OSKAR_CLEAR_COMPLEX_MATRIX(REAL, sum)
-            if (is_same<REAL, float>::value)
-                OSKAR_CLEAR_COMPLEX_MATRIX(REAL, guard)
-
-            // Pointer to source vector for station p.
-            const REAL4c* const station_p = &jones[SP * num_sources];
-
-            // Get common baseline values.
-            OSKAR_BASELINE_TERMS(REAL, station_u[SP], station_u[SQ],
-                    station_v[SP], station_v[SQ], station_w[SP], station_w[SQ],
-                    uu, vv, ww, uu2, vv2, uuvv, uv_len);
-
-            // Apply the baseline length filter.
-            if (uv_len < uv_min_lambda || uv_len > uv_max_lambda) continue;
-
-            // Compute the deltas for time-average smearing.
-            if (TIME_SMEARING)
-                OSKAR_BASELINE_DELTAS(REAL, station_x[SP], station_x[SQ],
-                        station_y[SP], station_y[SQ], du, dv, dw);
-
-            // Loop over sources.
-            for (int i = 0; i < num_sources; ++i)
+            for (int ip = 0; ip < num_p; ++ip)
             {
-                REAL smearing;
-                if (GAUSSIAN)
+                REAL uv_len;
+                const int k = num_baselines;
+                if (BP == BQ && ip <= iq) continue;
+                const int slot_p = (BP == BQ) ? ip : ip + XCORR_STATION_BLOCK;
+                const bool swap = stations_p[ip] < stations_q[iq];
+                const int p = swap ? stations_q[iq] : stations_p[ip];
+                const int q = swap ? stations_p[ip] : stations_q[iq];
+
+                // Get common baseline values.
+                OSKAR_BASELINE_TERMS(REAL, station_u[p], station_u[q],
+                        station_v[p], station_v[q], station_w[p], station_w[q],
+                        uu[k], vv[k], ww[k], uu2[k], vv2[k], uuvv[k], uv_len);
+
+                // Apply the baseline length filter.
+                if (uv_len < uv_min_lambda || uv_len > uv_max_lambda) continue;
+
+                // Compute the deltas for time-average smearing.
+                if (TIME_SMEARING)
+                    OSKAR_BASELINE_DELTAS(REAL, station_x[p], station_x[q],
+                            station_y[p], station_y[q], du[k], dv[k], dw[k]);
+                OSKAR_CLEAR_COMPLEX_MATRIX(REAL, sum[k])
+                if (is_same<REAL, float>::value)
+                    OSKAR_CLEAR_COMPLEX_MATRIX(REAL, guard[k])
+                SP[k] = p;
+                SQ[k] = q;
+                AP[k] = swap ? iq : slot_p;
+                AQ[k] = swap ? slot_p : iq;
+                num_baselines++;
+            }
+        }
+        if (num_baselines == 0) continue;
+
+        // Find the smallest UV distance in the block, to bound the
+        // Gaussian source smearing on all its baselines.
+        REAL uv2_min = (REAL) 0;
+        if (cull && GAUSSIAN)
+        {
+            uv2_min = uu2[0] + vv2[0];
+            for (int k = 1; k < num_baselines; ++k)
+                if (uu2[k] + vv2[k] < uv2_min) uv2_min = uu2[k] + vv2[k];
+        }
+
+        // Loop over blocks of sources, so that the Jones matrices for
+        // both blocks of stations stay in cache for all their baselines.
+        for (int s0 = 0; s0 < num_sources; s0 += XCORR_SOURCE_BLOCK)
+        {
+            const int s1 = (s0 + XCORR_SOURCE_BLOCK < num_sources) ?
+                    s0 + XCORR_SOURCE_BLOCK : num_sources;
+
+            // Find the sources in the block that could contribute more
+            // than the tolerance on any baseline in the block.
+            // Jones matrix amplitudes are not included in the bound.
+            int index[XCORR_SOURCE_BLOCK], num_index = 0;
+            REAL flux_limit[XCORR_SOURCE_BLOCK];
+            for (int i = s0; i < s1; ++i)
+            {
+                if (cull)
                 {
-                    const REAL t = source_a[i] * uu2 + source_b[i] * uuvv +
-                            source_c[i] * vv2;
-                    smearing = exp((REAL) -t);
+                    const REAL flux = fabs(source_I[i]) + fabs(source_Q[i]) +
+                            fabs(source_U[i]) + fabs(source_V[i]);
+
+                    // Use |sinc(t)| <= 1 / |t| on each baseline, and stop
+                    // as soon as one baseline needs the source.
+                    REAL limit = flux / cull_tolerance_jy;
+                    if (GAUSSIAN)
+                    {
+                        const REAL lambda = OSKAR_GAUSSIAN_MIN_EIGENVALUE(REAL,
+                                source_a[i], source_b[i], source_c[i]);
+                        if (lambda > (REAL) 0) limit *= exp(-lambda * uv2_min);
+                    }
+                    bool needed = limit >= (REAL) 1;
+                    if (!needed && (BANDWIDTH_SMEARING || TIME_SMEARING))
+                    {
+                        const REAL l = source_l[i];
+                        const REAL m = source_m[i];
+                        const REAL n = source_n[i] - (REAL) 1;
+                        for (int k = 0; k < num_baselines; ++k)
+                        {
+                            REAL t = (REAL) 1;
+                            if (BANDWIDTH_SMEARING)
+                            {
+                                const REAL x =
+                                        fabs(uu[k] * l + vv[k] * m + ww[k] * n);
+                                if (x > (REAL) 1) t = x;
+                            }
+                            if (TIME_SMEARING)
+                            {
+                                const REAL x =
+                                        fabs(du[k] * l + dv[k] * m + dw[k] * n);
+                                if (x > (REAL) 1) t *= x;
+                            }
+                            if (t <= limit)
+                            {
+                                needed = true;
+                                break;
+                            }
+                        }
+                    }
+                    if (!needed) continue;
+                    flux_limit[num_index] = flux / cull_tolerance_jy;
                 }
-                else smearing = (REAL) 1;
-                if (BANDWIDTH_SMEARING || TIME_SMEARING)
+                index[num_index++] = i;
+            }
+            if (num_index == 0) continue;
+#ifdef OSKAR_HAVE_CPU_SIMD
+            if (stage)
+            {
+                REAL* const smear = stage + 2 * stage_block;
+                const REAL *I = &source_I[s0], *Q = &source_Q[s0];
+                const REAL *U = &source_U[s0], *V = &source_V[s0];
+                if (num_index < s1 - s0)
                 {
-                    const REAL l = source_l[i];
-                    const REAL m = source_m[i];
-                    const REAL n = source_n[i] - (REAL) 1;
-                    if (BANDWIDTH_SMEARING)
+                    // Gather the Stokes parameters of the remaining sources.
+                    REAL* const stokes = smear + XCORR_SOURCE_BLOCK;
+                    for (int j = 0; j < num_index; ++j)
                     {
-                        const REAL t = uu * l + vv * m + ww * n;
-                        smearing *= OSKAR_SINC(REAL, t);
+                        const int i = index[j];
+                        stokes[j]                          = source_I[i];
+                        stokes[j + XCORR_SOURCE_BLOCK]     = source_Q[i];
+                        stokes[j + 2 * XCORR_SOURCE_BLOCK] = source_U[i];
+                        stokes[j + 3 * XCORR_SOURCE_BLOCK] = source_V[i];
                     }
-                    if (TIME_SMEARING)
+                    I = stokes;
+                    Q = stokes + XCORR_SOURCE_BLOCK;
+                    U = stokes + 2 * XCORR_SOURCE_BLOCK;
+                    V = stokes + 3 * XCORR_SOURCE_BLOCK;
+                }
+                xcorr_stage_jones<REAL, REAL4c>(num_sources, num_q,
+                        stations_q, num_index, index, jones, stage);
+                if (BP != BQ)
+                    xcorr_stage_jones<REAL, REAL4c>(num_sources, num_p,
+                            stations_p, num_index, index, jones,
+                            stage + stage_block);
+                for (int k = 0; k < num_baselines; ++k)
+                {
+                    REAL4c block_sum;
+                    const REAL* const jones_p =
+                            &stage[AP[k] * 8 * XCORR_SOURCE_BLOCK];
+                    const REAL* const jones_q =
+                            &stage[AQ[k] * 8 * XCORR_SOURCE_BLOCK];
+                    int num_keep = num_index, keep[XCORR_SOURCE_BLOCK];
+                    if (SMEARING)
                     {
-                        const REAL t = du * l + dv * m + dw * n;
-                        smearing *= OSKAR_SINC(REAL, t);
+                        num_keep = 0;
+                        for (int j = 0; j < num_index; ++j)
+                        {
+                            const int i = index[j];
+                            REAL smearing = (REAL) 1, t_bw = 0, t_time = 0;
+                            if (GAUSSIAN)
+                            {
+                                const REAL t = source_a[i] * uu2[k] +
+                                        source_b[i] * uuvv[k] +
+                                        source_c[i] * vv2[k];
+                                smearing = exp((REAL) -t);
+                            }
+                            if (BANDWIDTH_SMEARING || TIME_SMEARING)
+                            {
+                                const REAL l = source_l[i];
+                                const REAL m = source_m[i];
+                                const REAL n = source_n[i] - (REAL) 1;
+                                if (BANDWIDTH_SMEARING)
+                                    t_bw = uu[k] * l + vv[k] * m + ww[k] * n;
+                                if (TIME_SMEARING)
+                                    t_time = du[k] * l + dv[k] * m + dw[k] * n;
+                            }
+                            if (cull)
+                            {
+                                REAL t = (REAL) 1;
+                                if (BANDWIDTH_SMEARING && fabs(t_bw) > t)
+                                    t = fabs(t_bw);
+                                if (TIME_SMEARING && fabs(t_time) > (REAL) 1)
+                                    t *= fabs(t_time);
+                                if (smearing * flux_limit[j] < t) continue;
+                            }
+                            if (BANDWIDTH_SMEARING)
+                                smearing *= OSKAR_SINC(REAL, t_bw);
+                            if (TIME_SMEARING)
+                                smearing *= OSKAR_SINC(REAL, t_time);
+                            smear[num_keep] = smearing;
+                            keep[num_keep++] = j;
+                        }
+                        if (num_keep == 0) continue;
+                    }
+                    if (num_keep < num_index)
+                    {
+                        if (simd_level >= OSKAR_CPU_SIMD_AVX512)
+                            xcorr_soa_avx512<SMEARING, true,
+                                    REAL, REAL2, REAL4c>(num_keep, keep,
+                                    I, Q, U, V, jones_p, jones_q, smear,
+                                    block_sum);
+                        else
+                            xcorr_soa_avx2<SMEARING, true,
+                                    REAL, REAL2, REAL4c>(num_keep, keep,
+                                    I, Q, U, V, jones_p, jones_q, smear,
+                                    block_sum);
+                    }
+                    else if (simd_level >= OSKAR_CPU_SIMD_AVX512)
+                        xcorr_soa_avx512<SMEARING, false,
+                                REAL, REAL2, REAL4c>(num_index, keep,
+                                I, Q, U, V, jones_p, jones_q, smear,
+                                block_sum);
+                    else
+                        xcorr_soa_avx2<SMEARING, false,
+                                REAL, REAL2, REAL4c>(num_index, keep,
+                                I, Q, U, V, jones_p, jones_q, smear,
+                                block_sum);
+                    if (is_same<REAL, float>::value)
+                    {
+                        OSKAR_KAHAN_SUM_COMPLEX_MATRIX(
+                                REAL, sum[k], block_sum, guard[k])
+                    }
+                    else
+                    {
+                        OSKAR_ADD_COMPLEX_MATRIX_IN_PLACE(sum[k], block_sum)
                     }
                 }
+                continue;
+            }
+#endif
 
-                // Construct source brightness matrix.
-                OSKAR_CONSTRUCT_B(REAL, m2,
-                        source_I[i], source_Q[i], source_U[i], source_V[i])
-
-                // Multiply first Jones matrix with source brightness matrix.
-                OSKAR_LOAD_MATRIX(m1, station_p[i])
-                OSKAR_MUL_COMPLEX_MATRIX_HERMITIAN_IN_PLACE(REAL2, m1, m2)
+            // Loop over baselines in the block.
+            for (int k = 0; k < num_baselines; ++k)
+            {
+                REAL4c m1, m2, sum_k, guard_k;
+                sum_k = sum[k];
+                if (is_same<REAL, float>::value) guard_k = guard[k];
 
-                // Multiply result with second (Hermitian transposed) Jones matrix.
-                OSKAR_LOAD_MATRIX(m2, station_q[i])
-                OSKAR_MUL_COMPLEX_MATRIX_CONJUGATE_TRANSPOSE_IN_PLACE(REAL2, m1, m2)
+                // Pointers to source vectors for stations p and q.
+                const REAL4c* const station_p = &jones[SP[k] * num_sources];
+                const REAL4c* const station_q = &jones[SQ[k] * num_sources];
 
-                // Multiply result by smearing term and accumulate.
-                if (is_same<REAL, float>::value)
+                // Loop over sources.
+                for (int j = 0; j < num_index; ++j)
                 {
-                    OSKAR_KAHAN_SUM_MULTIPLY_COMPLEX_MATRIX(
-                            REAL, sum, m1, smearing, guard)
-                }
-                else
-                {
-                    OSKAR_MUL_ADD_COMPLEX_MATRIX_SCALAR(sum, m1, smearing)
+                    const int i = index[j];
+                    REAL smearing = (REAL) 1, t_bw = 0, t_time = 0;
+                    if (GAUSSIAN)
+                    {
+                        const REAL t = source_a[i] * uu2[k] +
+                                source_b[i] * uuvv[k] + source_c[i] * vv2[k];
+                        smearing = exp((REAL) -t);
+                    }
+                    if (BANDWIDTH_SMEARING || TIME_SMEARING)
+                    {
+                        const REAL l = source_l[i];
+                        const REAL m = source_m[i];
+                        const REAL n = source_n[i] - (REAL) 1;
+                        if (BANDWIDTH_SMEARING)
+                            t_bw = uu[k] * l + vv[k] * m + ww[k] * n;
+                        if (TIME_SMEARING)
+                            t_time = du[k] * l + dv[k] * m + dw[k] * n;
+                    }
+
+                    // Skip the source if its bound is below the tolerance.
+                    if (cull)
+                    {
+                        REAL t = (REAL) 1;
+                        if (BANDWIDTH_SMEARING && fabs(t_bw) > t)
+                            t = fabs(t_bw);
+                        if (TIME_SMEARING && fabs(t_time) > (REAL) 1)
+                            t *= fabs(t_time);
+                        if (smearing * flux_limit[j] < t) continue;
+                    }
+                    if (BANDWIDTH_SMEARING)
+                        smearing *= OSKAR_SINC(REAL, t_bw);
+                    if (TIME_SMEARING)
+                        smearing *= OSKAR_SINC(REAL, t_time);
+
+                    // Construct source brightness matrix.
+                    OSKAR_CONSTRUCT_B(REAL, m2,
+                            source_I[i], source_Q[i], source_U[i], source_V[i])
+
+                    // Multiply first Jones matrix with source brightness matrix.
+                    OSKAR_LOAD_MATRIX(m1, station_p[i])
+                    OSKAR_MUL_COMPLEX_MATRIX_HERMITIAN_IN_PLACE(REAL2, m1, m2)
+
+                    // Multiply result with second (Hermitian transposed) Jones matrix.
+                    OSKAR_LOAD_MATRIX(m2, station_q[i])
+                    OSKAR_MUL_COMPLEX_MATRIX_CONJUGATE_TRANSPOSE_IN_PLACE(REAL2, m1, m2)
+
+                    // Multiply result by smearing term and accumulate.
+                    if (is_same<REAL, float>::value)
+                    {
+                        OSKAR_KAHAN_SUM_MULTIPLY_COMPLEX_MATRIX(
+                                REAL, sum_k, m1, smearing, guard_k)
+                    }
+                    else
+                    {
+                        OSKAR_MUL_ADD_COMPLEX_MATRIX_SCALAR(sum_k, m1, smearing)
+                    }
                 }
+                sum[k] = sum_k;
+                if (is_same<REAL, float>::value) guard[k] = guard_k;
             }
+        }
 
-            // Add result to the baseline visibility.
-            int i = OSKAR_BASELINE_INDEX(num_stations, SP, SQ) + offset_out;
-            OSKAR_ADD_COMPLEX_MATRIX_IN_PLACE(vis[i], sum);
+        // Add results to the baseline visibilities.
+        for (int k = 0; k < num_baselines; ++k)
+        {
+            const int i = OSKAR_BASELINE_INDEX(num_stations, SP[k], SQ[k]) +
+                    offset_out;
+            OSKAR_ADD_COMPLEX_MATRIX_IN_PLACE(vis[i], sum[k]);
         }
     }
+    free(stage);
+    }
 }
 
 #define XCORR_KERNEL(BS, TS, GAUSSIAN, REAL, REAL2, REAL4c)                 \
@@ -180,7 +554,8 @@ void oskar_xcorr_omp(
                 d_station_u, d_station_v, d_station_w,                      \
                 d_station_x, d_station_y, uv_min_lambda, uv_max_lambda,     \
                 inv_wavelength, frac_bandwidth, time_int_sec,               \
-                gha0_rad, dec0_rad, d_vis);
+                gha0_rad, dec0_rad, cull_tolerance_jy, station_order,       \
+                d_vis);
 
 #define XCORR_SELECT(GAUSSIAN, REAL, REAL2, REAL4c)                         \
         if (frac_bandwidth == (REAL)0 && time_int_sec == (REAL)0)           \
@@ -202,7 +577,8 @@ void oskar_cross_correlate_point_omp_f(
         const float* d_station_x, const float* d_station_y,
         float uv_min_lambda, float uv_max_lambda, float inv_wavelength,
         float frac_bandwidth, float time_int_sec, float gha0_rad,
-        float dec0_rad, float4c* d_vis)
+        float dec0_rad, float cull_tolerance_jy, const int* station_order,
+        float4c* d_vis)
 {
     const float *d_a = 0, *d_b = 0, *d_c = 0;
     XCORR_SELECT(false, float, float2, float4c)
@@ -218,7 +594,8 @@ void oskar_cross_correlate_point_omp_d(
         const double* d_station_x, const double* d_station_y,
         double uv_min_lambda, double uv_max_lambda, double inv_wavelength,
         double frac_bandwidth, double time_int_sec, double gha0_rad,
-        double dec0_rad, double4c* d_vis)
+        double dec0_rad, double cull_tolerance_jy, const int* station_order,
+        double4c* d_vis)
 {
     const double *d_a = 0, *d_b = 0, *d_c = 0;
     XCORR_SELECT(false, double, double2, double4c)
@@ -234,7 +611,8 @@ void oskar_cross_correlate_gaussian_omp_f(
         const float* d_station_w, const float* d_station_x,
         const float* d_station_y, float uv_min_lambda, float uv_max_lambda,
         float inv_wavelength, float frac_bandwidth, float time_int_sec,
-        float gha0_rad, float dec0_rad, float4c* d_vis)
+        float gha0_rad, float dec0_rad, float cull_tolerance_jy,
+        const int* station_order, float4c* d_vis)
 {
     XCORR_SELECT(true, float, float2, float4c)
 }
@@ -249,7 +627,8 @@ void oskar_cross_correlate_gaussian_omp_d(
         const double* d_station_w, const double* d_station_x,
         const double* d_station_y, double uv_min_lambda, double uv_max_lambda,
         double inv_wavelength, double frac_bandwidth, double time_int_sec,
-        double gha0_rad, double dec0_rad, double4c* d_vis)
+        double gha0_rad, double dec0_rad, double cull_tolerance_jy,
+        const int* station_order, double4c* d_vis)
 {
     XCORR_SELECT(true, double, double2, double4c)
 }
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2014-2019, The University of Oxford
+ * Copyright (c) 2014-2020, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -48,6 +48,13 @@ struct is_same<T,T>
     typedef is_same<T,T> type;
 };
 
+// Number of stations in each block, and number of sources in each block.
+// The Jones scalars for two station blocks over one source block
+// should fit comfortably in the L2 cache.
+#define XCORR_STATION_BLOCK 8
+#define XCORR_SOURCE_BLOCK 256
+#define XCORR_NUM_BASELINES (XCORR_STATION_BLOCK * XCORR_STATION_BLOCK)
+
 template
 <
 // Compile-time parameters.
@@ -78,94 +85,236 @@ void oskar_xcorr_scalar_omp(
         const REAL                  time_int_sec,
         const REAL                  gha0_rad,
         const REAL                  dec0_rad,
+        const REAL                  cull_tolerance_jy,
+        const int*   const RESTRICT station_order,
         REAL2*             RESTRICT vis)
 {
-    // Loop over stations.
+    // Divide the baselines into pairs of station blocks, and loop over them.
+    // Pairs are not all the same size: a pair on the diagonal has at most
+    // 28 baselines, against 64 for other pairs, and pairs with the last
+    // block may have fewer. Pairs are therefore handed out one at a time.
+    const int num_blocks = (num_stations + XCORR_STATION_BLOCK - 1) /
+            XCORR_STATION_BLOCK;
+    const int num_block_pairs = num_blocks * (num_blocks + 1) / 2;
+    const bool cull = (GAUSSIAN || BANDWIDTH_SMEARING || TIME_SMEARING) &&
+            cull_tolerance_jy > (REAL) 0;
 #pragma omp parallel for schedule(dynamic, 1)
-    for (int SQ = 0; SQ < num_stations; ++SQ)
+    for (int b = 0; b < num_block_pairs; ++b)
     {
-        // Pointer to source vector for station q.
-        const REAL2* const station_q = &jones[SQ * num_sources];
+        REAL uu[XCORR_NUM_BASELINES], vv[XCORR_NUM_BASELINES];
+        REAL ww[XCORR_NUM_BASELINES], uu2[XCORR_NUM_BASELINES];
+        REAL vv2[XCORR_NUM_BASELINES], uuvv[XCORR_NUM_BASELINES];
+        REAL du[XCORR_NUM_BASELINES], dv[XCORR_NUM_BASELINES];
+        REAL dw[XCORR_NUM_BASELINES];
+        REAL2 sum[XCORR_NUM_BASELINES], guard[XCORR_NUM_BASELINES];
+        int SP[XCORR_NUM_BASELINES], SQ[XCORR_NUM_BASELINES];
+        int stations_p[XCORR_STATION_BLOCK], stations_q[XCORR_STATION_BLOCK];
+        int num_baselines = 0, num_p = 0, num_q = 0, BQ = 0, BP = b;
 
-        // Loop over baselines for this station.
-        for (int SP = SQ + 1; SP < num_stations; ++SP)
+        // Get the block indices, with BQ <= BP.
+        while (BP >= num_blocks - BQ)
         {
-            REAL uv_len, uu, vv, ww, uu2, vv2, uuvv, du, dv, dw;
-            REAL2 t1, t2, sum, guard;
-            sum.x = sum.y = (REAL) 0;
-            if (is_same<REAL, float>::value)
-                guard.x = guard.y = (REAL) 0;
-
-            // Pointer to source vector for station p.
-            const REAL2* const station_p = &jones[SP * num_sources];
-
-            // Get common baseline values.
-            OSKAR_BASELINE_TERMS(REAL, station_u[SP], station_u[SQ],
-                    station_v[SP], station_v[SQ], station_w[SP], station_w[SQ],
-                    uu, vv, ww, uu2, vv2, uuvv, uv_len);
-
-            // Apply the baseline length filter.
-            if (uv_len < uv_min_lambda || uv_len > uv_max_lambda) continue;
-
-            // Compute the deltas for time-average smearing.
-            if (TIME_SMEARING)
-                OSKAR_BASELINE_DELTAS(REAL, station_x[SP], station_x[SQ],
-                        station_y[SP], station_y[SQ], du, dv, dw);
-
-            // Loop over sources.
-            for (int i = 0; i < num_sources; ++i)
+            BP -= (num_blocks - BQ);
+            ++BQ;
+        }
+        BP += BQ;
+
+        // Get the stations in each block.
+        for (int i = BQ * XCORR_STATION_BLOCK;
+                i < (BQ + 1) * XCORR_STATION_BLOCK && i < num_stations; ++i)
+            stations_q[num_q++] = station_order ? station_order[i] : i;
+        for (int i = BP * XCORR_STATION_BLOCK;
+                i < (BP + 1) * XCORR_STATION_BLOCK && i < num_stations; ++i)
+            stations_p[num_p++] = station_order ? station_order[i] : i;
+
+        // Set up all baselines between stations in the two blocks.
+        for (int iq = 0; iq < num_q; ++iq)
+        {
+            for (int ip = 0; ip < num_p; ++ip)
             {
-                REAL smearing;
-                if (GAUSSIAN)
-                {
-                    const REAL t = source_a[i] * uu2 + source_b[i] * uuvv +
-                            source_c[i] * vv2;
-                    smearing = exp((REAL) -t);
-                }
-                else
-                {
-                    smearing = (REAL) 1;
-                }
-                smearing *= source_I[i];
-                if (BANDWIDTH_SMEARING || TIME_SMEARING)
+                REAL uv_len;
+                const int k = num_baselines;
+                if (BP == BQ && ip <= iq) continue;
+                const bool swap = stations_p[ip] < stations_q[iq];
+                const int p = swap ? stations_q[iq] : stations_p[ip];
+                const int q = swap ? stations_p[ip] : stations_q[iq];
+
+                // Get common baseline values.
+                OSKAR_BASELINE_TERMS(REAL, station_u[p], station_u[q],
+                        station_v[p], station_v[q], station_w[p], station_w[q],
+                        uu[k], vv[k], ww[k], uu2[k], vv2[k], uuvv[k], uv_len);
+
+                // Apply the baseline length filter.
+                if (uv_len < uv_min_lambda || uv_len > uv_max_lambda) continue;
+
+                // Compute the deltas for time-average smearing.
+                if (TIME_SMEARING)
+                    OSKAR_BASELINE_DELTAS(REAL, station_x[p], station_x[q],
+                            station_y[p], station_y[q], du[k], dv[k], dw[k]);
+                sum[k].x = sum[k].y = (REAL) 0;
+                if (is_same<REAL, float>::value)
+                    guard[k].x = guard[k].y = (REAL) 0;
+                SP[k] = p;
+                SQ[k] = q;
+                num_baselines++;
+            }
+        }
+        if (num_baselines == 0) continue;
+
+        // Find the smallest UV distance in the block, to bound the
+        // Gaussian source smearing on all its baselines.
+        REAL uv2_min = (REAL) 0;
+        if (cull && GAUSSIAN)
+        {
+            uv2_min = uu2[0] + vv2[0];
+            for (int k = 1; k < num_baselines; ++k)
+                if (uu2[k] + vv2[k] < uv2_min) uv2_min = uu2[k] + vv2[k];
+        }
+
+        // Loop over blocks of sources, so that the Jones scalars for
+        // both blocks of stations stay in cache for all their baselines.
+        for (int s0 = 0; s0 < num_sources; s0 += XCORR_SOURCE_BLOCK)
+        {
+            const int s1 = (s0 + XCORR_SOURCE_BLOCK < num_sources) ?
+                    s0 + XCORR_SOURCE_BLOCK : num_sources;
+
+            // Find the sources in the block that could contribute more
+            // than the tolerance on any baseline in the block.
+            // Jones amplitudes are not included in the bound.
+            int index[XCORR_SOURCE_BLOCK], num_active = 0;
+            REAL flux_limit[XCORR_SOURCE_BLOCK];
+            for (int i = s0; i < s1; ++i)
+            {
+                if (cull)
                 {
-                    const REAL l = source_l[i];
-                    const REAL m = source_m[i];
-                    const REAL n = source_n[i] - (REAL) 1;
-                    if (BANDWIDTH_SMEARING)
+                    const REAL flux = fabs(source_I[i]);
+
+                    // Use |sinc(t)| <= 1 / |t| on each baseline, and stop
+                    // as soon as one baseline needs the source.
+                    REAL limit = flux / cull_tolerance_jy;
+                    if (GAUSSIAN)
                     {
-                        const REAL t = uu * l + vv * m + ww * n;
-                        smearing *= OSKAR_SINC(REAL, t);
+                        const REAL lambda = OSKAR_GAUSSIAN_MIN_EIGENVALUE(REAL,
+                                source_a[i], source_b[i], source_c[i]);
+                        if (lambda > (REAL) 0) limit *= exp(-lambda * uv2_min);
                     }
-                    if (TIME_SMEARING)
+                    bool needed = limit >= (REAL) 1;
+                    if (!needed && (BANDWIDTH_SMEARING || TIME_SMEARING))
                     {
-                        const REAL t = du * l + dv * m + dw * n;
-                        smearing *= OSKAR_SINC(REAL, t);
+                        const REAL l = source_l[i];
+                        const REAL m = source_m[i];
+                        const REAL n = source_n[i] - (REAL) 1;
+                        for (int k = 0; k < num_baselines; ++k)
+                        {
+                            REAL t = (REAL) 1;
+                            if (BANDWIDTH_SMEARING)
+                            {
+                                const REAL x =
+                                        fabs(uu[k] * l + vv[k] * m + ww[k] * n);
+                                if (x > (REAL) 1) t = x;
+                            }
+                            if (TIME_SMEARING)
+                            {
+                                const REAL x =
+                                        fabs(du[k] * l + dv[k] * m + dw[k] * n);
+                                if (x > (REAL) 1) t *= x;
+                            }
+                            if (t <= limit)
+                            {
+                                needed = true;
+                                break;
+                            }
+                        }
                     }
+                    if (!needed) continue;
+                    flux_limit[num_active] = flux / cull_tolerance_jy;
                 }
+                index[num_active++] = i;
+            }
+            if (num_active == 0) continue;
 
-                // Multiply Jones scalars.
-                t1 = station_p[i];
-                t2 = station_q[i];
-                OSKAR_MUL_COMPLEX_CONJUGATE_IN_PLACE(REAL2, t1, t2)
+            // Loop over baselines in the block.
+            for (int k = 0; k < num_baselines; ++k)
+            {
+                REAL2 t1, t2, sum_k, guard_k;
+                sum_k = sum[k];
+                if (is_same<REAL, float>::value) guard_k = guard[k];
 
-                // Multiply result by smearing term and accumulate.
-                if (is_same<REAL, float>::value)
-                {
-                    OSKAR_KAHAN_SUM_MULTIPLY_COMPLEX(
-                            REAL, sum, t1, smearing, guard)
-                }
-                else
+                // Pointers to source vectors for stations p and q.
+                const REAL2* const station_p = &jones[SP[k] * num_sources];
+                const REAL2* const station_q = &jones[SQ[k] * num_sources];
+
+                // Loop over sources.
+                for (int j = 0; j < num_active; ++j)
                 {
-                    sum.x += t1.x * smearing;
-                    sum.y += t1.y * smearing;
+                    const int i = index[j];
+                    REAL smearing, t_bw = 0, t_time = 0;
+                    if (GAUSSIAN)
+                    {
+                        const REAL t = source_a[i] * uu2[k] +
+                                source_b[i] * uuvv[k] + source_c[i] * vv2[k];
+                        smearing = exp((REAL) -t);
+                    }
+                    else
+                    {
+                        smearing = (REAL) 1;
+                    }
+                    if (BANDWIDTH_SMEARING || TIME_SMEARING)
+                    {
+                        const REAL l = source_l[i];
+                        const REAL m = source_m[i];
+                        const REAL n = source_n[i] - (REAL) 1;
+                        if (BANDWIDTH_SMEARING)
+                            t_bw = uu[k] * l + vv[k] * m + ww[k] * n;
+                        if (TIME_SMEARING)
+                            t_time = du[k] * l + dv[k] * m + dw[k] * n;
+                    }
+
+                    // Skip the source if its bound is below the tolerance.
+                    if (cull)
+                    {
+                        REAL t = (REAL) 1;
+                        if (BANDWIDTH_SMEARING && fabs(t_bw) > t)
+                            t = fabs(t_bw);
+                        if (TIME_SMEARING && fabs(t_time) > (REAL) 1)
+                            t *= fabs(t_time);
+                        if (smearing * flux_limit[j] < t) continue;
+                    }
+                    smearing *= source_I[i];
+                    if (BANDWIDTH_SMEARING)
+                        smearing *= OSKAR_SINC(REAL, t_bw);
+                    if (TIME_SMEARING)
+                        smearing *= OSKAR_SINC(REAL, t_time);
+
+                    // Multiply Jones scalars.
+                    t1 = station_p[i];
+                    t2 = station_q[i];
+                    OSKAR_MUL_COMPLEX_CONJUGATE_IN_PLACE(REAL2, t1, t2)
+
+                    // Multiply result by smearing term and accumulate.
+                    if (is_same<REAL, float>::value)
+                    {
+                        OSKAR_KAHAN_SUM_MULTIPLY_COMPLEX(
+                                REAL, sum_k, t1, smearing, guard_k)
+                    }
+                    else
+                    {
+                        sum_k.x += t1.x * smearing;
+                        sum_k.y += t1.y * smearing;
+                    }
                 }
+                sum[k] = sum_k;
+                if (is_same<REAL, float>::value) guard[k] = guard_k;
             }
+        }
 
-            // Add result to the baseline visibility.
-            int i = OSKAR_BASELINE_INDEX(num_stations, SP, SQ) + offset_out;
-            vis[i].x += sum.x;
-            vis[i].y += sum.y;
+        // Add results to the baseline visibilities.
+        for (int k = 0; k < num_baselines; ++k)
+        {
+            const int i = OSKAR_BASELINE_INDEX(num_stations, SP[k], SQ[k]) +
+                    offset_out;
+            vis[i].x += sum[k].x;
+            vis[i].y += sum[k].y;
         }
     }
 }
@@ -176,7 +325,8 @@ void oskar_xcorr_scalar_omp(
                 d_a, d_b, d_c, d_station_u, d_station_v, d_station_w,       \
                 d_station_x, d_station_y, uv_min_lambda, uv_max_lambda,     \
                 inv_wavelength, frac_bandwidth, time_int_sec,               \
-                gha0_rad, dec0_rad, d_vis);
+                gha0_rad, dec0_rad, cull_tolerance_jy, station_order,       \
+                d_vis);
 
 #define XCORR_SELECT(GAUSSIAN, REAL, REAL2)                                 \
         if (frac_bandwidth == (REAL)0 && time_int_sec == (REAL)0)           \
@@ -196,7 +346,9 @@ void oskar_cross_correlate_scalar_point_omp_f(
         const float* d_station_w, const float* d_station_x,
         const float* d_station_y, float uv_min_lambda, float uv_max_lambda,
         float inv_wavelength, float frac_bandwidth, const float time_int_sec,
-        const float gha0_rad, const float dec0_rad, float2* d_vis)
+        const float gha0_rad, const float dec0_rad,
+        const float cull_tolerance_jy, const int* station_order,
+        float2* d_vis)
 {
     const float *d_a = 0, *d_b = 0, *d_c = 0;
     XCORR_SELECT(false, float, float2)
@@ -210,7 +362,9 @@ void oskar_cross_correlate_scalar_point_omp_d(
         const double* d_station_w, const double* d_station_x,
         const double* d_station_y, double uv_min_lambda, double uv_max_lambda,
         double inv_wavelength, double frac_bandwidth, const double time_int_sec,
-        const double gha0_rad, const double dec0_rad, double2* d_vis)
+        const double gha0_rad, const double dec0_rad,
+        const double cull_tolerance_jy, const int* station_order,
+        double2* d_vis)
 {
     const double *d_a = 0, *d_b = 0, *d_c = 0;
     XCORR_SELECT(false, double, double2)
@@ -226,7 +380,8 @@ void oskar_cross_correlate_scalar_gaussian_omp_f(
         const float* d_station_x, const float* d_station_y,
         float uv_min_lambda, float uv_max_lambda, float inv_wavelength,
         float frac_bandwidth, float time_int_sec, float gha0_rad,
-        float dec0_rad, float2* d_vis)
+        float dec0_rad, float cull_tolerance_jy, const int* station_order,
+        float2* d_vis)
 {
     XCORR_SELECT(true, float, float2)
 }
@@ -241,7 +396,8 @@ void oskar_cross_correlate_scalar_gaussian_omp_d(
         const double* d_station_x, const double* d_station_y,
         double uv_min_lambda, double uv_max_lambda, double inv_wavelength,
         double frac_bandwidth, double time_int_sec, double gha0_rad,
-        double dec0_rad, double2* d_vis)
+        double dec0_rad, double cull_tolerance_jy, const int* station_order,
+        double2* d_vis)
 {
     XCORR_SELECT(true, double, double2)
 }
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2013-2015, The University of Oxford
+ * Copyright (c) 2013-2020, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -31,8 +31,10 @@
 #include "utility/oskar_timer.h"
 
 #include "correlate/oskar_cross_correlate.h"
+#include "utility/oskar_cpu_simd_level.h"
 #include "utility/oskar_get_error_string.h"
 #include "math/oskar_kahan_sum.h"
+#include <cmath>
 #include <cstdlib>
 
 // Comment out this line to disable benchmark timer printing.
@@ -136,7 +138,9 @@ protected:
     }
 
     void runTest(int prec1, int prec2, int loc1, int loc2, int matrix,
-            int extended, double time_average)
+            int extended, double time_average,
+            int max_simd1 = OSKAR_CPU_SIMD_AVX512,
+            int max_simd2 = OSKAR_CPU_SIMD_AVX512)
     {
         int num_baselines, status = 0, type;
         oskar_Mem *vis1, *vis2;
@@ -160,6 +164,7 @@ protected:
         oskar_sky_set_use_extended(sky, extended);
         oskar_telescope_set_channel_bandwidth(tel, bandwidth);
         oskar_telescope_set_time_average(tel, time_average);
+        oskar_cpu_simd_set_max_level(max_simd1);
         oskar_timer_start(timer1);
         oskar_cross_correlate(oskar_sky_num_sources(sky), jones, sky,
                 tel, u_, v_, w_, 1.0, frequency, 0, vis1, &status);
@@ -178,6 +183,7 @@ protected:
         oskar_sky_set_use_extended(sky, extended);
         oskar_telescope_set_channel_bandwidth(tel, bandwidth);
         oskar_telescope_set_time_average(tel, time_average);
+        oskar_cpu_simd_set_max_level(max_simd2);
         oskar_timer_start(timer2);
         oskar_cross_correlate(oskar_sky_num_sources(sky), jones, sky,
                 tel, u_, v_, w_, 1.0, frequency, 0, vis2, &status);
@@ -186,6 +192,7 @@ protected:
         ASSERT_EQ(0, status) << oskar_get_error_string(status);
 
         // Destroy the timers.
+        oskar_cpu_simd_set_max_level(OSKAR_CPU_SIMD_AVX512);
         oskar_timer_free(timer1);
         oskar_timer_free(timer2);
 
@@ -223,6 +230,73 @@ protected:
                 time2 * 1000.0);
 #endif
     }
+
+    void runCullTest(int precision, int matrix, int extended, int max_simd)
+    {
+        int status = 0;
+        const double frequency = 100e6, tolerance = 0.05;
+
+        // Use stations along a line, so that baselines between different
+        // station blocks are long and point in the same direction.
+        // Unit Jones matrices give visibilities bounded by the flux.
+        createTestData(precision, OSKAR_CPU, matrix);
+        for (int i = 0; i < num_stations; ++i)
+        {
+            oskar_mem_set_element_real(u_, i, 400.0 * i, &status);
+            oskar_mem_set_element_real(v_, i, 300.0 * i, &status);
+        }
+        oskar_mem_set_value_real(oskar_jones_mem(jones), 1.0, 0,
+                oskar_mem_length(oskar_jones_mem(jones)), &status);
+        oskar_sky_set_use_extended(sky, extended);
+        oskar_telescope_set_channel_bandwidth(tel, 1e6);
+        oskar_telescope_set_time_average(tel, 10.0);
+        oskar_cpu_simd_set_max_level(max_simd);
+        ASSERT_EQ(0, status) << oskar_get_error_string(status);
+
+        // Correlate with and without culling.
+        const int num_baselines = oskar_telescope_num_baselines(tel);
+        const int type = precision | OSKAR_COMPLEX |
+                (matrix ? OSKAR_MATRIX : 0);
+        oskar_Mem* vis[3];
+        const double tol[] = {0.0, tolerance, 1e9};
+        for (int t = 0; t < 3; ++t)
+        {
+            vis[t] = oskar_mem_create(type, OSKAR_CPU, num_baselines, &status);
+            oskar_mem_clear_contents(vis[t], &status);
+            oskar_telescope_set_smearing_cull_tolerance(tel, tol[t]);
+            oskar_cross_correlate(num_sources, jones, sky, tel,
+                    u_, v_, w_, 1.0, frequency, 0, vis[t], &status);
+        }
+        oskar_cpu_simd_set_max_level(OSKAR_CPU_SIMD_AVX512);
+        ASSERT_EQ(0, status) << oskar_get_error_string(status);
+
+        // The error from each skipped source must be below the tolerance.
+        // A very large tolerance must skip all sources on all baselines.
+        const int num_values = num_baselines * (matrix ? 8 : 2);
+        double max_diff = 0.0;
+        for (int i = 0; i < num_values; ++i)
+        {
+            double ref, cull, all;
+            if (precision == OSKAR_DOUBLE)
+            {
+                ref = oskar_mem_double(vis[0], &status)[i];
+                cull = oskar_mem_double(vis[1], &status)[i];
+                all = oskar_mem_double(vis[2], &status)[i];
+            }
+            else
+            {
+                ref = oskar_mem_float(vis[0], &status)[i];
+                cull = oskar_mem_float(vis[1], &status)[i];
+                all = oskar_mem_float(vis[2], &status)[i];
+            }
+            if (fabs(ref - cull) > max_diff) max_diff = fabs(ref - cull);
+            ASSERT_EQ(0.0, all);
+        }
+        EXPECT_LT(max_diff, num_sources * tolerance);
+        for (int t = 0; t < 3; ++t) oskar_mem_free(vis[t], &status);
+        destroyTestData();
+        ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    }
 };
 
 const double cross_correlate::bandwidth = 1e4;
@@ -305,6 +379,28 @@ TEST_F(cross_correlate, matrix_point_timeSmearing_singleCPU_doubleGPU)
 }
 #endif
 
+// CPU only, comparing scalar and SIMD code paths.
+TEST_F(cross_correlate, matrix_gaussian_timeSmearing_singleCPU_simd)
+{
+    runTest(OSKAR_SINGLE, OSKAR_SINGLE,
+            OSKAR_CPU, OSKAR_CPU, 1, 1, 10.0,
+            OSKAR_CPU_SIMD_NONE, OSKAR_CPU_SIMD_AVX512);
+}
+
+TEST_F(cross_correlate, matrix_gaussian_timeSmearing_doubleCPU_simd)
+{
+    runTest(OSKAR_DOUBLE, OSKAR_DOUBLE,
+            OSKAR_CPU, OSKAR_CPU, 1, 1, 10.0,
+            OSKAR_CPU_SIMD_NONE, OSKAR_CPU_SIMD_AVX512);
+}
+
+TEST_F(cross_correlate, matrix_point_doubleCPU_avx2_avx512)
+{
+    runTest(OSKAR_DOUBLE, OSKAR_DOUBLE,
+            OSKAR_CPU, OSKAR_CPU, 1, 0, 0.0,
+            OSKAR_CPU_SIMD_AVX2, OSKAR_CPU_SIMD_AVX512);
+}
+
 // CPU only.
 TEST_F(cross_correlate, matrix_gaussian_singleCPU_doubleCPU)
 {
@@ -542,6 +638,20 @@ TEST_F(cross_correlate, scalar_gaussian_timeSmearing_singleCPU_doubleGPU)
 }
 #endif
 
+// CPU only, checking sources are skipped correctly.
+TEST_F(cross_correlate, smearing_cull_tolerance)
+{
+    for (int matrix = 0; matrix <= 1; ++matrix)
+    {
+        for (int extended = 0; extended <= 1; ++extended)
+        {
+            runCullTest(OSKAR_DOUBLE, matrix, extended, OSKAR_CPU_SIMD_NONE);
+            runCullTest(OSKAR_DOUBLE, matrix, extended, OSKAR_CPU_SIMD_AVX512);
+            runCullTest(OSKAR_SINGLE, matrix, extended, OSKAR_CPU_SIMD_AVX512);
+        }
+    }
+}
+
 #if 0
 TEST(KahanSum, sum)
 {
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2016-2019, The University of Oxford
+ * Copyright (c) 2016-2020, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -35,6 +35,7 @@
 
 #include <oskar_global.h>
 #include <log/oskar_log.h>
+#include <mem/oskar_mem.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -88,6 +89,19 @@ int oskar_imager_channel_snapshots(const oskar_Imager* h);
 OSKAR_EXPORT
 int oskar_imager_coords_only(const oskar_Imager* h);
 
+/**
+ * @brief
+ * Returns the maximum memory used to cache coordinates between passes.
+ *
+ * @details
+ * Returns the maximum memory used to cache coordinates between passes,
+ * in megabytes.
+ *
+ * @param[in] h  Handle to imager.
+ */
+OSKAR_EXPORT
+int oskar_imager_coord_cache_mem_mb(const oskar_Imager* h);
+
 /**
  * @brief
  * Returns the flag specifying whether to use the GPU for FFTs.
@@ -268,6 +282,39 @@ int oskar_imager_num_w_planes(const oskar_Imager* h);
 OSKAR_EXPORT
 const char* oskar_imager_output_root(const oskar_Imager* h);
 
+/**
+ * @brief
+ * Returns a handle to an image or visibility plane held by the imager.
+ *
+ * @details
+ * Returns a handle to the host memory of the plane at \p index, or NULL
+ * if the planes have not been allocated, or if they are updated only in
+ * device memory (when gridding on a GPU).
+ *
+ * The memory remains owned by the imager, and it is released by
+ * oskar_imager_finalise() and oskar_imager_reset_cache().
+ * The plane is not normalised: see oskar_imager_plane_norm().
+ *
+ * @param[in] h      Handle to imager.
+ * @param[in] index  Zero-based plane index.
+ */
+OSKAR_EXPORT
+oskar_Mem* oskar_imager_plane(oskar_Imager* h, int index);
+
+/**
+ * @brief
+ * Returns the current normalisation factor of an image plane.
+ *
+ * @details
+ * Returns the current normalisation factor of the plane at \p index,
+ * or 0 if the planes have not been allocated.
+ *
+ * @param[in] h      Handle to imager.
+ * @param[in] index  Zero-based plane index.
+ */
+OSKAR_EXPORT
+double oskar_imager_plane_norm(const oskar_Imager* h, int index);
+
 /**
  * @brief
  * Returns the grid size required by the algorithm.
@@ -392,6 +439,28 @@ void oskar_imager_set_channel_snapshots(oskar_Imager* h, int value);
 OSKAR_EXPORT
 void oskar_imager_set_coords_only(oskar_Imager* h, int flag);
 
+/**
+ * @brief
+ * Sets the maximum memory used to cache coordinates between passes.
+ *
+ * @details
+ * If the input data must be read twice (for uniform weighting or
+ * W-projection), the baseline coordinates, weights and time centroids
+ * read in the first pass are cached, so that only the visibility
+ * amplitudes need to be read in the second pass.
+ *
+ * This sets the maximum amount of memory used to hold the cache, in
+ * megabytes. If the cache is larger than this, the remainder is written
+ * to a temporary file alongside the output images (if the output root
+ * path has been set), and removed when imaging is finished.
+ * Set this to zero to disable the cache.
+ *
+ * @param[in,out] h          Handle to imager.
+ * @param[in]     value      Maximum cache size in memory, in megabytes.
+ */
+OSKAR_EXPORT
+void oskar_imager_set_coord_cache_mem_mb(oskar_Imager* h, int value);
+
 /**
  * @brief
  * Clears any direction override.
@@ -790,6 +859,22 @@ void oskar_imager_set_vis_phase_centre(oskar_Imager* h,
 OSKAR_EXPORT
 void oskar_imager_set_num_w_planes(oskar_Imager* h, int value);
 
+/**
+ * @brief
+ * Sets the directory used to cache W-projection kernels.
+ *
+ * @details
+ * Sets the directory used to cache W-projection kernels between runs.
+ * Kernels generated with the same parameters are memory-mapped from a
+ * file in this directory rather than being generated again.
+ * Set to NULL or an empty string to disable the cache (the default).
+ *
+ * @param[in,out] h            Handle to imager.
+ * @param[in] dir              Path of the cache directory.
+ */
+OSKAR_EXPORT
+void oskar_imager_set_w_kernel_cache_dir(oskar_Imager* h, const char* dir);
+
 /**
  * @brief
  * Sets the visibility weighting scheme to use.
@@ -867,6 +952,19 @@ double oskar_imager_uv_filter_max(const oskar_Imager* h);
 OSKAR_EXPORT
 double oskar_imager_uv_filter_min(const oskar_Imager* h);
 
+/**
+ * @brief
+ * Returns the directory used to cache W-projection kernels.
+ *
+ * @details
+ * Returns the directory used to cache W-projection kernels,
+ * or NULL if the cache is disabled.
+ *
+ * @param[in] h  Handle to imager.
+ */
+OSKAR_EXPORT
+const char* oskar_imager_w_kernel_cache_dir(const oskar_Imager* h);
+
 /**
  * @brief
  * Returns the visibility weighting scheme.
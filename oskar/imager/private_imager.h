@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2016-2019, The University of Oxford
+ * Copyright (c) 2016-2020, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -27,6 +27,7 @@
  */
 
 #include <fitsio.h>
+#include <binary/oskar_binary.h>
 #include <log/oskar_log.h>
 #include <math/oskar_fft.h>
 #include <mem/oskar_mem.h>
@@ -56,6 +57,15 @@ struct DeviceData
 };
 typedef struct DeviceData DeviceData;
 
+/* Coordinates of one block of visibility data, cached between passes. */
+struct CoordCacheBlock
+{
+    size_t num_rows;
+    int spilled; /* Set if the data are held in the spill file. */
+    oskar_Mem *uu, *vv, *ww, *weight, *time_centroid;
+};
+typedef struct CoordCacheBlock CoordCacheBlock;
+
 struct oskar_Imager
 {
     char* output_name[4];
@@ -97,6 +107,10 @@ struct oskar_Imager
     double *plane_norm, delta_l, delta_m, delta_n, M[9];
     oskar_Mem **planes, **weights_grids;
 
+    /* CPU gridder scratch data. */
+    oskar_Mem *tile_index, *sorted_index; /* sorted_index holds size_t. */
+    oskar_Mem *sorted_uu, *sorted_vv, *sorted_ww, *sorted_wt, *sorted_vis;
+
     /* DFT imager data. */
     oskar_Mem *l, *m, *n;
 
@@ -105,11 +119,22 @@ struct oskar_Imager
     int grid_size;
     oskar_Mem *conv_func, *corr_func;
 
+    /* Coordinate cache. */
+    int coord_cache_mem_mb, coord_cache_num_blocks, coord_cache_next;
+    size_t coord_cache_bytes;
+    CoordCacheBlock* coord_cache;
+    oskar_Binary* coord_cache_file;
+    char* coord_cache_file_name;
+    int coord_cache_file_writing;
+
     /* W-projection imager data. */
     size_t ww_points;
     int num_w_planes;
     double w_scale, ww_min, ww_max, ww_rms;
     oskar_Mem *w_support, *w_kernels_compact, *w_kernel_start;
+    char* w_kernel_cache_dir;
+    void* w_kernel_cache_map;
+    size_t w_kernel_cache_map_size;
 
     /* Memory allocated per GPU (array of DeviceData structures). */
     DeviceData* d;
@@ -0,0 +1,68 @@
+/*
+ * Copyright (c) 2020, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef OSKAR_IMAGER_COORD_CACHE_H_
+#define OSKAR_IMAGER_COORD_CACHE_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * The coordinate cache holds the baseline coordinates, weights and time
+ * centroids read during the first pass over the input data (needed for
+ * uniform weighting or W-projection), so that the second pass only needs to
+ * read the visibility amplitudes.
+ *
+ * Blocks are cached in memory until the limit set using
+ * oskar_imager_set_coord_cache_mem_mb() is reached; after that, they are
+ * written to a spill file next to the output images, if an output root
+ * path has been set. Blocks that could not be cached are read again
+ * from the input data.
+ *
+ * Blocks must be retrieved in the same order in which they were added.
+ */
+
+void oskar_imager_coord_cache_add(oskar_Imager* h, size_t num_rows,
+        const oskar_Mem* uu, const oskar_Mem* vv, const oskar_Mem* ww,
+        const oskar_Mem* weight, const oskar_Mem* time_centroid,
+        int* status);
+
+/* Returns the number of rows in the block, or 0 if it was not cached. */
+size_t oskar_imager_coord_cache_next(oskar_Imager* h,
+        const oskar_Mem** uu, const oskar_Mem** vv, const oskar_Mem** ww,
+        const oskar_Mem** weight, const oskar_Mem** time_centroid,
+        int* status);
+
+void oskar_imager_coord_cache_clear(oskar_Imager* h, int* status);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OSKAR_IMAGER_COORD_CACHE_H_ */
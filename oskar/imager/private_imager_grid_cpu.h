@@ -0,0 +1,78 @@
+/*
+ * Copyright (c) 2020, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef OSKAR_IMAGER_GRID_CPU_H_
+#define OSKAR_IMAGER_GRID_CPU_H_
+
+#include <mem/oskar_mem.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief
+ * Grids visibilities onto a plane in CPU memory using all available threads.
+ *
+ * @details
+ * Visibilities are bucket-sorted into square tiles of the grid.
+ * The tiles are then processed concurrently in four passes, choosing tiles
+ * from alternate rows and columns in each pass, so that no two threads ever
+ * update the same grid cell. Each tile is gridded using the serial kernel
+ * selected by the imager algorithm (oskar_grid_simple() or
+ * oskar_grid_wproj2()), with the normalisation and skipped counts
+ * accumulated per tile and summed in a fixed order at the end.
+ *
+ * Visibilities keep their input order within each tile, so the result
+ * does not depend on the number of threads.
+ *
+ * If only one thread is available, the serial kernel is called directly.
+ *
+ * @param[in,out] h          Handle to imager.
+ * @param[in] num_vis        Number of visibilities.
+ * @param[in] uu             Baseline uu coordinates, in wavelengths.
+ * @param[in] vv             Baseline vv coordinates, in wavelengths.
+ * @param[in] ww             Baseline ww coordinates (W-projection only).
+ * @param[in] amps           Complex visibility amplitudes.
+ * @param[in] weight         Visibility weights.
+ * @param[in,out] plane      Complex visibility grid to update.
+ * @param[in,out] plane_norm Updated grid normalisation factor.
+ * @param[out] num_skipped   Number of visibilities that fell outside the grid.
+ * @param[in,out] status     Status return code.
+ */
+void oskar_imager_grid_cpu(oskar_Imager* h, size_t num_vis,
+        const oskar_Mem* uu, const oskar_Mem* vv, const oskar_Mem* ww,
+        const oskar_Mem* amps, const oskar_Mem* weight, oskar_Mem* plane,
+        double* plane_norm, size_t* num_skipped, int* status);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OSKAR_IMAGER_GRID_CPU_H_ */
@@ -29,6 +29,9 @@
 #ifndef OSKAR_IMAGER_READ_DATA_H_
 #define OSKAR_IMAGER_READ_DATA_H_
 
+#include <binary/oskar_binary.h>
+#include <vis/oskar_vis_header.h>
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -41,6 +44,14 @@ void oskar_imager_read_data_vis(oskar_Imager* h, const char* filename,
         int i_file, int num_files, int* percent_done, int* percent_next,
         int* status);
 
+/* Reads baseline-dependent averaged rows from an open OSKAR visibility file.
+ * Each row is weighted by the number of time samples it contains.
+ * If coords_only is set, only the coordinates are passed to the imager. */
+void oskar_imager_read_data_vis_bda(oskar_Imager* h,
+        const oskar_VisHeader* hdr, oskar_Binary* vis_file, int coords_only,
+        int i_file, int num_files, int* percent_done, int* percent_next,
+        int* status);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,68 @@
+/*
+ * Copyright (c) 2020, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef OSKAR_IMAGER_W_KERNEL_CACHE_H_
+#define OSKAR_IMAGER_W_KERNEL_CACHE_H_
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * The W-kernel cache stores the compacted W-projection kernels, their
+ * support sizes and start indices in a file in the directory set using
+ * oskar_imager_set_w_kernel_cache_dir(), so that later runs with the same
+ * kernel parameters can memory-map the kernels instead of generating them.
+ *
+ * The file name is derived from a checksum of the key, and the full key is
+ * stored in the file header and checked when the file is loaded.
+ */
+struct WKernelCacheKey
+{
+    double w_scale, sampling;
+    int precision, num_w_planes, conv_size, inner, oversample, version;
+};
+typedef struct WKernelCacheKey WKernelCacheKey;
+
+/* Returns 1 if the kernels were loaded from the cache, or 0 if not. */
+int oskar_imager_w_kernel_cache_load(oskar_Imager* h,
+        const WKernelCacheKey* key, int* status);
+
+/* Failure to write the cache is not an error. */
+void oskar_imager_w_kernel_cache_save(oskar_Imager* h,
+        const WKernelCacheKey* key);
+
+void oskar_imager_w_kernel_cache_release(oskar_Imager* h);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OSKAR_IMAGER_W_KERNEL_CACHE_H_ */
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2016-2019, The University of Oxford
+ * Copyright (c) 2016-2020, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -80,6 +80,12 @@ int oskar_imager_coords_only(const oskar_Imager* h)
 }
 
 
+int oskar_imager_coord_cache_mem_mb(const oskar_Imager* h)
+{
+    return h->coord_cache_mem_mb;
+}
+
+
 int oskar_imager_fft_on_gpu(const oskar_Imager* h)
 {
     return h->fft_on_gpu;
@@ -184,6 +190,24 @@ const char* oskar_imager_output_root(const oskar_Imager* h)
 }
 
 
+oskar_Mem* oskar_imager_plane(oskar_Imager* h, int index)
+{
+    if (!h->planes || index < 0 || index >= h->num_planes) return 0;
+    if (h->grid_on_gpu && !(
+            h->algorithm == OSKAR_ALGORITHM_DFT_2D ||
+            h->algorithm == OSKAR_ALGORITHM_DFT_3D))
+        return 0;
+    return h->planes[index];
+}
+
+
+double oskar_imager_plane_norm(const oskar_Imager* h, int index)
+{
+    if (!h->plane_norm || index < 0 || index >= h->num_planes) return 0.0;
+    return h->plane_norm[index];
+}
+
+
 int oskar_imager_plane_size(oskar_Imager* h)
 {
     if (h->grid_size == 0)
@@ -308,6 +332,12 @@ void oskar_imager_set_coords_only(oskar_Imager* h, int flag)
 }
 
 
+void oskar_imager_set_coord_cache_mem_mb(oskar_Imager* h, int value)
+{
+    h->coord_cache_mem_mb = value;
+}
+
+
 void oskar_imager_set_default_direction(oskar_Imager* h)
 {
     h->direction_type = 'O';
@@ -710,6 +740,20 @@ void oskar_imager_set_num_w_planes(oskar_Imager* h, int value)
 }
 
 
+void oskar_imager_set_w_kernel_cache_dir(oskar_Imager* h, const char* dir)
+{
+    int len = 0;
+    free(h->w_kernel_cache_dir);
+    h->w_kernel_cache_dir = 0;
+    if (dir) len = (int) strlen(dir);
+    if (len > 0)
+    {
+        h->w_kernel_cache_dir = (char*) calloc(1 + len, 1);
+        strcpy(h->w_kernel_cache_dir, dir);
+    }
+}
+
+
 void oskar_imager_set_weighting(oskar_Imager* h, const char* type, int* status)
 {
     if (!strncmp(type, "N", 1) || !strncmp(type, "n", 1))
@@ -754,6 +798,12 @@ double oskar_imager_uv_filter_min(const oskar_Imager* h)
 }
 
 
+const char* oskar_imager_w_kernel_cache_dir(const oskar_Imager* h)
+{
+    return h->w_kernel_cache_dir;
+}
+
+
 const char* oskar_imager_weighting(const oskar_Imager* h)
 {
     switch (h->weighting)
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2016-2019, The University of Oxford
+ * Copyright (c) 2016-2020, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -75,6 +75,14 @@ oskar_Imager* oskar_imager_create(int imager_precision, int* status)
     h->weight_im   = oskar_mem_create(imager_precision, OSKAR_CPU, 0, status);
     h->weight_tmp  = oskar_mem_create(imager_precision, OSKAR_CPU, 0, status);
     h->time_im     = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, 0, status);
+    h->tile_index  = oskar_mem_create(OSKAR_INT, OSKAR_CPU, 0, status);
+    h->sorted_index = oskar_mem_create(OSKAR_CHAR, OSKAR_CPU, 0, status);
+    h->sorted_uu   = oskar_mem_create(imager_precision, OSKAR_CPU, 0, status);
+    h->sorted_vv   = oskar_mem_create(imager_precision, OSKAR_CPU, 0, status);
+    h->sorted_ww   = oskar_mem_create(imager_precision, OSKAR_CPU, 0, status);
+    h->sorted_wt   = oskar_mem_create(imager_precision, OSKAR_CPU, 0, status);
+    h->sorted_vis  = oskar_mem_create(imager_precision | OSKAR_COMPLEX,
+            OSKAR_CPU, 0, status);
 
     /* Check data type. */
     if (imager_precision != OSKAR_SINGLE && imager_precision != OSKAR_DOUBLE)
@@ -99,6 +107,7 @@ oskar_Imager* oskar_imager_create(int imager_precision, int* status)
     oskar_imager_set_fov(h, 1.0);
     oskar_imager_set_size(h, 256, status);
     oskar_imager_set_uv_filter_max(h, DBL_MAX);
+    oskar_imager_set_coord_cache_mem_mb(h, 1024);
     return h;
 }
 
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2016-2019, The University of Oxford
+ * Copyright (c) 2016-2020, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -54,6 +54,13 @@ void oskar_imager_free(oskar_Imager* h, int* status)
     oskar_mem_free(h->weight_im, status);
     oskar_mem_free(h->weight_tmp, status);
     oskar_mem_free(h->time_im, status);
+    oskar_mem_free(h->tile_index, status);
+    oskar_mem_free(h->sorted_index, status);
+    oskar_mem_free(h->sorted_uu, status);
+    oskar_mem_free(h->sorted_vv, status);
+    oskar_mem_free(h->sorted_ww, status);
+    oskar_mem_free(h->sorted_wt, status);
+    oskar_mem_free(h->sorted_vis, status);
     oskar_timer_free(h->tmr_grid_finalise);
     oskar_timer_free(h->tmr_grid_update);
     oskar_timer_free(h->tmr_init);
@@ -76,6 +83,7 @@ void oskar_imager_free(oskar_Imager* h, int* status)
     free(h->input_root);
     free(h->output_root);
     free(h->ms_column);
+    free(h->w_kernel_cache_dir);
     free(h->gpu_ids);
     free(h->d);
     free(h);
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2016-2019, The University of Oxford
+ * Copyright (c) 2016-2020, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -28,7 +28,9 @@
 
 #include "imager/private_imager.h"
 #include "imager/oskar_imager_reset_cache.h"
+#include "imager/private_imager_coord_cache.h"
 #include "imager/private_imager_free_device_data.h"
+#include "imager/private_imager_w_kernel_cache.h"
 #include "log/oskar_log.h"
 #include "math/oskar_fft.h"
 #include <fitsio.h>
@@ -64,6 +66,10 @@ void oskar_imager_reset_cache(oskar_Imager* h, int* status)
     oskar_mem_free(h->w_support, status); h->w_support = 0;
     oskar_mem_free(h->w_kernels_compact, status); h->w_kernels_compact = 0;
     oskar_mem_free(h->w_kernel_start, status); h->w_kernel_start = 0;
+    oskar_imager_w_kernel_cache_release(h);
+
+    /* Clear the coordinate cache. */
+    oskar_imager_coord_cache_clear(h, status);
 
     /* Free the image planes. */
     if (h->planes)
@@ -89,6 +95,13 @@ void oskar_imager_reset_cache(oskar_Imager* h, int* status)
     oskar_mem_realloc(h->weight_im, 0, status);
     oskar_mem_realloc(h->weight_tmp, 0, status);
     oskar_mem_realloc(h->time_im, 0, status);
+    oskar_mem_realloc(h->tile_index, 0, status);
+    oskar_mem_realloc(h->sorted_index, 0, status);
+    oskar_mem_realloc(h->sorted_uu, 0, status);
+    oskar_mem_realloc(h->sorted_vv, 0, status);
+    oskar_mem_realloc(h->sorted_ww, 0, status);
+    oskar_mem_realloc(h->sorted_wt, 0, status);
+    oskar_mem_realloc(h->sorted_vis, 0, status);
     oskar_mem_free(h->stokes, status); h->stokes = 0;
 
     /* Close any open FITS files. */
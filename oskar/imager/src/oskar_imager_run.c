@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2016-2019, The University of Oxford
+ * Copyright (c) 2016-2020, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -27,6 +27,7 @@
  */
 
 #include "imager/private_imager.h"
+#include "imager/private_imager_coord_cache.h"
 #include "imager/private_imager_read_coords.h"
 #include "imager/private_imager_read_data.h"
 #include "imager/private_imager_read_dims.h"
@@ -141,6 +142,9 @@ void oskar_imager_run(oskar_Imager* h,
                     &percent_done, &percent_next, status);
     }
 
+    /* Release the coordinate cache. */
+    oskar_imager_coord_cache_clear(h, status);
+
     /* Check for errors. */
     if (*status)
     {
@@ -0,0 +1,228 @@
+/*
+ * Copyright (c) 2020, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "imager/private_imager.h"
+#include "imager/private_imager_coord_cache.h"
+#include "mem/oskar_binary_read_mem.h"
+#include "mem/oskar_binary_write_mem.h"
+#include "utility/oskar_thread.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef OSKAR_OS_WIN
+#include <process.h>
+#define getpid _getpid
+#else
+#include <unistd.h>
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+static const char* group_name = "IMAGER_COORD_CACHE";
+
+static size_t mem_bytes(const oskar_Mem* mem)
+{
+    return !mem ? 0 :
+            oskar_mem_length(mem) * oskar_mem_element_size(oskar_mem_type(mem));
+}
+
+static oskar_Mem* spill(oskar_Binary* file, const oskar_Mem* mem,
+        const char* name, int index, int* status)
+{
+    if (!mem) return 0;
+    oskar_binary_write_mem_ext(file, mem, group_name, name, index, 0, status);
+    return oskar_mem_create(oskar_mem_type(mem), OSKAR_CPU, 0, status);
+}
+
+static void unspill(oskar_Binary* file, oskar_Mem* mem,
+        const char* name, int index, int* status)
+{
+    if (!mem) return;
+    oskar_binary_read_mem_ext(file, mem, group_name, name, index, status);
+}
+
+void oskar_imager_coord_cache_add(oskar_Imager* h, size_t num_rows,
+        const oskar_Mem* uu, const oskar_Mem* vv, const oskar_Mem* ww,
+        const oskar_Mem* weight, const oskar_Mem* time_centroid,
+        int* status)
+{
+    CoordCacheBlock *b, *blocks;
+    size_t bytes;
+    const int i = h->coord_cache_num_blocks;
+    if (*status || h->coord_cache_mem_mb <= 0) return;
+
+    /* Add a new block record, even if the block can't be cached. */
+    blocks = (CoordCacheBlock*) realloc(h->coord_cache,
+            (i + 1) * sizeof(CoordCacheBlock));
+    if (!blocks)
+    {
+        *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+        return;
+    }
+    h->coord_cache = blocks;
+    b = &h->coord_cache[i];
+    memset(b, 0, sizeof(CoordCacheBlock));
+    h->coord_cache_num_blocks++;
+    bytes = mem_bytes(uu) + mem_bytes(vv) + mem_bytes(ww) +
+            mem_bytes(weight) + mem_bytes(time_centroid);
+    if (h->coord_cache_bytes + bytes <=
+            (size_t) h->coord_cache_mem_mb * 1024 * 1024)
+    {
+        /* Keep the block in memory. */
+        h->coord_cache_bytes += bytes;
+        b->uu = oskar_mem_create_copy(uu, OSKAR_CPU, status);
+        b->vv = oskar_mem_create_copy(vv, OSKAR_CPU, status);
+        b->ww = oskar_mem_create_copy(ww, OSKAR_CPU, status);
+        if (weight)
+            b->weight = oskar_mem_create_copy(weight, OSKAR_CPU, status);
+        if (time_centroid)
+            b->time_centroid = oskar_mem_create_copy(time_centroid,
+                    OSKAR_CPU, status);
+    }
+    else if (h->output_root && strlen(h->output_root) > 0)
+    {
+        /* Write the block to the spill file, opening it if necessary.
+         * The name is unique to this process and imager, so that imagers
+         * with the same output root do not write to the same file. */
+        if (!h->coord_cache_file)
+        {
+            static volatile int file_counter = 0;
+            const size_t len = strlen(h->output_root) + 60;
+            free(h->coord_cache_file_name);
+            h->coord_cache_file_name = (char*) calloc(len, 1);
+            if (!h->coord_cache_file_name)
+            {
+                *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+                return;
+            }
+            sprintf(h->coord_cache_file_name, "%s_coords.%d.%d.tmp",
+                    h->output_root, (int) getpid(),
+                    oskar_atomic_fetch_add(&file_counter, 1));
+            h->coord_cache_file = oskar_binary_create(
+                    h->coord_cache_file_name, 'w', status);
+            h->coord_cache_file_writing = 1;
+            if (*status)
+            {
+                oskar_log_error(h->log, "Unable to create coordinate cache "
+                        "file '%s'", h->coord_cache_file_name);
+                return;
+            }
+        }
+        b->spilled = 1;
+        b->uu = spill(h->coord_cache_file, uu, "UU", i, status);
+        b->vv = spill(h->coord_cache_file, vv, "VV", i, status);
+        b->ww = spill(h->coord_cache_file, ww, "WW", i, status);
+        b->weight = spill(h->coord_cache_file, weight, "WEIGHT", i, status);
+        b->time_centroid = spill(h->coord_cache_file, time_centroid,
+                "TIME_CENTROID", i, status);
+    }
+    else return;
+    b->num_rows = num_rows;
+}
+
+size_t oskar_imager_coord_cache_next(oskar_Imager* h,
+        const oskar_Mem** uu, const oskar_Mem** vv, const oskar_Mem** ww,
+        const oskar_Mem** weight, const oskar_Mem** time_centroid,
+        int* status)
+{
+    CoordCacheBlock* b;
+    const int i = h->coord_cache_next;
+    if (*status || i >= h->coord_cache_num_blocks) return 0;
+    h->coord_cache_next++;
+
+    /* Release the data for the previous block if it was read from file. */
+    if (i > 0 && h->coord_cache[i - 1].spilled)
+    {
+        b = &h->coord_cache[i - 1];
+        oskar_mem_realloc(b->uu, 0, status);
+        oskar_mem_realloc(b->vv, 0, status);
+        oskar_mem_realloc(b->ww, 0, status);
+        if (b->weight) oskar_mem_realloc(b->weight, 0, status);
+        if (b->time_centroid) oskar_mem_realloc(b->time_centroid, 0, status);
+    }
+    b = &h->coord_cache[i];
+    if (b->num_rows == 0) return 0;
+    if (b->spilled)
+    {
+        /* Re-open the spill file for reading, if necessary. */
+        if (h->coord_cache_file_writing)
+        {
+            oskar_binary_free(h->coord_cache_file);
+            h->coord_cache_file = oskar_binary_create(
+                    h->coord_cache_file_name, 'r', status);
+            h->coord_cache_file_writing = 0;
+            if (*status) return 0;
+        }
+        unspill(h->coord_cache_file, b->uu, "UU", i, status);
+        unspill(h->coord_cache_file, b->vv, "VV", i, status);
+        unspill(h->coord_cache_file, b->ww, "WW", i, status);
+        unspill(h->coord_cache_file, b->weight, "WEIGHT", i, status);
+        unspill(h->coord_cache_file, b->time_centroid,
+                "TIME_CENTROID", i, status);
+        if (*status) return 0;
+    }
+    *uu = b->uu;
+    *vv = b->vv;
+    *ww = b->ww;
+    if (weight) *weight = b->weight;
+    if (time_centroid) *time_centroid = b->time_centroid;
+    return b->num_rows;
+}
+
+void oskar_imager_coord_cache_clear(oskar_Imager* h, int* status)
+{
+    int i;
+    for (i = 0; i < h->coord_cache_num_blocks; ++i)
+    {
+        CoordCacheBlock* b = &h->coord_cache[i];
+        oskar_mem_free(b->uu, status);
+        oskar_mem_free(b->vv, status);
+        oskar_mem_free(b->ww, status);
+        oskar_mem_free(b->weight, status);
+        oskar_mem_free(b->time_centroid, status);
+    }
+    free(h->coord_cache);
+    h->coord_cache = 0;
+    h->coord_cache_num_blocks = 0;
+    h->coord_cache_next = 0;
+    h->coord_cache_bytes = 0;
+    oskar_binary_free(h->coord_cache_file);
+    h->coord_cache_file = 0;
+    if (h->coord_cache_file_name) remove(h->coord_cache_file_name);
+    free(h->coord_cache_file_name);
+    h->coord_cache_file_name = 0;
+    h->coord_cache_file_writing = 0;
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,330 @@
+/*
+ * Copyright (c) 2020, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "imager/private_imager.h"
+#include "imager/oskar_imager.h"
+
+#include "imager/private_imager_grid_cpu.h"
+#include "imager/oskar_grid_simple.h"
+#include "imager/oskar_grid_wproj2.h"
+
+#include <math.h>
+#include <stdlib.h>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define MIN_TILE_SIZE 32
+
+static void grid_range(const oskar_Imager* h, int grid_size, size_t start,
+        size_t num, const oskar_Mem* uu, const oskar_Mem* vv,
+        const oskar_Mem* ww, const oskar_Mem* amps, const oskar_Mem* weight,
+        oskar_Mem* plane, size_t* num_skipped, double* norm);
+static void gather(int num_threads, size_t num,
+        const size_t* RESTRICT idx, const oskar_Mem* src, oskar_Mem* dst,
+        int* status);
+
+void oskar_imager_grid_cpu(oskar_Imager* h, size_t num_vis,
+        const oskar_Mem* uu, const oskar_Mem* vv, const oskar_Mem* ww,
+        const oskar_Mem* amps, const oskar_Mem* weight, oskar_Mem* plane,
+        double* plane_norm, size_t* num_skipped, int* status)
+{
+    int i, c, t, max_support, num_threads = 1;
+    size_t *counts, *sorted_index, *tile_skipped;
+    double *tile_norm;
+    if (*status) return;
+    const int is_wproj = (h->algorithm == OSKAR_ALGORITHM_WPROJ);
+    const int grid_size = oskar_imager_plane_size(h);
+    const int grid_centre = grid_size / 2;
+    const double grid_scale = grid_size * h->cellsize_rad;
+#ifdef _OPENMP
+    num_threads = omp_get_max_threads();
+#endif
+
+    /* Use the serial gridder directly if there is nothing to share. */
+    if (num_threads < 2 || num_vis < (size_t) num_threads)
+    {
+        grid_range(h, grid_size, 0, num_vis, uu, vv, ww, amps, weight,
+                plane, num_skipped, plane_norm);
+        return;
+    }
+
+    /* Tiles must be at least twice the largest kernel support
+     * (plus a cell for rounding differences), so that the kernel footprints
+     * of tiles in alternate rows and columns never overlap. */
+    max_support = h->support;
+    if (is_wproj)
+    {
+        const int* support = oskar_mem_int_const(h->w_support, status);
+        max_support = 0;
+        for (i = 0; i < h->num_w_planes; ++i)
+            if (support[i] > max_support) max_support = support[i];
+    }
+    int tile_size = 2 * (max_support + 1);
+    if (tile_size < MIN_TILE_SIZE) tile_size = MIN_TILE_SIZE;
+    const int num_tiles_u = (grid_size + tile_size - 1) / tile_size;
+    const int num_tiles_v = num_tiles_u;
+    const int num_tiles = num_tiles_u * num_tiles_v;
+
+    /* Allocate scratch memory. */
+    const size_t chunk_size = (num_vis + num_threads - 1) / num_threads;
+    counts = (size_t*) calloc((size_t) num_tiles * num_threads + 1,
+            sizeof(size_t));
+    tile_norm = (double*) calloc(num_tiles, sizeof(double));
+    tile_skipped = (size_t*) calloc(num_tiles, sizeof(size_t));
+    if (!counts || !tile_norm || !tile_skipped)
+        *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+    oskar_mem_ensure(h->tile_index, num_vis, status);
+    oskar_mem_ensure(h->sorted_index, num_vis * sizeof(size_t), status);
+    oskar_mem_ensure(h->sorted_uu, num_vis, status);
+    oskar_mem_ensure(h->sorted_vv, num_vis, status);
+    oskar_mem_ensure(h->sorted_vis, num_vis, status);
+    oskar_mem_ensure(h->sorted_wt, num_vis, status);
+    if (is_wproj) oskar_mem_ensure(h->sorted_ww, num_vis, status);
+    if (*status)
+    {
+        free(counts);
+        free(tile_norm);
+        free(tile_skipped);
+        return;
+    }
+    int* tile_index = oskar_mem_int(h->tile_index, status);
+    sorted_index = (size_t*) oskar_mem_void(h->sorted_index);
+
+    /* Find the tile containing each visibility, and count the number of
+     * visibilities from each thread's range of the input in each tile. */
+    const int is_dbl = (oskar_mem_precision(uu) == OSKAR_DOUBLE);
+    const void* uu_ = oskar_mem_void_const(uu);
+    const void* vv_ = oskar_mem_void_const(vv);
+#pragma omp parallel for private(t)
+    for (t = 0; t < num_threads; ++t)
+    {
+        size_t j;
+        size_t* thread_counts = counts + t;
+        const size_t end = (t + 1) * chunk_size < num_vis ?
+                (t + 1) * chunk_size : num_vis;
+        for (j = t * chunk_size; j < end; ++j)
+        {
+            double pos_u, pos_v;
+            int tile_u, tile_v;
+            if (is_dbl)
+            {
+                pos_u = -((const double*)uu_)[j] * grid_scale;
+                pos_v = ((const double*)vv_)[j] * grid_scale;
+            }
+            else
+            {
+                pos_u = -((const float*)uu_)[j] * grid_scale;
+                pos_v = ((const float*)vv_)[j] * grid_scale;
+            }
+            pos_u = round(pos_u) + grid_centre;
+            pos_v = round(pos_v) + grid_centre;
+
+            /* Points outside the grid go in an edge tile,
+             * where the kernel will skip them. */
+            tile_u = pos_u < 0.0 ? 0 : (pos_u >= grid_size ?
+                    num_tiles_u - 1 : (int)pos_u / tile_size);
+            tile_v = pos_v < 0.0 ? 0 : (pos_v >= grid_size ?
+                    num_tiles_v - 1 : (int)pos_v / tile_size);
+            tile_index[j] = tile_u + tile_v * num_tiles_u;
+            thread_counts[tile_index[j] * num_threads]++;
+        }
+    }
+
+    /* Exclusive prefix sum over (tile, thread) gives a stable sort order. */
+    {
+        size_t sum = 0;
+        const int num_counts = num_tiles * num_threads;
+        for (i = 0; i < num_counts; ++i)
+        {
+            const size_t x = counts[i];
+            counts[i] = sum;
+            sum += x;
+        }
+        counts[num_counts] = sum;
+    }
+
+    /* Bucket sort the visibility indices into tiles. */
+#pragma omp parallel for private(t)
+    for (t = 0; t < num_threads; ++t)
+    {
+        size_t j;
+        size_t* thread_offsets = counts + t;
+        const size_t end = (t + 1) * chunk_size < num_vis ?
+                (t + 1) * chunk_size : num_vis;
+        for (j = t * chunk_size; j < end; ++j)
+            sorted_index[thread_offsets[tile_index[j] * num_threads]++] = j;
+    }
+
+    /* Gather the visibility data in tile order. */
+    gather(num_threads, num_vis, sorted_index, uu, h->sorted_uu, status);
+    gather(num_threads, num_vis, sorted_index, vv, h->sorted_vv, status);
+    gather(num_threads, num_vis, sorted_index, amps, h->sorted_vis, status);
+    gather(num_threads, num_vis, sorted_index, weight, h->sorted_wt, status);
+    if (is_wproj)
+        gather(num_threads, num_vis, sorted_index, ww, h->sorted_ww, status);
+
+    /* Grid each set of non-adjacent tiles in turn.
+     * The sort has moved each offset on to the start of the next one. */
+    for (c = 0; c < 4 && !*status; ++c)
+    {
+#pragma omp parallel for private(i) schedule(dynamic, 1)
+        for (i = 0; i < num_tiles; ++i)
+        {
+            const int tile_u = i % num_tiles_u, tile_v = i / num_tiles_u;
+            if (((tile_v & 1) << 1 | (tile_u & 1)) != c) continue;
+            const size_t start = (i == 0) ? 0 : counts[i * num_threads - 1];
+            const size_t end = counts[(i + 1) * num_threads - 1];
+            if (end == start) continue;
+            grid_range(h, grid_size, start, end - start,
+                    h->sorted_uu, h->sorted_vv, h->sorted_ww, h->sorted_vis,
+                    h->sorted_wt, plane, &tile_skipped[i], &tile_norm[i]);
+        }
+    }
+
+    /* Sum the per-tile results in a fixed order. */
+    *num_skipped = 0;
+    for (i = 0; i < num_tiles; ++i)
+    {
+        *num_skipped += tile_skipped[i];
+        *plane_norm += tile_norm[i];
+    }
+    free(counts);
+    free(tile_norm);
+    free(tile_skipped);
+}
+
+static void grid_range(const oskar_Imager* h, int grid_size, size_t start,
+        size_t num, const oskar_Mem* uu, const oskar_Mem* vv,
+        const oskar_Mem* ww, const oskar_Mem* amps, const oskar_Mem* weight,
+        oskar_Mem* plane, size_t* num_skipped, double* norm)
+{
+    if (oskar_mem_precision(plane) == OSKAR_DOUBLE)
+    {
+        const double* uu_ = (const double*) oskar_mem_void_const(uu) + start;
+        const double* vv_ = (const double*) oskar_mem_void_const(vv) + start;
+        const double* vis_ = (const double*) oskar_mem_void_const(amps) +
+                2 * start;
+        const double* wt_ = (const double*) oskar_mem_void_const(weight) +
+                start;
+        double* grid_ = (double*) oskar_mem_void(plane);
+        if (h->algorithm == OSKAR_ALGORITHM_WPROJ)
+            oskar_grid_wproj2_d(h->num_w_planes,
+                    (const int*) oskar_mem_void_const(h->w_support),
+                    h->oversample,
+                    (const int*) oskar_mem_void_const(h->w_kernel_start),
+                    (const double*) oskar_mem_void_const(h->w_kernels_compact),
+                    num, uu_, vv_,
+                    (const double*) oskar_mem_void_const(ww) + start,
+                    vis_, wt_, h->cellsize_rad, h->w_scale,
+                    grid_size, num_skipped, norm, grid_);
+        else
+            oskar_grid_simple_d(h->support, h->oversample,
+                    (const double*) oskar_mem_void_const(h->conv_func),
+                    num, uu_, vv_, vis_, wt_, h->cellsize_rad,
+                    grid_size, num_skipped, norm, grid_);
+    }
+    else
+    {
+        const float* uu_ = (const float*) oskar_mem_void_const(uu) + start;
+        const float* vv_ = (const float*) oskar_mem_void_const(vv) + start;
+        const float* vis_ = (const float*) oskar_mem_void_const(amps) +
+                2 * start;
+        const float* wt_ = (const float*) oskar_mem_void_const(weight) +
+                start;
+        float* grid_ = (float*) oskar_mem_void(plane);
+        if (h->algorithm == OSKAR_ALGORITHM_WPROJ)
+            oskar_grid_wproj2_f(h->num_w_planes,
+                    (const int*) oskar_mem_void_const(h->w_support),
+                    h->oversample,
+                    (const int*) oskar_mem_void_const(h->w_kernel_start),
+                    (const float*) oskar_mem_void_const(h->w_kernels_compact),
+                    num, uu_, vv_,
+                    (const float*) oskar_mem_void_const(ww) + start,
+                    vis_, wt_, (float) (h->cellsize_rad), (float) (h->w_scale),
+                    grid_size, num_skipped, norm, grid_);
+        else
+            oskar_grid_simple_f(h->support, h->oversample,
+                    (const float*) oskar_mem_void_const(h->conv_func),
+                    num, uu_, vv_, vis_, wt_, (float) (h->cellsize_rad),
+                    grid_size, num_skipped, norm, grid_);
+    }
+}
+
+static void gather(int num_threads, size_t num,
+        const size_t* RESTRICT idx, const oskar_Mem* src, oskar_Mem* dst,
+        int* status)
+{
+    int t;
+    if (*status) return;
+    const int type = oskar_mem_type(src);
+    if (type != OSKAR_DOUBLE && type != OSKAR_SINGLE &&
+            type != OSKAR_DOUBLE_COMPLEX && type != OSKAR_SINGLE_COMPLEX)
+    {
+        *status = OSKAR_ERR_BAD_DATA_TYPE;
+        return;
+    }
+    const void* in = oskar_mem_void_const(src);
+    void* out = oskar_mem_void(dst);
+    const size_t chunk_size = (num + num_threads - 1) / num_threads;
+#pragma omp parallel for private(t)
+    for (t = 0; t < num_threads; ++t)
+    {
+        size_t j;
+        const size_t end = (t + 1) * chunk_size < num ?
+                (t + 1) * chunk_size : num;
+        switch (type)
+        {
+        case OSKAR_DOUBLE:
+            for (j = t * chunk_size; j < end; ++j)
+                ((double*)out)[j] = ((const double*)in)[idx[j]];
+            break;
+        case OSKAR_SINGLE:
+            for (j = t * chunk_size; j < end; ++j)
+                ((float*)out)[j] = ((const float*)in)[idx[j]];
+            break;
+        case OSKAR_DOUBLE_COMPLEX:
+            for (j = t * chunk_size; j < end; ++j)
+                ((double2*)out)[j] = ((const double2*)in)[idx[j]];
+            break;
+        default:
+            for (j = t * chunk_size; j < end; ++j)
+                ((float2*)out)[j] = ((const float2*)in)[idx[j]];
+            break;
+        }
+    }
+}
+
+#ifdef __cplusplus
+}
+#endif
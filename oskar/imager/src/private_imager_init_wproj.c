@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2016-2019, The University of Oxford
+ * Copyright (c) 2016-2020, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -32,6 +32,7 @@
 #include "imager/private_imager_composite_nearest_even.h"
 #include "imager/private_imager_generate_w_phase_screen.h"
 #include "imager/private_imager_init_wproj.h"
+#include "imager/private_imager_w_kernel_cache.h"
 #include "imager/oskar_grid_functions_spheroidal.h"
 #include "math/oskar_cmath.h"
 #include "math/oskar_fft.h"
@@ -42,6 +43,10 @@
 #include <string.h>
 #include <stdio.h>
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -49,14 +54,28 @@ extern "C" {
 #define MIN(a,b) ((a) < (b) ? (a) : (b))
 #define MAX(a,b) ((a) > (b) ? (a) : (b))
 
+/* Increment this if the kernel generation changes. */
+#define W_KERNEL_CACHE_VERSION 1
+
 #include <fitsio.h>
 
 static void oskar_imager_evaluate_w_kernel_params(const oskar_Imager* h,
         int* num_w_planes, double* w_scale);
 
+static void oskar_imager_generate_w_kernels(oskar_Imager* h,
+        int conv_size, int inner, double sampling, int* status);
+
+static void oskar_imager_evaluate_w_kernel_size(oskar_Imager* h,
+        int num_w_planes, int* conv_size, int* inner, double* sampling);
+
+static void oskar_imager_evaluate_w_kernel_plane(int i, int conv_size,
+        int inner, double sampling, double w_scale, const oskar_Mem* taper,
+        oskar_Mem* screen, oskar_Mem* screen_gpu, oskar_FFT* fft,
+        oskar_Mem* kernel_cube, double* max, int* status);
+
 static oskar_Mem* oskar_imager_evaluate_w_kernel_cube(oskar_Imager* h,
-        int num_w_planes, double w_scale,
-        size_t* conv_size_half, double* norm_factor, int* status);
+        int num_w_planes, double w_scale, int conv_size, int inner,
+        double sampling, double* norm_factor, int* status);
 
 static oskar_Mem* oskar_imager_evaluate_w_kernel_support_sizes(
         int num_w_planes, int oversample, size_t conv_size_half,
@@ -81,55 +100,39 @@ static void oskar_imager_rearrange_kernels(int num_w_planes,
  */
 void oskar_imager_init_wproj(oskar_Imager* h, int* status)
 {
-    size_t conv_size_half = 0;
-    double norm_factor = 1.;
-    oskar_Mem *kernel_cube = 0;
-    const int save_kernels = 0;
+    int conv_size = 0, inner = 0;
+    double sampling = 0.0;
+    WKernelCacheKey key;
     if (*status) return;
 
-    /* Evaluate number of w-projection planes, and w-scale. */
-    oskar_imager_evaluate_w_kernel_params(h, &h->num_w_planes, &h->w_scale);
-
-    /* Evaluate unnormalised kernels. */
-    kernel_cube = oskar_imager_evaluate_w_kernel_cube(h, h->num_w_planes,
-            h->w_scale, &conv_size_half, &norm_factor, status);
-
-    /* Evaluate the support size of each kernel. */
+    /* Release any existing kernels. */
     oskar_mem_free(h->w_support, status);
-    h->w_support = oskar_imager_evaluate_w_kernel_support_sizes(
-            h->num_w_planes, h->oversample, conv_size_half,
-            kernel_cube, norm_factor, status);
+    oskar_mem_free(h->w_kernels_compact, status);
+    oskar_mem_free(h->w_kernel_start, status);
+    h->w_support = h->w_kernels_compact = h->w_kernel_start = 0;
+    oskar_imager_w_kernel_cache_release(h);
 
-#if 0
-    /* Print kernel support sizes. */
+    /* Evaluate number of w-projection planes, w-scale and kernel size. */
+    oskar_imager_evaluate_w_kernel_params(h, &h->num_w_planes, &h->w_scale);
+    oskar_imager_evaluate_w_kernel_size(h, h->num_w_planes,
+            &conv_size, &inner, &sampling);
+
+    /* Load the kernels from the cache if possible, or generate them. */
+    memset(&key, 0, sizeof(key));
+    key.w_scale = h->w_scale;
+    key.sampling = sampling;
+    key.precision = h->imager_prec;
+    key.num_w_planes = h->num_w_planes;
+    key.conv_size = conv_size;
+    key.inner = inner;
+    key.oversample = h->oversample;
+    key.version = W_KERNEL_CACHE_VERSION;
+    if (!oskar_imager_w_kernel_cache_load(h, &key, status))
     {
-        int i;
-        for (i = 0; i < h->num_w_planes; ++i)
-        {
-            const int* supp = oskar_mem_int_const(h->w_support, status);
-            printf("Plane %d, support: %d\n", i, supp[i]);
-        }
+        oskar_imager_generate_w_kernels(h, conv_size, inner, sampling, status);
+        if (!*status) oskar_imager_w_kernel_cache_save(h, &key);
     }
-#endif
-
-    /* Normalise the kernel cube. */
-    oskar_imager_normalise_kernel_cube(h->w_support, h->oversample,
-            conv_size_half, kernel_cube, status);
-    if (save_kernels)
-        oskar_imager_trim_and_save_kernel_cube(h, h->num_w_planes,
-                h->w_support, &conv_size_half, kernel_cube, status);
-
-    /* Rearrange and compact the kernels. */
-    oskar_mem_free(h->w_kernels_compact, status);
-    oskar_mem_free(h->w_kernel_start, status);
-    h->w_kernel_start = oskar_mem_create(OSKAR_INT, OSKAR_CPU,
-            h->num_w_planes, status);
-    h->w_kernels_compact = oskar_mem_create(h->imager_prec| OSKAR_COMPLEX,
-            OSKAR_CPU, 0, status);
-    oskar_imager_rearrange_kernels(h->num_w_planes, h->w_support,
-            h->oversample, conv_size_half, kernel_cube, h->w_kernels_compact,
-            oskar_mem_int(h->w_kernel_start, status), status);
-    oskar_mem_free(kernel_cube, status);
+    if (*status) return;
 
     /* Record data about the kernels. */
     oskar_log_message(h->log, 'M', 0, "Baseline W values (wavelengths)");
@@ -176,6 +179,54 @@ void oskar_imager_init_wproj(oskar_Imager* h, int* status)
 }
 
 
+static void oskar_imager_generate_w_kernels(oskar_Imager* h,
+        int conv_size, int inner, double sampling, int* status)
+{
+    double norm_factor = 1.;
+    oskar_Mem *kernel_cube = 0;
+    const int save_kernels = 0;
+    size_t conv_size_half = conv_size / 2 - 1;
+
+    /* Evaluate unnormalised kernels. */
+    kernel_cube = oskar_imager_evaluate_w_kernel_cube(h, h->num_w_planes,
+            h->w_scale, conv_size, inner, sampling, &norm_factor, status);
+
+    /* Evaluate the support size of each kernel. */
+    h->w_support = oskar_imager_evaluate_w_kernel_support_sizes(
+            h->num_w_planes, h->oversample, conv_size_half,
+            kernel_cube, norm_factor, status);
+
+#if 0
+    /* Print kernel support sizes. */
+    {
+        int i;
+        for (i = 0; i < h->num_w_planes; ++i)
+        {
+            const int* supp = oskar_mem_int_const(h->w_support, status);
+            printf("Plane %d, support: %d\n", i, supp[i]);
+        }
+    }
+#endif
+
+    /* Normalise the kernel cube. */
+    oskar_imager_normalise_kernel_cube(h->w_support, h->oversample,
+            conv_size_half, kernel_cube, status);
+    if (save_kernels)
+        oskar_imager_trim_and_save_kernel_cube(h, h->num_w_planes,
+                h->w_support, &conv_size_half, kernel_cube, status);
+
+    /* Rearrange and compact the kernels. */
+    h->w_kernel_start = oskar_mem_create(OSKAR_INT, OSKAR_CPU,
+            h->num_w_planes, status);
+    h->w_kernels_compact = oskar_mem_create(h->imager_prec| OSKAR_COMPLEX,
+            OSKAR_CPU, 0, status);
+    oskar_imager_rearrange_kernels(h->num_w_planes, h->w_support,
+            h->oversample, conv_size_half, kernel_cube, h->w_kernels_compact,
+            oskar_mem_int(h->w_kernel_start, status), status);
+    oskar_mem_free(kernel_cube, status);
+}
+
+
 static void oskar_imager_evaluate_w_kernel_params(const oskar_Imager* h,
         int* num_w_planes, double* w_scale)
 {
@@ -199,19 +250,10 @@ static void oskar_imager_evaluate_w_kernel_params(const oskar_Imager* h,
 }
 
 
-static oskar_Mem* oskar_imager_evaluate_w_kernel_cube(oskar_Imager* h,
-        int num_w_planes, double w_scale,
-        size_t* conv_size_half, double* norm_factor, int* status)
+static void oskar_imager_evaluate_w_kernel_size(oskar_Imager* h,
+        int num_w_planes, int* conv_size, int* inner, double* sampling)
 {
     size_t max_mem_bytes;
-    oskar_FFT* fft = 0;
-    oskar_Mem *screen = 0, *screen_gpu = 0, *screen_ptr = 0;
-    oskar_Mem *taper = 0, *taper_gpu = 0, *taper_ptr = 0;
-    oskar_Mem *kernel_cube = 0;
-    char *ptr_out, *ptr_in;
-    double *maxes, max_val = -INT_MAX, sampling;
-    int i;
-    if (*status) return 0;
 
     /* Calculate convolution kernel size. */
     const size_t max_bytes_per_plane = 64 * 1024 * 1024; /* 64 MB/plane */
@@ -220,15 +262,76 @@ static oskar_Mem* oskar_imager_evaluate_w_kernel_cube(oskar_Imager* h,
     const double max_conv_size = sqrt(max_mem_bytes / (16. * num_w_planes));
     const int nearest = oskar_imager_composite_nearest_even(
             2 * (int)(max_conv_size / 2.0), 0, 0);
-    const int conv_size = MIN((int)(h->image_size * h->image_padding),nearest);
-    *conv_size_half = conv_size / 2 - 1;
-    const size_t kernel_plane_size = (*conv_size_half) * (*conv_size_half);
+    *conv_size = MIN((int)(h->image_size * h->image_padding), nearest);
 
     /* Get size of inner region of kernel. */
-    const int inner = conv_size / h->oversample;
+    *inner = *conv_size / h->oversample;
     const double l_max = sin(0.5 * h->fov_deg * M_PI/180.0);
-    sampling = (2.0 * l_max * h->oversample) / h->image_size;
-    sampling *= ((double) oskar_imager_plane_size(h)) / ((double) conv_size);
+    *sampling = (2.0 * l_max * h->oversample) / h->image_size;
+    *sampling *= ((double) oskar_imager_plane_size(h)) / ((double) *conv_size);
+}
+
+
+static void oskar_imager_evaluate_w_kernel_plane(int i, int conv_size,
+        int inner, double sampling, double w_scale, const oskar_Mem* taper,
+        oskar_Mem* screen, oskar_Mem* screen_gpu, oskar_FFT* fft,
+        oskar_Mem* kernel_cube, double* max, int* status)
+{
+    size_t iy, in = 0, out = 0;
+    oskar_Mem* screen_ptr = screen_gpu ? screen_gpu : screen;
+    const int prec = oskar_mem_precision(screen);
+    const size_t conv_size_half = conv_size / 2 - 1;
+    const size_t element_size = 2 * oskar_mem_element_size(prec);
+    const size_t copy_len = conv_size_half * element_size;
+
+    /* Generate the tapered phase screen. */
+    oskar_imager_generate_w_phase_screen(i, conv_size, inner,
+            sampling, w_scale, taper, screen_ptr, status);
+
+    /* Perform the FFT to get the kernel. No shifts are required. */
+    oskar_fft_exec(fft, screen_ptr, status);
+    if (screen_ptr != screen)
+        oskar_mem_copy(screen, screen_ptr, status);
+    if (*status) return;
+
+    /* Get the maximum (from the first element). */
+    if (prec == OSKAR_DOUBLE)
+    {
+        const double* t = (const double*) oskar_mem_void_const(screen);
+        *max = sqrt(t[0]*t[0] + t[1]*t[1]);
+    }
+    else
+    {
+        const float* t = (const float*) oskar_mem_void_const(screen);
+        *max = sqrt(t[0]*t[0] + t[1]*t[1]);
+    }
+
+    /* Save only the first quarter of the kernel; the rest is redundant. */
+    const char* ptr_in = oskar_mem_char_const(screen);
+    char* ptr_out = oskar_mem_char(kernel_cube) +
+            conv_size_half * conv_size_half * element_size * (size_t) i;
+    for (iy = 0; iy < conv_size_half; ++iy)
+    {
+        memcpy(ptr_out + out, ptr_in + in, copy_len);
+        in += element_size * (size_t) conv_size;
+        out += copy_len;
+    }
+}
+
+
+static oskar_Mem* oskar_imager_evaluate_w_kernel_cube(oskar_Imager* h,
+        int num_w_planes, double w_scale, int conv_size, int inner,
+        double sampling, double* norm_factor, int* status)
+{
+    oskar_FFT** fft = 0;
+    oskar_Mem **screen = 0, *screen_gpu = 0;
+    oskar_Mem *taper = 0, *taper_gpu = 0, *taper_ptr = 0;
+    oskar_Mem *kernel_cube = 0;
+    double *maxes, max_val = -INT_MAX;
+    int i, num_threads = 1, *thread_status = 0;
+    if (*status) return 0;
+    const size_t conv_size_half = conv_size / 2 - 1;
+    const size_t kernel_plane_size = conv_size_half * conv_size_half;
 
     /* Generate 1D spheroidal tapering function to cover the inner region. */
     const int prec = h->imager_prec;
@@ -257,68 +360,68 @@ static oskar_Mem* oskar_imager_evaluate_w_kernel_cube(oskar_Imager* h,
     kernel_cube = oskar_mem_create(prec | OSKAR_COMPLEX, OSKAR_CPU,
             ((size_t) num_w_planes) * kernel_plane_size, status);
 
-    /* Create scratch arrays and FFT plan for the phase screens. */
-    screen = oskar_mem_create(prec | OSKAR_COMPLEX,
-            OSKAR_CPU, conv_size * conv_size, status);
-    screen_ptr = screen;
+    /* Planes are generated in parallel on the CPU, using one phase screen
+     * per thread, as long as there is enough free memory for them. */
     const int fft_loc = (h->generate_w_kernels_on_gpu && h->num_gpus > 0) ?
             h->dev_loc : OSKAR_CPU;
+#ifdef _OPENMP
+    if (fft_loc == OSKAR_CPU)
+    {
+        const size_t screen_bytes = (size_t) conv_size * (size_t) conv_size *
+                oskar_mem_element_size(prec | OSKAR_COMPLEX);
+        const size_t max_screens =
+                oskar_get_free_physical_memory() / (2 * screen_bytes);
+        num_threads = MIN(omp_get_max_threads(), num_w_planes);
+        if ((size_t) num_threads > max_screens)
+            num_threads = MAX(1, (int) max_screens);
+    }
+#endif
+
+    /* Create scratch arrays and FFT plans for the phase screens. */
+    screen = (oskar_Mem**) calloc(num_threads, sizeof(oskar_Mem*));
+    fft = (oskar_FFT**) calloc(num_threads, sizeof(oskar_FFT*));
+    thread_status = (int*) calloc(num_threads, sizeof(int));
     if (fft_loc != OSKAR_CPU)
     {
         oskar_device_set(h->dev_loc, h->gpu_ids[0], status);
         screen_gpu = oskar_mem_create(prec | OSKAR_COMPLEX,
                 h->dev_loc, conv_size * conv_size, status);
         taper_gpu = oskar_mem_create_copy(taper, h->dev_loc, status);
-        screen_ptr = screen_gpu;
         taper_ptr = taper_gpu;
     }
-    fft = oskar_fft_create(h->imager_prec, fft_loc,
-            2, conv_size, 0, status);
-    oskar_fft_set_ensure_consistent_norm(fft, 0);
+    for (i = 0; i < num_threads; ++i)
+    {
+        screen[i] = oskar_mem_create(prec | OSKAR_COMPLEX,
+                OSKAR_CPU, conv_size * conv_size, status);
+        fft[i] = oskar_fft_create(h->imager_prec, fft_loc,
+                2, conv_size, 0, status);
+        oskar_fft_set_ensure_consistent_norm(fft[i], 0);
+        thread_status[i] = *status;
+    }
 
     /* Evaluate kernels. */
-    ptr_in = oskar_mem_char(screen);
-    const size_t element_size = 2 * oskar_mem_element_size(prec);
-    const size_t copy_len = (*conv_size_half) * element_size;
     maxes = (double*) calloc(num_w_planes, sizeof(double));
+#pragma omp parallel for schedule(dynamic, 1) num_threads(num_threads)
     for (i = 0; i < num_w_planes; ++i)
     {
-        size_t iy, in = 0, out = 0, offset;
-
-        /* Generate the tapered phase screen. */
-        oskar_imager_generate_w_phase_screen(i, conv_size, inner,
-                sampling, w_scale, taper_ptr, screen_ptr, status);
-
-        /* Perform the FFT to get the kernel. No shifts are required. */
-        oskar_fft_exec(fft, screen_ptr, status);
-        if (screen_ptr != screen)
-            oskar_mem_copy(screen, screen_ptr, status);
-        if (*status) break;
-
-        /* Get the maximum (from the first element). */
-        if (prec == OSKAR_DOUBLE)
-        {
-            const double* t = (const double*) oskar_mem_void_const(screen);
-            maxes[i] = sqrt(t[0]*t[0] + t[1]*t[1]);
-        }
-        else
-        {
-            const float* t = (const float*) oskar_mem_void_const(screen);
-            maxes[i] = sqrt(t[0]*t[0] + t[1]*t[1]);
-        }
-
-        /* Save only the first quarter of the kernel; the rest is redundant. */
-        offset = kernel_plane_size * element_size * (size_t) i;
-        ptr_out = oskar_mem_char(kernel_cube) + offset;
-        for (iy = 0; iy < *conv_size_half; ++iy)
-        {
-            memcpy(ptr_out + out, ptr_in + in, copy_len);
-            in += element_size * (size_t) conv_size;
-            out += copy_len;
-        }
+        int t = 0;
+#ifdef _OPENMP
+        t = omp_get_thread_num();
+#endif
+        if (thread_status[t]) continue;
+        oskar_imager_evaluate_w_kernel_plane(i, conv_size, inner,
+                sampling, w_scale, taper_ptr, screen[t], screen_gpu, fft[t],
+                kernel_cube, &maxes[i], &thread_status[t]);
+    }
+    for (i = 0; i < num_threads; ++i)
+    {
+        if (!*status) *status = thread_status[i];
+        oskar_fft_free(fft[i]);
+        oskar_mem_free(screen[i], status);
     }
-    oskar_fft_free(fft);
-    oskar_mem_free(screen, status);
+    free(fft);
+    free(screen);
+    free(thread_status);
     oskar_mem_free(screen_gpu, status);
     oskar_mem_free(taper, status);
     oskar_mem_free(taper_gpu, status);
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2017-2019, The University of Oxford
+ * Copyright (c) 2017-2020, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -27,7 +27,9 @@
  */
 
 #include "imager/private_imager.h"
+#include "imager/private_imager_coord_cache.h"
 #include "imager/private_imager_read_coords.h"
+#include "imager/private_imager_read_data.h"
 #include "imager/oskar_imager.h"
 #include "binary/oskar_binary.h"
 #include "math/oskar_cmath.h"
@@ -122,6 +124,10 @@ void oskar_imager_read_coords_ms(oskar_Imager* h, const char* filename,
             w_[i] = uvw_[3*i + 2];
         }
 
+        /* Cache the coordinates for the second pass. */
+        oskar_imager_coord_cache_add(h, block_size,
+                u, v, w, weight, time_centroid, status);
+
         /* Update the imager with the data. */
         oskar_timer_pause(h->tmr_read);
         oskar_imager_update(h, block_size, 0, num_channels - 1,
@@ -197,6 +203,17 @@ void oskar_imager_read_coords_vis(oskar_Imager* h, const char* filename,
             oskar_vis_header_phase_centre_ra_deg(hdr),
             oskar_vis_header_phase_centre_dec_deg(hdr));
 
+    /* Read averaged rows if baseline-dependent averaging was used.
+     * These are not cached, as they are small. */
+    if (oskar_vis_header_bda(hdr))
+    {
+        oskar_imager_read_data_vis_bda(h, hdr, vis_file, 1,
+                i_file, num_files, percent_done, percent_next, status);
+        oskar_vis_header_free(hdr, status);
+        oskar_binary_free(vis_file);
+        return;
+    }
+
     /* Create scratch arrays. Weights are all 1. */
     uu = oskar_mem_create(coord_prec, OSKAR_CPU, 0, status);
     vv = oskar_mem_create(coord_prec, OSKAR_CPU, 0, status);
@@ -240,6 +257,10 @@ void oskar_imager_read_coords_vis(oskar_Imager* h, const char* filename,
         oskar_binary_read_mem(vis_file, ww, OSKAR_TAG_GROUP_VIS_BLOCK,
                 OSKAR_VIS_BLOCK_TAG_BASELINE_WW, i_block, status);
 
+        /* Cache the coordinates for the second pass.
+         * Weights and time centroids can be regenerated. */
+        oskar_imager_coord_cache_add(h, num_rows, uu, vv, ww, 0, 0, status);
+
         /* Update the imager with the data. */
         oskar_timer_pause(h->tmr_read);
         for (c = 0; c < num_channels; ++c)
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2017-2019, The University of Oxford
+ * Copyright (c) 2017-2020, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -27,12 +27,14 @@
  */
 
 #include "imager/private_imager.h"
+#include "imager/private_imager_coord_cache.h"
 #include "imager/private_imager_read_data.h"
 #include "imager/oskar_imager.h"
 #include "binary/oskar_binary.h"
 #include "math/oskar_cmath.h"
 #include "mem/oskar_binary_read_mem.h"
 #include "ms/oskar_measurement_set.h"
+#include "vis/oskar_vis_bda.h"
 #include "vis/oskar_vis_block.h"
 #include "vis/oskar_vis_header.h"
 #include "utility/oskar_timer.h"
@@ -46,6 +48,33 @@
 extern "C" {
 #endif
 
+#ifndef OSKAR_NO_MS
+/* Returns the range of channels in the file needed by the selected
+ * frequencies, so that only these need to be read. */
+static void ms_channel_range(const oskar_Imager* h, int num_channels,
+        int* start_chan, int* end_chan)
+{
+    int i;
+    const double f0 = h->vis_freq_start_hz, df = h->freq_inc_hz;
+    *start_chan = num_channels;
+    *end_chan = -1;
+    for (i = 0; i < h->num_sel_freqs; ++i)
+    {
+        const int c = (df == 0.0) ? 0 :
+                (int) round((h->sel_freqs[i] - f0) / df);
+        if (c < 0 || c >= num_channels) continue;
+        if (c < *start_chan) *start_chan = c;
+        if (c > *end_chan) *end_chan = c;
+    }
+    if (*end_chan < 0)
+    {
+        /* Nothing selected: read a single channel to keep going. */
+        *start_chan = 0;
+        *end_chan = 0;
+    }
+}
+#endif
+
 void oskar_imager_read_data_ms(oskar_Imager* h, const char* filename,
         int i_file, int num_files, int* percent_done, int* percent_next,
         int* status)
@@ -71,6 +100,7 @@ void oskar_imager_read_data_ms(oskar_Imager* h, const char* filename,
     const size_t num_baselines = num_stations * (num_stations - 1) / 2;
     const int num_pols = (int) oskar_ms_num_pols(ms);
     const int num_channels = (int) oskar_ms_num_channels(ms);
+    int start_chan = 0, end_chan = 0;
 
     /* Set visibility meta-data. */
     oskar_imager_set_vis_frequency(h,
@@ -80,6 +110,10 @@ void oskar_imager_read_data_ms(oskar_Imager* h, const char* filename,
             oskar_ms_phase_centre_ra_rad(ms) * 180/M_PI,
             oskar_ms_phase_centre_dec_rad(ms) * 180/M_PI);
 
+    /* Get the range of channels to read. */
+    ms_channel_range(h, num_channels, &start_chan, &end_chan);
+    const int num_channels_read = 1 + end_chan - start_chan;
+
     /* Create arrays. */
     uvw = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, 3 * num_baselines, status);
     u = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, num_baselines, status);
@@ -96,48 +130,64 @@ void oskar_imager_read_data_ms(oskar_Imager* h, const char* filename,
     type = OSKAR_SINGLE | OSKAR_COMPLEX;
     if (num_pols == 4) type |= OSKAR_MATRIX;
     data = oskar_mem_create(type, OSKAR_CPU,
-            num_baselines * num_channels, status);
+            num_baselines * num_channels_read, status);
 
     /* Loop over visibility blocks. */
     for (start_row = 0; start_row < num_rows; start_row += num_baselines)
     {
-        size_t allocated, required, block_size, i;
+        size_t allocated, required, block_size, cached_rows, i;
+        const oskar_Mem *u_in = u, *v_in = v, *w_in = w;
+        const oskar_Mem *weight_in = weight, *time_centroid_in = time_centroid;
         if (*status) break;
 
         /* Read rows from Measurement Set. */
         oskar_timer_resume(h->tmr_read);
         block_size = num_rows - start_row;
         if (block_size > num_baselines) block_size = num_baselines;
-        allocated = oskar_mem_length(uvw) *
-                oskar_mem_element_size(oskar_mem_type(uvw));
-        oskar_ms_read_column(ms, "UVW", start_row, block_size,
-                allocated, oskar_mem_void(uvw), &required, status);
-        allocated = oskar_mem_length(weight) *
-                oskar_mem_element_size(oskar_mem_type(weight));
-        oskar_ms_read_column(ms, "WEIGHT", start_row, block_size,
-                allocated, oskar_mem_void(weight), &required, status);
-        allocated = oskar_mem_length(time_centroid) *
-                oskar_mem_element_size(oskar_mem_type(time_centroid));
-        oskar_ms_read_column(ms, "TIME_CENTROID", start_row, block_size,
-                allocated, oskar_mem_void(time_centroid), &required, status);
+        cached_rows = oskar_imager_coord_cache_next(h, &u_in, &v_in, &w_in,
+                &weight_in, &time_centroid_in, status);
+        if (cached_rows > 0 && cached_rows != block_size)
+        {
+            *status = OSKAR_ERR_DIMENSION_MISMATCH;
+            break;
+        }
+        if (cached_rows == 0)
+        {
+            /* Coordinates were not cached, so read them again. */
+            allocated = oskar_mem_length(uvw) *
+                    oskar_mem_element_size(oskar_mem_type(uvw));
+            oskar_ms_read_column(ms, "UVW", start_row, block_size,
+                    allocated, oskar_mem_void(uvw), &required, status);
+            allocated = oskar_mem_length(weight) *
+                    oskar_mem_element_size(oskar_mem_type(weight));
+            oskar_ms_read_column(ms, "WEIGHT", start_row, block_size,
+                    allocated, oskar_mem_void(weight), &required, status);
+            allocated = oskar_mem_length(time_centroid) *
+                    oskar_mem_element_size(oskar_mem_type(time_centroid));
+            oskar_ms_read_column(ms, "TIME_CENTROID", start_row, block_size,
+                    allocated, oskar_mem_void(time_centroid), &required,
+                    status);
+
+            /* Split up baseline coordinates. */
+            for (i = 0; i < block_size; ++i)
+            {
+                u_[i] = uvw_[3*i + 0];
+                v_[i] = uvw_[3*i + 1];
+                w_[i] = uvw_[3*i + 2];
+            }
+        }
         allocated = oskar_mem_length(data) *
                 oskar_mem_element_size(oskar_mem_type(data));
-        oskar_ms_read_column(ms, h->ms_column, start_row, block_size,
+        oskar_ms_read_column_channels(ms, h->ms_column, start_row,
+                block_size, start_chan, num_channels_read,
                 allocated, oskar_mem_void(data), &required, status);
         if (*status) break;
 
-        /* Split up baseline coordinates. */
-        for (i = 0; i < block_size; ++i)
-        {
-            u_[i] = uvw_[3*i + 0];
-            v_[i] = uvw_[3*i + 1];
-            w_[i] = uvw_[3*i + 2];
-        }
-
         /* Update the imager with the data. */
         oskar_timer_pause(h->tmr_read);
-        oskar_imager_update(h, block_size, 0, num_channels - 1,
-                num_pols, u, v, w, data, weight, time_centroid, status);
+        oskar_imager_update(h, block_size, start_chan, end_chan,
+                num_pols, u_in, v_in, w_in, data, weight_in,
+                time_centroid_in, status);
         *percent_done = (int) round(100.0 * (
                 (start_row + block_size) / (double)(num_rows * num_files) +
                 i_file / (double)num_files));
@@ -210,6 +260,16 @@ void oskar_imager_read_data_vis(oskar_Imager* h, const char* filename,
             oskar_vis_header_phase_centre_ra_deg(hdr),
             oskar_vis_header_phase_centre_dec_deg(hdr));
 
+    /* Read averaged rows if baseline-dependent averaging was used. */
+    if (oskar_vis_header_bda(hdr))
+    {
+        oskar_imager_read_data_vis_bda(h, hdr, vis_file, 0,
+                i_file, num_files, percent_done, percent_next, status);
+        oskar_vis_header_free(hdr, status);
+        oskar_binary_free(vis_file);
+        return;
+    }
+
     /* Create scratch arrays. Weights are all 1. */
     time_centroid = oskar_mem_create(OSKAR_DOUBLE,
             OSKAR_CPU, num_baselines * max_times_per_block, status);
@@ -222,18 +282,47 @@ void oskar_imager_read_data_vis(oskar_Imager* h, const char* filename,
     block = oskar_vis_block_create_from_header(OSKAR_CPU, hdr, status);
     for (i_block = 0; i_block < num_blocks; ++i_block)
     {
-        int c, t;
+        int c, t, dim_start_and_size[6];
+        size_t cached_rows;
+        const oskar_Mem *uu = 0, *vv = 0, *ww = 0;
         if (*status) break;
 
         /* Read the visibility data. */
         oskar_timer_resume(h->tmr_read);
         oskar_binary_set_query_search_start(vis_file,
                 i_block * tags_per_block, status);
-        oskar_vis_block_read(block, hdr, vis_file, i_block, status);
-        const int start_time   = oskar_vis_block_start_time_index(block);
-        const int start_chan   = oskar_vis_block_start_channel_index(block);
-        const int num_times    = oskar_vis_block_num_times(block);
-        const int num_channels = oskar_vis_block_num_channels(block);
+        cached_rows = oskar_imager_coord_cache_next(h, &uu, &vv, &ww, 0, 0,
+                status);
+        if (cached_rows > 0)
+        {
+            /* Coordinates are cached, so only read the cross-correlations. */
+            oskar_binary_read(vis_file, OSKAR_INT,
+                    OSKAR_TAG_GROUP_VIS_BLOCK,
+                    OSKAR_VIS_BLOCK_TAG_DIM_START_AND_SIZE, i_block,
+                    sizeof(dim_start_and_size), dim_start_and_size, status);
+            oskar_binary_read_mem(vis_file,
+                    oskar_vis_block_cross_correlations(block),
+                    OSKAR_TAG_GROUP_VIS_BLOCK,
+                    OSKAR_VIS_BLOCK_TAG_CROSS_CORRELATIONS, i_block, status);
+            if (cached_rows != (size_t) dim_start_and_size[2] * num_baselines)
+                *status = OSKAR_ERR_DIMENSION_MISMATCH;
+        }
+        else
+        {
+            oskar_vis_block_read(block, hdr, vis_file, i_block, status);
+            dim_start_and_size[0] = oskar_vis_block_start_time_index(block);
+            dim_start_and_size[1] = oskar_vis_block_start_channel_index(block);
+            dim_start_and_size[2] = oskar_vis_block_num_times(block);
+            dim_start_and_size[3] = oskar_vis_block_num_channels(block);
+            uu = oskar_vis_block_baseline_uu_metres_const(block);
+            vv = oskar_vis_block_baseline_vv_metres_const(block);
+            ww = oskar_vis_block_baseline_ww_metres_const(block);
+        }
+        if (*status) break;
+        const int start_time   = dim_start_and_size[0];
+        const int start_chan   = dim_start_and_size[1];
+        const int num_times    = dim_start_and_size[2];
+        const int num_channels = dim_start_and_size[3];
         const size_t num_rows  = num_times * num_baselines;
 
         /* Fill in the time centroid values. */
@@ -264,10 +353,7 @@ void oskar_imager_read_data_vis(oskar_Imager* h, const char* filename,
                 oskar_timer_pause(h->tmr_copy_convert);
                 oskar_imager_update(h, num_rows,
                         start_chan + c, start_chan + c, num_pols,
-                        oskar_vis_block_baseline_uu_metres_const(block),
-                        oskar_vis_block_baseline_vv_metres_const(block),
-                        oskar_vis_block_baseline_ww_metres_const(block),
-                        scratch, weight, time_centroid, status);
+                        uu, vv, ww, scratch, weight, time_centroid, status);
             }
         }
         *percent_done = (int) round(100.0 * (
@@ -287,6 +373,76 @@ void oskar_imager_read_data_vis(oskar_Imager* h, const char* filename,
     oskar_binary_free(vis_file);
 }
 
+void oskar_imager_read_data_vis_bda(oskar_Imager* h,
+        const oskar_VisHeader* hdr, oskar_Binary* vis_file, int coords_only,
+        int i_file, int num_files, int* percent_done, int* percent_next,
+        int* status)
+{
+    oskar_VisBda* vis;
+    oskar_Mem* weight;
+    int i_block, p, r;
+    if (*status) return;
+    const int num_blocks = oskar_vis_header_num_blocks(hdr);
+    const int num_pols =
+            oskar_type_is_matrix(oskar_vis_header_amp_type(hdr)) ? 4 : 1;
+
+    /* Loop over visibility blocks. */
+    vis = oskar_vis_bda_create_from_header(hdr, status);
+    weight = oskar_mem_create(h->imager_prec, OSKAR_CPU, 0, status);
+    for (i_block = 0; i_block < num_blocks; ++i_block)
+    {
+        if (*status) break;
+
+        /* Read the averaged rows. */
+        oskar_timer_resume(h->tmr_read);
+        oskar_vis_bda_read(vis, hdr, vis_file, i_block, status);
+        const int start_chan   = oskar_vis_bda_start_channel_index(vis);
+        const int num_channels = oskar_vis_bda_num_channels(vis);
+        const int num_rows     = oskar_vis_bda_num_rows(vis);
+
+        /* Weight each row by the number of samples it contains. */
+        oskar_mem_realloc(weight, (size_t) num_rows * num_pols, status);
+        if (*status) break;
+        const int* n = oskar_mem_int_const(
+                oskar_vis_bda_num_samples_const(vis), status);
+        if (h->imager_prec == OSKAR_DOUBLE)
+        {
+            double* w = oskar_mem_double(weight, status);
+            for (r = 0; r < num_rows; ++r)
+                for (p = 0; p < num_pols; ++p)
+                    w[r * num_pols + p] = (double) n[r];
+        }
+        else
+        {
+            float* w = oskar_mem_float(weight, status);
+            for (r = 0; r < num_rows; ++r)
+                for (p = 0; p < num_pols; ++p)
+                    w[r * num_pols + p] = (float) n[r];
+        }
+        oskar_timer_pause(h->tmr_read);
+
+        /* Update the imager with the data for all channels. */
+        if (num_rows > 0)
+            oskar_imager_update(h, num_rows, start_chan,
+                    start_chan + num_channels - 1, num_pols,
+                    oskar_vis_bda_baseline_uu_metres_const(vis),
+                    oskar_vis_bda_baseline_vv_metres_const(vis),
+                    oskar_vis_bda_baseline_ww_metres_const(vis),
+                    coords_only ? 0 : oskar_vis_bda_cross_correlations_const(vis),
+                    weight, oskar_vis_bda_time_centroid_const(vis), status);
+        *percent_done = (int) round(100.0 * (
+                (i_block + 1) / (double)(num_blocks * num_files) +
+                i_file / (double)num_files));
+        if (percent_next && *percent_done >= *percent_next)
+        {
+            oskar_log_message(h->log, 'S', -2, "%3d%% ...", *percent_done);
+            *percent_next = 10 + 10 * (*percent_done / 10);
+        }
+    }
+    oskar_mem_free(weight, status);
+    oskar_vis_bda_free(vis, status);
+}
+
 #ifdef __cplusplus
 }
 #endif
@@ -30,8 +30,8 @@
 #include "imager/oskar_imager.h"
 
 #include "imager/define_grid_tile_grid.h"
+#include "imager/private_imager_grid_cpu.h"
 #include "imager/private_imager_update_plane_fft.h"
-#include "imager/oskar_grid_simple.h"
 #include "math/oskar_prefix_sum.h"
 #include "math/oskar_round_robin.h"
 #include "utility/oskar_device.h"
@@ -89,26 +89,8 @@ void oskar_imager_update_plane_fft(oskar_Imager* h, size_t num_vis,
         const size_t num_cells = ((size_t) grid_size) * ((size_t) grid_size);
         oskar_mem_ensure(plane_ptr, num_cells, status);
         if (*status) return;
-        if (h->imager_prec == OSKAR_DOUBLE)
-            oskar_grid_simple_d(h->support, h->oversample,
-                    oskar_mem_double_const(h->conv_func, status), num_vis,
-                    oskar_mem_double_const(uu, status),
-                    oskar_mem_double_const(vv, status),
-                    oskar_mem_double_const(amps, status),
-                    oskar_mem_double_const(weight, status),
-                    h->cellsize_rad,
-                    grid_size, num_skipped, plane_norm,
-                    oskar_mem_double(plane_ptr, status));
-        else
-            oskar_grid_simple_f(h->support, h->oversample,
-                    oskar_mem_float_const(h->conv_func, status), num_vis,
-                    oskar_mem_float_const(uu, status),
-                    oskar_mem_float_const(vv, status),
-                    oskar_mem_float_const(amps, status),
-                    oskar_mem_float_const(weight, status),
-                    (float) (h->cellsize_rad),
-                    grid_size, num_skipped, plane_norm,
-                    oskar_mem_float(plane_ptr, status));
+        oskar_imager_grid_cpu(h, num_vis, uu, vv, 0, amps, weight,
+                plane_ptr, plane_norm, num_skipped, status);
     }
     else
     {
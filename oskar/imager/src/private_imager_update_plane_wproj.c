@@ -30,8 +30,8 @@
 #include "imager/oskar_imager.h"
 
 #include "imager/define_grid_tile_grid.h"
+#include "imager/private_imager_grid_cpu.h"
 #include "imager/private_imager_update_plane_wproj.h"
-#include "imager/oskar_grid_wproj2.h"
 #include "math/oskar_prefix_sum.h"
 #include "math/oskar_round_robin.h"
 #include "utility/oskar_device.h"
@@ -89,34 +89,8 @@ void oskar_imager_update_plane_wproj(oskar_Imager* h, size_t num_vis,
         const size_t num_cells = ((size_t) grid_size) * ((size_t) grid_size);
         oskar_mem_ensure(plane_ptr, num_cells, status);
         if (*status) return;
-        if (h->imager_prec == OSKAR_DOUBLE)
-            oskar_grid_wproj2_d(h->num_w_planes,
-                    oskar_mem_int_const(h->w_support, status),
-                    h->oversample,
-                    oskar_mem_int_const(h->w_kernel_start, status),
-                    oskar_mem_double_const(h->w_kernels_compact, status), num_vis,
-                    oskar_mem_double_const(uu, status),
-                    oskar_mem_double_const(vv, status),
-                    oskar_mem_double_const(ww, status),
-                    oskar_mem_double_const(amps, status),
-                    oskar_mem_double_const(weight, status),
-                    h->cellsize_rad, h->w_scale,
-                    grid_size, num_skipped, plane_norm,
-                    oskar_mem_double(plane_ptr, status));
-        else
-            oskar_grid_wproj2_f(h->num_w_planes,
-                    oskar_mem_int_const(h->w_support, status),
-                    h->oversample,
-                    oskar_mem_int_const(h->w_kernel_start, status),
-                    oskar_mem_float_const(h->w_kernels_compact, status), num_vis,
-                    oskar_mem_float_const(uu, status),
-                    oskar_mem_float_const(vv, status),
-                    oskar_mem_float_const(ww, status),
-                    oskar_mem_float_const(amps, status),
-                    oskar_mem_float_const(weight, status),
-                    h->cellsize_rad, h->w_scale,
-                    grid_size, num_skipped, plane_norm,
-                    oskar_mem_float(plane_ptr, status));
+        oskar_imager_grid_cpu(h, num_vis, uu, vv, ww, amps, weight,
+                plane_ptr, plane_norm, num_skipped, status);
     }
     else
     {
@@ -0,0 +1,270 @@
+/*
+ * Copyright (c) 2020, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/* Needed for mmap() when compiling with -std=c99. */
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200112L
+#endif
+
+#include "imager/private_imager.h"
+#include "imager/private_imager_w_kernel_cache.h"
+#include "binary/oskar_crc.h"
+#include "utility/oskar_dir.h"
+#include "utility/oskar_thread.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef OSKAR_OS_WIN
+#include <process.h>
+#define getpid _getpid
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* The kernels start on a boundary of this many bytes in the file. */
+#define ALIGNMENT 64
+
+static const char cache_magic[8] = {'O', 'S', 'K', 'A', 'R', 'W', 'K', 'C'};
+
+struct WKernelCacheHeader
+{
+    char magic[8];
+    WKernelCacheKey key;
+    unsigned long long num_kernel_values, kernel_offset;
+};
+typedef struct WKernelCacheHeader WKernelCacheHeader;
+
+static char* cache_file_name(const oskar_Imager* h, const WKernelCacheKey* key)
+{
+    char name[40];
+    oskar_CRC* crc_data = oskar_crc_create(OSKAR_CRC_32C);
+    const unsigned long crc = oskar_crc_compute(crc_data, key, sizeof(*key));
+    oskar_crc_free(crc_data);
+    sprintf(name, "oskar_w_kernels_%08lx.bin", crc & 0xFFFFFFFFul);
+    return oskar_dir_get_path(h->w_kernel_cache_dir, name);
+}
+
+static size_t kernel_offset(int num_w_planes)
+{
+    const size_t len = sizeof(WKernelCacheHeader) +
+            2 * (size_t) num_w_planes * sizeof(int);
+    return ALIGNMENT * ((len + ALIGNMENT - 1) / ALIGNMENT);
+}
+
+static char* map_file(const char* filename, size_t* size)
+{
+#ifndef OSKAR_OS_WIN
+    struct stat st;
+    void* ptr = 0;
+    const int fd = open(filename, O_RDONLY);
+    if (fd < 0) return 0;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0)
+    {
+        close(fd);
+        return 0;
+    }
+    *size = (size_t) st.st_size;
+    ptr = mmap(0, *size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    return (ptr == MAP_FAILED) ? 0 : (char*) ptr;
+#else
+    char* ptr = 0;
+    long len = 0;
+    FILE* file = fopen(filename, "rb");
+    if (!file) return 0;
+    if (fseek(file, 0, SEEK_END) == 0) len = ftell(file);
+    if (len > 0 && fseek(file, 0, SEEK_SET) == 0)
+    {
+        *size = (size_t) len;
+        ptr = (char*) malloc(*size);
+        if (ptr && fread(ptr, 1, *size, file) != *size)
+        {
+            free(ptr);
+            ptr = 0;
+        }
+    }
+    fclose(file);
+    return ptr;
+#endif
+}
+
+static void unmap_file(void* ptr, size_t size)
+{
+    if (!ptr) return;
+#ifndef OSKAR_OS_WIN
+    munmap(ptr, size);
+#else
+    (void) size;
+    free(ptr);
+#endif
+}
+
+int oskar_imager_w_kernel_cache_load(oskar_Imager* h,
+        const WKernelCacheKey* key, int* status)
+{
+    char *data = 0, *filename = 0;
+    size_t size = 0;
+    if (*status || !h->w_kernel_cache_dir) return 0;
+    oskar_imager_w_kernel_cache_release(h);
+    filename = cache_file_name(h, key);
+    data = map_file(filename, &size);
+    if (!data)
+    {
+        free(filename);
+        return 0;
+    }
+
+    /* Check the header matches the key exactly. */
+    const WKernelCacheHeader* hdr = (const WKernelCacheHeader*) data;
+    const int num_w_planes = key->num_w_planes;
+    const int type = key->precision | OSKAR_COMPLEX;
+    const size_t offset = kernel_offset(num_w_planes);
+    if (size < offset ||
+            memcmp(hdr->magic, cache_magic, sizeof(cache_magic)) != 0 ||
+            memcmp(&hdr->key, key, sizeof(WKernelCacheKey)) != 0 ||
+            hdr->kernel_offset != offset ||
+            size != offset + hdr->num_kernel_values *
+            oskar_mem_element_size(type))
+    {
+        unmap_file(data, size);
+        free(filename);
+        return 0;
+    }
+    h->w_kernel_cache_map = data;
+    h->w_kernel_cache_map_size = size;
+
+    /* Copy the support sizes and start indices, and alias the kernels. */
+    const size_t num_values = (size_t) hdr->num_kernel_values;
+    const size_t int_bytes = num_w_planes * sizeof(int);
+    oskar_mem_free(h->w_support, status);
+    oskar_mem_free(h->w_kernel_start, status);
+    oskar_mem_free(h->w_kernels_compact, status);
+    h->w_support = oskar_mem_create(OSKAR_INT, OSKAR_CPU,
+            num_w_planes, status);
+    h->w_kernel_start = oskar_mem_create(OSKAR_INT, OSKAR_CPU,
+            num_w_planes, status);
+    h->w_kernels_compact = oskar_mem_create_alias_from_raw(data + offset,
+            type, OSKAR_CPU, num_values, status);
+    if (!*status)
+    {
+        const char* ptr = data + sizeof(WKernelCacheHeader);
+        memcpy(oskar_mem_void(h->w_support), ptr, int_bytes);
+        memcpy(oskar_mem_void(h->w_kernel_start), ptr + int_bytes, int_bytes);
+        oskar_log_message(h->log, 'M', 0,
+                "Loaded W-kernels from cache file '%s'.", filename);
+    }
+    free(filename);
+    return !*status;
+}
+
+void oskar_imager_w_kernel_cache_save(oskar_Imager* h,
+        const WKernelCacheKey* key)
+{
+    WKernelCacheHeader hdr;
+    static const char zeros[ALIGNMENT] = {0};
+    int ok = 0;
+    if (!h->w_kernel_cache_dir || !h->w_kernels_compact) return;
+    const size_t n = (size_t) key->num_w_planes;
+    const size_t num_values = oskar_mem_length(h->w_kernels_compact);
+    const size_t element_size = oskar_mem_element_size(
+            oskar_mem_type(h->w_kernels_compact));
+    const size_t offset = kernel_offset(key->num_w_planes);
+    const size_t num_pad = offset - sizeof(hdr) - 2 * n * sizeof(int);
+    memset(&hdr, 0, sizeof(hdr));
+    memcpy(hdr.magic, cache_magic, sizeof(cache_magic));
+    hdr.key = *key;
+    hdr.num_kernel_values = (unsigned long long) num_values;
+    hdr.kernel_offset = (unsigned long long) offset;
+
+    /* Write to a temporary file first, so that another process can never
+     * see an incomplete cache. The temporary file name is unique to this
+     * process and call, so that imagers writing the same cache at the same
+     * time do not write to the same file. */
+    static volatile int save_counter = 0;
+    if (!oskar_dir_exists(h->w_kernel_cache_dir))
+        oskar_dir_mkpath(h->w_kernel_cache_dir);
+    char* filename = cache_file_name(h, key);
+    const size_t len = strlen(filename) + 40;
+    char* temp_filename = (char*) calloc(len, 1);
+    if (!temp_filename)
+    {
+        free(filename);
+        return;
+    }
+    sprintf(temp_filename, "%s.%d.%d.tmp", filename, (int) getpid(),
+            oskar_atomic_fetch_add(&save_counter, 1));
+    FILE* file = fopen(temp_filename, "wb");
+    if (file)
+    {
+        ok = fwrite(&hdr, sizeof(hdr), 1, file) == 1 &&
+                fwrite(oskar_mem_void_const(h->w_support),
+                        sizeof(int), n, file) == n &&
+                fwrite(oskar_mem_void_const(h->w_kernel_start),
+                        sizeof(int), n, file) == n &&
+                fwrite(zeros, 1, num_pad, file) == num_pad &&
+                fwrite(oskar_mem_void_const(h->w_kernels_compact),
+                        element_size, num_values, file) == num_values;
+        if (fclose(file) != 0) ok = 0;
+    }
+#ifdef OSKAR_OS_WIN
+    if (ok) remove(filename);
+#endif
+    if (!ok || rename(temp_filename, filename) != 0)
+    {
+        remove(temp_filename);
+        oskar_log_warning(h->log,
+                "Could not write W-kernel cache file '%s'.", filename);
+    }
+    else
+    {
+        oskar_log_message(h->log, 'M', 0,
+                "Saved W-kernels to cache file '%s'.", filename);
+    }
+    free(temp_filename);
+    free(filename);
+}
+
+void oskar_imager_w_kernel_cache_release(oskar_Imager* h)
+{
+    unmap_file(h->w_kernel_cache_map, h->w_kernel_cache_map_size);
+    h->w_kernel_cache_map = 0;
+    h->w_kernel_cache_map_size = 0;
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,153 @@
+/*
+ * Copyright (c) 2020, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <gtest/gtest.h>
+#include "imager/oskar_imager.h"
+
+#include <cmath>
+#include <cstdlib>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+static void grid_with_threads(const char* algorithm, int type,
+        int num_threads, oskar_Mem* grid, double* plane_norm)
+{
+    int status = 0, size = 256, num_vis = 50000;
+
+    // Create and set up the imager.
+    oskar_Imager* im = oskar_imager_create(type, &status);
+    oskar_imager_set_algorithm(im, algorithm, &status);
+    oskar_imager_set_fov(im, 2.0);
+    oskar_imager_set_size(im, size, &status);
+    oskar_imager_set_grid_on_gpu(im, 0);
+    ASSERT_EQ(0, status);
+
+    // Create visibility data.
+    oskar_Mem* uu = oskar_mem_create(type, OSKAR_CPU, num_vis, &status);
+    oskar_Mem* vv = oskar_mem_create(type, OSKAR_CPU, num_vis, &status);
+    oskar_Mem* ww = oskar_mem_create(type, OSKAR_CPU, num_vis, &status);
+    oskar_Mem* vis = oskar_mem_create(type | OSKAR_COMPLEX, OSKAR_CPU,
+            num_vis, &status);
+    oskar_Mem* weight = oskar_mem_create(type, OSKAR_CPU, num_vis, &status);
+    oskar_mem_random_gaussian(uu, 0, 1, 2, 3, 1000.0, &status);
+    oskar_mem_random_gaussian(vv, 4, 5, 6, 7, 1000.0, &status);
+    oskar_mem_random_gaussian(ww, 8, 9, 10, 11, 100.0, &status);
+    oskar_mem_random_gaussian(vis, 12, 13, 14, 15, 1.0, &status);
+    oskar_mem_random_uniform(weight, 16, 17, 18, 19, &status);
+    ASSERT_EQ(0, status);
+
+    // Scan the coordinates first, to set up W-projection.
+    oskar_imager_set_coords_only(im, 1);
+    oskar_imager_update_plane(im, num_vis, uu, vv, ww, 0, weight,
+            0, 0, 0, 0, &status);
+    oskar_imager_set_coords_only(im, 0);
+
+    // Grid visibility data.
+#ifdef _OPENMP
+    omp_set_num_threads(num_threads);
+#else
+    (void) num_threads;
+#endif
+    oskar_imager_update_plane(im, num_vis, uu, vv, ww, vis, weight,
+            0, grid, plane_norm, 0, &status);
+    ASSERT_EQ(0, status);
+
+    // Clean up.
+    oskar_imager_free(im, &status);
+    oskar_mem_free(uu, &status);
+    oskar_mem_free(vv, &status);
+    oskar_mem_free(ww, &status);
+    oskar_mem_free(vis, &status);
+    oskar_mem_free(weight, &status);
+}
+
+static void compare_threads(const char* algorithm, int type, double tol)
+{
+    int status = 0;
+    double norm_serial = 0.0, norm_parallel = 0.0;
+    oskar_Mem* grid_serial = oskar_mem_create(type | OSKAR_COMPLEX,
+            OSKAR_CPU, 0, &status);
+    oskar_Mem* grid_parallel = oskar_mem_create(type | OSKAR_COMPLEX,
+            OSKAR_CPU, 0, &status);
+#ifdef _OPENMP
+    const int max_threads = omp_get_max_threads();
+#endif
+    grid_with_threads(algorithm, type, 1, grid_serial, &norm_serial);
+    grid_with_threads(algorithm, type, 4, grid_parallel, &norm_parallel);
+#ifdef _OPENMP
+    omp_set_num_threads(max_threads);
+#endif
+    ASSERT_EQ(oskar_mem_length(grid_serial), oskar_mem_length(grid_parallel));
+    EXPECT_NEAR(1.0, norm_parallel / norm_serial, tol);
+
+    // Compare the grids, relative to the largest cell magnitude.
+    oskar_Mem* serial = oskar_mem_convert_precision(grid_serial,
+            OSKAR_DOUBLE, &status);
+    oskar_Mem* parallel = oskar_mem_convert_precision(grid_parallel,
+            OSKAR_DOUBLE, &status);
+    const double* a = oskar_mem_double_const(serial, &status);
+    const double* b = oskar_mem_double_const(parallel, &status);
+    const size_t num_values = 2 * oskar_mem_length(serial);
+    double max_abs = 0.0, max_diff = 0.0;
+    for (size_t i = 0; i < num_values; ++i)
+    {
+        const double diff = fabs(a[i] - b[i]);
+        if (fabs(a[i]) > max_abs) max_abs = fabs(a[i]);
+        if (diff > max_diff) max_diff = diff;
+    }
+    EXPECT_GT(max_abs, 0.0);
+    EXPECT_LT(max_diff / max_abs, tol);
+
+    // Clean up.
+    oskar_mem_free(serial, &status);
+    oskar_mem_free(parallel, &status);
+    oskar_mem_free(grid_serial, &status);
+    oskar_mem_free(grid_parallel, &status);
+}
+
+TEST(imager, grid_cpu_threads_fft_double)
+{
+    compare_threads("FFT", OSKAR_DOUBLE, 1e-10);
+}
+
+TEST(imager, grid_cpu_threads_fft_single)
+{
+    compare_threads("FFT", OSKAR_SINGLE, 1e-4);
+}
+
+TEST(imager, grid_cpu_threads_wproj_double)
+{
+    compare_threads("W-projection", OSKAR_DOUBLE, 1e-10);
+}
+
+TEST(imager, grid_cpu_threads_wproj_single)
+{
+    compare_threads("W-projection", OSKAR_SINGLE, 1e-4);
+}
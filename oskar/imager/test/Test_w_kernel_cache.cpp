@@ -0,0 +1,198 @@
+/*
+ * Copyright (c) 2020, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <gtest/gtest.h>
+#include "imager/oskar_imager.h"
+#include "utility/oskar_dir.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+static void grid_wproj(int type, const char* cache_dir, oskar_Mem* grid)
+{
+    int status = 0, size = 128, num_vis = 20000;
+    double plane_norm = 0.0;
+
+    // Create and set up the imager.
+    oskar_Imager* im = oskar_imager_create(type, &status);
+    oskar_imager_set_algorithm(im, "W-projection", &status);
+    oskar_imager_set_fov(im, 2.0);
+    oskar_imager_set_size(im, size, &status);
+    oskar_imager_set_grid_on_gpu(im, 0);
+    oskar_imager_set_generate_w_kernels_on_gpu(im, 0);
+    oskar_imager_set_w_kernel_cache_dir(im, cache_dir);
+    ASSERT_EQ(0, status);
+
+    // Create visibility data.
+    oskar_Mem* uu = oskar_mem_create(type, OSKAR_CPU, num_vis, &status);
+    oskar_Mem* vv = oskar_mem_create(type, OSKAR_CPU, num_vis, &status);
+    oskar_Mem* ww = oskar_mem_create(type, OSKAR_CPU, num_vis, &status);
+    oskar_Mem* vis = oskar_mem_create(type | OSKAR_COMPLEX, OSKAR_CPU,
+            num_vis, &status);
+    oskar_Mem* weight = oskar_mem_create(type, OSKAR_CPU, num_vis, &status);
+    oskar_mem_random_gaussian(uu, 0, 1, 2, 3, 1000.0, &status);
+    oskar_mem_random_gaussian(vv, 4, 5, 6, 7, 1000.0, &status);
+    oskar_mem_random_gaussian(ww, 8, 9, 10, 11, 100.0, &status);
+    oskar_mem_random_gaussian(vis, 12, 13, 14, 15, 1.0, &status);
+    oskar_mem_random_uniform(weight, 16, 17, 18, 19, &status);
+    ASSERT_EQ(0, status);
+
+    // Scan the coordinates first, to set up W-projection.
+    oskar_imager_set_coords_only(im, 1);
+    oskar_imager_update_plane(im, num_vis, uu, vv, ww, 0, weight,
+            0, 0, 0, 0, &status);
+    oskar_imager_set_coords_only(im, 0);
+
+    // Grid visibility data.
+    oskar_imager_update_plane(im, num_vis, uu, vv, ww, vis, weight,
+            0, grid, &plane_norm, 0, &status);
+    ASSERT_EQ(0, status);
+
+    // Clean up.
+    oskar_imager_free(im, &status);
+    oskar_mem_free(uu, &status);
+    oskar_mem_free(vv, &status);
+    oskar_mem_free(ww, &status);
+    oskar_mem_free(vis, &status);
+    oskar_mem_free(weight, &status);
+}
+
+// Overwrites the second half of the only cache file in the directory
+// with zeros. This is all kernel data, so that a run which loads the
+// cache must grid differently from one which generates the kernels.
+static void damage_cache(const char* cache_dir)
+{
+    int num_items = 0;
+    char** items = 0;
+    oskar_dir_items(cache_dir, "*.bin", 1, 0, &num_items, &items);
+    ASSERT_EQ(1, num_items);
+    char* path = oskar_dir_get_path(cache_dir, items[0]);
+    FILE* file = fopen(path, "r+b");
+    ASSERT_TRUE(file != 0);
+    fseek(file, 0, SEEK_END);
+    const long size = ftell(file);
+    std::vector<char> zeros(size - size / 2, 0);
+    fseek(file, size / 2, SEEK_SET);
+    EXPECT_EQ(zeros.size(), fwrite(&zeros[0], 1, zeros.size(), file));
+    fclose(file);
+    free(path);
+    for (int i = 0; i < num_items; ++i) free(items[i]);
+    free(items);
+}
+
+static double max_diff(const oskar_Mem* x, const oskar_Mem* y)
+{
+    int status = 0;
+    double diff = 0.0;
+    oskar_Mem* a = oskar_mem_convert_precision(x, OSKAR_DOUBLE, &status);
+    oskar_Mem* b = oskar_mem_convert_precision(y, OSKAR_DOUBLE, &status);
+    const double* pa = oskar_mem_double_const(a, &status);
+    const double* pb = oskar_mem_double_const(b, &status);
+    for (size_t i = 0; i < 2 * oskar_mem_length(a); ++i)
+        if (fabs(pa[i] - pb[i]) > diff) diff = fabs(pa[i] - pb[i]);
+    oskar_mem_free(a, &status);
+    oskar_mem_free(b, &status);
+    return diff;
+}
+
+static void compare_cache(int type)
+{
+    int status = 0;
+    const char* cache_dir = "temp_test_w_kernel_cache";
+    oskar_dir_remove(cache_dir);
+    oskar_Mem* grid_ref = oskar_mem_create(type | OSKAR_COMPLEX,
+            OSKAR_CPU, 0, &status);
+    oskar_Mem* grid_save = oskar_mem_create(type | OSKAR_COMPLEX,
+            OSKAR_CPU, 0, &status);
+    oskar_Mem* grid_load = oskar_mem_create(type | OSKAR_COMPLEX,
+            OSKAR_CPU, 0, &status);
+
+    // Grid without the cache, then write and read it.
+    grid_wproj(type, 0, grid_ref);
+    EXPECT_FALSE(oskar_dir_exists(cache_dir));
+    grid_wproj(type, cache_dir, grid_save);
+    EXPECT_TRUE(oskar_dir_exists(cache_dir));
+    grid_wproj(type, cache_dir, grid_load);
+    ASSERT_EQ(oskar_mem_length(grid_ref), oskar_mem_length(grid_save));
+    ASSERT_EQ(oskar_mem_length(grid_ref), oskar_mem_length(grid_load));
+
+    // Kernels loaded from the cache must be identical to generated ones.
+    oskar_Mem* ref = oskar_mem_convert_precision(grid_ref,
+            OSKAR_DOUBLE, &status);
+    oskar_Mem* save = oskar_mem_convert_precision(grid_save,
+            OSKAR_DOUBLE, &status);
+    oskar_Mem* load = oskar_mem_convert_precision(grid_load,
+            OSKAR_DOUBLE, &status);
+    const double* a = oskar_mem_double_const(ref, &status);
+    const double* b = oskar_mem_double_const(save, &status);
+    const double* c = oskar_mem_double_const(load, &status);
+    const size_t num_values = 2 * oskar_mem_length(ref);
+    double max_abs = 0.0, max_diff_save = 0.0, max_diff_load = 0.0;
+    for (size_t i = 0; i < num_values; ++i)
+    {
+        if (fabs(a[i]) > max_abs) max_abs = fabs(a[i]);
+        if (fabs(a[i] - b[i]) > max_diff_save)
+            max_diff_save = fabs(a[i] - b[i]);
+        if (fabs(b[i] - c[i]) > max_diff_load)
+            max_diff_load = fabs(b[i] - c[i]);
+    }
+    EXPECT_GT(max_abs, 0.0);
+    EXPECT_DOUBLE_EQ(0.0, max_diff_save);
+    EXPECT_DOUBLE_EQ(0.0, max_diff_load);
+
+    // Check the kernels really are read from the cache:
+    // damaging the cache file must change the result.
+    oskar_Mem* grid_damaged = oskar_mem_create(type | OSKAR_COMPLEX,
+            OSKAR_CPU, 0, &status);
+    damage_cache(cache_dir);
+    grid_wproj(type, cache_dir, grid_damaged);
+    ASSERT_EQ(oskar_mem_length(grid_ref), oskar_mem_length(grid_damaged));
+    EXPECT_GT(max_diff(grid_save, grid_damaged), 0.0);
+    oskar_mem_free(grid_damaged, &status);
+
+    // Clean up.
+    oskar_dir_remove(cache_dir);
+    oskar_mem_free(ref, &status);
+    oskar_mem_free(save, &status);
+    oskar_mem_free(load, &status);
+    oskar_mem_free(grid_ref, &status);
+    oskar_mem_free(grid_save, &status);
+    oskar_mem_free(grid_load, &status);
+}
+
+TEST(imager, w_kernel_cache_double)
+{
+    compare_cache(OSKAR_DOUBLE);
+}
+
+TEST(imager, w_kernel_cache_single)
+{
+    compare_cache(OSKAR_SINGLE);
+}
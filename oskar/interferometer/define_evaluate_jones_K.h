@@ -73,3 +73,103 @@ OSKAR_REGISTER_KERNEL(NAME)
     KERNEL_LOOP_END\
 }\
 OSKAR_REGISTER_KERNEL(NAME)
+
+#define OSKAR_JONES_K_CHANNELS_ARGS(FP, FP2)\
+        const int       num_channels,\
+        const int       resync_interval,\
+        const int       num_sources,\
+        GLOBAL_IN(FP,   l),\
+        GLOBAL_IN(FP,   m),\
+        GLOBAL_IN(FP,   n),\
+        const int       num_stations,\
+        GLOBAL_IN(FP,   u),\
+        GLOBAL_IN(FP,   v),\
+        GLOBAL_IN(FP,   w),\
+        const FP        wavenumber_start,\
+        const FP        wavenumber_inc,\
+        GLOBAL_IN(FP,   source_filter),\
+        const FP        source_filter_min,\
+        const FP        source_filter_max,\
+        const int       ignore_w_components,\
+        GLOBAL_OUT(FP2, jones)\
+
+/* Between exact evaluations every resync_interval channels, the phase for
+ * each channel is obtained from the previous one by a complex multiply. */
+#define OSKAR_JONES_K_CHANNELS_GPU(NAME, FP, FP2) KERNEL(NAME) (\
+        OSKAR_JONES_K_CHANNELS_ARGS(FP, FP2))\
+{\
+    const int s = GLOBAL_ID_X, a = GLOBAL_ID_Y;\
+    if (s >= num_sources || a >= num_stations) return;\
+    const int stride = num_sources * num_stations;\
+    int c, i_out = s + num_sources * a;\
+    FP phase, amp = (FP) 0;\
+    FP2 val, step;\
+    if (source_filter[s] > source_filter_min &&\
+            source_filter[s] <= source_filter_max) amp = (FP) 1;\
+    phase = u[a] * l[s] + v[a] * m[s];\
+    if (!ignore_w_components) phase += w[a] * (n[s] - (FP)1);\
+    SINCOS(phase * wavenumber_inc, step.y, step.x);\
+    for (c = 0; c < num_channels; ++c, i_out += stride) {\
+        if (c % resync_interval == 0) {\
+            const FP t = phase * (wavenumber_start + c * wavenumber_inc);\
+            SINCOS(t, val.y, val.x);\
+            val.x *= amp; val.y *= amp;\
+        } else {\
+            const FP re = val.x * step.x - val.y * step.y;\
+            val.y = val.x * step.y + val.y * step.x;\
+            val.x = re;\
+        }\
+        jones[i_out] = val;\
+    }\
+}\
+OSKAR_REGISTER_KERNEL(NAME)
+
+/* Sources are processed in tiles, so that the recurrence between channels
+ * is a loop over consecutive sources that the compiler can vectorise.
+ * The output is accessed as an array of reals, as the memory is not
+ * guaranteed to have the alignment given to the complex types. */
+#define OSKAR_JONES_K_CHANNELS_CPU(NAME, TARGET, FP, FP2) TARGET KERNEL(NAME) (\
+        OSKAR_JONES_K_CHANNELS_ARGS(FP, FP2))\
+{\
+    int a, c, s, s0;\
+    FP phase_[JONES_K_SOURCE], amp_[JONES_K_SOURCE];\
+    FP step_re_[JONES_K_SOURCE], step_im_[JONES_K_SOURCE];\
+    const int stride = 2 * num_sources * num_stations;\
+    for (a = 0; a < num_stations; ++a) {\
+        for (s0 = 0; s0 < num_sources; s0 += JONES_K_SOURCE) {\
+            int tile = num_sources - s0;\
+            if (tile > JONES_K_SOURCE) tile = JONES_K_SOURCE;\
+            FP* out = (FP*) (jones + s0 + num_sources * a);\
+            for (s = 0; s < tile; ++s) {\
+                FP phase = u[a] * l[s0 + s] + v[a] * m[s0 + s];\
+                if (!ignore_w_components)\
+                    phase += w[a] * (n[s0 + s] - (FP)1);\
+                const FP f = source_filter[s0 + s];\
+                amp_[s] = (f > source_filter_min &&\
+                        f <= source_filter_max) ? (FP) 1 : (FP) 0;\
+                phase_[s] = phase;\
+                SINCOS(phase * wavenumber_inc, step_im_[s], step_re_[s]);\
+            }\
+            for (c = 0; c < num_channels; ++c, out += stride) {\
+                if (c % resync_interval == 0) {\
+                    const FP k = wavenumber_start + c * wavenumber_inc;\
+                    for (s = 0; s < tile; ++s) {\
+                        FP re, im;\
+                        SINCOS(phase_[s] * k, im, re);\
+                        out[2 * s]     = amp_[s] * re;\
+                        out[2 * s + 1] = amp_[s] * im;\
+                    }\
+                } else {\
+                    const FP* prev = out - stride;\
+                    DO_PRAGMA(omp simd)\
+                    for (s = 0; s < tile; ++s) {\
+                        const FP re = prev[2 * s], im = prev[2 * s + 1];\
+                        out[2 * s]     = re * step_re_[s] - im * step_im_[s];\
+                        out[2 * s + 1] = re * step_im_[s] + im * step_re_[s];\
+                    }\
+                }\
+            }\
+        }\
+    }\
+}\
+OSKAR_REGISTER_KERNEL(NAME)
@@ -76,6 +76,54 @@ void oskar_evaluate_jones_K(oskar_Jones* K, int num_sources,
         double source_filter_min, double source_filter_max,
         int ignore_w_components, int* status);
 
+/**
+ * @brief
+ * Evaluates the interferometer phase (K) Jones term for a range of channels.
+ *
+ * @details
+ * This function evaluates the same values as oskar_evaluate_jones_K()
+ * for \p num_channels uniformly spaced channels at once.
+ *
+ * As the phase changes by the same amount for every channel, the values
+ * for each channel are obtained from the previous channel with a single
+ * complex multiply. The phase is evaluated exactly every few channels to
+ * limit the accumulated rounding error.
+ *
+ * The output array \p K is resized if necessary, and contains
+ * \p num_channels consecutive blocks of size \p num_stations *
+ * \p num_sources. Each block has the same layout as the data in
+ * an oskar_Jones structure.
+ *
+ * The source filter is applied in the same way for every channel.
+ *
+ * @param[out] K                 Output array of complex values.
+ * @param[in]  num_channels      The number of channels to evaluate.
+ * @param[in]  num_stations      The number of stations.
+ * @param[in]  num_sources       The number of sources in the input arrays.
+ * @param[in]  l                 Source l-direction cosines.
+ * @param[in]  m                 Source m-direction cosines.
+ * @param[in]  n                 Source n-direction cosines.
+ * @param[in]  u                 Station u coordinates, in metres.
+ * @param[in]  v                 Station v coordinates, in metres.
+ * @param[in]  w                 Station w coordinates, in metres.
+ * @param[in]  freq_start_hz     The frequency of the first channel, in Hz.
+ * @param[in]  freq_inc_hz       The frequency increment, in Hz.
+ * @param[in]  source_filter     Per-source values used for filtering.
+ * @param[in]  source_filter_min Minimum allowed filter value (exclusive).
+ * @param[in]  source_filter_max Maximum allowed filter value (inclusive).
+ * @param[in]  ignore_w_components If set, ignore station w coordinate values.
+ * @param[in,out] status         Status return code.
+ */
+OSKAR_EXPORT
+void oskar_evaluate_jones_K_channels(oskar_Mem* K, int num_channels,
+        int num_stations, int num_sources,
+        const oskar_Mem* l, const oskar_Mem* m, const oskar_Mem* n,
+        const oskar_Mem* u, const oskar_Mem* v, const oskar_Mem* w,
+        double freq_start_hz, double freq_inc_hz,
+        const oskar_Mem* source_filter,
+        double source_filter_min, double source_filter_max,
+        int ignore_w_components, int* status);
+
 #ifdef __cplusplus
 }
 #endif
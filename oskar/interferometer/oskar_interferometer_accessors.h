@@ -65,6 +65,28 @@ void oskar_interferometer_reset_cache(oskar_Interferometer* h, int* status);
 OSKAR_EXPORT
 void oskar_interferometer_reset_work_unit_index(oskar_Interferometer* h);
 
+/**
+ * @brief
+ * Sets the parameters for baseline-dependent averaging of the output.
+ *
+ * @details
+ * If enabled, the cross-correlations on each baseline are averaged in time
+ * before they are written, until the baseline would move further in the
+ * uvw-plane than allowed by the amplitude loss limit, or until the maximum
+ * averaging time is reached. Only cross-correlations can be averaged.
+ *
+ * See oskar_vis_bda_averager_create() for a description of the parameters.
+ *
+ * @param[in,out] h          Handle to simulator.
+ * @param[in] enable         If true, enable baseline-dependent averaging.
+ * @param[in] max_fact       Maximum allowed amplitude loss factor (> 1).
+ * @param[in] fov_deg        Field of view, in degrees.
+ * @param[in] max_time_sec   Maximum averaging time, in seconds (0 = none).
+ */
+OSKAR_EXPORT
+void oskar_interferometer_set_bda(oskar_Interferometer* h, int enable,
+        double max_fact, double fov_deg, double max_time_sec);
+
 OSKAR_EXPORT
 void oskar_interferometer_set_coords_only(oskar_Interferometer* h, int value,
         int* status);
@@ -99,6 +121,24 @@ void oskar_interferometer_set_max_times_per_block(oskar_Interferometer* h,
 OSKAR_EXPORT
 void oskar_interferometer_set_num_devices(oskar_Interferometer* h, int value);
 
+/**
+ * @brief
+ * Sets the number of visibility blocks that can be held for output.
+ *
+ * @details
+ * Sets the number of visibility blocks that can be held in host memory
+ * while they are waiting to be written, which allows the simulation to
+ * run ahead of file output. Each compute device needs one block of
+ * host memory for each buffer. The value is clamped to the range 2 to 8.
+ * The default is 3.
+ *
+ * @param[in,out] h     Handle to simulator.
+ * @param[in] value     Number of visibility blocks.
+ */
+OSKAR_EXPORT
+void oskar_interferometer_set_num_vis_buffers(oskar_Interferometer* h,
+        int value);
+
 OSKAR_EXPORT
 void oskar_interferometer_set_observation_frequency(oskar_Interferometer* h,
         double start_hz, double inc_hz, int num_channels);
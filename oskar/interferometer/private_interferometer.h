@@ -38,14 +38,24 @@
 #include <telescope/oskar_telescope.h>
 #include <utility/oskar_thread.h>
 #include <utility/oskar_timer.h>
+#include <vis/oskar_vis_bda.h>
 #include <vis/oskar_vis_block.h>
 #include <vis/oskar_vis_header.h>
 
+/* Maximum number of visibility blocks held on the host for output. */
+#define OSKAR_MAX_VIS_BUFFERS 8
+
 /* Memory allocated per compute device (may be either CPU or GPU). */
 struct DeviceData
 {
-    /* Host memory. */
-    oskar_VisBlock* vis_block_cpu[2]; /* On host, for copy back & write. */
+    /* Host memory, for copy back & write. One per buffered block.
+     * For devices other than the first, these are only created if
+     * more than one device can contribute to the same time. */
+    oskar_VisBlock* vis_block_cpu[OSKAR_MAX_VIS_BUFFERS];
+
+    /* Flags set for each time in each buffered block that has been
+     * simulated by this device. */
+    char* times_used;
 
     /* Device memory. */
     int previous_chunk_index;
@@ -55,6 +65,9 @@ struct DeviceData
     oskar_Sky* chunk_clip;      /* Copy of the chunk after horizon clipping. */
     oskar_Telescope* tel;       /* Telescope model, created as a copy. */
     oskar_Jones *J, *R, *E, *K, *Z;
+    oskar_Mem* K_channels;      /* Jones K for a batch of channels. */
+    int K_channel_start;        /* First channel index in K_channels. */
+    int K_num_channels;         /* Number of channels in K_channels. */
     oskar_StationWork* station_work;
 
     /* Timers. */
@@ -74,17 +87,20 @@ struct oskar_Interferometer
     /* Settings. */
     int prec, num_devices, num_gpus_avail, dev_loc, num_gpus, *gpu_ids;
     int num_channels, num_time_steps;
-    int max_sources_per_chunk, max_times_per_block;
+    int max_sources_per_chunk, max_times_per_block, num_vis_buffers;
     int apply_horizon_clip, force_polarised_ms, zero_failed_gaussians;
     int coords_only, ignore_w_components;
     double freq_start_hz, freq_inc_hz, time_start_mjd_utc, time_inc_sec;
     double source_min_jy, source_max_jy;
+    int bda;
+    double bda_max_fact, bda_fov_deg, bda_max_time_sec;
     char correlation_type, *vis_name, *ms_name, *settings_path;
 
     /* State. */
-    int init_sky, work_unit_index;
+    int init_sky;
+    volatile int work_unit_index[OSKAR_MAX_VIS_BUFFERS]; /* Per buffer. */
+    int output_block_index[OSKAR_MAX_VIS_BUFFERS]; /* Per buffer. */
     oskar_Mutex* mutex;
-    oskar_Barrier* barrier;
     oskar_Log* log;
 
     /* Sky model and telescope model. */
@@ -97,8 +113,11 @@ struct oskar_Interferometer
     oskar_MeasurementSet* ms;
     oskar_Binary* vis;
     oskar_Mem *temp, *t_u, *t_v, *t_w;
+    oskar_VisBdaAverager* bda_averager; /* Baseline-dependent averager. */
+    oskar_VisBda* bda_out[OSKAR_MAX_VIS_BUFFERS]; /* Averaged rows. */
     oskar_Timer* tmr_sim;   /* The total time for the simulation. */
-    oskar_Timer* tmr_write; /* The time spent writing vis blocks. */
+    oskar_Timer* tmr_write; /* The time spent writing OSKAR vis blocks. */
+    oskar_Timer* tmr_write_ms; /* The time spent writing MS vis blocks. */
 
     /* Array of DeviceData structures, one per compute device. */
     DeviceData* d;
@@ -108,4 +127,29 @@ struct oskar_Interferometer
 typedef struct oskar_Interferometer oskar_Interferometer;
 #endif
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Returns true if each time in a block is simulated by only one device,
+ * so that devices can write to the output buffer directly. */
+int oskar_interferometer_exclusive_times(const oskar_Interferometer* h);
+
+/* Copies visibility data for a range of times from one block to another. */
+void oskar_interferometer_copy_block_times(oskar_VisBlock* dst,
+        const oskar_VisBlock* src, int time_start, int num_times,
+        int* status);
+
+/* Writes a finalised block to the Measurement Set, if required. */
+void oskar_interferometer_write_block_ms(oskar_Interferometer* h,
+        const oskar_VisBlock* block, int block_index, int* status);
+
+/* Writes a finalised block to the OSKAR visibility file, if required. */
+void oskar_interferometer_write_block_vis(oskar_Interferometer* h,
+        const oskar_VisBlock* block, int block_index, int* status);
+
+#ifdef __cplusplus
+}
+#endif
+
 #endif /* include guard */
@@ -28,6 +28,7 @@
 
 #include "interferometer/define_evaluate_jones_K.h"
 #include "interferometer/oskar_evaluate_jones_K.h"
+#include "utility/oskar_cpu_simd_level.h"
 #include "utility/oskar_device.h"
 #include "utility/oskar_kernel_macros.h"
 
@@ -37,6 +38,36 @@ extern "C" {
 
 OSKAR_JONES_K_CPU(evaluate_jones_K_float, float, float2)
 OSKAR_JONES_K_CPU(evaluate_jones_K_double, double, double2)
+OSKAR_JONES_K_CHANNELS_CPU(evaluate_jones_K_channels_float, , float, float2)
+OSKAR_JONES_K_CHANNELS_CPU(evaluate_jones_K_channels_double, , double, double2)
+#ifdef OSKAR_HAVE_CPU_SIMD
+OSKAR_JONES_K_CHANNELS_CPU(evaluate_jones_K_channels_float_avx2,
+        OSKAR_TARGET_AVX2, float, float2)
+OSKAR_JONES_K_CHANNELS_CPU(evaluate_jones_K_channels_float_avx512,
+        OSKAR_TARGET_AVX512, float, float2)
+OSKAR_JONES_K_CHANNELS_CPU(evaluate_jones_K_channels_double_avx2,
+        OSKAR_TARGET_AVX2, double, double2)
+OSKAR_JONES_K_CHANNELS_CPU(evaluate_jones_K_channels_double_avx512,
+        OSKAR_TARGET_AVX512, double, double2)
+#endif
+
+/* Number of channels between exact evaluations of the phase. */
+#define RESYNC_INTERVAL_SINGLE 8
+#define RESYNC_INTERVAL_DOUBLE 64
+
+#define K_CHANNELS_ARGS(FP, FP2, SUFFIX) num_channels, resync_interval,\
+        num_sources,\
+        oskar_mem_##FP##_const(l, status),\
+        oskar_mem_##FP##_const(m, status),\
+        oskar_mem_##FP##_const(n, status),\
+        num_stations,\
+        oskar_mem_##FP##_const(u, status),\
+        oskar_mem_##FP##_const(v, status),\
+        oskar_mem_##FP##_const(w, status),\
+        wavenumber_start##SUFFIX, wavenumber_inc##SUFFIX,\
+        oskar_mem_##FP##_const(source_filter, status),\
+        source_filter_min##SUFFIX, source_filter_max##SUFFIX,\
+        ignore_w_components, oskar_mem_##FP2(K, status)
 
 void oskar_evaluate_jones_K(oskar_Jones* K, int num_sources,
         const oskar_Mem* l, const oskar_Mem* m, const oskar_Mem* n,
@@ -159,6 +190,139 @@ void oskar_evaluate_jones_K(oskar_Jones* K, int num_sources,
     }
 }
 
+void oskar_evaluate_jones_K_channels(oskar_Mem* K, int num_channels,
+        int num_stations, int num_sources,
+        const oskar_Mem* l, const oskar_Mem* m, const oskar_Mem* n,
+        const oskar_Mem* u, const oskar_Mem* v, const oskar_Mem* w,
+        double freq_start_hz, double freq_inc_hz,
+        const oskar_Mem* source_filter,
+        double source_filter_min, double source_filter_max,
+        int ignore_w_components, int* status)
+{
+    if (*status) return;
+    const int type = oskar_mem_type(K);
+    const int precision = oskar_type_precision(type);
+    const int location = oskar_mem_location(K);
+    const int is_dbl = (type == OSKAR_DOUBLE_COMPLEX);
+    const int resync_interval = is_dbl ?
+            RESYNC_INTERVAL_DOUBLE : RESYNC_INTERVAL_SINGLE;
+    const double wavenumber_start = 2.0 * M_PI * freq_start_hz / 299792458.0;
+    const double wavenumber_inc = 2.0 * M_PI * freq_inc_hz / 299792458.0;
+    const float wavenumber_start_f = (float) wavenumber_start;
+    const float wavenumber_inc_f = (float) wavenumber_inc;
+    const float source_filter_min_f = (float) source_filter_min;
+    const float source_filter_max_f = (float) source_filter_max;
+    if (oskar_mem_location(l) != location ||
+            oskar_mem_location(m) != location ||
+            oskar_mem_location(n) != location ||
+            oskar_mem_location(source_filter) != location ||
+            oskar_mem_location(u) != location ||
+            oskar_mem_location(v) != location ||
+            oskar_mem_location(w) != location)
+    {
+        *status = OSKAR_ERR_LOCATION_MISMATCH;
+        return;
+    }
+    if (precision != oskar_mem_type(l) || precision != oskar_mem_type(m) ||
+            precision != oskar_mem_type(n) || precision != oskar_mem_type(u) ||
+            precision != oskar_mem_type(v) || precision != oskar_mem_type(w) ||
+            precision != oskar_mem_type(source_filter))
+    {
+        *status = OSKAR_ERR_TYPE_MISMATCH;
+        return;
+    }
+    if (type != OSKAR_SINGLE_COMPLEX && type != OSKAR_DOUBLE_COMPLEX)
+    {
+        *status = OSKAR_ERR_BAD_DATA_TYPE;
+        return;
+    }
+    oskar_mem_ensure(K,
+            (size_t) num_channels * num_stations * num_sources, status);
+    if (*status || num_channels == 0) return;
+    if (location == OSKAR_CPU)
+    {
+#ifdef OSKAR_HAVE_CPU_SIMD
+        const int simd_level = oskar_cpu_simd_level();
+        if (is_dbl)
+        {
+            if (simd_level >= OSKAR_CPU_SIMD_AVX512)
+                evaluate_jones_K_channels_double_avx512(
+                        K_CHANNELS_ARGS(double, double2, ));
+            else if (simd_level == OSKAR_CPU_SIMD_AVX2)
+                evaluate_jones_K_channels_double_avx2(
+                        K_CHANNELS_ARGS(double, double2, ));
+            else
+                evaluate_jones_K_channels_double(
+                        K_CHANNELS_ARGS(double, double2, ));
+        }
+        else
+        {
+            if (simd_level >= OSKAR_CPU_SIMD_AVX512)
+                evaluate_jones_K_channels_float_avx512(
+                        K_CHANNELS_ARGS(float, float2, _f));
+            else if (simd_level == OSKAR_CPU_SIMD_AVX2)
+                evaluate_jones_K_channels_float_avx2(
+                        K_CHANNELS_ARGS(float, float2, _f));
+            else
+                evaluate_jones_K_channels_float(
+                        K_CHANNELS_ARGS(float, float2, _f));
+        }
+#else
+        if (is_dbl)
+            evaluate_jones_K_channels_double(
+                    K_CHANNELS_ARGS(double, double2, ));
+        else
+            evaluate_jones_K_channels_float(
+                    K_CHANNELS_ARGS(float, float2, _f));
+#endif
+    }
+    else
+    {
+        size_t local_size[] = {JONES_K_SOURCE, JONES_K_STATION, 1};
+        size_t global_size[] = {1, 1, 1};
+        const char* k = is_dbl ?
+                "evaluate_jones_K_channels_double" :
+                "evaluate_jones_K_channels_float";
+        if (oskar_device_is_cpu(location))
+            local_size[1] = 1;
+        oskar_device_check_local_size(location, 0, local_size);
+        oskar_device_check_local_size(location, 1, local_size);
+        global_size[0] = oskar_device_global_size(
+                (size_t) num_sources, local_size[0]);
+        global_size[1] = oskar_device_global_size(
+                (size_t) num_stations, local_size[1]);
+        const oskar_Arg args[] = {
+                {INT_SZ, &num_channels},
+                {INT_SZ, &resync_interval},
+                {INT_SZ, &num_sources},
+                {PTR_SZ, oskar_mem_buffer_const(l)},
+                {PTR_SZ, oskar_mem_buffer_const(m)},
+                {PTR_SZ, oskar_mem_buffer_const(n)},
+                {INT_SZ, &num_stations},
+                {PTR_SZ, oskar_mem_buffer_const(u)},
+                {PTR_SZ, oskar_mem_buffer_const(v)},
+                {PTR_SZ, oskar_mem_buffer_const(w)},
+                {is_dbl ? DBL_SZ : FLT_SZ, is_dbl ?
+                        (const void*)&wavenumber_start :
+                        (const void*)&wavenumber_start_f},
+                {is_dbl ? DBL_SZ : FLT_SZ, is_dbl ?
+                        (const void*)&wavenumber_inc :
+                        (const void*)&wavenumber_inc_f},
+                {PTR_SZ, oskar_mem_buffer_const(source_filter)},
+                {is_dbl ? DBL_SZ : FLT_SZ, is_dbl ?
+                        (const void*)&source_filter_min :
+                        (const void*)&source_filter_min_f},
+                {is_dbl ? DBL_SZ : FLT_SZ, is_dbl ?
+                        (const void*)&source_filter_max :
+                        (const void*)&source_filter_max_f},
+                {INT_SZ, &ignore_w_components},
+                {PTR_SZ, oskar_mem_buffer(K)}
+        };
+        oskar_device_launch_kernel(k, location, 2, local_size, global_size,
+                sizeof(args) / sizeof(oskar_Arg), args, 0, 0, status);
+    }
+}
+
 #ifdef __cplusplus
 }
 #endif
@@ -67,7 +67,18 @@ int oskar_interferometer_num_vis_blocks(const oskar_Interferometer* h)
 
 void oskar_interferometer_reset_work_unit_index(oskar_Interferometer* h)
 {
-    h->work_unit_index = 0;
+    int i;
+    for (i = 0; i < OSKAR_MAX_VIS_BUFFERS; ++i)
+        h->work_unit_index[i] = 0;
+}
+
+void oskar_interferometer_set_bda(oskar_Interferometer* h, int enable,
+        double max_fact, double fov_deg, double max_time_sec)
+{
+    h->bda = enable;
+    h->bda_max_fact = max_fact;
+    h->bda_fov_deg = fov_deg;
+    h->bda_max_time_sec = max_time_sec;
 }
 
 void oskar_interferometer_set_coords_only(oskar_Interferometer* h, int value,
@@ -159,6 +170,17 @@ void oskar_interferometer_set_max_times_per_block(oskar_Interferometer* h,
     h->max_times_per_block = value;
 }
 
+void oskar_interferometer_set_num_vis_buffers(oskar_Interferometer* h,
+        int value)
+{
+    int status = 0;
+    if (value < 2) value = 2;
+    if (value > OSKAR_MAX_VIS_BUFFERS) value = OSKAR_MAX_VIS_BUFFERS;
+    if (value == h->num_vis_buffers) return;
+    oskar_interferometer_free_device_data(h, &status);
+    h->num_vis_buffers = value;
+}
+
 void oskar_interferometer_set_num_devices(oskar_Interferometer* h, int value)
 {
     int status = 0;
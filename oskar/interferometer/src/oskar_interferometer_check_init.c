@@ -165,6 +165,25 @@ static void set_up_vis_header(oskar_Interferometer* h, int* status)
     oskar_mem_copy(oskar_vis_header_station_z_offset_ecef_metres(h->header),
             oskar_telescope_station_true_offset_ecef_metres_const(h->tel, 2),
             status);
+
+    /* Set up baseline-dependent averaging if required. */
+    if (h->bda && !*status)
+    {
+        if (write_autocorr)
+        {
+            oskar_log_error(h->log, "Baseline-dependent averaging can only "
+                    "be used with cross-correlations.");
+            *status = OSKAR_ERR_SETUP_FAIL;
+            return;
+        }
+        oskar_vis_header_set_bda(h->header, 1);
+        h->bda_averager = oskar_vis_bda_averager_create(h->header,
+                h->bda_max_fact, h->bda_fov_deg, h->bda_max_time_sec, status);
+        if (!*status)
+            oskar_log_message(h->log, 'M', 0, "Baseline-dependent averaging "
+                    "enabled (max. uvw change %.3f m).",
+                    oskar_vis_bda_averager_max_duvw_metres(h->bda_averager));
+    }
 }
 
 
@@ -178,7 +197,7 @@ typedef struct ThreadArgs ThreadArgs;
 
 static void* init_device(void* arg)
 {
-    int dev_loc, vistype, *status;
+    int dev_loc, vistype, j, *status;
     ThreadArgs* a = (ThreadArgs*)arg;
     oskar_Interferometer* h = a->h;
     DeviceData* d = a->d;
@@ -216,19 +235,23 @@ static void* init_device(void* arg)
         d->tmr_correlate = oskar_timer_create(dev_loc);
     }
 
-    /* Visibility blocks. */
+    /* Visibility blocks.
+     * Host blocks for the other devices are created when needed. */
     if (!d->vis_block)
     {
         d->vis_block = oskar_vis_block_create_from_header(dev_loc,
                 h->header, status);
-        d->vis_block_cpu[0] = oskar_vis_block_create_from_header(OSKAR_CPU,
-                h->header, status);
-        d->vis_block_cpu[1] = oskar_vis_block_create_from_header(OSKAR_CPU,
-                h->header, status);
+        if (i == 0)
+            for (j = 0; j < h->num_vis_buffers; ++j)
+                d->vis_block_cpu[j] = oskar_vis_block_create_from_header(
+                        OSKAR_CPU, h->header, status);
+        d->times_used = (char*) calloc(OSKAR_MAX_VIS_BUFFERS *
+                oskar_vis_header_max_times_per_block(h->header), 1);
     }
     oskar_vis_block_clear(d->vis_block, status);
-    oskar_vis_block_clear(d->vis_block_cpu[0], status);
-    oskar_vis_block_clear(d->vis_block_cpu[1], status);
+    for (j = 0; j < h->num_vis_buffers; ++j)
+        if (d->vis_block_cpu[j])
+            oskar_vis_block_clear(d->vis_block_cpu[j], status);
 
     /* Device scratch memory. */
     if (!d->tel)
@@ -247,6 +270,8 @@ static void* init_device(void* arg)
                 status);
         d->K = oskar_jones_create(complx, dev_loc, num_stations, num_src,
                 status);
+        d->K_channels = oskar_mem_create(complx, dev_loc, 0, status);
+        d->K_num_channels = 0;
         d->Z = 0;
         d->station_work = oskar_station_work_create(h->prec, dev_loc, status);
         oskar_station_work_set_tec_screen_common_params(d->station_work,
@@ -274,6 +299,10 @@ static void set_up_device_data(oskar_Interferometer* h, int* status)
     if (h->num_devices < h->num_gpus)
         oskar_interferometer_set_num_devices(h, h->num_gpus);
 
+    /* No output buffers have been prepared yet. */
+    for (i = 0; i < OSKAR_MAX_VIS_BUFFERS; ++i)
+        h->output_block_index[i] = -1;
+
     /* Set up devices in parallel. */
     const int num_devices = h->num_devices;
     threads = (oskar_Thread**) calloc(num_devices, sizeof(oskar_Thread*));
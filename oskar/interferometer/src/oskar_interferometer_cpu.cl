@@ -1,3 +1,4 @@
 /* Copyright (c) 2018-2019, The University of Oxford. See LICENSE file. */
 
 OSKAR_JONES_K_CPU( M_CAT(evaluate_jones_K_, Real), Real, Real2)
+OSKAR_JONES_K_CHANNELS_GPU( M_CAT(evaluate_jones_K_channels_, Real), Real, Real2)
@@ -44,12 +44,12 @@ oskar_Interferometer* oskar_interferometer_create(int precision, int* status)
     h->prec      = precision;
     h->tmr_sim   = oskar_timer_create(OSKAR_TIMER_NATIVE);
     h->tmr_write = oskar_timer_create(OSKAR_TIMER_NATIVE);
+    h->tmr_write_ms = oskar_timer_create(OSKAR_TIMER_NATIVE);
     h->temp      = oskar_mem_create(precision, OSKAR_CPU, 0, status);
     h->t_u       = oskar_mem_create(precision, OSKAR_CPU, 0, status);
     h->t_v       = oskar_mem_create(precision, OSKAR_CPU, 0, status);
     h->t_w       = oskar_mem_create(precision, OSKAR_CPU, 0, status);
     h->mutex     = oskar_mutex_create();
-    h->barrier   = oskar_barrier_create(0);
     h->log       = oskar_log_create(OSKAR_LOG_MESSAGE, OSKAR_LOG_WARNING);
 
     /* Get number of devices available, and device location. */
@@ -64,6 +64,8 @@ oskar_Interferometer* oskar_interferometer_create(int precision, int* status)
     oskar_interferometer_set_horizon_clip(h, 1);
     oskar_interferometer_set_source_flux_range(h, -DBL_MAX, DBL_MAX);
     oskar_interferometer_set_max_times_per_block(h, 8);
+    oskar_interferometer_set_num_vis_buffers(h, 3);
+    oskar_interferometer_set_bda(h, 0, 1.01, 1.0, 0.0);
     return h;
 }
 
@@ -150,8 +150,12 @@ static void record_timing(oskar_Interferometer* h)
     for (i = 0; i < h->num_devices; ++i)
         oskar_log_value(h->log, 'M', 0, "Compute", "%.3f s [Device %i]",
                 compute_times[i], i);
-    oskar_log_value(h->log, 'M', 0, "Write", "%.3f s",
-            oskar_timer_elapsed(h->tmr_write));
+    if (h->vis_name)
+        oskar_log_value(h->log, 'M', 0, "Write", "%.3f s",
+                oskar_timer_elapsed(h->tmr_write));
+    if (h->ms_name)
+        oskar_log_value(h->log, 'M', 0, "Write (Measurement Set)", "%.3f s",
+                oskar_timer_elapsed(h->tmr_write_ms));
     oskar_log_message(h->log, 'M', 0, "Compute components:");
     oskar_log_value(h->log, 'M', 1, "Copy", "%4.1f%%",
             (t_copy / t_compute) * 100.0);
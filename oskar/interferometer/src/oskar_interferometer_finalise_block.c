@@ -39,37 +39,25 @@
 extern "C" {
 #endif
 
+static void combine_devices(oskar_Interferometer* h, int i_buffer,
+        int* status);
+static void add_times(oskar_VisBlock* dst, const oskar_VisBlock* src,
+        int time_index, int* status);
+static void clear_times(oskar_VisBlock* dst, int time_index, int* status);
 static unsigned int disp_width(unsigned int v);
 
 oskar_VisBlock* oskar_interferometer_finalise_block(oskar_Interferometer* h,
         int block_index, int* status)
 {
-    int i, i_active;
-    oskar_VisBlock *b0 = 0, *b = 0;
+    int i_buffer;
+    oskar_VisBlock *b0 = 0;
     if (*status) return 0;
 
-    /* The visibilities must be copied back
-     * at the end of the block simulation. */
-
-    /* Combine all vis blocks into the first one. */
-    i_active = (block_index + 1) % 2;
-    b0 = h->d[0].vis_block_cpu[!i_active];
+    /* Combine the visibilities from all devices into the first block. */
+    i_buffer = block_index % h->num_vis_buffers;
+    b0 = h->d[0].vis_block_cpu[i_buffer];
     if (!h->coords_only)
-    {
-        oskar_Mem *xc0 = 0, *ac0 = 0;
-        xc0 = oskar_vis_block_cross_correlations(b0);
-        ac0 = oskar_vis_block_auto_correlations(b0);
-        for (i = 1; i < h->num_devices; ++i)
-        {
-            b = h->d[i].vis_block_cpu[!i_active];
-            if (oskar_vis_block_has_cross_correlations(b))
-                oskar_mem_add(xc0, xc0, oskar_vis_block_cross_correlations(b),
-                        0, 0, 0, oskar_mem_length(xc0), status);
-            if (oskar_vis_block_has_auto_correlations(b))
-                oskar_mem_add(ac0, ac0, oskar_vis_block_auto_correlations(b),
-                        0, 0, 0, oskar_mem_length(ac0), status);
-        }
-    }
+        combine_devices(h, i_buffer, status);
 
     /* Calculate baseline uvw coordinates for the block. */
     if (oskar_vis_block_has_cross_correlations(b0))
@@ -97,6 +85,20 @@ oskar_VisBlock* oskar_interferometer_finalise_block(oskar_Interferometer* h,
         oskar_vis_block_add_system_noise(b0, h->header, h->tel,
                 block_index, h->temp, status);
 
+    /* Average the cross-correlations for output, if required.
+     * Blocks are finalised in order, so the averages can span blocks. */
+    if (h->bda_averager)
+    {
+        const int num_blocks = oskar_interferometer_num_vis_blocks(h);
+        if (block_index == 0)
+            oskar_vis_bda_averager_reset(h->bda_averager);
+        if (!h->bda_out[i_buffer])
+            h->bda_out[i_buffer] = oskar_vis_bda_create_from_header(
+                    h->header, status);
+        oskar_vis_bda_averager_add_block(h->bda_averager, b0,
+                block_index == num_blocks - 1, h->bda_out[i_buffer], status);
+    }
+
     /* Print status message. */
     if (!*status)
     {
@@ -112,6 +114,138 @@ oskar_VisBlock* oskar_interferometer_finalise_block(oskar_Interferometer* h,
     return b0;
 }
 
+int oskar_interferometer_exclusive_times(const oskar_Interferometer* h)
+{
+    /* A work unit is one time and one sky chunk, so if there is only
+     * one sky chunk, each time in a block is simulated by one device. */
+    return h->num_sky_chunks <= 1;
+}
+
+void oskar_interferometer_copy_block_times(oskar_VisBlock* dst,
+        const oskar_VisBlock* src, int time_start, int num_times,
+        int* status)
+{
+    const size_t num_channels = (size_t) oskar_vis_block_num_channels(src);
+    if (oskar_vis_block_has_cross_correlations(src))
+    {
+        const size_t n = num_channels * oskar_vis_block_num_baselines(src);
+        oskar_mem_copy_contents(oskar_vis_block_cross_correlations(dst),
+                oskar_vis_block_cross_correlations_const(src),
+                time_start * n, time_start * n, num_times * n, status);
+    }
+    if (oskar_vis_block_has_auto_correlations(src))
+    {
+        const size_t n = num_channels * oskar_vis_block_num_stations(src);
+        oskar_mem_copy_contents(oskar_vis_block_auto_correlations(dst),
+                oskar_vis_block_auto_correlations_const(src),
+                time_start * n, time_start * n, num_times * n, status);
+    }
+}
+
+static void combine_devices(oskar_Interferometer* h, int i_buffer,
+        int* status)
+{
+    int i, j, t, stride, num_tasks;
+    oskar_VisBlock* b0 = h->d[0].vis_block_cpu[i_buffer];
+    const int exclusive = oskar_interferometer_exclusive_times(h);
+    const int num_devices = h->num_devices;
+    const int num_times = oskar_vis_block_num_times(b0);
+    const int max_times = oskar_vis_header_max_times_per_block(h->header);
+    if (*status) return;
+
+    /* Find the devices that simulated each time in the block. */
+    int* num_used = (int*) calloc(num_times, sizeof(int));
+    int* used_by = (int*) calloc(num_times * num_devices, sizeof(int));
+    int* tasks = (int*) calloc(num_times * num_devices, sizeof(int));
+    oskar_VisBlock** blocks = (oskar_VisBlock**) calloc(
+            num_devices, sizeof(oskar_VisBlock*));
+    for (i = 0; i < num_devices; ++i)
+    {
+        const char* times_used =
+                h->d[i].times_used + i_buffer * max_times;
+        blocks[i] = i == 0 ? b0 : h->d[i].vis_block_cpu[i_buffer];
+        for (t = 0; t < num_times; ++t)
+            if (times_used[t])
+                used_by[t * num_devices + num_used[t]++] = i;
+    }
+
+    /* Sum the data for each time over the devices that simulated it,
+     * using a pairwise tree. The additions at each level are independent,
+     * so they are done in parallel. Each result ends up in the block
+     * of the first device in the list. */
+    for (stride = 1; !exclusive && stride < num_devices; stride *= 2)
+    {
+        for (num_tasks = 0, t = 0; t < num_times; ++t)
+            for (i = 0; i + stride < num_used[t]; i += 2 * stride)
+                tasks[num_tasks++] = t * num_devices + i;
+        if (num_tasks == 0) break;
+#pragma omp parallel for private(i, t) num_threads(num_devices)
+        for (j = 0; j < num_tasks; ++j)
+        {
+            t = tasks[j] / num_devices;
+            i = tasks[j];
+            add_times(blocks[used_by[i]], blocks[used_by[i + stride]],
+                    t, status);
+        }
+    }
+
+    /* Copy each result to the output block, if it is not already there,
+     * and clear any times that no device simulated. */
+#pragma omp parallel for private(i) num_threads(num_devices)
+    for (t = 0; t < num_times; ++t)
+    {
+        i = used_by[t * num_devices];
+        if (num_used[t] == 0)
+            clear_times(b0, t, status);
+        else if (!exclusive && i != 0)
+            oskar_interferometer_copy_block_times(b0, blocks[i], t, 1, status);
+    }
+    free(num_used);
+    free(used_by);
+    free(tasks);
+    free(blocks);
+}
+
+static void add_times(oskar_VisBlock* dst, const oskar_VisBlock* src,
+        int time_index, int* status)
+{
+    oskar_Mem *out;
+    const size_t num_channels = (size_t) oskar_vis_block_num_channels(dst);
+    if (oskar_vis_block_has_cross_correlations(dst))
+    {
+        const size_t n = num_channels * oskar_vis_block_num_baselines(dst);
+        const size_t offset = time_index * n;
+        out = oskar_vis_block_cross_correlations(dst);
+        oskar_mem_add(out, out, oskar_vis_block_cross_correlations_const(src),
+                offset, offset, offset, n, status);
+    }
+    if (oskar_vis_block_has_auto_correlations(dst))
+    {
+        const size_t n = num_channels * oskar_vis_block_num_stations(dst);
+        const size_t offset = time_index * n;
+        out = oskar_vis_block_auto_correlations(dst);
+        oskar_mem_add(out, out, oskar_vis_block_auto_correlations_const(src),
+                offset, offset, offset, n, status);
+    }
+}
+
+static void clear_times(oskar_VisBlock* dst, int time_index, int* status)
+{
+    const size_t num_channels = (size_t) oskar_vis_block_num_channels(dst);
+    if (oskar_vis_block_has_cross_correlations(dst))
+    {
+        const size_t n = num_channels * oskar_vis_block_num_baselines(dst);
+        oskar_mem_set_value_real(oskar_vis_block_cross_correlations(dst),
+                0.0, time_index * n, n, status);
+    }
+    if (oskar_vis_block_has_auto_correlations(dst))
+    {
+        const size_t n = num_channels * oskar_vis_block_num_stations(dst);
+        oskar_mem_set_value_real(oskar_vis_block_auto_correlations(dst),
+                0.0, time_index * n, n, status);
+    }
+}
+
 static unsigned int disp_width(unsigned int v)
 {
     return (v >= 100000u) ? 6 : (v >= 10000u) ? 5 : (v >= 1000u) ? 4 :
@@ -51,8 +51,8 @@ void oskar_interferometer_free(oskar_Interferometer* h, int* status)
     oskar_mem_free(h->t_w, status);
     oskar_timer_free(h->tmr_sim);
     oskar_timer_free(h->tmr_write);
+    oskar_timer_free(h->tmr_write_ms);
     oskar_mutex_free(h->mutex);
-    oskar_barrier_free(h->barrier);
     oskar_log_free(h->log);
     free(h->sky_chunks);
     free(h->gpu_ids);
@@ -65,7 +65,7 @@ void oskar_interferometer_free(oskar_Interferometer* h, int* status)
 
 void oskar_interferometer_free_device_data(oskar_Interferometer* h, int* status)
 {
-    int i;
+    int i, j;
     if (!h->d) return;
     for (i = 0; i < h->num_devices; ++i)
     {
@@ -80,9 +80,10 @@ void oskar_interferometer_free_device_data(oskar_Interferometer* h, int* status)
         oskar_timer_free(d->tmr_K);
         oskar_timer_free(d->tmr_join);
         oskar_timer_free(d->tmr_correlate);
-        oskar_vis_block_free(d->vis_block_cpu[0], status);
-        oskar_vis_block_free(d->vis_block_cpu[1], status);
+        for (j = 0; j < OSKAR_MAX_VIS_BUFFERS; ++j)
+            oskar_vis_block_free(d->vis_block_cpu[j], status);
         oskar_vis_block_free(d->vis_block, status);
+        free(d->times_used);
         oskar_mem_free(d->u, status);
         oskar_mem_free(d->v, status);
         oskar_mem_free(d->w, status);
@@ -93,6 +94,7 @@ void oskar_interferometer_free_device_data(oskar_Interferometer* h, int* status)
         oskar_jones_free(d->J, status);
         oskar_jones_free(d->E, status);
         oskar_jones_free(d->K, status);
+        oskar_mem_free(d->K_channels, status);
         oskar_jones_free(d->R, status);
         memset(d, 0, sizeof(DeviceData));
     }
@@ -100,7 +102,15 @@ void oskar_interferometer_free_device_data(oskar_Interferometer* h, int* status)
 
 void oskar_interferometer_reset_cache(oskar_Interferometer* h, int* status)
 {
+    int i;
     oskar_interferometer_free_device_data(h, status);
+    oskar_vis_bda_averager_free(h->bda_averager, status);
+    for (i = 0; i < OSKAR_MAX_VIS_BUFFERS; ++i)
+    {
+        oskar_vis_bda_free(h->bda_out[i], status);
+        h->bda_out[i] = 0;
+    }
+    h->bda_averager = 0;
     oskar_binary_free(h->vis);
     oskar_vis_header_free(h->header, status);
 #ifndef OSKAR_NO_MS
@@ -39,24 +39,48 @@
 extern "C" {
 #endif
 
+/* Progress of the simulation, shared by all threads. */
+struct Schedule
+{
+    oskar_ConditionVar* var;
+    int num_blocks_finalised; /* Number of blocks ready to be written. */
+    int num_blocks_written;   /* Number of blocks written to all outputs. */
+    int* num_devices_done;    /* Number of devices finished, per block. */
+    int num_writers;          /* Number of output writer threads. */
+    int num_written[2];       /* Number of blocks written, per writer. */
+};
+typedef struct Schedule Schedule;
+
 struct ThreadArgs
 {
     oskar_Interferometer* h;
-    DeviceData* d;
-    int num_threads, thread_id, *status;
+    Schedule* schedule;
+    int num_devices, thread_id, *status;
 };
 typedef struct ThreadArgs ThreadArgs;
 
+static void write_block(oskar_Interferometer* h, int writer_id,
+        const oskar_VisBlock* block, int block_index, int* status)
+{
+    /* Writer 0 writes the OSKAR visibility file if there is one,
+     * otherwise the Measurement Set. */
+    if (writer_id == 0 && h->vis_name)
+        oskar_interferometer_write_block_vis(h, block, block_index, status);
+    else
+        oskar_interferometer_write_block_ms(h, block, block_index, status);
+}
+
 static void* run_blocks(void* arg)
 {
     oskar_Interferometer* h;
-    int b, thread_id, device_id, num_blocks, num_threads, *status;
+    Schedule* schedule;
+    int b, thread_id, num_blocks, num_buffers, num_devices, *status;
 
     /* Get thread function arguments. */
     h = ((ThreadArgs*)arg)->h;
-    num_threads = ((ThreadArgs*)arg)->num_threads;
+    schedule = ((ThreadArgs*)arg)->schedule;
+    num_devices = ((ThreadArgs*)arg)->num_devices;
     thread_id = ((ThreadArgs*)arg)->thread_id;
-    device_id = thread_id - 1;
     status = ((ThreadArgs*)arg)->status;
 
 #ifdef _OPENMP
@@ -67,36 +91,95 @@ static void* run_blocks(void* arg)
 
     /* Loop over blocks of observation time, running simulation and file
      * writing one block at a time. Simulation and file output are overlapped
-     * by using double buffering, and a dedicated thread is used for file
-     * output.
+     * by using a ring of host buffers, one for each block in flight.
      *
-     * Thread 0 is used for file writes.
+     * Thread 0 combines the results from all devices (finalises the block).
      * Threads 1 to n (mapped to compute devices) do the simulation.
+     * The remaining threads write the blocks, one thread for each output
+     * file, so that Measurement Set and OSKAR visibility file output
+     * proceed concurrently.
      *
-     * Note that no write is launched on the first loop counter (as no
-     * data are ready yet) and no simulation is performed for the last loop
-     * counter (which corresponds to the last block + 1) as this iteration
-     * simply writes the last block.
+     * There is no barrier between blocks. Work units within a block are
+     * claimed by each device using an atomic counter, so faster devices
+     * simply process more of them. When a device runs out of work in one
+     * block, it moves on to the next block as soon as its host buffer is
+     * free (when the block that last used it has been written to all
+     * outputs), while other devices finish their work units in the
+     * previous block. The finalising thread waits for all devices to finish
+     * each block, and each writer thread waits for blocks to be finalised.
      */
     num_blocks = oskar_interferometer_num_vis_blocks(h);
-    for (b = 0; b < num_blocks + 1; ++b)
+    num_buffers = h->num_vis_buffers;
+    if (thread_id > 0 && thread_id <= num_devices)
     {
-        if ((thread_id > 0 || num_threads == 1) && b < num_blocks)
-            oskar_interferometer_run_block(h, b, device_id, status);
-        if (thread_id == 0 && b > 0)
+        for (b = 0; b < num_blocks; ++b)
         {
-            oskar_VisBlock* block;
-            block = oskar_interferometer_finalise_block(h, b - 1, status);
-            oskar_interferometer_write_block(h, block, b - 1, status);
+            /* Wait until the host buffer for this block is free. */
+            oskar_condition_lock(schedule->var);
+            while (schedule->num_blocks_written < b - (num_buffers - 1))
+                oskar_condition_wait(schedule->var);
+            oskar_condition_unlock(schedule->var);
+
+            /* Simulate all the work units this device can get. */
+            oskar_interferometer_run_block(h, b, thread_id - 1, status);
+
+            /* Tell the finalising thread this device has finished. */
+            oskar_condition_lock(schedule->var);
+            schedule->num_devices_done[b]++;
+            oskar_condition_notify_all(schedule->var);
+            oskar_condition_unlock(schedule->var);
         }
+    }
+    else if (thread_id == 0)
+    {
+        for (b = 0; b < num_blocks; ++b)
+        {
+            /* Wait for all devices to finish the block. */
+            oskar_condition_lock(schedule->var);
+            while (schedule->num_devices_done[b] < num_devices)
+                oskar_condition_wait(schedule->var);
 
-        /* Barrier 1: Reset work unit index and print status. */
-        oskar_barrier_wait(h->barrier);
-        if (thread_id == 0)
-            oskar_interferometer_reset_work_unit_index(h);
+            /* No device will use this work unit counter again until the
+             * buffer has been written, so it can be reset now. */
+            h->work_unit_index[b % num_buffers] = 0;
+            oskar_condition_unlock(schedule->var);
 
-        /* Barrier 2: Synchronise before moving to the next block. */
-        oskar_barrier_wait(h->barrier);
+            /* Combine the block, and let the writers have it. */
+            oskar_interferometer_finalise_block(h, b, status);
+            oskar_condition_lock(schedule->var);
+            schedule->num_blocks_finalised = b + 1;
+            oskar_condition_notify_all(schedule->var);
+            oskar_condition_unlock(schedule->var);
+        }
+    }
+    else
+    {
+        const int writer_id = thread_id - num_devices - 1;
+        for (b = 0; b < num_blocks; ++b)
+        {
+            int i, num_written;
+
+            /* Wait for the block to be finalised. */
+            oskar_condition_lock(schedule->var);
+            while (schedule->num_blocks_finalised <= b)
+                oskar_condition_wait(schedule->var);
+            oskar_condition_unlock(schedule->var);
+
+            /* Write the block. */
+            write_block(h, writer_id,
+                    h->d[0].vis_block_cpu[b % num_buffers], b, status);
+
+            /* Release the buffer once all writers have finished with it. */
+            oskar_condition_lock(schedule->var);
+            schedule->num_written[writer_id] = b + 1;
+            num_written = b + 1;
+            for (i = 0; i < schedule->num_writers; ++i)
+                if (schedule->num_written[i] < num_written)
+                    num_written = schedule->num_written[i];
+            schedule->num_blocks_written = num_written;
+            oskar_condition_notify_all(schedule->var);
+            oskar_condition_unlock(schedule->var);
+        }
     }
     return 0;
 }
@@ -107,6 +190,7 @@ void oskar_interferometer_run(oskar_Interferometer* h, int* status)
     int i;
     oskar_Thread** threads = 0;
     ThreadArgs* args = 0;
+    Schedule schedule;
     if (*status || !h) return;
 
     /* Check the visibilities are going somewhere. */
@@ -129,15 +213,27 @@ void oskar_interferometer_run(oskar_Interferometer* h, int* status)
     /* Initialise if required. */
     oskar_interferometer_check_init(h, status);
 
-    /* Set up worker threads. */
-    const int num_threads = h->num_devices + 1;
-    oskar_barrier_set_num_threads(h->barrier, num_threads);
+    /* Set up worker threads: one to finalise blocks, one per device,
+     * and one per output file. */
+    schedule.var = oskar_condition_create();
+    schedule.num_blocks_finalised = 0;
+    schedule.num_blocks_written = 0;
+    schedule.num_devices_done = (int*) calloc(
+            oskar_interferometer_num_vis_blocks(h), sizeof(int));
+    schedule.num_writers = 0;
+    schedule.num_written[0] = schedule.num_written[1] = 0;
+    if (h->vis_name) schedule.num_writers++;
+#ifndef OSKAR_NO_MS
+    if (h->ms_name) schedule.num_writers++;
+#endif
+    const int num_threads = 1 + h->num_devices + schedule.num_writers;
     threads = (oskar_Thread**) calloc(num_threads, sizeof(oskar_Thread*));
     args = (ThreadArgs*) calloc(num_threads, sizeof(ThreadArgs));
     for (i = 0; i < num_threads; ++i)
     {
         args[i].h = h;
-        args[i].num_threads = num_threads;
+        args[i].schedule = &schedule;
+        args[i].num_devices = h->num_devices;
         args[i].thread_id = i;
         args[i].status = status;
     }
@@ -155,6 +251,8 @@ void oskar_interferometer_run(oskar_Interferometer* h, int* status)
     }
     free(threads);
     free(args);
+    free(schedule.num_devices_done);
+    oskar_condition_free(schedule.var);
 
     /* Finalise. */
     oskar_interferometer_finalise(h, status);
@@ -39,13 +39,25 @@
 #include "interferometer/oskar_evaluate_jones_K.h"
 #include "utility/oskar_device.h"
 
+#include <float.h>
+#include <string.h>
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+/* Maximum size of the buffer holding Jones K for a batch of channels. */
+#define K_CHANNELS_MAX_BYTES (64 << 20)
+
+static void sim_time_terms(oskar_Interferometer* h, DeviceData* d,
+        oskar_Sky* sky, int time_index_simulation, int* status);
 static void sim_baselines(oskar_Interferometer* h, DeviceData* d,
         oskar_Sky* sky, int channel_index_block, int time_index_block,
         int time_index_simulation, int* status);
+static void prepare_output_block(oskar_Interferometer* h, int block_index,
+        int i_active, int time_index_start, int num_times, int* status);
+static void copy_times_to_host(oskar_Interferometer* h, int device_id,
+        int i_active, int num_times, const char* times_used, int* status);
 static unsigned int disp_width(unsigned int v);
 
 void oskar_interferometer_run_block(oskar_Interferometer* h, int block_index,
@@ -70,7 +82,8 @@ void oskar_interferometer_run_block(oskar_Interferometer* h, int block_index,
         oskar_device_set(h->dev_loc, h->gpu_ids[device_id], status);
 
     /* Clear the visibility block. */
-    const int i_active = block_index % 2; /* Index of the active buffer. */
+    /* Index of the active buffer. */
+    const int i_active = block_index % h->num_vis_buffers;
     d = &(h->d[device_id]);
     oskar_timer_resume(d->tmr_compute);
     oskar_vis_block_clear(d->vis_block, status);
@@ -91,6 +104,13 @@ void oskar_interferometer_run_block(oskar_Interferometer* h, int block_index,
     oskar_vis_block_set_num_times(d->vis_block, num_times_block, status);
     oskar_vis_block_set_start_time_index(d->vis_block, time_index_start);
 
+    /* Prepare the output buffer, and clear the record of times simulated. */
+    prepare_output_block(h, block_index, i_active,
+            time_index_start, num_times_block, status);
+    char* times_used = d->times_used +
+            i_active * oskar_vis_header_max_times_per_block(h->header);
+    memset(times_used, 0, num_times_block);
+
     /* Go though all possible work units in the block. A work unit is defined
      * as the simulation for one time and one sky chunk. */
     while (!h->coords_only)
@@ -98,9 +118,8 @@ void oskar_interferometer_run_block(oskar_Interferometer* h, int block_index,
         oskar_Sky* sky;
         int i_channel;
 
-        oskar_mutex_lock(h->mutex);
-        const int i_work_unit = (h->work_unit_index)++;
-        oskar_mutex_unlock(h->mutex);
+        const int i_work_unit = oskar_atomic_fetch_add(
+                &h->work_unit_index[i_active], 1);
         if ((i_work_unit >= num_times_block * total_chunks) || *status) break;
 
         /* Convert slice index to chunk/time index. */
@@ -129,6 +148,10 @@ void oskar_interferometer_run_block(oskar_Interferometer* h, int block_index,
             oskar_timer_pause(d->tmr_clip);
         }
 
+        /* Evaluate terms that are the same for all channels. */
+        if (oskar_sky_num_sources(sky) > 0) times_used[i_time] = 1;
+        sim_time_terms(h, d, sky, sim_time_idx, status);
+
         /* Simulate all baselines for all channels for this time and chunk. */
         for (i_channel = 0; i_channel < num_channels; ++i_channel)
         {
@@ -146,21 +169,67 @@ void oskar_interferometer_run_block(oskar_Interferometer* h, int block_index,
         d->previous_chunk_index = i_chunk;
     }
 
-    /* Copy the visibility block to host memory. */
+    /* Copy the simulated times to host memory. */
     oskar_timer_resume(d->tmr_copy);
-    oskar_vis_block_copy(d->vis_block_cpu[i_active], d->vis_block, status);
+    copy_times_to_host(h, device_id, i_active, num_times_block,
+            times_used, status);
     oskar_timer_pause(d->tmr_copy);
     oskar_timer_pause(d->tmr_compute);
 }
 
 
+static void sim_time_terms(oskar_Interferometer* h, DeviceData* d,
+        oskar_Sky* sky, int time_index_simulation, int* status)
+{
+    double dt_dump_days, t_dump, gast, ra0, dec0;
+    const oskar_Mem *x, *y, *z;
+    const int num_stations = oskar_telescope_num_stations(d->tel);
+    const int num_src = oskar_sky_num_sources(sky);
+    if (num_src == 0 || *status) return;
+
+    /* Get the time of the visibility slice being simulated. */
+    dt_dump_days = h->time_inc_sec / 86400.0;
+    t_dump = h->time_start_mjd_utc +
+            dt_dump_days * (time_index_simulation + 0.5);
+    gast = oskar_convert_mjd_to_gast_fast(t_dump);
+
+    /* Set dimensions of Jones matrices. */
+    if (d->R)
+        oskar_jones_set_size(d->R, num_stations, num_src, status);
+    if (d->Z)
+        oskar_jones_set_size(d->Z, num_stations, num_src, status);
+    oskar_jones_set_size(d->J, num_stations, num_src, status);
+    oskar_jones_set_size(d->E, num_stations, num_src, status);
+    oskar_jones_set_size(d->K, num_stations, num_src, status);
+    d->K_num_channels = 0;
+
+    /* Evaluate station u,v,w coordinates, in metres. */
+    ra0 = oskar_telescope_phase_centre_ra_rad(d->tel);
+    dec0 = oskar_telescope_phase_centre_dec_rad(d->tel);
+    x = oskar_telescope_station_true_offset_ecef_metres_const(d->tel, 0);
+    y = oskar_telescope_station_true_offset_ecef_metres_const(d->tel, 1);
+    z = oskar_telescope_station_true_offset_ecef_metres_const(d->tel, 2);
+    oskar_convert_ecef_to_station_uvw(num_stations, x, y, z, ra0, dec0, gast,
+            0, 0, d->u, d->v, d->w, status);
+
+    /* Evaluate parallactic angle (Jones R: matrix).
+     * TODO Move this into station beam evaluation instead. */
+    if (d->R)
+    {
+        oskar_timer_resume(d->tmr_E);
+        oskar_evaluate_jones_R(d->R, num_src, oskar_sky_ra_rad_const(sky),
+                oskar_sky_dec_rad_const(sky), d->tel, gast, status);
+        oskar_timer_pause(d->tmr_E);
+    }
+}
+
+
 static void sim_baselines(oskar_Interferometer* h, DeviceData* d,
         oskar_Sky* sky, int channel_index_block, int time_index_block,
         int time_index_simulation, int* status)
 {
     int num_baselines, num_stations, num_src, num_times_block, num_channels;
-    double dt_dump_days, t_start, t_dump, gast, frequency, ra0, dec0;
-    const oskar_Mem *x, *y, *z;
+    double dt_dump_days, t_start, t_dump, gast, frequency;
 
     /* Get dimensions. */
     num_baselines   = oskar_telescope_num_baselines(d->tel);
@@ -183,24 +252,6 @@ static void sim_baselines(oskar_Interferometer* h, DeviceData* d,
     /* Scale source fluxes with spectral index and rotation measure. */
     oskar_sky_scale_flux_with_frequency(sky, frequency, status);
 
-    /* Evaluate station u,v,w coordinates. */
-    ra0 = oskar_telescope_phase_centre_ra_rad(d->tel);
-    dec0 = oskar_telescope_phase_centre_dec_rad(d->tel);
-    x = oskar_telescope_station_true_offset_ecef_metres_const(d->tel, 0);
-    y = oskar_telescope_station_true_offset_ecef_metres_const(d->tel, 1);
-    z = oskar_telescope_station_true_offset_ecef_metres_const(d->tel, 2);
-    oskar_convert_ecef_to_station_uvw(num_stations, x, y, z, ra0, dec0, gast,
-            0, 0, d->u, d->v, d->w, status);
-
-    /* Set dimensions of Jones matrices. */
-    if (d->R)
-        oskar_jones_set_size(d->R, num_stations, num_src, status);
-    if (d->Z)
-        oskar_jones_set_size(d->Z, num_stations, num_src, status);
-    oskar_jones_set_size(d->J, num_stations, num_src, status);
-    oskar_jones_set_size(d->E, num_stations, num_src, status);
-    oskar_jones_set_size(d->K, num_stations, num_src, status);
-
     /* Evaluate station beam (Jones E: may be matrix). */
     oskar_timer_resume(d->tmr_E);
     oskar_evaluate_jones_E(d->E, num_src, OSKAR_RELATIVE_DIRECTIONS,
@@ -222,32 +273,63 @@ static void sim_baselines(oskar_Interferometer* h, DeviceData* d,
     }
 #endif
 
-    /* Evaluate parallactic angle (Jones R: matrix), and join with Jones Z*E.
-     * TODO Move this into station beam evaluation instead. */
+    /* Join Jones Z*E with parallactic angle (Jones R),
+     * which was evaluated for this time. */
     if (d->R)
     {
-        oskar_timer_resume(d->tmr_E);
-        oskar_evaluate_jones_R(d->R, num_src, oskar_sky_ra_rad_const(sky),
-                oskar_sky_dec_rad_const(sky), d->tel, gast, status);
-        oskar_timer_pause(d->tmr_E);
         oskar_timer_resume(d->tmr_join);
-        oskar_jones_join(d->R, d->E, d->R, status);
+        oskar_jones_join(d->E, d->E, d->R, status);
         oskar_timer_pause(d->tmr_join);
     }
 
-    /* Evaluate interferometer phase (Jones K: scalar). */
-    oskar_timer_resume(d->tmr_K);
-    oskar_evaluate_jones_K(d->K, num_src, oskar_sky_l_const(sky),
-            oskar_sky_m_const(sky), oskar_sky_n_const(sky), d->u, d->v, d->w,
-            frequency, oskar_sky_I_const(sky),
-            h->source_min_jy, h->source_max_jy, h->ignore_w_components,
-            status);
-    oskar_timer_pause(d->tmr_K);
-
-    /* Join Jones K with Jones Z*E. */
-    oskar_timer_resume(d->tmr_join);
-    oskar_jones_join(d->J, d->K, d->R ? d->R : d->E, status);
-    oskar_timer_pause(d->tmr_join);
+    /* Evaluate interferometer phase (Jones K: scalar) and join with
+     * Jones Z*E. Unless a source filter is used, which depends on the
+     * flux in each channel, Jones K is evaluated for a batch of channels
+     * at once, which avoids evaluating sine and cosine terms for every
+     * channel. */
+    const size_t num_values = (size_t) num_stations * num_src;
+    if (h->source_min_jy <= -DBL_MAX && h->source_max_jy >= DBL_MAX)
+    {
+        if (channel_index_block < d->K_channel_start ||
+                channel_index_block >= d->K_channel_start + d->K_num_channels)
+        {
+            const size_t bytes = num_values * oskar_mem_element_size(
+                    oskar_mem_type(d->K_channels));
+            int batch = (int) (K_CHANNELS_MAX_BYTES / bytes);
+            if (batch > num_channels - channel_index_block)
+                batch = num_channels - channel_index_block;
+            if (batch < 1) batch = 1;
+            oskar_timer_resume(d->tmr_K);
+            oskar_evaluate_jones_K_channels(d->K_channels, batch,
+                    num_stations, num_src, oskar_sky_l_const(sky),
+                    oskar_sky_m_const(sky), oskar_sky_n_const(sky),
+                    d->u, d->v, d->w, frequency, h->freq_inc_hz,
+                    oskar_sky_I_const(sky), -DBL_MAX, DBL_MAX,
+                    h->ignore_w_components, status);
+            oskar_timer_pause(d->tmr_K);
+            d->K_channel_start = channel_index_block;
+            d->K_num_channels = batch;
+        }
+        oskar_timer_resume(d->tmr_join);
+        oskar_mem_multiply(oskar_jones_mem(d->J), d->K_channels,
+                oskar_jones_mem(d->E), 0,
+                (channel_index_block - d->K_channel_start) * num_values, 0,
+                num_values, status);
+        oskar_timer_pause(d->tmr_join);
+    }
+    else
+    {
+        oskar_timer_resume(d->tmr_K);
+        oskar_evaluate_jones_K(d->K, num_src, oskar_sky_l_const(sky),
+                oskar_sky_m_const(sky), oskar_sky_n_const(sky),
+                d->u, d->v, d->w, frequency, oskar_sky_I_const(sky),
+                h->source_min_jy, h->source_max_jy, h->ignore_w_components,
+                status);
+        oskar_timer_pause(d->tmr_K);
+        oskar_timer_resume(d->tmr_join);
+        oskar_jones_join(d->J, d->K, d->E, status);
+        oskar_timer_pause(d->tmr_join);
+    }
 
     /* Calculate output offset. */
     const int offset = num_channels * time_index_block + channel_index_block;
@@ -267,6 +349,50 @@ static void sim_baselines(oskar_Interferometer* h, DeviceData* d,
 }
 
 
+static void prepare_output_block(oskar_Interferometer* h, int block_index,
+        int i_active, int time_index_start, int num_times, int* status)
+{
+    /* The first device to start the block sets the output buffer
+     * dimensions, before any device can copy data into it. */
+    oskar_mutex_lock(h->mutex);
+    if (h->output_block_index[i_active] != block_index)
+    {
+        oskar_VisBlock* b0 = h->d[0].vis_block_cpu[i_active];
+        oskar_vis_block_set_num_times(b0, num_times, status);
+        oskar_vis_block_set_start_time_index(b0, time_index_start);
+        h->output_block_index[i_active] = block_index;
+    }
+    oskar_mutex_unlock(h->mutex);
+}
+
+
+static void copy_times_to_host(oskar_Interferometer* h, int device_id,
+        int i_active, int num_times, const char* times_used, int* status)
+{
+    int t = 0, t_start;
+    DeviceData* d = &(h->d[device_id]);
+    oskar_VisBlock* dst = d->vis_block_cpu[i_active];
+
+    /* If no other device can contribute to the same times, copy them
+     * straight to the output buffer. Otherwise, copy them to this
+     * device's own host buffer, to be combined later. */
+    if (device_id == 0 || oskar_interferometer_exclusive_times(h))
+        dst = h->d[0].vis_block_cpu[i_active];
+    else if (!dst)
+        dst = d->vis_block_cpu[i_active] = oskar_vis_block_create_from_header(
+                OSKAR_CPU, h->header, status);
+
+    /* Copy each contiguous range of times that were simulated. */
+    while (t < num_times)
+    {
+        if (!times_used[t]) { ++t; continue; }
+        for (t_start = t; t < num_times && times_used[t]; ++t);
+        oskar_interferometer_copy_block_times(dst, d->vis_block,
+                t_start, t - t_start, status);
+    }
+}
+
+
 static unsigned int disp_width(unsigned int v)
 {
     return (v >= 100000u) ? 6 : (v >= 10000u) ? 5 : (v >= 1000u) ? 4 :
@@ -28,6 +28,7 @@
 
 #include "interferometer/private_interferometer.h"
 #include "interferometer/oskar_interferometer.h"
+#include "vis/oskar_vis_bda_write_ms.h"
 #include "vis/oskar_vis_block_write_ms.h"
 #include "vis/oskar_vis_header_write_ms.h"
 
@@ -37,18 +38,53 @@ extern "C" {
 
 void oskar_interferometer_write_block(oskar_Interferometer* h,
         const oskar_VisBlock* block, int block_index, int* status)
+{
+    oskar_interferometer_write_block_ms(h, block, block_index, status);
+    oskar_interferometer_write_block_vis(h, block, block_index, status);
+}
+
+void oskar_interferometer_write_block_ms(oskar_Interferometer* h,
+        const oskar_VisBlock* block, int block_index, int* status)
 {
     if (*status) return;
-    oskar_timer_resume(h->tmr_write);
 #ifndef OSKAR_NO_MS
+    oskar_timer_resume(h->tmr_write_ms);
     if (h->ms_name && !h->ms)
         h->ms = oskar_vis_header_write_ms(h->header, h->ms_name, OSKAR_TRUE,
                 h->force_polarised_ms, status);
-    if (h->ms) oskar_vis_block_write_ms(block, h->header, h->ms, status);
+    if (h->ms)
+    {
+        /* Averaged rows are appended to the end of the main table. */
+        if (h->bda_averager)
+            oskar_vis_bda_write_ms(
+                    h->bda_out[block_index % h->num_vis_buffers],
+                    h->header, h->ms, status);
+        else
+            oskar_vis_block_write_ms(block, h->header, h->ms, status);
+    }
+    oskar_timer_pause(h->tmr_write_ms);
+#else
+    (void) h;
+    (void) block;
+    (void) block_index;
 #endif
+}
+
+void oskar_interferometer_write_block_vis(oskar_Interferometer* h,
+        const oskar_VisBlock* block, int block_index, int* status)
+{
+    if (*status) return;
+    oskar_timer_resume(h->tmr_write);
     if (h->vis_name && !h->vis)
         h->vis = oskar_vis_header_write(h->header, h->vis_name, status);
-    if (h->vis) oskar_vis_block_write(block, h->vis, block_index, status);
+    if (h->vis)
+    {
+        if (h->bda_averager)
+            oskar_vis_bda_write(h->bda_out[block_index % h->num_vis_buffers],
+                    h->vis, block_index, status);
+        else
+            oskar_vis_block_write(block, h->vis, block_index, status);
+    }
     oskar_timer_pause(h->tmr_write);
 }
 
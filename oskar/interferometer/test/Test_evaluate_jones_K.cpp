@@ -29,10 +29,14 @@
 #include <gtest/gtest.h>
 
 #include "interferometer/oskar_evaluate_jones_K.h"
+#include "interferometer/oskar_jones.h"
+#include "utility/oskar_cpu_simd_level.h"
 #include "utility/oskar_get_error_string.h"
 #include "utility/oskar_timer.h"
 #include "utility/oskar_vector_types.h"
 
+#include <cfloat>
+#include <cmath>
 #include <cstdio>
 
 static void run_test(int type, double tol)
@@ -125,3 +129,189 @@ TEST(Jones_K, test_double)
 {
     run_test(OSKAR_DOUBLE, 1e-8);
 }
+
+static void run_test_channel_step(int type, int num_channels, double tol)
+{
+    int status = 0;
+    int num_sources = 1000;
+    int num_stations = 100;
+    double freq_start_hz = 100e6, freq_inc_hz = 10e3;
+    oskar_Jones* K = oskar_jones_create(type | OSKAR_COMPLEX, OSKAR_CPU,
+            num_stations, num_sources, &status);
+    oskar_Jones* K_step = oskar_jones_create(type | OSKAR_COMPLEX, OSKAR_CPU,
+            num_stations, num_sources, &status);
+    oskar_Jones* K_exact = oskar_jones_create(type | OSKAR_COMPLEX, OSKAR_CPU,
+            num_stations, num_sources, &status);
+    oskar_Mem* l = oskar_mem_create(type, OSKAR_CPU, num_sources, &status);
+    oskar_Mem* m = oskar_mem_create(type, OSKAR_CPU, num_sources, &status);
+    oskar_Mem* n = oskar_mem_create(type, OSKAR_CPU, num_sources, &status);
+    oskar_Mem* I = oskar_mem_create(type, OSKAR_CPU, num_sources, &status);
+    oskar_Mem* u = oskar_mem_create(type, OSKAR_CPU, num_stations, &status);
+    oskar_Mem* v = oskar_mem_create(type, OSKAR_CPU, num_stations, &status);
+    oskar_Mem* w = oskar_mem_create(type, OSKAR_CPU, num_stations, &status);
+
+    srand(2);
+    oskar_mem_random_range(l, -1.0, 1.0, &status);
+    oskar_mem_random_range(m, -1.0, 1.0, &status);
+    oskar_mem_random_range(n, -1.0, 1.0, &status);
+    oskar_mem_random_range(I, 0.0, 1.0, &status);
+    oskar_mem_random_range(u, -100.0, 100.0, &status);
+    oskar_mem_random_range(v, -100.0, 100.0, &status);
+    oskar_mem_random_range(w, -100.0, 100.0, &status);
+
+    // Rotate the phase from the first channel to the last one.
+    oskar_evaluate_jones_K(K, num_sources, l, m, n, u, v, w,
+            freq_start_hz, I, -DBL_MAX, DBL_MAX, 0, &status);
+    oskar_evaluate_jones_K(K_step, num_sources, l, m, n, u, v, w,
+            freq_inc_hz, I, -DBL_MAX, DBL_MAX, 0, &status);
+    for (int i = 1; i < num_channels; ++i)
+        oskar_jones_join(K, K, K_step, &status);
+
+    // Evaluate the last channel directly and compare.
+    oskar_evaluate_jones_K(K_exact, num_sources, l, m, n, u, v, w,
+            freq_start_hz + (num_channels - 1) * freq_inc_hz,
+            I, -DBL_MAX, DBL_MAX, 0, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    double max_err, avg_err;
+    oskar_mem_evaluate_relative_error(oskar_jones_mem_const(K),
+            oskar_jones_mem_const(K_exact), 0, &max_err, &avg_err, 0, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    EXPECT_LT(avg_err, tol);
+
+    oskar_mem_free(l, &status);
+    oskar_mem_free(m, &status);
+    oskar_mem_free(n, &status);
+    oskar_mem_free(I, &status);
+    oskar_mem_free(u, &status);
+    oskar_mem_free(v, &status);
+    oskar_mem_free(w, &status);
+    oskar_jones_free(K, &status);
+    oskar_jones_free(K_step, &status);
+    oskar_jones_free(K_exact, &status);
+}
+
+TEST(Jones_K, channel_step_single)
+{
+    run_test_channel_step(OSKAR_SINGLE, 8, 1e-4);
+}
+
+TEST(Jones_K, channel_step_double)
+{
+    run_test_channel_step(OSKAR_DOUBLE, 64, 1e-10);
+}
+
+static void run_test_channels(int type, int location, double tol)
+{
+    int status = 0;
+    int num_sources = 1000;
+    int num_stations = 50;
+    int num_channels = 100;
+    double freq_start_hz = 100e6, freq_inc_hz = 10e3;
+    const size_t num_values = (size_t) num_stations * num_sources;
+    oskar_Jones* K = oskar_jones_create(type | OSKAR_COMPLEX, OSKAR_CPU,
+            num_stations, num_sources, &status);
+    oskar_Mem* K_channels = oskar_mem_create(type | OSKAR_COMPLEX,
+            location, 0, &status);
+    oskar_Mem* l = oskar_mem_create(type, OSKAR_CPU, num_sources, &status);
+    oskar_Mem* m = oskar_mem_create(type, OSKAR_CPU, num_sources, &status);
+    oskar_Mem* n = oskar_mem_create(type, OSKAR_CPU, num_sources, &status);
+    oskar_Mem* I = oskar_mem_create(type, OSKAR_CPU, num_sources, &status);
+    oskar_Mem* u = oskar_mem_create(type, OSKAR_CPU, num_stations, &status);
+    oskar_Mem* v = oskar_mem_create(type, OSKAR_CPU, num_stations, &status);
+    oskar_Mem* w = oskar_mem_create(type, OSKAR_CPU, num_stations, &status);
+
+    srand(2);
+    oskar_mem_random_range(l, -1.0, 1.0, &status);
+    oskar_mem_random_range(m, -1.0, 1.0, &status);
+    oskar_mem_random_range(n, -1.0, 1.0, &status);
+    oskar_mem_random_range(I, 0.0, 1.0, &status);
+    oskar_mem_random_range(u, -100.0, 100.0, &status);
+    oskar_mem_random_range(v, -100.0, 100.0, &status);
+    oskar_mem_random_range(w, -100.0, 100.0, &status);
+    oskar_Mem* l_g = oskar_mem_create_copy(l, location, &status);
+    oskar_Mem* m_g = oskar_mem_create_copy(m, location, &status);
+    oskar_Mem* n_g = oskar_mem_create_copy(n, location, &status);
+    oskar_Mem* I_g = oskar_mem_create_copy(I, location, &status);
+    oskar_Mem* u_g = oskar_mem_create_copy(u, location, &status);
+    oskar_Mem* v_g = oskar_mem_create_copy(v, location, &status);
+    oskar_Mem* w_g = oskar_mem_create_copy(w, location, &status);
+
+    // Evaluate all channels at once, using a source filter.
+    oskar_Timer* tmr = oskar_timer_create(OSKAR_TIMER_NATIVE);
+    oskar_timer_start(tmr);
+    oskar_evaluate_jones_K_channels(K_channels, num_channels, num_stations,
+            num_sources, l_g, m_g, n_g, u_g, v_g, w_g,
+            freq_start_hz, freq_inc_hz, I_g, 0.2, 0.9, 0, &status);
+    printf("Jones K (%d channels): %.3f sec\n", num_channels,
+            oskar_timer_elapsed(tmr));
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    oskar_Mem* K_all = oskar_mem_convert_precision(K_channels,
+            OSKAR_DOUBLE, &status);
+
+    // Compare each channel with a direct evaluation.
+    oskar_timer_start(tmr);
+    for (int c = 0; c < num_channels; ++c)
+    {
+        oskar_evaluate_jones_K(K, num_sources, l, m, n, u, v, w,
+                freq_start_hz + c * freq_inc_hz, I, 0.2, 0.9, 0, &status);
+        oskar_Mem* K_exact = oskar_mem_convert_precision(
+                oskar_jones_mem_const(K), OSKAR_DOUBLE, &status);
+        const double2* a = oskar_mem_double2_const(K_all, &status) +
+                c * num_values;
+        const double2* b = oskar_mem_double2_const(K_exact, &status);
+        double max_err = 0.0;
+        for (size_t i = 0; i < num_values; ++i)
+        {
+            const double err = fabs(a[i].x - b[i].x) + fabs(a[i].y - b[i].y);
+            if (err > max_err) max_err = err;
+        }
+        EXPECT_LT(max_err, tol) << "Channel " << c;
+        oskar_mem_free(K_exact, &status);
+    }
+    printf("Jones K (%d single channels): %.3f sec\n", num_channels,
+            oskar_timer_elapsed(tmr));
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+
+    oskar_mem_free(l, &status);
+    oskar_mem_free(m, &status);
+    oskar_mem_free(n, &status);
+    oskar_mem_free(I, &status);
+    oskar_mem_free(u, &status);
+    oskar_mem_free(v, &status);
+    oskar_mem_free(w, &status);
+    oskar_mem_free(l_g, &status);
+    oskar_mem_free(m_g, &status);
+    oskar_mem_free(n_g, &status);
+    oskar_mem_free(I_g, &status);
+    oskar_mem_free(u_g, &status);
+    oskar_mem_free(v_g, &status);
+    oskar_mem_free(w_g, &status);
+    oskar_mem_free(K_channels, &status);
+    oskar_mem_free(K_all, &status);
+    oskar_jones_free(K, &status);
+    oskar_timer_free(tmr);
+}
+
+TEST(Jones_K, channels_single)
+{
+    run_test_channels(OSKAR_SINGLE, OSKAR_CPU, 1e-3);
+}
+
+TEST(Jones_K, channels_double)
+{
+    run_test_channels(OSKAR_DOUBLE, OSKAR_CPU, 1e-10);
+}
+
+TEST(Jones_K, channels_double_no_simd)
+{
+    oskar_cpu_simd_set_max_level(OSKAR_CPU_SIMD_NONE);
+    run_test_channels(OSKAR_DOUBLE, OSKAR_CPU, 1e-10);
+    oskar_cpu_simd_set_max_level(OSKAR_CPU_SIMD_AVX512);
+}
+
+#ifdef OSKAR_HAVE_CUDA
+TEST(Jones_K, channels_device)
+{
+    run_test_channels(OSKAR_DOUBLE, OSKAR_GPU, 1e-10);
+}
+#endif
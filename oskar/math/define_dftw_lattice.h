@@ -0,0 +1,162 @@
+/* Copyright (c) 2012-2020, The University of Oxford. See LICENSE file. */
+
+/* Number of phase recurrence steps between exact sincos evaluations. */
+#define OSKAR_DFTW_LATTICE_RESYNC 16
+
+/* Fills TABLE[k] = exp(i * k * PHASE) for k in [0, N), using a complex
+ * multiply per step and resynchronising with an exact sincos to bound the
+ * accumulated rounding error. */
+#define OSKAR_DFTW_LATTICE_POWERS(FP, FP2, TABLE, N, PHASE) {\
+    FP2 step_;\
+    SINCOS(PHASE, step_.y, step_.x);\
+    for (int k_ = 0; k_ < N; ++k_) {\
+        if ((k_ % OSKAR_DFTW_LATTICE_RESYNC) == 0) {\
+            const FP t_ = (FP)k_ * PHASE;\
+            SINCOS(t_, TABLE[k_].y, TABLE[k_].x);\
+        } else {\
+            const FP2 p_ = TABLE[k_ - 1];\
+            TABLE[k_].x = p_.x * step_.x - p_.y * step_.y;\
+            TABLE[k_].y = p_.x * step_.y + p_.y * step_.x;\
+        }\
+    }}\
+
+#define OSKAR_DFTW_LATTICE_ARGS(FP, FP2)\
+        const int       num_in,\
+        const FP        wavenumber,\
+        GLOBAL_IN(FP2,  weights_in),\
+        const FP        o_x,\
+        const FP        o_y,\
+        const FP        o_z,\
+        const FP        a_x,\
+        const FP        a_y,\
+        const FP        a_z,\
+        const FP        b_x,\
+        const FP        b_y,\
+        const FP        b_z,\
+        const int       num_a,\
+        const int       num_b,\
+        GLOBAL_IN(int,  lattice_idx),\
+        const int       offset_coord_out,\
+        const int       num_out,\
+        GLOBAL_IN(FP,   x_out),\
+        GLOBAL_IN(FP,   y_out),\
+        GLOBAL_IN(FP,   z_out),\
+        GLOBAL_IN(int,  data_idx),\
+        GLOBAL_IN(FP2,  data),\
+        const int       eval_x,\
+        const int       eval_y,\
+        const int       offset_out,\
+        GLOBAL_OUT(FP2, output),\
+        const FP        norm_factor\
+
+/* Evaluates the phase tables for output direction i_out.
+ * The origin phase is folded into the table for the second lattice vector,
+ * so the phasor for element (i, j) is pa[i] * pb[j]. */
+#define OSKAR_DFTW_LATTICE_TABLES(IS_3D, FP, FP2) \
+    FP2 pa[OSKAR_DFTW_LATTICE_MAX_DIM], pb[OSKAR_DFTW_LATTICE_MAX_DIM];\
+    FP2 base;\
+    {\
+        FP phase_o, phase_a, phase_b;\
+        const FP xo = wavenumber * x_out[i_out + offset_coord_out];\
+        const FP yo = wavenumber * y_out[i_out + offset_coord_out];\
+        phase_o = xo * o_x + yo * o_y;\
+        phase_a = xo * a_x + yo * a_y;\
+        phase_b = xo * b_x + yo * b_y;\
+        if (IS_3D) {\
+            const FP zo = wavenumber * z_out[i_out + offset_coord_out];\
+            phase_o += zo * o_z;\
+            phase_a += zo * a_z;\
+            phase_b += zo * b_z;\
+        }\
+        SINCOS(phase_o, base.y, base.x);\
+        OSKAR_DFTW_LATTICE_POWERS(FP, FP2, pa, num_a, phase_a)\
+        OSKAR_DFTW_LATTICE_POWERS(FP, FP2, pb, num_b, phase_b)\
+        for (i = 0; i < num_b; ++i) {\
+            const FP2 p = pb[i];\
+            pb[i].x = p.x * base.x - p.y * base.y;\
+            pb[i].y = p.x * base.y + p.y * base.x;\
+        }\
+    }\
+
+/* Evaluates the weighted phasor (re, im) for input element i. */
+#define OSKAR_DFTW_LATTICE_PHASOR(FP, FP2) \
+    const FP2 p_a = pa[lattice_idx[2 * i]];\
+    const FP2 p_b = pb[lattice_idx[2 * i + 1]];\
+    const FP2 w = weights_in[i];\
+    FP re = p_a.x * p_b.x - p_a.y * p_b.y;\
+    FP im = p_a.x * p_b.y + p_a.y * p_b.x;\
+    const FP t = re;\
+    re *= w.x; re -= w.y * im;\
+    im *= w.x; im += w.y * t;\
+
+#define OSKAR_DFTW_LATTICE_C2C_CPU(NAME, IS_3D, FP, FP2) KERNEL(NAME) (\
+        OSKAR_DFTW_LATTICE_ARGS(FP, FP2))\
+{\
+    (void) eval_x; (void) eval_y;\
+    KERNEL_LOOP_PAR_X(int, i_out, 0, num_out)\
+    int i;\
+    FP2 out; MAKE_ZERO2(FP, out);\
+    OSKAR_DFTW_LATTICE_TABLES(IS_3D, FP, FP2)\
+    for (i = 0; i < num_in; ++i) {\
+        OSKAR_DFTW_LATTICE_PHASOR(FP, FP2)\
+        const int i_in = (data_idx ? data_idx[i] : i) * num_out + i_out;\
+        const FP2 in = data[i_in];\
+        out.x += in.x * re; out.x -= in.y * im;\
+        out.y += in.y * re; out.y += in.x * im;\
+    }\
+    out.x *= norm_factor;\
+    out.y *= norm_factor;\
+    output[i_out + offset_out] = out;\
+    KERNEL_LOOP_END\
+}\
+OSKAR_REGISTER_KERNEL(NAME)
+
+#define OSKAR_DFTW_LATTICE_M2M_CPU(NAME, IS_3D, FP, FP2) KERNEL(NAME) (\
+        OSKAR_DFTW_LATTICE_ARGS(FP, FP2))\
+{\
+    KERNEL_LOOP_PAR_X(int, i_out, 0, num_out)\
+    int i;\
+    FP2 out_xx, out_xy, out_yx, out_yy;\
+    MAKE_ZERO2(FP, out_xx); MAKE_ZERO2(FP, out_xy);\
+    MAKE_ZERO2(FP, out_yx); MAKE_ZERO2(FP, out_yy);\
+    OSKAR_DFTW_LATTICE_TABLES(IS_3D, FP, FP2)\
+    for (i = 0; i < num_in; ++i) {\
+        OSKAR_DFTW_LATTICE_PHASOR(FP, FP2)\
+        const int i_in = 4 * ((data_idx ? data_idx[i] : i) * num_out + i_out);\
+        if (eval_x) {\
+            const FP2 xx = data[i_in + 0];\
+            const FP2 xy = data[i_in + 1];\
+            out_xx.x += xx.x * re; out_xx.x -= xx.y * im;\
+            out_xx.y += xx.y * re; out_xx.y += xx.x * im;\
+            out_xy.x += xy.x * re; out_xy.x -= xy.y * im;\
+            out_xy.y += xy.y * re; out_xy.y += xy.x * im;\
+        }\
+        if (eval_y) {\
+            const FP2 yx = data[i_in + 2];\
+            const FP2 yy = data[i_in + 3];\
+            out_yx.x += yx.x * re; out_yx.x -= yx.y * im;\
+            out_yx.y += yx.y * re; out_yx.y += yx.x * im;\
+            out_yy.x += yy.x * re; out_yy.x -= yy.y * im;\
+            out_yy.y += yy.y * re; out_yy.y += yy.x * im;\
+        }\
+    }\
+    const int j = 4 * (i_out + offset_out);\
+    if (eval_x) {\
+        out_xx.x *= norm_factor;\
+        out_xx.y *= norm_factor;\
+        out_xy.x *= norm_factor;\
+        out_xy.y *= norm_factor;\
+        output[j + 0] = out_xx;\
+        output[j + 1] = out_xy;\
+    }\
+    if (eval_y) {\
+        out_yx.x *= norm_factor;\
+        out_yx.y *= norm_factor;\
+        out_yy.x *= norm_factor;\
+        out_yy.y *= norm_factor;\
+        output[j + 2] = out_yx;\
+        output[j + 3] = out_yy;\
+    }\
+    KERNEL_LOOP_END\
+}\
+OSKAR_REGISTER_KERNEL(NAME)
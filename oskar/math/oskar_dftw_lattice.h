@@ -0,0 +1,119 @@
+/*
+ * Copyright (c) 2020, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef OSKAR_DFTW_LATTICE_H_
+#define OSKAR_DFTW_LATTICE_H_
+
+/**
+ * @file oskar_dftw_lattice.h
+ */
+
+#include <oskar_global.h>
+#include <mem/oskar_mem.h>
+
+/* Maximum number of lattice points along each lattice vector. */
+#define OSKAR_DFTW_LATTICE_MAX_DIM 256
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief
+ * Function to perform a DFT using supplied weights, for inputs on a lattice.
+ *
+ * @details
+ * This function computes the same result as oskar_dftw(), for input
+ * positions that lie on a regular (e.g. rectangular or hexagonal) lattice.
+ *
+ * The position of input point \p i is given by
+ * origin + i_a * vector_a + i_b * vector_b, where the lattice indices
+ * (i_a, i_b) are stored as consecutive pairs in \p lattice_idx.
+ * The \p lattice array contains the origin, vector_a and vector_b
+ * (each as x, y, z), in that order, in the same units as the wavelength.
+ *
+ * Instead of evaluating a sincos for every input and output point,
+ * the phase factors along each lattice vector are computed by recurrence
+ * for each output point, so the cost per input point is reduced to a
+ * few complex multiplies.
+ *
+ * The lattice indices must be in the range [0, \p lattice_dims[0]) and
+ * [0, \p lattice_dims[1]), and the dimensions must not exceed
+ * OSKAR_DFTW_LATTICE_MAX_DIM.
+ *
+ * This function is currently only available for data in CPU memory.
+ *
+ * See oskar_dftw() for a description of the other parameters.
+ *
+ * @param[in] normalise        If true, divide output values by \p num_in.
+ * @param[in] num_in           Number of input points.
+ * @param[in] wavenumber       Wavenumber (2 pi / wavelength).
+ * @param[in] weights_in       Array of input complex DFT weights.
+ * @param[in] lattice          Lattice origin and vectors (9 values).
+ * @param[in] lattice_dims     Number of lattice points along each vector.
+ * @param[in] lattice_idx      Lattice index pairs for each input point.
+ * @param[in] offset_coord_out Start offset into output coordinate arrays.
+ * @param[in] num_out          Number of output points.
+ * @param[in] x_out            Array of output 1/x positions.
+ * @param[in] y_out            Array of output 1/y positions.
+ * @param[in] z_out            Array of output 1/z positions.
+ * @param[in] data_idx         Optional input data indices.
+ * @param[in] data             Input data.
+ * @param[in] eval_x           For matrix data, evaluate X components if true.
+ * @param[in] eval_y           For matrix data, evaluate Y components if true.
+ * @param[in] offset_out       Start offset into output data array.
+ * @param[out] output          Output data.
+ * @param[in,out] status       Status return code.
+ */
+OSKAR_EXPORT
+void oskar_dftw_lattice(
+        int normalise,
+        int num_in,
+        double wavenumber,
+        const oskar_Mem* weights_in,
+        const double lattice[9],
+        const int lattice_dims[2],
+        const oskar_Mem* lattice_idx,
+        int offset_coord_out,
+        int num_out,
+        const oskar_Mem* x_out,
+        const oskar_Mem* y_out,
+        const oskar_Mem* z_out,
+        const oskar_Mem* data_idx,
+        const oskar_Mem* data,
+        int eval_x,
+        int eval_y,
+        int offset_out,
+        oskar_Mem* output,
+        int* status);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* include guard */
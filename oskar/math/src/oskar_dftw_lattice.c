@@ -0,0 +1,184 @@
+/*
+ * Copyright (c) 2020, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "math/define_dftw_lattice.h"
+#include "math/oskar_dftw_lattice.h"
+#include "utility/oskar_kernel_macros.h"
+#include "utility/oskar_vector_types.h"
+
+OSKAR_DFTW_LATTICE_C2C_CPU(dftw_lattice_c2c_2d_float, 0, float, float2)
+OSKAR_DFTW_LATTICE_C2C_CPU(dftw_lattice_c2c_3d_float, 1, float, float2)
+OSKAR_DFTW_LATTICE_M2M_CPU(dftw_lattice_m2m_2d_float, 0, float, float2)
+OSKAR_DFTW_LATTICE_M2M_CPU(dftw_lattice_m2m_3d_float, 1, float, float2)
+
+OSKAR_DFTW_LATTICE_C2C_CPU(dftw_lattice_c2c_2d_double, 0, double, double2)
+OSKAR_DFTW_LATTICE_C2C_CPU(dftw_lattice_c2c_3d_double, 1, double, double2)
+OSKAR_DFTW_LATTICE_M2M_CPU(dftw_lattice_m2m_2d_double, 0, double, double2)
+OSKAR_DFTW_LATTICE_M2M_CPU(dftw_lattice_m2m_3d_double, 1, double, double2)
+
+#define LATTICE_ARGS_DOUBLE \
+        num_in, wavenumber, oskar_mem_double2_const(weights_in, status),\
+        lattice[0], lattice[1], lattice[2],\
+        lattice[3], lattice[4], lattice[5],\
+        lattice[6], lattice[7], lattice[8],\
+        lattice_dims[0], lattice_dims[1], lattice_idx_p,\
+        offset_coord_out, num_out,\
+        oskar_mem_double_const(x_out, status),\
+        oskar_mem_double_const(y_out, status),\
+        is_3d ? oskar_mem_double_const(z_out, status) : 0,\
+        data_idx_p, oskar_mem_double2_const(data, status),\
+        eval_x, eval_y, offset_out,\
+        oskar_mem_double2(output, status), norm_factor
+
+#define LATTICE_ARGS_FLOAT \
+        num_in, (float) wavenumber, oskar_mem_float2_const(weights_in, status),\
+        (float) lattice[0], (float) lattice[1], (float) lattice[2],\
+        (float) lattice[3], (float) lattice[4], (float) lattice[5],\
+        (float) lattice[6], (float) lattice[7], (float) lattice[8],\
+        lattice_dims[0], lattice_dims[1], lattice_idx_p,\
+        offset_coord_out, num_out,\
+        oskar_mem_float_const(x_out, status),\
+        oskar_mem_float_const(y_out, status),\
+        is_3d ? oskar_mem_float_const(z_out, status) : 0,\
+        data_idx_p, oskar_mem_float2_const(data, status),\
+        eval_x, eval_y, offset_out,\
+        oskar_mem_float2(output, status), (float) norm_factor
+
+void oskar_dftw_lattice(
+        int normalise,
+        int num_in,
+        double wavenumber,
+        const oskar_Mem* weights_in,
+        const double lattice[9],
+        const int lattice_dims[2],
+        const oskar_Mem* lattice_idx,
+        int offset_coord_out,
+        int num_out,
+        const oskar_Mem* x_out,
+        const oskar_Mem* y_out,
+        const oskar_Mem* z_out,
+        const oskar_Mem* data_idx,
+        const oskar_Mem* data,
+        int eval_x,
+        int eval_y,
+        int offset_out,
+        oskar_Mem* output,
+        int* status)
+{
+    if (*status) return;
+    const int location = oskar_mem_location(output);
+    const int type = oskar_mem_precision(output);
+    const int is_dbl = oskar_mem_is_double(output);
+    const int is_3d = (z_out != NULL);
+    const int is_matrix = oskar_mem_is_matrix(output);
+    const double norm_factor = normalise ? 1.0 / num_in : 1.0;
+    if (!oskar_mem_is_complex(output) || !oskar_mem_is_complex(weights_in) ||
+            oskar_mem_is_matrix(weights_in))
+    {
+        *status = OSKAR_ERR_BAD_DATA_TYPE;
+        return;
+    }
+    if (location != OSKAR_CPU)
+    {
+        *status = OSKAR_ERR_BAD_LOCATION;
+        return;
+    }
+    if (oskar_mem_location(data) != location ||
+            oskar_mem_location(weights_in) != location ||
+            oskar_mem_location(lattice_idx) != location ||
+            oskar_mem_location(x_out) != location ||
+            oskar_mem_location(y_out) != location ||
+            (is_3d && oskar_mem_location(z_out) != location))
+    {
+        *status = OSKAR_ERR_LOCATION_MISMATCH;
+        return;
+    }
+    if (oskar_mem_precision(weights_in) != type ||
+            oskar_mem_type(lattice_idx) != OSKAR_INT ||
+            oskar_mem_type(x_out) != type ||
+            oskar_mem_type(y_out) != type ||
+            (is_3d && oskar_mem_type(z_out) != type))
+    {
+        *status = OSKAR_ERR_TYPE_MISMATCH;
+        return;
+    }
+    if (!oskar_mem_is_complex(data) ||
+            oskar_mem_type(data) != oskar_mem_type(output) ||
+            oskar_mem_precision(data) != type)
+    {
+        *status = OSKAR_ERR_TYPE_MISMATCH;
+        return;
+    }
+    if (lattice_dims[0] < 1 || lattice_dims[1] < 1 ||
+            lattice_dims[0] > OSKAR_DFTW_LATTICE_MAX_DIM ||
+            lattice_dims[1] > OSKAR_DFTW_LATTICE_MAX_DIM ||
+            (int) oskar_mem_length(lattice_idx) < 2 * num_in)
+    {
+        *status = OSKAR_ERR_OUT_OF_RANGE;
+        return;
+    }
+    oskar_mem_ensure(output, (size_t) offset_out + num_out, status);
+    if (*status) return;
+    const int* lattice_idx_p = oskar_mem_int_const(lattice_idx, status);
+    const int* data_idx_p =
+            data_idx ? oskar_mem_int_const(data_idx, status) : 0;
+    if (is_matrix)
+    {
+        if (is_3d)
+        {
+            if (is_dbl)
+                dftw_lattice_m2m_3d_double(LATTICE_ARGS_DOUBLE);
+            else
+                dftw_lattice_m2m_3d_float(LATTICE_ARGS_FLOAT);
+        }
+        else
+        {
+            if (is_dbl)
+                dftw_lattice_m2m_2d_double(LATTICE_ARGS_DOUBLE);
+            else
+                dftw_lattice_m2m_2d_float(LATTICE_ARGS_FLOAT);
+        }
+    }
+    else
+    {
+        if (is_3d)
+        {
+            if (is_dbl)
+                dftw_lattice_c2c_3d_double(LATTICE_ARGS_DOUBLE);
+            else
+                dftw_lattice_c2c_3d_float(LATTICE_ARGS_FLOAT);
+        }
+        else
+        {
+            if (is_dbl)
+                dftw_lattice_c2c_2d_double(LATTICE_ARGS_DOUBLE);
+            else
+                dftw_lattice_c2c_2d_float(LATTICE_ARGS_FLOAT);
+        }
+    }
+}
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2019, The University of Oxford
+ * Copyright (c) 2019-2020, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -38,6 +38,13 @@
 #include <math.h>
 #include <stdlib.h>
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+/* Transposes are done in square tiles of this many complex elements. */
+#define TRANSPOSE_TILE 32
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -47,6 +54,7 @@ struct oskar_FFT
     size_t num_cells_total;
     oskar_Mem *fftpack_work, *fftpack_wsave;
     int precision, location, num_dim, dim_size, ensure_consistent_norm;
+    int num_threads;
 #ifdef OSKAR_HAVE_CUDA
     cufftHandle cufft_plan;
 #endif
@@ -91,6 +99,98 @@ static void print_cufft_error(cufftResult code)
 }
 #endif
 
+static void fft2_cpu_d(oskar_FFT* h, double* c, double* wsave, double* work)
+{
+    int i, pass;
+    const int n = h->dim_size;
+    for (pass = 0; pass < 2; ++pass)
+    {
+        /* Transform each row, using a separate work buffer per thread. */
+#pragma omp parallel for private(i) num_threads(h->num_threads)
+        for (i = 0; i < n; ++i)
+        {
+            int thread_id = 0;
+#ifdef _OPENMP
+            thread_id = omp_get_thread_num();
+#endif
+            oskar_fftpack_cfftmf(1, n, n, 1, c + 2 * (size_t)i * n, wsave,
+                    work + 2 * (size_t)thread_id * n);
+        }
+
+        /* Transpose in tiles, so that columns can be transformed as rows. */
+#pragma omp parallel for schedule(dynamic, 1) num_threads(h->num_threads)
+        for (i = 0; i < n; i += TRANSPOSE_TILE)
+        {
+            int j, k, l;
+            const int k_end = (i + TRANSPOSE_TILE < n) ? i + TRANSPOSE_TILE : n;
+            for (j = i; j < n; j += TRANSPOSE_TILE)
+            {
+                const int l_end = (j + TRANSPOSE_TILE < n) ?
+                        j + TRANSPOSE_TILE : n;
+                for (k = i; k < k_end; ++k)
+                {
+                    for (l = (j == i) ? k + 1 : j; l < l_end; ++l)
+                    {
+                        const size_t a = 2 * ((size_t)k * n + l);
+                        const size_t b = 2 * ((size_t)l * n + k);
+                        const double re = c[a], im = c[a + 1];
+                        c[a] = c[b];
+                        c[a + 1] = c[b + 1];
+                        c[b] = re;
+                        c[b + 1] = im;
+                    }
+                }
+            }
+        }
+    }
+}
+
+static void fft2_cpu_f(oskar_FFT* h, float* c, float* wsave, float* work)
+{
+    int i, pass;
+    const int n = h->dim_size;
+    for (pass = 0; pass < 2; ++pass)
+    {
+        /* Transform each row, using a separate work buffer per thread. */
+#pragma omp parallel for private(i) num_threads(h->num_threads)
+        for (i = 0; i < n; ++i)
+        {
+            int thread_id = 0;
+#ifdef _OPENMP
+            thread_id = omp_get_thread_num();
+#endif
+            oskar_fftpack_cfftmf_f(1, n, n, 1, c + 2 * (size_t)i * n, wsave,
+                    work + 2 * (size_t)thread_id * n);
+        }
+
+        /* Transpose in tiles, so that columns can be transformed as rows. */
+#pragma omp parallel for schedule(dynamic, 1) num_threads(h->num_threads)
+        for (i = 0; i < n; i += TRANSPOSE_TILE)
+        {
+            int j, k, l;
+            const int k_end = (i + TRANSPOSE_TILE < n) ? i + TRANSPOSE_TILE : n;
+            for (j = i; j < n; j += TRANSPOSE_TILE)
+            {
+                const int l_end = (j + TRANSPOSE_TILE < n) ?
+                        j + TRANSPOSE_TILE : n;
+                for (k = i; k < k_end; ++k)
+                {
+                    for (l = (j == i) ? k + 1 : j; l < l_end; ++l)
+                    {
+                        const size_t a = 2 * ((size_t)k * n + l);
+                        const size_t b = 2 * ((size_t)l * n + k);
+                        const float re = c[a], im = c[a + 1];
+                        c[a] = c[b];
+                        c[a + 1] = c[b + 1];
+                        c[b] = re;
+                        c[b + 1] = im;
+                    }
+                }
+            }
+        }
+    }
+}
+
 oskar_FFT* oskar_fft_create(int precision, int location, int num_dim,
         int dim_size, int batch_size_1d, int* status)
 {
@@ -109,10 +209,15 @@ oskar_FFT* oskar_fft_create(int precision, int location, int num_dim,
     h->ensure_consistent_norm = 1;
     h->num_cells_total = (size_t) dim_size;
     for (i = 1; i < num_dim; ++i) h->num_cells_total *= (size_t) dim_size;
+    h->num_threads = 1;
+#ifdef _OPENMP
+    /* Only use multiple threads if the transform is big enough. */
+    if (h->num_cells_total >= 65536) h->num_threads = omp_get_max_threads();
+#endif
     if (location == OSKAR_CPU || (location & OSKAR_CL))
     {
-        int len = 4 * dim_size +
-                2 * (int)(log((double)dim_size) / log(2.0)) + 8;
+        int len = 2 * dim_size +
+                (int)(log((double)dim_size) / log(2.0)) + 4;
         if (location & OSKAR_CL)
         {
             h->location = OSKAR_CPU;
@@ -128,16 +233,16 @@ oskar_FFT* oskar_fft_create(int precision, int location, int num_dim,
         else if (num_dim == 2)
         {
             if (precision == OSKAR_DOUBLE)
-                oskar_fftpack_cfft2i(dim_size, dim_size,
+                oskar_fftpack_cfftmi(dim_size,
                         oskar_mem_double(h->fftpack_wsave, status));
             else
-                oskar_fftpack_cfft2i_f(dim_size, dim_size,
+                oskar_fftpack_cfftmi_f(dim_size,
                         oskar_mem_float(h->fftpack_wsave, status));
         }
         else
             *status = OSKAR_ERR_INVALID_ARGUMENT;
         h->fftpack_work = oskar_mem_create(precision, OSKAR_CPU,
-                2 * h->num_cells_total, status);
+                2 * (size_t) dim_size * h->num_threads, status);
     }
     else if (location == OSKAR_GPU)
     {
@@ -182,13 +287,11 @@ void oskar_fft_exec(oskar_FFT* h, oskar_Mem* data, int* status)
         else if (h->num_dim == 2)
         {
             if (h->precision == OSKAR_DOUBLE)
-                oskar_fftpack_cfft2f(h->dim_size, h->dim_size, h->dim_size,
-                        oskar_mem_double(data_ptr, status),
+                fft2_cpu_d(h, oskar_mem_double(data_ptr, status),
                         oskar_mem_double(h->fftpack_wsave, status),
                         oskar_mem_double(h->fftpack_work, status));
             else
-                oskar_fftpack_cfft2f_f(h->dim_size, h->dim_size, h->dim_size,
-                        oskar_mem_float(data_ptr, status),
+                fft2_cpu_f(h, oskar_mem_float(data_ptr, status),
                         oskar_mem_float(h->fftpack_wsave, status),
                         oskar_mem_float(h->fftpack_work, status));
             /* This step not needed for W-kernel generation, so turn it off. */
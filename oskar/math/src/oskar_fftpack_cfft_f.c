@@ -52,7 +52,7 @@
  * This C translation from the original Fortran sources is also covered by
  * the Modified BSD license, as follows:
  *
- * Copyright (c) 2016, The University of Oxford
+ * Copyright (c) 2016-2020, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -167,6 +167,26 @@ void oskar_fftpack_cfft2i_f(const int l, const int m, float *wsave)
 }
 
 
+void oskar_fftpack_cfftmb_f(const int lot, const int jump, const int n,
+        const int inc, float *c, float *wsave, float *work)
+{
+    cfftmb(lot, jump, n, inc, c, wsave, work);
+}
+
+
+void oskar_fftpack_cfftmf_f(const int lot, const int jump, const int n,
+        const int inc, float *c, float *wsave, float *work)
+{
+    cfftmf(lot, jump, n, inc, c, wsave, work);
+}
+
+
+void oskar_fftpack_cfftmi_f(const int n, float *wsave)
+{
+    cfftmi(n, wsave);
+}
+
+
 void cfftmb(const int lot, const int jump, const int n, const int inc,
         float *c, float *wsave, float *work)
 {
@@ -0,0 +1,208 @@
+/*
+ * Copyright (c) 2020, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <gtest/gtest.h>
+
+#include "math/oskar_cmath.h"
+#include "math/oskar_dftw.h"
+#include "math/oskar_dftw_lattice.h"
+#include "utility/oskar_get_error_string.h"
+#include "utility/oskar_timer.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+static void set_random(oskar_Mem* mem)
+{
+    const size_t num = oskar_mem_length(mem) *
+            (oskar_mem_is_matrix(mem) ? 8 : 2);
+    void* p = oskar_mem_void(mem);
+    for (size_t i = 0; i < num; ++i)
+    {
+        const double val = 2.0 * rand() / (double) RAND_MAX - 1.0;
+        if (oskar_mem_is_double(mem))
+            ((double*) p)[i] = val;
+        else
+            ((float*) p)[i] = (float) val;
+    }
+}
+
+static double max_rel_diff(const oskar_Mem* a, const oskar_Mem* b,
+        int* status)
+{
+    double max_diff = 0.0, max_val = 0.0;
+    oskar_Mem* a_d = oskar_mem_convert_precision(a, OSKAR_DOUBLE, status);
+    oskar_Mem* b_d = oskar_mem_convert_precision(b, OSKAR_DOUBLE, status);
+    const double* pa = oskar_mem_double_const(a_d, status);
+    const double* pb = oskar_mem_double_const(b_d, status);
+    const size_t num = oskar_mem_length(a) *
+            (oskar_mem_is_matrix(a) ? 8 : 2);
+    for (size_t i = 0; i < num; ++i)
+    {
+        const double diff = fabs(pa[i] - pb[i]);
+        if (diff > max_diff) max_diff = diff;
+        if (fabs(pa[i]) > max_val) max_val = fabs(pa[i]);
+    }
+    oskar_mem_free(a_d, status);
+    oskar_mem_free(b_d, status);
+    return max_diff / max_val;
+}
+
+static void run_test(int type, bool matrix, bool is_3d, double tol)
+{
+    int status = 0, num_in = 0, num_out = 1000;
+    const int dims[] = {24, 24};
+    const double freq_hz = 200e6, spacing = 1.1;
+    const double wavenumber = 2.0 * M_PI * freq_hz / 299792458.0;
+
+    // Generate a hexagonal lattice with a circular boundary,
+    // on a tilted plane if required.
+    const double tilt = is_3d ? 0.05 : 0.0;
+    const double lattice[] = {
+            -0.75 * dims[0] * spacing, -0.43 * dims[1] * spacing, 2.0,
+            spacing, 0.0, tilt * spacing,
+            0.5 * spacing, 0.5 * sqrt(3.0) * spacing, 0.0
+    };
+    std::vector<double> x, y, z;
+    std::vector<int> idx;
+    for (int j = 0; j < dims[1]; ++j)
+    {
+        for (int i = 0; i < dims[0]; ++i)
+        {
+            const double px = lattice[0] + i * lattice[3] + j * lattice[6];
+            const double py = lattice[1] + i * lattice[4] + j * lattice[7];
+            const double pz = lattice[2] + i * lattice[5] + j * lattice[8];
+            if (px * px + py * py > 100.0) continue;
+            x.push_back(px);
+            y.push_back(py);
+            z.push_back(pz);
+            idx.push_back(i);
+            idx.push_back(j);
+        }
+    }
+    num_in = (int) x.size();
+    ASSERT_GT(num_in, 200);
+
+    // Copy element positions and lattice indices.
+    oskar_Mem *x_in, *y_in, *z_in, *x_in_d, *y_in_d, *z_in_d, *lattice_idx;
+    x_in_d = oskar_mem_create_alias_from_raw(&x[0], OSKAR_DOUBLE,
+            OSKAR_CPU, num_in, &status);
+    y_in_d = oskar_mem_create_alias_from_raw(&y[0], OSKAR_DOUBLE,
+            OSKAR_CPU, num_in, &status);
+    z_in_d = oskar_mem_create_alias_from_raw(&z[0], OSKAR_DOUBLE,
+            OSKAR_CPU, num_in, &status);
+    lattice_idx = oskar_mem_create_alias_from_raw(&idx[0], OSKAR_INT,
+            OSKAR_CPU, 2 * num_in, &status);
+    x_in = oskar_mem_convert_precision(x_in_d, type, &status);
+    y_in = oskar_mem_convert_precision(y_in_d, type, &status);
+    z_in = oskar_mem_convert_precision(z_in_d, type, &status);
+
+    // Generate output directions, element weights and element data.
+    // Use two element types, selected using the data index.
+    const int data_type = type | OSKAR_COMPLEX | (matrix ? OSKAR_MATRIX : 0);
+    oskar_Mem *x_out, *y_out, *z_out, *weights, *data, *data_idx;
+    x_out = oskar_mem_create(type, OSKAR_CPU, num_out, &status);
+    y_out = oskar_mem_create(type, OSKAR_CPU, num_out, &status);
+    z_out = oskar_mem_create(type, OSKAR_CPU, num_out, &status);
+    weights = oskar_mem_create(type | OSKAR_COMPLEX, OSKAR_CPU,
+            num_in, &status);
+    data = oskar_mem_create(data_type, OSKAR_CPU, 2 * num_out, &status);
+    data_idx = oskar_mem_create(OSKAR_INT, OSKAR_CPU, num_in, &status);
+    for (int i = 0; i < num_out; ++i)
+    {
+        const double phi = 2.0 * M_PI * i / num_out;
+        const double theta = 0.5 * M_PI * i / num_out;
+        oskar_mem_set_element_real(x_out, i, sin(theta) * cos(phi), &status);
+        oskar_mem_set_element_real(y_out, i, sin(theta) * sin(phi), &status);
+        oskar_mem_set_element_real(z_out, i, cos(theta), &status);
+    }
+    int* data_idx_p = oskar_mem_int(data_idx, &status);
+    for (int i = 0; i < num_in; ++i) data_idx_p[i] = i % 2;
+    set_random(weights);
+    set_random(data);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+
+    // Evaluate using the generic DFT and the lattice version.
+    oskar_Mem *ref, *out;
+    ref = oskar_mem_create(data_type, OSKAR_CPU, num_out, &status);
+    out = oskar_mem_create(data_type, OSKAR_CPU, num_out, &status);
+    oskar_Timer* tmr = oskar_timer_create(OSKAR_TIMER_NATIVE);
+    oskar_timer_start(tmr);
+    oskar_dftw(1, num_in, wavenumber, weights, x_in, y_in, z_in,
+            0, num_out, x_out, y_out, is_3d ? z_out : 0, data_idx, data,
+            1, 1, 0, ref, &status);
+    const double t_ref = oskar_timer_elapsed(tmr);
+    oskar_timer_start(tmr);
+    oskar_dftw_lattice(1, num_in, wavenumber, weights, lattice, dims,
+            lattice_idx, 0, num_out, x_out, y_out, is_3d ? z_out : 0,
+            data_idx, data, 1, 1, 0, out, &status);
+    const double t_lattice = oskar_timer_elapsed(tmr);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    printf("dftw: %.4f s, dftw_lattice: %.4f s\n", t_ref, t_lattice);
+
+    // Check results are consistent.
+    EXPECT_LT(max_rel_diff(ref, out, &status), tol);
+
+    oskar_timer_free(tmr);
+    oskar_mem_free(x_in_d, &status);
+    oskar_mem_free(y_in_d, &status);
+    oskar_mem_free(z_in_d, &status);
+    oskar_mem_free(x_in, &status);
+    oskar_mem_free(y_in, &status);
+    oskar_mem_free(z_in, &status);
+    oskar_mem_free(lattice_idx, &status);
+    oskar_mem_free(x_out, &status);
+    oskar_mem_free(y_out, &status);
+    oskar_mem_free(z_out, &status);
+    oskar_mem_free(weights, &status);
+    oskar_mem_free(data, &status);
+    oskar_mem_free(data_idx, &status);
+    oskar_mem_free(ref, &status);
+    oskar_mem_free(out, &status);
+}
+
+TEST(dftw_lattice, c2c_2d_double)
+{
+    run_test(OSKAR_DOUBLE, false, false, 1e-12);
+}
+
+TEST(dftw_lattice, m2m_3d_double)
+{
+    run_test(OSKAR_DOUBLE, true, true, 1e-12);
+}
+
+TEST(dftw_lattice, c2c_3d_single)
+{
+    run_test(OSKAR_SINGLE, false, true, 1e-4);
+}
+
+TEST(dftw_lattice, m2m_2d_single)
+{
+    run_test(OSKAR_SINGLE, true, false, 1e-4);
+}
@@ -0,0 +1,159 @@
+/*
+ * Copyright (c) 2020, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <gtest/gtest.h>
+
+#include "math/oskar_fft.h"
+#include "math/oskar_fftpack_cfft.h"
+#include "math/oskar_fftpack_cfft_f.h"
+#include "utility/oskar_timer.h"
+
+#include <cmath>
+#include <cstdlib>
+
+static void fill_random(oskar_Mem* data)
+{
+    int status = 0;
+    const size_t n = 2 * oskar_mem_length(data);
+    srand(1);
+    if (oskar_mem_precision(data) == OSKAR_DOUBLE)
+    {
+        double* p = oskar_mem_double(data, &status);
+        for (size_t i = 0; i < n; ++i) p[i] = rand() / (double) RAND_MAX;
+    }
+    else
+    {
+        float* p = oskar_mem_float(data, &status);
+        for (size_t i = 0; i < n; ++i) p[i] = rand() / (float) RAND_MAX;
+    }
+}
+
+static void check_against_dft(int type, int n, double tol)
+{
+    int status = 0;
+    const size_t num_cells = (size_t) n * n;
+    oskar_Mem* data = oskar_mem_create(type | OSKAR_COMPLEX, OSKAR_CPU,
+            num_cells, &status);
+    fill_random(data);
+    oskar_Mem* in = oskar_mem_convert_precision(data, OSKAR_DOUBLE, &status);
+    oskar_FFT* fft = oskar_fft_create(type, OSKAR_CPU, 2, n, 0, &status);
+    oskar_fft_exec(fft, data, &status);
+    ASSERT_EQ(0, status);
+    oskar_Mem* out = oskar_mem_convert_precision(data, OSKAR_DOUBLE, &status);
+    const double* a = oskar_mem_double_const(in, &status);
+    const double* b = oskar_mem_double_const(out, &status);
+
+    // Compare with a direct evaluation of the forward DFT.
+    double max_err = 0.0;
+    for (int y = 0; y < n; ++y)
+    {
+        for (int x = 0; x < n; ++x)
+        {
+            double re = 0.0, im = 0.0;
+            for (int j = 0; j < n; ++j)
+            {
+                for (int i = 0; i < n; ++i)
+                {
+                    const double phase = -2.0 * M_PI *
+                            ((double) ((x * i) % n) / n +
+                            (double) ((y * j) % n) / n);
+                    const double c = cos(phase), s = sin(phase);
+                    const size_t k = 2 * ((size_t) j * n + i);
+                    re += a[k] * c - a[k + 1] * s;
+                    im += a[k] * s + a[k + 1] * c;
+                }
+            }
+            const size_t k = 2 * ((size_t) y * n + x);
+            const double err = fabs(re - b[k]) + fabs(im - b[k + 1]);
+            if (err > max_err) max_err = err;
+        }
+    }
+    EXPECT_LT(max_err / num_cells, tol);
+    oskar_fft_free(fft);
+    oskar_mem_free(in, &status);
+    oskar_mem_free(out, &status);
+    oskar_mem_free(data, &status);
+}
+
+TEST(FFT, cpu_2d_against_dft)
+{
+    check_against_dft(OSKAR_DOUBLE, 60, 1e-12);
+    check_against_dft(OSKAR_DOUBLE, 32, 1e-12);
+    check_against_dft(OSKAR_SINGLE, 60, 1e-5);
+    check_against_dft(OSKAR_SINGLE, 32, 1e-5);
+}
+
+TEST(FFT, cpu_2d_against_fftpack)
+{
+    int status = 0;
+    const int n = 1024;
+    const size_t num_cells = (size_t) n * n;
+    oskar_Mem* data = oskar_mem_create(OSKAR_DOUBLE_COMPLEX, OSKAR_CPU,
+            num_cells, &status);
+    fill_random(data);
+    oskar_Mem* data2 = oskar_mem_create_copy(data, OSKAR_CPU, &status);
+
+    // Transform using FFTPACK directly.
+    oskar_Timer* tmr = oskar_timer_create(OSKAR_TIMER_NATIVE);
+    oskar_Mem* wsave = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU,
+            4 * n + 2 * (int)(log((double)n) / log(2.0)) + 8, &status);
+    oskar_Mem* work = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU,
+            2 * num_cells, &status);
+    oskar_fftpack_cfft2i(n, n, oskar_mem_double(wsave, &status));
+    oskar_timer_start(tmr);
+    oskar_fftpack_cfft2f(n, n, n, oskar_mem_double(data2, &status),
+            oskar_mem_double(wsave, &status),
+            oskar_mem_double(work, &status));
+    printf("FFTPACK 2D FFT took %.3f sec\n", oskar_timer_elapsed(tmr));
+    oskar_mem_scale_real(data2, (double) num_cells, 0, num_cells, &status);
+
+    // Transform using the FFT plan.
+    oskar_FFT* fft = oskar_fft_create(OSKAR_DOUBLE, OSKAR_CPU, 2, n, 0,
+            &status);
+    oskar_timer_start(tmr);
+    oskar_fft_exec(fft, data, &status);
+    printf("Planned 2D FFT took %.3f sec\n", oskar_timer_elapsed(tmr));
+    ASSERT_EQ(0, status);
+
+    // Check results are consistent.
+    const double* a = oskar_mem_double_const(data, &status);
+    const double* b = oskar_mem_double_const(data2, &status);
+    double max_err = 0.0;
+    for (size_t i = 0; i < 2 * num_cells; ++i)
+    {
+        const double err = fabs(a[i] - b[i]);
+        if (err > max_err) max_err = err;
+    }
+    EXPECT_LT(max_err, 1e-8);
+    oskar_fft_free(fft);
+    oskar_timer_free(tmr);
+    oskar_mem_free(wsave, &status);
+    oskar_mem_free(work, &status);
+    oskar_mem_free(data, &status);
+    oskar_mem_free(data2, &status);
+}
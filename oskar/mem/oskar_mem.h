@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2012-2019, The University of Oxford
+ * Copyright (c) 2012-2020, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -72,6 +72,7 @@ enum OSKAR_MEM_LOCATION
 #include <mem/oskar_mem_accessors.h>
 #include <mem/oskar_mem_add.h>
 #include <mem/oskar_mem_add_real.h>
+#include <mem/oskar_mem_allocator.h>
 #include <mem/oskar_mem_append_raw.h>
 #include <mem/oskar_mem_clear_contents.h>
 #include <mem/oskar_mem_copy.h>
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2013-2019, The University of Oxford
+ * Copyright (c) 2013-2020, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -71,6 +71,22 @@ int oskar_mem_allocated(const oskar_Mem* mem);
 OSKAR_EXPORT
 size_t oskar_mem_length(const oskar_Mem* mem);
 
+/**
+ * @brief
+ * Returns the number of elements the memory block can hold.
+ *
+ * @details
+ * This accessor function returns the number of elements that can be held
+ * in the memory block without reallocating it.
+ * This is never less than the length of the block.
+ *
+ * @param[in] mem Pointer to the memory block.
+ *
+ * @return The number of elements that can be held.
+ */
+OSKAR_EXPORT
+size_t oskar_mem_capacity(const oskar_Mem* mem);
+
 /**
  * @brief
  * Returns the enumerated location of the memory block.
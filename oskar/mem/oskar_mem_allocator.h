@@ -0,0 +1,110 @@
+/*
+ * Copyright (c) 2020, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef OSKAR_MEM_ALLOCATOR_H_
+#define OSKAR_MEM_ALLOCATOR_H_
+
+/**
+ * @file oskar_mem_allocator.h
+ */
+
+#include <oskar_global.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief
+ * Returns counters from the host memory allocator.
+ *
+ * @details
+ * Host memory used by oskar_Mem structures is allocated with 64-byte
+ * alignment, and blocks that are freed are kept in a pool for reuse.
+ *
+ * This function returns the number of host memory blocks requested
+ * since the counters were last reset, the number of those that were
+ * taken from the pool, and the number of resize operations that were
+ * done in place because the existing block was already large enough.
+ *
+ * Any of the pointers may be NULL if the value is not required.
+ *
+ * @param[out] num_allocated  Number of host memory blocks requested.
+ * @param[out] num_reused     Number of blocks taken from the pool.
+ * @param[out] num_in_place   Number of resize operations done in place.
+ */
+OSKAR_EXPORT
+void oskar_mem_allocator_counters(size_t* num_allocated, size_t* num_reused,
+        size_t* num_in_place);
+
+/**
+ * @brief
+ * Resets the host memory allocator counters.
+ *
+ * @details
+ * Resets the counters returned by oskar_mem_allocator_counters() to zero.
+ * The counters are shared by the whole process, so this is not called
+ * by the library itself: applications may call it to report counters
+ * for a part of their own processing.
+ */
+OSKAR_EXPORT
+void oskar_mem_allocator_reset_counters(void);
+
+/**
+ * @brief
+ * Releases all unused host memory held in the pool.
+ *
+ * @details
+ * Returns all memory blocks currently held in the pool to the system.
+ * The pool is shared by the whole process, so this is not called
+ * by the library itself.
+ */
+OSKAR_EXPORT
+void oskar_mem_allocator_release(void);
+
+/**
+ * @brief
+ * Sets whether large host memory blocks should use huge pages.
+ *
+ * @details
+ * If enabled, host memory blocks of 2 MB or more are aligned to 2 MB
+ * boundaries and the operating system is advised to back them with
+ * transparent huge pages, where this is supported.
+ * This is disabled by default.
+ *
+ * @param[in] value If true, use huge pages for large blocks.
+ */
+OSKAR_EXPORT
+void oskar_mem_allocator_set_huge_pages(int value);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OSKAR_MEM_ALLOCATOR_H_ */
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2011-2019, The University of Oxford
+ * Copyright (c) 2011-2020, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -48,6 +48,7 @@ struct oskar_Mem
     int type;            /* Enumerated element type of memory block. */
     int location;        /* Enumerated address space of data pointer. */
     size_t num_elements; /* Number of elements in memory block. */
+    size_t capacity;     /* Number of bytes allocated, if owned. */
     int owner;           /* Flag set if the structure owns the memory. */
     void* data;          /* Data pointer. */
 
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2013-2019, The University of Oxford
+ * Copyright (c) 2013-2020, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -43,6 +43,13 @@ size_t oskar_mem_length(const oskar_Mem* mem)
     return mem->num_elements;
 }
 
+size_t oskar_mem_capacity(const oskar_Mem* mem)
+{
+    const size_t element_size = oskar_mem_element_size(mem->type);
+    if (!mem->owner || element_size == 0) return mem->num_elements;
+    return mem->capacity / element_size;
+}
+
 int oskar_mem_location(const oskar_Mem* mem)
 {
     return mem->location;
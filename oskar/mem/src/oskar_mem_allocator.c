@@ -0,0 +1,257 @@
+/*
+ * Copyright (c) 2020, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/* Needed for posix_memalign() and madvise() when compiling with -std=c99. */
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200112L
+#endif
+#if defined(__linux__) && !defined(_DEFAULT_SOURCE)
+#define _DEFAULT_SOURCE
+#endif
+
+#include "mem/oskar_mem_allocator.h"
+#include "mem/private_mem_allocator.h"
+#include "utility/oskar_thread.h"
+
+#include <stdlib.h>
+
+#if defined(OSKAR_OS_WIN)
+#include <malloc.h>
+#elif defined(OSKAR_OS_LINUX)
+#include <sys/mman.h>
+#endif
+
+/* Size classes are spaced by a quarter of each power of two,
+ * from 64 bytes to 64 MB. Larger blocks are not pooled. */
+#define ALIGNMENT 64
+#define HUGE_PAGE_SIZE (2 * 1024 * 1024)
+#define MIN_CLASS_BITS 6
+#define MAX_CLASS_BITS 26
+#define NUM_SUB_CLASSES 4
+#define NUM_CLASSES (1 + (MAX_CLASS_BITS - MIN_CLASS_BITS) * NUM_SUB_CLASSES)
+#define MAX_POOL_BLOCKS 16
+#define MAX_POOL_BYTES ((size_t)256 * 1024 * 1024)
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct PoolBlock PoolBlock;
+struct PoolBlock
+{
+    PoolBlock* next;
+};
+
+/* Each size class has its own lock, so threads only contend when they
+ * use blocks of the same size. The total size and the counters are
+ * updated atomically, outside the locks. */
+static volatile int pool_lock[NUM_CLASSES];
+static PoolBlock* pool[NUM_CLASSES];
+static int pool_count[NUM_CLASSES];
+static volatile int pool_bytes = 0;
+static volatile int counter_allocated = 0;
+static volatile int counter_reused = 0;
+static volatile int counter_in_place = 0;
+static int use_huge_pages = 0;
+
+/* Returns the block size for the given number of bytes,
+ * and its size class index, or -1 if it is too large to be pooled. */
+static size_t size_class(size_t bytes, int* index)
+{
+    int p = MIN_CLASS_BITS;
+    if (bytes <= ((size_t)1 << MIN_CLASS_BITS))
+    {
+        *index = 0;
+        return (size_t)1 << MIN_CLASS_BITS;
+    }
+    if (bytes > ((size_t)1 << MAX_CLASS_BITS))
+    {
+        *index = -1;
+        return (bytes + 4095) & ~((size_t)4095);
+    }
+    while (((size_t)1 << (p + 1)) < bytes) ++p;
+    const size_t base = (size_t)1 << p;
+    const size_t step = base / NUM_SUB_CLASSES;
+    const size_t k = (bytes - base + step - 1) / step;
+    *index = 1 + (p - MIN_CLASS_BITS) * NUM_SUB_CLASSES + (int)k - 1;
+    return base + k * step;
+}
+
+/* Returns the block size of the given size class. */
+static size_t class_size(int index)
+{
+    if (index == 0) return (size_t)1 << MIN_CLASS_BITS;
+    const int p = MIN_CLASS_BITS + (index - 1) / NUM_SUB_CLASSES;
+    const size_t k = (size_t)((index - 1) % NUM_SUB_CLASSES + 1);
+    const size_t base = (size_t)1 << p;
+    return base + k * (base / NUM_SUB_CLASSES);
+}
+
+static void* system_alloc(size_t bytes)
+{
+    void* ptr = 0;
+    const size_t alignment = (use_huge_pages && bytes >= HUGE_PAGE_SIZE) ?
+            HUGE_PAGE_SIZE : ALIGNMENT;
+#if defined(OSKAR_OS_WIN)
+    ptr = _aligned_malloc(bytes, alignment);
+#else
+    if (posix_memalign(&ptr, alignment, bytes)) ptr = 0;
+#endif
+#if defined(OSKAR_OS_LINUX) && defined(MADV_HUGEPAGE)
+    if (ptr && alignment == HUGE_PAGE_SIZE)
+        (void) madvise(ptr, bytes, MADV_HUGEPAGE);
+#endif
+    return ptr;
+}
+
+static void system_free(void* ptr)
+{
+#if defined(OSKAR_OS_WIN)
+    _aligned_free(ptr);
+#else
+    free(ptr);
+#endif
+}
+
+void* oskar_mem_host_alloc(size_t bytes, size_t* capacity, int* status)
+{
+    int index = 0;
+    void* ptr = 0;
+    const size_t size = size_class(bytes, &index);
+    oskar_atomic_fetch_add(&counter_allocated, 1);
+    if (index >= 0 && pool[index])
+    {
+        oskar_spin_lock(&pool_lock[index]);
+        if (pool[index])
+        {
+            ptr = pool[index];
+            pool[index] = pool[index]->next;
+            pool_count[index]--;
+        }
+        oskar_spin_unlock(&pool_lock[index]);
+        if (ptr)
+        {
+            oskar_atomic_fetch_add(&pool_bytes, -(int)size);
+            oskar_atomic_fetch_add(&counter_reused, 1);
+        }
+    }
+    if (!ptr) ptr = system_alloc(size);
+    if (!ptr)
+    {
+        *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+        *capacity = 0;
+        return 0;
+    }
+    *capacity = size;
+    return ptr;
+}
+
+void oskar_mem_host_free(void* ptr, size_t capacity)
+{
+    int index = 0;
+    if (!ptr) return;
+    const size_t size = size_class(capacity, &index);
+    if (index >= 0 && size == capacity)
+    {
+        /* Reserve space in the pool before taking the lock. */
+        const int old_bytes = oskar_atomic_fetch_add(&pool_bytes, (int)size);
+        if ((size_t)old_bytes + size <= MAX_POOL_BYTES)
+        {
+            oskar_spin_lock(&pool_lock[index]);
+            if (pool_count[index] < MAX_POOL_BLOCKS)
+            {
+                PoolBlock* block = (PoolBlock*) ptr;
+                block->next = pool[index];
+                pool[index] = block;
+                pool_count[index]++;
+                ptr = 0;
+            }
+            oskar_spin_unlock(&pool_lock[index]);
+        }
+        if (ptr) oskar_atomic_fetch_add(&pool_bytes, -(int)size);
+    }
+    if (ptr) system_free(ptr);
+}
+
+void oskar_mem_count_resize_in_place(void)
+{
+    oskar_atomic_fetch_add(&counter_in_place, 1);
+}
+
+void oskar_mem_allocator_counters(size_t* num_allocated, size_t* num_reused,
+        size_t* num_in_place)
+{
+    if (num_allocated) *num_allocated = (unsigned int) counter_allocated;
+    if (num_reused) *num_reused = (unsigned int) counter_reused;
+    if (num_in_place) *num_in_place = (unsigned int) counter_in_place;
+}
+
+void oskar_mem_allocator_reset_counters(void)
+{
+    oskar_atomic_fetch_add(&counter_allocated, -counter_allocated);
+    oskar_atomic_fetch_add(&counter_reused, -counter_reused);
+    oskar_atomic_fetch_add(&counter_in_place, -counter_in_place);
+}
+
+void oskar_mem_allocator_release(void)
+{
+    int i;
+    PoolBlock* list = 0;
+    for (i = 0; i < NUM_CLASSES; ++i)
+    {
+        int num_released = 0;
+        oskar_spin_lock(&pool_lock[i]);
+        while (pool[i])
+        {
+            PoolBlock* block = pool[i];
+            pool[i] = block->next;
+            block->next = list;
+            list = block;
+            num_released++;
+        }
+        pool_count[i] = 0;
+        oskar_spin_unlock(&pool_lock[i]);
+        oskar_atomic_fetch_add(&pool_bytes,
+                -num_released * (int)class_size(i));
+    }
+    while (list)
+    {
+        PoolBlock* block = list;
+        list = list->next;
+        system_free(block);
+    }
+}
+
+void oskar_mem_allocator_set_huge_pages(int value)
+{
+    use_huge_pages = value;
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2013-2019, The University of Oxford
+ * Copyright (c) 2013-2020, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -32,6 +32,7 @@
 
 #include "mem/oskar_mem.h"
 #include "mem/private_mem.h"
+#include "mem/private_mem_allocator.h"
 #include "utility/oskar_device.h"
 
 #include <stdlib.h>
@@ -76,13 +77,9 @@ oskar_Mem* oskar_mem_create(int type, int location, size_t num_elements,
     mem->num_elements = num_elements;
     if (location == OSKAR_CPU)
     {
-        /* Allocate host memory. */
-        mem->data = calloc(bytes, 1);
-        if (mem->data == NULL)
-        {
-            *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
-            return mem;
-        }
+        /* Allocate aligned host memory. */
+        mem->data = oskar_mem_host_alloc(bytes, &mem->capacity, status);
+        if (*status) return mem;
         /* The memset() call forces the allocation
          * to actually happen by touching the whole block.
          * This makes subsequent copies much faster. */
@@ -95,6 +92,7 @@ oskar_Mem* oskar_mem_create(int type, int location, size_t num_elements,
         *status = (int)cudaMalloc(&mem->data, bytes);
         if (!*status && mem->data == NULL)
             *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+        if (!*status) mem->capacity = bytes;
 #else
         *status = OSKAR_ERR_CUDA_NOT_AVAILABLE;
 #endif
@@ -108,6 +106,8 @@ oskar_Mem* oskar_mem_create(int type, int location, size_t num_elements,
                 CL_MEM_READ_WRITE, bytes, NULL, &error);
         if (error != CL_SUCCESS)
             *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+        else
+            mem->capacity = bytes;
         mem->data = (void*) (mem->buffer);
 #else
         *status = OSKAR_ERR_OPENCL_NOT_AVAILABLE;
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2011-2019, The University of Oxford
+ * Copyright (c) 2011-2020, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -32,6 +32,7 @@
 
 #include "mem/oskar_mem.h"
 #include "mem/private_mem.h"
+#include "mem/private_mem_allocator.h"
 
 #include <stdlib.h>
 
@@ -65,8 +66,8 @@ void oskar_mem_free(oskar_Mem* mem, int* status)
         /* Check whether the memory is on the host or the device. */
         if (mem->location == OSKAR_CPU)
         {
-            /* Free host memory. */
-            free(mem->data);
+            /* Free host memory, or return it to the pool. */
+            oskar_mem_host_free(mem->data, mem->capacity);
         }
         else if (mem->location == OSKAR_GPU)
         {
@@ -30,6 +30,7 @@
 #include "mem/oskar_mem.h"
 #include "mem/private_mem.h"
 #include "mem/define_mem_multiply.h"
+#include "utility/oskar_cpu_simd_level.h"
 #include "utility/oskar_device.h"
 #include "utility/oskar_kernel_macros.h"
 
@@ -56,6 +57,84 @@ OSKAR_MEM_MUL_CM_M( M_CAT(mem_mul_cm_m_, double), double2, double4c)
 OSKAR_MEM_MUL_MC_M( M_CAT(mem_mul_mc_m_, double), double2, double4c)
 OSKAR_MEM_MUL_MM_M( M_CAT(mem_mul_mm_m_, double), double2, double4c)
 
+#ifdef OSKAR_HAVE_CPU_SIMD
+/* Matrix-matrix multiply compiled for a specific instruction set.
+ * The output may be the same as one of the inputs, so no RESTRICT here.
+ * Elements are accessed as arrays of reals, as the memory is not
+ * guaranteed to have the alignment given to the matrix types. */
+#define MEM_MUL_MM_M_SIMD(NAME, TARGET, FP, FP2, FP4c)\
+TARGET static void NAME(\
+        const unsigned int off_a, const unsigned int off_b,\
+        const unsigned int off_c, const unsigned int n,\
+        const FP4c* a, const FP4c* b, FP4c* c)\
+{\
+    int i;\
+    const int num = (int) n;\
+    const FP* a_ = (const FP*) (a + off_a);\
+    const FP* b_ = (const FP*) (b + off_b);\
+    FP* c_ = (FP*) (c + off_c);\
+    DO_PRAGMA(omp simd)\
+    for (i = 0; i < num; ++i)\
+    {\
+        FP4c ac, bc;\
+        ac.a.x = a_[8 * i];     ac.a.y = a_[8 * i + 1];\
+        ac.b.x = a_[8 * i + 2]; ac.b.y = a_[8 * i + 3];\
+        ac.c.x = a_[8 * i + 4]; ac.c.y = a_[8 * i + 5];\
+        ac.d.x = a_[8 * i + 6]; ac.d.y = a_[8 * i + 7];\
+        bc.a.x = b_[8 * i];     bc.a.y = b_[8 * i + 1];\
+        bc.b.x = b_[8 * i + 2]; bc.b.y = b_[8 * i + 3];\
+        bc.c.x = b_[8 * i + 4]; bc.c.y = b_[8 * i + 5];\
+        bc.d.x = b_[8 * i + 6]; bc.d.y = b_[8 * i + 7];\
+        OSKAR_MUL_COMPLEX_MATRIX_IN_PLACE(FP2, ac, bc)\
+        c_[8 * i]     = ac.a.x; c_[8 * i + 1] = ac.a.y;\
+        c_[8 * i + 2] = ac.b.x; c_[8 * i + 3] = ac.b.y;\
+        c_[8 * i + 4] = ac.c.x; c_[8 * i + 5] = ac.c.y;\
+        c_[8 * i + 6] = ac.d.x; c_[8 * i + 7] = ac.d.y;\
+    }\
+}
+
+MEM_MUL_MM_M_SIMD(mem_mul_mm_m_float_avx2,
+        OSKAR_TARGET_AVX2, float, float2, float4c)
+MEM_MUL_MM_M_SIMD(mem_mul_mm_m_float_avx512,
+        OSKAR_TARGET_AVX512, float, float2, float4c)
+MEM_MUL_MM_M_SIMD(mem_mul_mm_m_double_avx2,
+        OSKAR_TARGET_AVX2, double, double2, double4c)
+MEM_MUL_MM_M_SIMD(mem_mul_mm_m_double_avx512,
+        OSKAR_TARGET_AVX512, double, double2, double4c)
+#endif
+
+static void mem_mul_mm_m_float_cpu(
+        const unsigned int off_a, const unsigned int off_b,
+        const unsigned int off_c, const unsigned int n,
+        const float4c* a, const float4c* b, float4c* c)
+{
+#ifdef OSKAR_HAVE_CPU_SIMD
+    const int simd_level = oskar_cpu_simd_level();
+    if (simd_level >= OSKAR_CPU_SIMD_AVX512)
+        mem_mul_mm_m_float_avx512(off_a, off_b, off_c, n, a, b, c);
+    else if (simd_level == OSKAR_CPU_SIMD_AVX2)
+        mem_mul_mm_m_float_avx2(off_a, off_b, off_c, n, a, b, c);
+    else
+#endif
+    mem_mul_mm_m_float(off_a, off_b, off_c, n, a, b, c);
+}
+
+static void mem_mul_mm_m_double_cpu(
+        const unsigned int off_a, const unsigned int off_b,
+        const unsigned int off_c, const unsigned int n,
+        const double4c* a, const double4c* b, double4c* c)
+{
+#ifdef OSKAR_HAVE_CPU_SIMD
+    const int simd_level = oskar_cpu_simd_level();
+    if (simd_level >= OSKAR_CPU_SIMD_AVX512)
+        mem_mul_mm_m_double_avx512(off_a, off_b, off_c, n, a, b, c);
+    else if (simd_level == OSKAR_CPU_SIMD_AVX2)
+        mem_mul_mm_m_double_avx2(off_a, off_b, off_c, n, a, b, c);
+    else
+#endif
+    mem_mul_mm_m_double(off_a, off_b, off_c, n, a, b, c);
+}
+
 void oskar_mem_multiply(
         oskar_Mem* out,
         const oskar_Mem* in1,
@@ -105,7 +184,7 @@ void oskar_mem_multiply(
                         (const double2*)a, (const double2*)b, (double2*)c);
                 break;
             case OSKAR_DOUBLE_COMPLEX_MATRIX:
-                mem_mul_mm_m_double(off_a, off_b, off_c, n,
+                mem_mul_mm_m_double_cpu(off_a, off_b, off_c, n,
                         (const double4c*)a, (const double4c*)b, (double4c*)c);
                 break;
             case OSKAR_SINGLE:
@@ -117,7 +196,7 @@ void oskar_mem_multiply(
                         (const float2*)a, (const float2*)b, (float2*)c);
                 break;
             case OSKAR_SINGLE_COMPLEX_MATRIX:
-                mem_mul_mm_m_float(off_a, off_b, off_c, n,
+                mem_mul_mm_m_float_cpu(off_a, off_b, off_c, n,
                         (const float4c*)a, (const float4c*)b, (float4c*)c);
                 break;
             default:
@@ -32,6 +32,7 @@
 
 #include "mem/oskar_mem.h"
 #include "mem/private_mem.h"
+#include "mem/private_mem_allocator.h"
 #include "utility/oskar_device.h"
 
 #include <string.h>
@@ -67,23 +68,44 @@ void oskar_mem_realloc(oskar_Mem* mem, size_t num_elements, int* status)
     if (new_size == old_size)
         return;
 
+    /* Resize in place if the existing block is already large enough. */
+    if (new_size > 0 && new_size <= mem->capacity)
+    {
+        /* Initialise the new memory if it's larger than the old block. */
+        if (mem->location == OSKAR_CPU && new_size > old_size)
+            memset((char*)mem->data + old_size, 0, new_size - old_size);
+        mem->num_elements = num_elements;
+        oskar_mem_count_resize_in_place();
+        return;
+    }
+
     /* Check memory location. */
     if (mem->location == OSKAR_CPU)
     {
-        /* Reallocate the memory. */
-        void* mem_new = realloc(mem->data, new_size);
-        if (!mem_new && (new_size > 0))
+        /* Allocate a new block of memory. */
+        size_t capacity = 0;
+        void* mem_new = NULL;
+        if (new_size > 0)
         {
-            *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
-            return;
+            mem_new = oskar_mem_host_alloc(new_size, &capacity, status);
+            if (*status) return;
         }
 
+        /* Copy contents of old block to new block. */
+        const size_t copy_size = (old_size > new_size) ? new_size : old_size;
+        if (copy_size > 0)
+            memcpy(mem_new, mem->data, copy_size);
+
         /* Initialise the new memory if it's larger than the old block. */
         if (new_size > old_size)
             memset((char*)mem_new + old_size, 0, new_size - old_size);
 
+        /* Free the old block. */
+        oskar_mem_host_free(mem->data, mem->capacity);
+
         /* Set the new meta-data. */
-        mem->data = (new_size > 0) ? mem_new : 0;
+        mem->data = mem_new;
+        mem->capacity = capacity;
         mem->num_elements = num_elements;
     }
     else if (mem->location == OSKAR_GPU)
@@ -122,6 +144,7 @@ void oskar_mem_realloc(oskar_Mem* mem, size_t num_elements, int* status)
 
         /* Set the new meta-data. */
         mem->data = mem_new;
+        mem->capacity = new_size;
         mem->num_elements = num_elements;
 #else
         *status = OSKAR_ERR_CUDA_NOT_AVAILABLE;
@@ -159,6 +182,7 @@ void oskar_mem_realloc(oskar_Mem* mem, size_t num_elements, int* status)
         /* Set the new meta-data. */
         mem->buffer = mem_new;
         mem->data = (void*) (mem->buffer);
+        mem->capacity = new_size;
         mem->num_elements = num_elements;
 #else
         *status = OSKAR_ERR_OPENCL_NOT_AVAILABLE;
@@ -0,0 +1,110 @@
+/*
+ * Copyright (c) 2020, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <gtest/gtest.h>
+
+#include "utility/oskar_get_error_string.h"
+#include "mem/oskar_mem.h"
+#include "utility/oskar_thread.h"
+
+#include <stdint.h>
+
+TEST(Mem, allocator_alignment)
+{
+    int status = 0;
+    for (size_t n = 1; n < 5000000; n = 3 * n + 1)
+    {
+        oskar_Mem* mem = oskar_mem_create(OSKAR_SINGLE, OSKAR_CPU, n, &status);
+        ASSERT_EQ(0, status) << oskar_get_error_string(status);
+        EXPECT_EQ(0u, (uintptr_t)oskar_mem_void_const(mem) % 64);
+        EXPECT_GE(oskar_mem_capacity(mem), n);
+        EXPECT_LE(oskar_mem_capacity(mem), n + n / 4 + 16);
+        oskar_mem_free(mem, &status);
+    }
+}
+
+TEST(Mem, allocator_reuse)
+{
+    int status = 0;
+    size_t num_allocated = 0, num_reused = 0, num_in_place = 0;
+    oskar_mem_allocator_release();
+    oskar_mem_allocator_reset_counters();
+    for (int i = 0; i < 10; ++i)
+    {
+        oskar_Mem* mem = oskar_mem_create(OSKAR_DOUBLE_COMPLEX, OSKAR_CPU,
+                12345, &status);
+        const double* data = oskar_mem_double_const(mem, &status);
+        for (int j = 0; j < 2 * 12345; ++j) ASSERT_EQ(0.0, data[j]);
+        oskar_mem_set_value_real(mem, 2.0, 0, 12345, &status);
+        oskar_mem_free(mem, &status);
+    }
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    oskar_mem_allocator_counters(&num_allocated, &num_reused, &num_in_place);
+    EXPECT_EQ(10u, num_allocated);
+    EXPECT_EQ(9u, num_reused);
+    EXPECT_EQ(0u, num_in_place);
+    oskar_mem_allocator_release();
+}
+
+static void* allocate_and_free(void* arg)
+{
+    int* status = (int*) arg;
+    for (int i = 0; i < 2000; ++i)
+    {
+        oskar_Mem* mem = oskar_mem_create(OSKAR_SINGLE, OSKAR_CPU,
+                100 + 37 * (i % 50), status);
+        oskar_mem_set_value_real(mem, 1.0, 0, oskar_mem_length(mem), status);
+        oskar_mem_free(mem, status);
+    }
+    return 0;
+}
+
+TEST(Mem, allocator_threads)
+{
+    const int num_threads = 8;
+    int status[num_threads];
+    oskar_Thread* threads[num_threads];
+    size_t num_allocated = 0, num_reused = 0;
+    oskar_mem_allocator_release();
+    oskar_mem_allocator_reset_counters();
+    for (int i = 0; i < num_threads; ++i)
+    {
+        status[i] = 0;
+        threads[i] = oskar_thread_create(allocate_and_free, &status[i], 0);
+    }
+    for (int i = 0; i < num_threads; ++i)
+    {
+        oskar_thread_join(threads[i]);
+        oskar_thread_free(threads[i]);
+        ASSERT_EQ(0, status[i]) << oskar_get_error_string(status[i]);
+    }
+    oskar_mem_allocator_counters(&num_allocated, &num_reused, 0);
+    EXPECT_EQ((size_t) num_threads * 2000, num_allocated);
+    EXPECT_GT(num_reused, 0u);
+    oskar_mem_allocator_release();
+}
@@ -0,0 +1,103 @@
+/*
+ * Copyright (c) 2020, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <gtest/gtest.h>
+
+#include "mem/oskar_mem.h"
+#include "utility/oskar_cpu_simd_level.h"
+#include "utility/oskar_get_error_string.h"
+
+static void run_multiply_matrix(int type, int max_simd, oskar_Mem* out,
+        oskar_Mem* out_in_place)
+{
+    int status = 0;
+    const int num_elements = 1001;
+    oskar_Mem *in1, *in2;
+    in1 = oskar_mem_create(type, OSKAR_CPU, num_elements + 3, &status);
+    in2 = oskar_mem_create(type, OSKAR_CPU, num_elements + 5, &status);
+    srand(1);
+    oskar_mem_random_range(in1, -2.0, 2.0, &status);
+    oskar_mem_random_range(in2, -2.0, 2.0, &status);
+    oskar_cpu_simd_set_max_level(max_simd);
+
+    // Out-of-place, with different offsets for each array.
+    oskar_mem_multiply(out, in1, in2, 1, 3, 5, num_elements, &status);
+
+    // In-place, as used when joining Jones matrices.
+    oskar_mem_multiply(in1, in1, in2, 0, 0, 0, num_elements, &status);
+    oskar_mem_copy_contents(out_in_place, in1, 0, 0, num_elements, &status);
+    oskar_cpu_simd_set_max_level(OSKAR_CPU_SIMD_AVX512);
+    oskar_mem_free(in1, &status);
+    oskar_mem_free(in2, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+}
+
+static void check_values(const oskar_Mem* approx, const oskar_Mem* accurate,
+        double tol)
+{
+    int status = 0;
+    double min_rel_error, max_rel_error, avg_rel_error, std_rel_error;
+    oskar_mem_evaluate_relative_error(approx, accurate, &min_rel_error,
+            &max_rel_error, &avg_rel_error, &std_rel_error, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    EXPECT_LT(max_rel_error, tol);
+}
+
+static void test_multiply_matrix_simd(int type, double tol)
+{
+    int status = 0;
+    const int num_elements = 1001;
+    oskar_Mem *out_scalar, *out_simd, *in_place_scalar, *in_place_simd;
+    out_scalar = oskar_mem_create(type, OSKAR_CPU, num_elements + 1, &status);
+    out_simd = oskar_mem_create(type, OSKAR_CPU, num_elements + 1, &status);
+    in_place_scalar = oskar_mem_create(type, OSKAR_CPU, num_elements, &status);
+    in_place_simd = oskar_mem_create(type, OSKAR_CPU, num_elements, &status);
+    oskar_mem_clear_contents(out_scalar, &status);
+    oskar_mem_clear_contents(out_simd, &status);
+    run_multiply_matrix(type, OSKAR_CPU_SIMD_NONE,
+            out_scalar, in_place_scalar);
+    run_multiply_matrix(type, OSKAR_CPU_SIMD_AVX512,
+            out_simd, in_place_simd);
+    check_values(out_simd, out_scalar, tol);
+    check_values(in_place_simd, in_place_scalar, tol);
+    oskar_mem_free(out_scalar, &status);
+    oskar_mem_free(out_simd, &status);
+    oskar_mem_free(in_place_scalar, &status);
+    oskar_mem_free(in_place_simd, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+}
+
+TEST(Mem, multiply_matrix_simd_single)
+{
+    test_multiply_matrix_simd(OSKAR_SINGLE_COMPLEX_MATRIX, 1e-5);
+}
+
+TEST(Mem, multiply_matrix_simd_double)
+{
+    test_multiply_matrix_simd(OSKAR_DOUBLE_COMPLEX_MATRIX, 1e-13);
+}
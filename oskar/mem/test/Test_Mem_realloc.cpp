@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2013-2017, The University of Oxford
+ * Copyright (c) 2013-2020, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -60,3 +60,33 @@ TEST(Mem, realloc_cpu)
     oskar_mem_free(mem, &status);
     ASSERT_EQ(0, status) << oskar_get_error_string(status);
 }
+
+
+TEST(Mem, realloc_cpu_in_place)
+{
+    int status = 0;
+    oskar_Mem *mem = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, 1000, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    ASSERT_GE(oskar_mem_capacity(mem), (size_t)1000);
+    oskar_mem_set_value_real(mem, 1.0, 0, 1000, &status);
+    const void* ptr = oskar_mem_void_const(mem);
+
+    // Shrink and grow again: the block should not move,
+    // and the elements exposed again should be zero.
+    oskar_mem_realloc(mem, 10, &status);
+    ASSERT_EQ(10, (int)oskar_mem_length(mem));
+    oskar_mem_ensure(mem, 1000, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    ASSERT_EQ(1000, (int)oskar_mem_length(mem));
+    EXPECT_EQ(ptr, oskar_mem_void_const(mem));
+    const double* data = oskar_mem_double_const(mem, &status);
+    for (int i = 0; i < 10; ++i) EXPECT_DOUBLE_EQ(1.0, data[i]);
+    for (int i = 10; i < 1000; ++i) EXPECT_DOUBLE_EQ(0.0, data[i]);
+
+    // Resize to zero should release the block.
+    oskar_mem_realloc(mem, 0, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    EXPECT_EQ(0, (int)oskar_mem_capacity(mem));
+    EXPECT_FALSE(oskar_mem_allocated(mem));
+    oskar_mem_free(mem, &status);
+}
@@ -34,6 +34,7 @@
  */
 
 #include <ms/oskar_ms_macros.h>
+#include <stddef.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -61,6 +62,42 @@ oskar_MeasurementSet* oskar_ms_create(const char* file_name,
         unsigned int num_channels, unsigned int num_pols, double freq_start_hz,
         double freq_inc_hz, int write_autocorr, int write_crosscorr);
 
+/**
+ * @brief Creates a new Measurement Set with the given tile limits.
+ *
+ * @details
+ * Creates a new, empty Measurement Set with the given name, using
+ * tiled storage for the DATA column which spans at most
+ * \p max_tile_channels channels and \p max_tile_bytes bytes per tile.
+ * Tiles are channel-blocked so that reading a subset of the band
+ * does not require the whole spectrum to be read from disk.
+ *
+ * The FLAG column is stored using the incremental storage manager,
+ * so it takes almost no space if the flags do not change.
+ *
+ * If either limit is 0, a default value is used.
+ * oskar_ms_create() is equivalent to calling this function with
+ * both limits set to 0.
+ *
+ * @param[in] file_name         The file name to use.
+ * @param[in] app_name          The name of the application creating the MS.
+ * @param[in] num_stations      The number of antennas/stations.
+ * @param[in] num_channels      The number of channels in the band.
+ * @param[in] num_pols          The number of polarisations (1, 2 or 4).
+ * @param[in] freq_start_hz     The frequency at the centre of channel 0, in Hz.
+ * @param[in] freq_inc_hz       The channel separation, in Hz.
+ * @param[in] write_autocorr    If set, write auto-correlation data.
+ * @param[in] write_crosscorr   If set, write cross-correlation data.
+ * @param[in] max_tile_channels Maximum number of channels in a data tile.
+ * @param[in] max_tile_bytes    Maximum size of a data tile, in bytes.
+ */
+OSKAR_MS_EXPORT
+oskar_MeasurementSet* oskar_ms_create_tiled(const char* file_name,
+        const char* app_name, unsigned int num_stations,
+        unsigned int num_channels, unsigned int num_pols, double freq_start_hz,
+        double freq_inc_hz, int write_autocorr, int write_crosscorr,
+        unsigned int max_tile_channels, size_t max_tile_bytes);
+
 #ifdef __cplusplus
 }
 #endif
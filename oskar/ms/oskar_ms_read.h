@@ -60,6 +60,38 @@ void oskar_ms_read_column(const oskar_MeasurementSet* p, const char* column,
         size_t data_size_bytes, void* data, size_t* required_size_bytes,
         int* status);
 
+/**
+ * @brief Gets a range of channels from one column in a Measurement Set.
+ *
+ * @details
+ * Gets data for a range of channels from one array column in a
+ * Measurement Set. The column must have (polarisation, channel) cells,
+ * as the DATA and FLAG columns do.
+ *
+ * Only the requested channels are read from the table, so this is
+ * more efficient than oskar_ms_read_column() if a subset of the band is
+ * needed. The data are returned in the same order as
+ * oskar_ms_read_column(), with polarisation the fastest varying dimension,
+ * then channel, and row the slowest.
+ *
+ * @param[in] p                     Pointer to opened Measurement Set.
+ * @param[in] column                Name of required column in main table.
+ * @param[in] start_row             Start row.
+ * @param[in] num_rows              Number of rows to return.
+ * @param[in] start_channel         Start channel index (zero-based).
+ * @param[in] num_channels          Number of channels to return.
+ * @param[in] data_size_bytes       Data size of allocated block, in bytes.
+ * @param[in,out] data              Data block to fill.
+ * @param[out] required_size_bytes  Required size of the data block, in bytes.
+ * @param[in,out] status            Status return code.
+ */
+OSKAR_MS_EXPORT
+void oskar_ms_read_column_channels(const oskar_MeasurementSet* p,
+        const char* column, unsigned int start_row, unsigned int num_rows,
+        unsigned int start_channel, unsigned int num_channels,
+        size_t data_size_bytes, void* data, size_t* required_size_bytes,
+        int* status);
+
 /**
  * @details
  * Reads baseline coordinate data from the main table.
@@ -173,6 +173,96 @@ void oskar_ms_write_vis_f(oskar_MeasurementSet* p,
         unsigned int num_channels, unsigned int num_baselines,
         const float* vis);
 
+/**
+ * @details
+ * Writes rows of baseline-dependent averaged data to the main table.
+ *
+ * @details
+ * This function writes a list of rows, each with its own antenna indices,
+ * time centroid and number of averaged samples, to the main table of the
+ * Measurement Set, extending it if necessary.
+ *
+ * The INTERVAL and EXPOSURE columns of each row are set to the given
+ * values multiplied by the number of samples in the row, the WEIGHT column
+ * is set to the number of samples, and SIGMA to its inverse square root.
+ *
+ * The dimensionality of the complex \p vis data block is:
+ * (num_rows * num_channels * num_pols),
+ * with num_pols the fastest varying dimension, then num_channels,
+ * and num_rows the slowest.
+ *
+ * Time centroids are given in units of (MJD) * 86400, i.e. seconds since
+ * Julian date 2400000.5.
+ *
+ * @param[in] start_row     The start row index to write (zero-based).
+ * @param[in] num_rows      Number of rows to write to the main table.
+ * @param[in] start_channel The start channel index of the visibility block.
+ * @param[in] num_channels  The number of channels in the visibility block.
+ * @param[in] antenna1      First antenna index of each row.
+ * @param[in] antenna2      Second antenna index of each row.
+ * @param[in] num_samples   Number of samples averaged in each row.
+ * @param[in] time_centroid Time centroid of each row.
+ * @param[in] uu            Baseline u-coordinates, in metres.
+ * @param[in] vv            Baseline v-coordinates, in metres.
+ * @param[in] ww            Baseline w-coordinates, in metres.
+ * @param[in] exposure_sec  The exposure length per sample, in seconds.
+ * @param[in] interval_sec  The interval length per sample, in seconds.
+ * @param[in] vis           Pointer to complex visibility block.
+ */
+OSKAR_MS_EXPORT
+void oskar_ms_write_rows_d(oskar_MeasurementSet* p,
+        unsigned int start_row, unsigned int num_rows,
+        unsigned int start_channel, unsigned int num_channels,
+        const int* antenna1, const int* antenna2, const int* num_samples,
+        const double* time_centroid,
+        const double* uu, const double* vv, const double* ww,
+        double exposure_sec, double interval_sec, const double* vis);
+
+/**
+ * @details
+ * Writes rows of baseline-dependent averaged data to the main table.
+ *
+ * @details
+ * This function writes a list of rows, each with its own antenna indices,
+ * time centroid and number of averaged samples, to the main table of the
+ * Measurement Set, extending it if necessary.
+ *
+ * The INTERVAL and EXPOSURE columns of each row are set to the given
+ * values multiplied by the number of samples in the row, the WEIGHT column
+ * is set to the number of samples, and SIGMA to its inverse square root.
+ *
+ * The dimensionality of the complex \p vis data block is:
+ * (num_rows * num_channels * num_pols),
+ * with num_pols the fastest varying dimension, then num_channels,
+ * and num_rows the slowest.
+ *
+ * Time centroids are given in units of (MJD) * 86400, i.e. seconds since
+ * Julian date 2400000.5.
+ *
+ * @param[in] start_row     The start row index to write (zero-based).
+ * @param[in] num_rows      Number of rows to write to the main table.
+ * @param[in] start_channel The start channel index of the visibility block.
+ * @param[in] num_channels  The number of channels in the visibility block.
+ * @param[in] antenna1      First antenna index of each row.
+ * @param[in] antenna2      Second antenna index of each row.
+ * @param[in] num_samples   Number of samples averaged in each row.
+ * @param[in] time_centroid Time centroid of each row.
+ * @param[in] uu            Baseline u-coordinates, in metres.
+ * @param[in] vv            Baseline v-coordinates, in metres.
+ * @param[in] ww            Baseline w-coordinates, in metres.
+ * @param[in] exposure_sec  The exposure length per sample, in seconds.
+ * @param[in] interval_sec  The interval length per sample, in seconds.
+ * @param[in] vis           Pointer to complex visibility block.
+ */
+OSKAR_MS_EXPORT
+void oskar_ms_write_rows_f(oskar_MeasurementSet* p,
+        unsigned int start_row, unsigned int num_rows,
+        unsigned int start_channel, unsigned int num_channels,
+        const int* antenna1, const int* antenna2, const int* num_samples,
+        const double* time_centroid,
+        const float* uu, const float* vv, const float* ww,
+        double exposure_sec, double interval_sec, const float* vis);
+
 #ifdef __cplusplus
 }
 #endif
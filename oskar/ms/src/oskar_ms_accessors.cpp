@@ -121,6 +121,15 @@ void oskar_ms_ensure_num_rows(oskar_MeasurementSet* p, unsigned int num)
 {
     if (!p->ms) return;
     int rows_to_add = (int)num - (int)(p->ms->nrow());
+    if (rows_to_add > 0 && p->ms->nrow() == 0 && p->msmc)
+    {
+        // Write the default flags into the first row only.
+        // Rows added later inherit them from the incremental storage manager.
+        p->ms->addRow(1);
+        p->msmc->flag().put(0,
+                Array<Bool>(IPosition(2, p->num_pols, p->num_channels), false));
+        rows_to_add--;
+    }
     if (rows_to_add > 0)
         p->ms->addRow((unsigned int)rows_to_add);
 }
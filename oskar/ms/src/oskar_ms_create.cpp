@@ -46,10 +46,25 @@ static void oskar_ms_add_band(oskar_MeasurementSet* p, int pol_id,
         const Vector<double>& chan_widths);
 static void oskar_ms_add_pol(oskar_MeasurementSet* p, unsigned int num_pols);
 
+// Default tile limits for the DATA column.
+#define DEFAULT_TILE_CHANNELS 64
+#define DEFAULT_TILE_BYTES (1024 * 1024)
+
 oskar_MeasurementSet* oskar_ms_create(const char* file_name,
         const char* app_name, unsigned int num_stations,
         unsigned int num_channels, unsigned int num_pols, double freq_start_hz,
         double freq_inc_hz, int write_autocorr, int write_crosscorr)
+{
+    return oskar_ms_create_tiled(file_name, app_name, num_stations,
+            num_channels, num_pols, freq_start_hz, freq_inc_hz,
+            write_autocorr, write_crosscorr, 0, 0);
+}
+
+oskar_MeasurementSet* oskar_ms_create_tiled(const char* file_name,
+        const char* app_name, unsigned int num_stations,
+        unsigned int num_channels, unsigned int num_pols, double freq_start_hz,
+        double freq_inc_hz, int write_autocorr, int write_crosscorr,
+        unsigned int max_tile_channels, size_t max_tile_bytes)
 {
     oskar_MeasurementSet* p = (oskar_MeasurementSet*)
             calloc(1, sizeof(oskar_MeasurementSet));
@@ -68,8 +83,6 @@ oskar_MeasurementSet* oskar_ms_create(const char* file_name,
     Vector<String> tsmNames(1);
     tsmNames[0] = MS::columnName(MS::DATA);
     desc.defineHypercolumn("TiledData", 3, tsmNames);
-    tsmNames[0] = MS::columnName(MS::FLAG);
-    desc.defineHypercolumn("TiledFlag", 3, tsmNames);
     tsmNames[0] = MS::columnName(MS::UVW);
     desc.defineHypercolumn("TiledUVW", 2, tsmNames);
     tsmNames[0] = MS::columnName(MS::WEIGHT);
@@ -95,6 +108,8 @@ oskar_MeasurementSet* oskar_ms_create(const char* file_name,
         SetupNewTable tab(file_name, desc, Table::New);
 
         // Create the default storage managers.
+        // The FLAG column is not tiled: it uses the incremental storage
+        // manager, which stores a value only when it changes between rows.
         IncrementalStMan incrStorageManager("ISMData");
         tab.bindAll(incrStorageManager);
         StandardStMan stdStorageManager("SSMData", 32768, 32768);
@@ -114,13 +129,21 @@ oskar_MeasurementSet* oskar_ms_create(const char* file_name,
         TiledColumnStMan sigmaStorageManager("TiledSigma", sigmaTileShape);
         tab.bindColumn(MS::columnName(MS::SIGMA), sigmaStorageManager);
 
-        // Create tiled column storage managers for DATA and FLAG columns.
-        IPosition dataTileShape(3, num_pols, num_channels, 2 * num_baselines);
+        // Create tiled column storage manager for DATA column.
+        // Tiles are blocked in channel, and the number of rows in each tile
+        // is limited so that the tile size stays within the byte limit.
+        if (max_tile_channels == 0) max_tile_channels = DEFAULT_TILE_CHANNELS;
+        if (max_tile_bytes == 0) max_tile_bytes = DEFAULT_TILE_BYTES;
+        unsigned int tile_channels = num_channels;
+        if (tile_channels > max_tile_channels)
+            tile_channels = max_tile_channels;
+        size_t tile_rows = max_tile_bytes /
+                (num_pols * tile_channels * sizeof(Complex));
+        if (tile_rows > 2 * num_baselines) tile_rows = 2 * num_baselines;
+        if (tile_rows == 0) tile_rows = 1;
+        IPosition dataTileShape(3, num_pols, tile_channels, tile_rows);
         TiledColumnStMan dataStorageManager("TiledData", dataTileShape);
         tab.bindColumn(MS::columnName(MS::DATA), dataStorageManager);
-        IPosition flagTileShape(3, num_pols, num_channels, 16 * num_baselines);
-        TiledColumnStMan flagStorageManager("TiledFlag", flagTileShape);
-        tab.bindColumn(MS::columnName(MS::FLAG), flagStorageManager);
 
         // Create the Measurement Set.
         p->ms = new MeasurementSet(tab, TableLock(TableLock::PermanentLocking));
@@ -58,6 +58,32 @@ void copy_array(const oskar_MeasurementSet* p, const char* column,
     }
 }
 
+template<typename T>
+void copy_array_channels(const oskar_MeasurementSet* p, const char* column,
+        unsigned int start_row, unsigned int num_rows,
+        unsigned int start_channel, unsigned int num_channels,
+        size_t data_size_bytes, void* data, size_t* required_size,
+        int* status)
+{
+    try
+    {
+        Slicer row_range(IPosition(1, start_row), IPosition(1, num_rows));
+        Slicer array_section(IPosition(2, 0, start_channel),
+                IPosition(2, p->num_pols, num_channels));
+        ArrayColumn<T> ac(*(p->ms), column);
+        Array<T> a = ac.getColumnRange(row_range, array_section);
+        *required_size = a.size() * sizeof(T);
+        if (data_size_bytes >= *required_size)
+            memcpy(data, a.data(), *required_size);
+        else
+            *status = OSKAR_ERR_MS_OUT_OF_RANGE;
+    }
+    catch (...)
+    {
+        *status = OSKAR_ERR_MS_NO_DATA;
+    }
+}
+
 template<typename T>
 void copy_scalar(const oskar_MeasurementSet* p, const char* column,
         unsigned int start_row, unsigned int num_rows,
@@ -196,6 +222,68 @@ void oskar_ms_read_column(const oskar_MeasurementSet* p, const char* column,
     }
 }
 
+void oskar_ms_read_column_channels(const oskar_MeasurementSet* p,
+        const char* column, unsigned int start_row, unsigned int num_rows,
+        unsigned int start_channel, unsigned int num_channels,
+        size_t data_size_bytes, void* data, size_t* required_size_bytes,
+        int* status)
+{
+    if (*status || !p->ms) return;
+
+    // Check that the column exists and has one cell per channel.
+    if (!p->ms->tableDesc().isColumn(column))
+    {
+        *status = OSKAR_ERR_MS_COLUMN_NOT_FOUND;
+        return;
+    }
+    const ColumnDesc& cdesc = p->ms->tableDesc().columnDesc(column);
+    if (cdesc.isScalar() || cdesc.ndim() != 2)
+    {
+        *status = OSKAR_ERR_MS_COLUMN_NOT_FOUND;
+        return;
+    }
+
+    // Check that some data are selected.
+    if (num_rows == 0 || num_channels == 0) return;
+
+    // Check that the row and channel ranges are within the table bounds.
+    unsigned int total_rows = p->ms->nrow();
+    if (start_row >= total_rows ||
+            start_channel + num_channels > p->num_channels)
+    {
+        *status = OSKAR_ERR_MS_OUT_OF_RANGE;
+        return;
+    }
+    if (start_row + num_rows > total_rows)
+        num_rows = total_rows - start_row;
+
+    switch (cdesc.dataType())
+    {
+    case TpBool:
+        copy_array_channels<Bool>(p, column, start_row, num_rows,
+                start_channel, num_channels,
+                data_size_bytes, data, required_size_bytes, status); break;
+    case TpFloat:
+        copy_array_channels<Float>(p, column, start_row, num_rows,
+                start_channel, num_channels,
+                data_size_bytes, data, required_size_bytes, status); break;
+    case TpDouble:
+        copy_array_channels<Double>(p, column, start_row, num_rows,
+                start_channel, num_channels,
+                data_size_bytes, data, required_size_bytes, status); break;
+    case TpComplex:
+        copy_array_channels<Complex>(p, column, start_row, num_rows,
+                start_channel, num_channels,
+                data_size_bytes, data, required_size_bytes, status); break;
+    case TpDComplex:
+        copy_array_channels<DComplex>(p, column, start_row, num_rows,
+                start_channel, num_channels,
+                data_size_bytes, data, required_size_bytes, status); break;
+    default:
+        *status = OSKAR_ERR_MS_UNKNOWN_DATA_TYPE; break;
+    }
+}
+
 template <typename T>
 void oskar_ms_read_coords(oskar_MeasurementSet* p,
         unsigned int start_row, unsigned int num_baselines,
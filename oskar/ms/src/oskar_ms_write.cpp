@@ -32,6 +32,8 @@
 #include <tables/Tables.h>
 #include <casa/Arrays/Vector.h>
 
+#include <cmath>
+
 using namespace casacore;
 
 static void oskar_ms_create_baseline_indices(oskar_MeasurementSet* p,
@@ -223,3 +225,108 @@ void oskar_ms_write_vis_f(oskar_MeasurementSet* p,
     oskar_ms_write_vis(p, start_row, start_channel,
             num_channels, num_baselines, vis);
 }
+
+template <typename T>
+void oskar_ms_write_rows(oskar_MeasurementSet* p,
+        unsigned int start_row, unsigned int num_rows,
+        unsigned int start_channel, unsigned int num_channels,
+        const int* antenna1, const int* antenna2, const int* num_samples,
+        const double* time_centroid, const T* uu, const T* vv, const T* ww,
+        double exposure_sec, double interval_sec, const T* vis)
+{
+    MSMainColumns* msmc = p->msmc;
+    if (!msmc || num_rows == 0) return;
+
+    // Allocate storage for a (u,v,w) coordinate and a visibility weight.
+    unsigned int num_pols = p->num_pols;
+    Vector<Double> uvw(3);
+    Vector<Float> weight(num_pols), sigma(num_pols);
+
+    // Get references to columns.
+    ArrayColumn<Double>& col_uvw = msmc->uvw();
+    ScalarColumn<Int>& col_antenna1 = msmc->antenna1();
+    ScalarColumn<Int>& col_antenna2 = msmc->antenna2();
+    ArrayColumn<Float>& col_weight = msmc->weight();
+    ArrayColumn<Float>& col_sigma = msmc->sigma();
+    ScalarColumn<Double>& col_exposure = msmc->exposure();
+    ScalarColumn<Double>& col_interval = msmc->interval();
+    ScalarColumn<Double>& col_time = msmc->time();
+    ScalarColumn<Double>& col_timeCentroid = msmc->timeCentroid();
+
+    // Add new rows if required.
+    oskar_ms_ensure_num_rows(p, start_row + num_rows);
+
+    // Loop over rows to add.
+    for (unsigned int r = 0; r < num_rows; ++r)
+    {
+        // Write the data to the Measurement Set.
+        unsigned int row = r + start_row;
+        const double n = (double) num_samples[r];
+        const double interval = n * interval_sec;
+        uvw(0) = uu[r]; uvw(1) = vv[r]; uvw(2) = ww[r];
+        weight = (Float) n;
+        sigma = (Float) (1.0 / sqrt(n));
+        col_uvw.put(row, uvw);
+        col_antenna1.put(row, antenna1[r]);
+        col_antenna2.put(row, antenna2[r]);
+        col_weight.put(row, weight);
+        col_sigma.put(row, sigma);
+        col_exposure.put(row, n * exposure_sec);
+        col_interval.put(row, interval);
+        col_time.put(row, time_centroid[r]);
+        col_timeCentroid.put(row, time_centroid[r]);
+
+        // Update time range if required.
+        if (time_centroid[r] - interval/2.0 < p->start_time)
+            p->start_time = time_centroid[r] - interval/2.0;
+        if (time_centroid[r] + interval/2.0 > p->end_time)
+            p->end_time = time_centroid[r] + interval/2.0;
+    }
+
+    // Copy visibility data into the array.
+    // The dimension order is already the same as the Measurement Set.
+    IPosition shape(3, num_pols, num_channels, num_rows);
+    Array<Complex> vis_data(shape);
+    float* out = (float*) vis_data.data();
+    const size_t num_values = 2 * (size_t) num_pols * num_channels * num_rows;
+    for (size_t i = 0; i < num_values; ++i)
+        out[i] = (float) vis[i];
+
+    // Write visibilities to DATA column.
+    IPosition start1(1, start_row);
+    IPosition length1(1, num_rows);
+    Slicer row_range(start1, length1);
+    IPosition start2(2, 0, start_channel);
+    IPosition length2(2, num_pols, num_channels);
+    Slicer array_section(start2, length2);
+    ArrayColumn<Complex>& col_data = msmc->data();
+    col_data.putColumnRange(row_range, array_section, vis_data);
+    p->time_inc_sec = interval_sec;
+    p->data_written = 1;
+}
+
+void oskar_ms_write_rows_d(oskar_MeasurementSet* p,
+        unsigned int start_row, unsigned int num_rows,
+        unsigned int start_channel, unsigned int num_channels,
+        const int* antenna1, const int* antenna2, const int* num_samples,
+        const double* time_centroid,
+        const double* uu, const double* vv, const double* ww,
+        double exposure_sec, double interval_sec, const double* vis)
+{
+    oskar_ms_write_rows(p, start_row, num_rows, start_channel, num_channels,
+            antenna1, antenna2, num_samples, time_centroid, uu, vv, ww,
+            exposure_sec, interval_sec, vis);
+}
+
+void oskar_ms_write_rows_f(oskar_MeasurementSet* p,
+        unsigned int start_row, unsigned int num_rows,
+        unsigned int start_channel, unsigned int num_channels,
+        const int* antenna1, const int* antenna2, const int* num_samples,
+        const double* time_centroid,
+        const float* uu, const float* vv, const float* ww,
+        double exposure_sec, double interval_sec, const float* vis)
+{
+    oskar_ms_write_rows(p, start_row, num_rows, start_channel, num_channels,
+            antenna1, antenna2, num_samples, time_centroid, uu, vv, ww,
+            exposure_sec, interval_sec, vis);
+}
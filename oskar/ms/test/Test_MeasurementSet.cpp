@@ -182,3 +182,84 @@ TEST(MeasurementSet, test_multi_channel)
     free(uvw);
     oskar_ms_close(ms);
 }
+
+
+TEST(MeasurementSet, test_read_channel_range)
+{
+    int status = 0;
+
+    // Define the data dimensions.
+    int n_ant = 4;           // Number of antennas.
+    int n_pol = 4;           // Number of polarisations.
+    int n_chan = 10;         // Number of channels.
+    int n_times = 3;         // Number of correlator dumps.
+    int start_chan = 3;      // First channel to read back.
+    int n_chan_read = 5;     // Number of channels to read back.
+
+    // Create the Measurement Set, using tiles smaller than the band.
+    oskar_MeasurementSet* ms = oskar_ms_create_tiled("channel_range.ms",
+            "test", n_ant, n_chan, n_pol, 400e6, 25e3, 0, 1, 4, 256);
+    ASSERT_TRUE(ms);
+    oskar_ms_set_phase_centre(ms, 0, 0.0, 1.570796);
+
+    // Write test data.
+    int n_baselines = n_ant * (n_ant - 1) / 2;
+    std::vector<double> u(n_baselines, 1.0), v(n_baselines, 2.0);
+    std::vector<double> w(n_baselines, 3.0);
+    std::vector< std::complex<double> > vis_data(n_pol * n_chan * n_baselines);
+    for (int t = 0; t < n_times; ++t)
+    {
+        oskar_ms_write_coords_d(ms, t * n_baselines, n_baselines,
+                &u[0], &v[0], &w[0], 90.0, 90.0, (double)t);
+        for (int c = 0; c < n_chan; ++c)
+            for (int b = 0; b < n_baselines; ++b)
+                for (int p = 0; p < n_pol; ++p)
+                    vis_data[c * n_baselines * n_pol + b * n_pol + p] =
+                            std::complex<double>(100.0 * c + p, t + 0.5 * b);
+        oskar_ms_write_vis_d(ms, t * n_baselines, 0, n_chan, n_baselines,
+                (double*)(&vis_data[0]));
+    }
+
+    // Read a range of channels back again.
+    int n_rows = n_baselines * n_times;
+    size_t vis_size = n_rows * n_chan_read * n_pol *
+            sizeof(std::complex<float>);
+    size_t required_size = 0;
+    std::vector< std::complex<float> > vis(n_rows * n_chan_read * n_pol);
+    oskar_ms_read_column_channels(ms, "DATA", 0, n_rows,
+            start_chan, n_chan_read, vis_size, &vis[0], &required_size,
+            &status);
+    ASSERT_EQ(0, status);
+    ASSERT_EQ(vis_size, required_size);
+    for (int r = 0; r < n_rows; ++r)
+    {
+        const int t = r / n_baselines, b = r % n_baselines;
+        for (int c = 0; c < n_chan_read; ++c)
+        {
+            for (int p = 0; p < n_pol; ++p)
+            {
+                const std::complex<float>& val =
+                        vis[(r * n_chan_read + c) * n_pol + p];
+                ASSERT_EQ(100.0 * (c + start_chan) + p, val.real());
+                ASSERT_EQ(t + 0.5 * b, val.imag());
+            }
+        }
+    }
+
+    // Check that a range past the end of the band is rejected.
+    oskar_ms_read_column_channels(ms, "DATA", 0, n_rows,
+            n_chan - 1, 2, vis_size, &vis[0], &required_size, &status);
+    ASSERT_EQ((int) OSKAR_ERR_MS_OUT_OF_RANGE, status);
+    status = 0;
+
+    // Check that the default flags are set for every row.
+    size_t flag_size = n_rows * n_chan * n_pol * sizeof(bool);
+    std::vector<char> flags(flag_size, 1);
+    oskar_ms_read_column(ms, "FLAG", 0, n_rows, flag_size, &flags[0],
+            &required_size, &status);
+    ASSERT_EQ(0, status);
+    ASSERT_EQ(flag_size, required_size);
+    for (size_t i = 0; i < flag_size; ++i)
+        ASSERT_EQ(0, flags[i]);
+    oskar_ms_close(ms);
+}
@@ -43,6 +43,7 @@
 #include <utility/oskar_get_error_string.h>
 #include <utility/oskar_timer.h>
 #include <utility/oskar_version_string.h>
+#include <vis/oskar_vis_bda.h>
 #include <vis/oskar_vis_block.h>
 #include <vis/oskar_vis_header.h>
 
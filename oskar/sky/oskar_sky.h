@@ -62,7 +62,10 @@ enum OSKAR_SKY_TAGS
     OSKAR_SKY_TAG_FWHM_MAJOR = 11,
     OSKAR_SKY_TAG_FWHM_MINOR = 12,
     OSKAR_SKY_TAG_POSITION_ANGLE = 13,
-    OSKAR_SKY_TAG_ROTATION_MEASURE = 14
+    OSKAR_SKY_TAG_ROTATION_MEASURE = 14,
+    OSKAR_SKY_TAG_SOURCE_FILE_SIZE = 15,
+    OSKAR_SKY_TAG_SOURCE_FILE_MTIME = 16,
+    OSKAR_SKY_TAG_SOURCE_FILE_CRC = 17
 };
 
 #ifdef __cplusplus
@@ -88,6 +91,7 @@ enum OSKAR_SKY_TAGS
 #include <sky/oskar_sky_generate_random_power_law.h>
 #include <sky/oskar_sky_horizon_clip.h>
 #include <sky/oskar_sky_load.h>
+#include <sky/oskar_sky_load_cached.h>
 #include <sky/oskar_sky_override_polarisation.h>
 #include <sky/oskar_sky_read.h>
 #include <sky/oskar_sky_resize.h>
@@ -0,0 +1,74 @@
+/*
+ * Copyright (c) 2020, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef OSKAR_SKY_LOAD_CACHED_H_
+#define OSKAR_SKY_LOAD_CACHED_H_
+
+/**
+ * @file oskar_sky_load_cached.h
+ */
+
+#include <oskar_global.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief
+ * Loads a plain text sky model file, using a binary cache if possible.
+ *
+ * @details
+ * Loads a plain text sky model file as oskar_sky_load() does, but first
+ * checks for a binary copy of the same data in \p cache_filename.
+ *
+ * The cache is used only if it was made from a file of the same size,
+ * modification time and CRC-32C checksum as the text file, and if it holds
+ * data of the requested type. Otherwise, the text file is loaded and a new
+ * cache file is written in the OSKAR binary sky model format.
+ * Failure to write the cache is not an error.
+ *
+ * If \p cache_filename is NULL or empty, the cache is written alongside
+ * the text file, with ".cache" appended to its name.
+ *
+ * @param[in]  filename        Path to a source list text file.
+ * @param[in]  cache_filename  Path to the binary cache file (may be NULL).
+ * @param[in]  type            Required data type (OSKAR_SINGLE or OSKAR_DOUBLE).
+ * @param[in,out] status       Status return code.
+ *
+ * @return A handle to the sky model structure, or NULL if an error occurred.
+ */
+OSKAR_EXPORT
+oskar_Sky* oskar_sky_load_cached(const char* filename,
+        const char* cache_filename, int type, int* status);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OSKAR_SKY_LOAD_CACHED_H_ */
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2011-2015, The University of Oxford
+ * Copyright (c) 2011-2020, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -25,13 +25,24 @@
  * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
  * POSSIBILITY OF SUCH DAMAGE.
  */
-
+#include "sky/private_sky.h"
 #include "sky/oskar_sky.h"
-#include "utility/oskar_getline.h"
 #include "utility/oskar_string_to_array.h"
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+
+#ifndef OSKAR_OS_WIN
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 #ifdef __cplusplus
 extern "C" {
@@ -40,61 +51,137 @@ extern "C" {
 static const double deg2rad = 1.74532925199432957692369e-2;
 static const double arcsec2rad = 4.84813681109535993589914e-6;
 
-oskar_Sky* oskar_sky_load(const char* filename, int type, int* status)
-{
-    int n = 0;
-    FILE* file;
-    char* line = 0;
-    size_t bufsize = 0;
-    oskar_Sky* sky;
-
-    /* Check if safe to proceed. */
-    if (*status) return 0;
+/* Number of text chunks per thread, for load balancing. */
+#define CHUNKS_PER_THREAD 8
 
-    /* Get the data type. */
-    if (type != OSKAR_SINGLE && type != OSKAR_DOUBLE)
+/* Maps (or reads) the whole file into memory. */
+static char* map_file(const char* filename, size_t* size, int* status)
+{
+    char* data = 0;
+#ifdef OSKAR_OS_WIN
+    __int64 len = 0;
+    FILE* file = fopen(filename, "rb");
+    *size = 0;
+    if (!file)
     {
-        *status = OSKAR_ERR_BAD_DATA_TYPE;
+        *status = OSKAR_ERR_FILE_IO;
         return 0;
     }
-
-    /* Open the file. */
-    file = fopen(filename, "r");
-    if (!file)
+    _fseeki64(file, 0, SEEK_END);
+    len = _ftelli64(file);
+    _fseeki64(file, 0, SEEK_SET);
+    if (len > 0)
+    {
+        data = (char*) malloc((size_t) len);
+        if (!data)
+            *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+        else if (fread(data, 1, (size_t) len, file) != (size_t) len)
+            *status = OSKAR_ERR_FILE_IO;
+        else
+            *size = (size_t) len;
+    }
+    fclose(file);
+#else
+    struct stat st;
+    const int fd = open(filename, O_RDONLY);
+    *size = 0;
+    if (fd < 0)
     {
         *status = OSKAR_ERR_FILE_IO;
         return 0;
     }
+    if (fstat(fd, &st) != 0)
+        *status = OSKAR_ERR_FILE_IO;
+    else if (st.st_size > 0)
+    {
+        void* ptr = mmap(0, (size_t) st.st_size, PROT_READ, MAP_PRIVATE,
+                fd, 0);
+        if (ptr == MAP_FAILED)
+            *status = OSKAR_ERR_FILE_IO;
+        else
+        {
+            data = (char*) ptr;
+            *size = (size_t) st.st_size;
+#ifdef POSIX_MADV_SEQUENTIAL
+            posix_madvise(ptr, *size, POSIX_MADV_SEQUENTIAL);
+#endif
+        }
+    }
+    close(fd);
+#endif
+    return data;
+}
+
+static void unmap_file(char* data, size_t size)
+{
+    if (!data) return;
+#ifdef OSKAR_OS_WIN
+    (void) size;
+    free(data);
+#else
+    munmap(data, size);
+#endif
+}
 
-    /* Initialise the sky model. */
-    sky = oskar_sky_create(type, OSKAR_CPU, 0, status);
+/* Returns the number of lines in the given range of text. */
+static int count_lines(const char* start, const char* end)
+{
+    int n = 0;
+    const char* p = start;
+    while (p < end)
+    {
+        p = (const char*) memchr(p, '\n', (size_t) (end - p));
+        if (!p) return n + 1; /* Final line without a terminator. */
+        ++p;
+        ++n;
+    }
+    return n;
+}
 
-    /* Loop over lines in file. */
-    while (oskar_getline(&line, &bufsize, file) != OSKAR_ERR_EOF)
+/*
+ * Parses all the lines in the given range of text, writing sources into
+ * the sky model starting at index "offset". Returns the number written.
+ */
+static int parse_lines(const char* start, const char* end, oskar_Sky* sky,
+        int offset, char** buffer, size_t* buffer_size, int* status)
+{
+    int n = 0;
+    const char* p = start;
+    while (p < end && !*status)
     {
-        /* Set defaults. */
         /* RA, Dec, I, Q, U, V, freq0, spix, RM, FWHM maj, FWHM min, PA */
         double par[] = {0., 0., 0., 0., 0., 0., 0., 0., 0., 0., 0., 0.};
         size_t num_param = sizeof(par) / sizeof(double);
-        size_t num_required = 3, num_read = 0;
-
-        /* Load source parameters (require at least RA, Dec, Stokes I). */
-        num_read = oskar_string_to_array_d(line, num_param, par);
-        if (num_read < num_required)
-            continue;
+        size_t num_required = 3, num_read = 0, len = 0;
+        const char* eol = (const char*) memchr(p, '\n', (size_t) (end - p));
+        if (!eol) eol = end;
+        len = (size_t) (eol - p);
 
-        /* Ensure enough space in arrays. */
-        if (oskar_sky_num_sources(sky) <= n)
+        /* Copy the line into a NULL-terminated buffer for parsing. */
+        if (len + 1 > *buffer_size)
         {
-            oskar_sky_resize(sky, n + 100, status);
-            if (*status)
+            void* t = realloc(*buffer, len + 1);
+            if (!t)
+            {
+                *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
                 break;
+            }
+            *buffer = (char*) t;
+            *buffer_size = len + 1;
         }
+        memcpy(*buffer, p, len);
+        (*buffer)[len] = '\0';
+        p = eol + 1;
+
+        /* Load source parameters (require at least RA, Dec, Stokes I). */
+        num_read = oskar_string_to_array_d(*buffer, num_param, par);
+        if (num_read < num_required)
+            continue;
 
         if (num_read <= 9)
         {
             /* RA, Dec, I, Q, U, V, freq0, spix, RM */
-            oskar_sky_set_source(sky, n, par[0] * deg2rad,
+            oskar_sky_set_source(sky, offset + n, par[0] * deg2rad,
                     par[1] * deg2rad, par[2], par[3], par[4], par[5],
                     par[6], par[7], par[8], 0.0, 0.0, 0.0, status);
         }
@@ -102,7 +189,7 @@ oskar_Sky* oskar_sky_load(const char* filename, int type, int* status)
         {
             /* Old format, with no rotation measure. */
             /* RA, Dec, I, Q, U, V, freq0, spix, FWHM maj, FWHM min, PA */
-            oskar_sky_set_source(sky, n, par[0] * deg2rad,
+            oskar_sky_set_source(sky, offset + n, par[0] * deg2rad,
                     par[1] * deg2rad, par[2], par[3], par[4], par[5],
                     par[6], par[7], 0.0, par[8] * arcsec2rad,
                     par[9] * arcsec2rad, par[10] * deg2rad, status);
@@ -111,7 +198,7 @@ oskar_Sky* oskar_sky_load(const char* filename, int type, int* status)
         {
             /* New format. */
             /* RA, Dec, I, Q, U, V, freq0, spix, RM, FWHM maj, FWHM min, PA */
-            oskar_sky_set_source(sky, n, par[0] * deg2rad,
+            oskar_sky_set_source(sky, offset + n, par[0] * deg2rad,
                     par[1] * deg2rad, par[2], par[3], par[4], par[5],
                     par[6], par[7], par[8], par[9] * arcsec2rad,
                     par[10] * arcsec2rad, par[11] * deg2rad, status);
@@ -124,13 +211,129 @@ oskar_Sky* oskar_sky_load(const char* filename, int type, int* status)
         }
         ++n;
     }
+    return n;
+}
+
+/* Moves a block of sources down to a lower index. */
+static void move_sources(oskar_Sky* sky, int to, int from, int num)
+{
+    int i;
+    oskar_Mem* const cols[] = {
+            sky->ra_rad, sky->dec_rad, sky->I, sky->Q, sky->U, sky->V,
+            sky->reference_freq_hz, sky->spectral_index, sky->rm_rad,
+            sky->fwhm_major_rad, sky->fwhm_minor_rad, sky->pa_rad
+    };
+    const size_t element_size = oskar_mem_element_size(sky->precision);
+    if (to == from || num == 0) return;
+    for (i = 0; i < (int) (sizeof(cols) / sizeof(oskar_Mem*)); ++i)
+    {
+        char* p = (char*) oskar_mem_void(cols[i]);
+        memmove(p + to * element_size, p + from * element_size,
+                num * element_size);
+    }
+}
+
+oskar_Sky* oskar_sky_load(const char* filename, int type, int* status)
+{
+    int c, num_chunks = 1, num_lines = 0, num_sources = 0;
+    int *chunk_lines = 0, *chunk_sources = 0;
+    size_t size = 0, *chunk_start = 0;
+    char* data = 0;
+    oskar_Sky* sky;
+
+    /* Check if safe to proceed. */
+    if (*status) return 0;
+
+    /* Get the data type. */
+    if (type != OSKAR_SINGLE && type != OSKAR_DOUBLE)
+    {
+        *status = OSKAR_ERR_BAD_DATA_TYPE;
+        return 0;
+    }
+
+    /* Map the file into memory. */
+    data = map_file(filename, &size, status);
+    if (*status) return 0;
+
+    /* Split the text into chunks that start at the beginning of a line. */
+#ifdef _OPENMP
+    num_chunks = CHUNKS_PER_THREAD * omp_get_max_threads();
+#endif
+    if ((size_t) num_chunks > size / 4096 + 1)
+        num_chunks = (int) (size / 4096 + 1);
+    chunk_start = (size_t*) calloc(num_chunks + 1, sizeof(size_t));
+    chunk_lines = (int*) calloc(num_chunks, sizeof(int));
+    chunk_sources = (int*) calloc(num_chunks, sizeof(int));
+    chunk_start[num_chunks] = size;
+    for (c = 1; c < num_chunks; ++c)
+    {
+        size_t i = (size / num_chunks) * c;
+        if (i < chunk_start[c - 1]) i = chunk_start[c - 1];
+        while (i < size && data[i - 1] != '\n') ++i;
+        chunk_start[c] = i;
+    }
+
+    /* Count the lines in each chunk, to get an upper bound on the number
+     * of sources, and the index of the first source in each chunk. */
+#pragma omp parallel for schedule(dynamic, 1)
+    for (c = 0; c < num_chunks; ++c)
+    {
+        chunk_lines[c] = count_lines(data + chunk_start[c],
+                data + chunk_start[c + 1]);
+    }
+    for (c = 0; c < num_chunks; ++c)
+    {
+        const int t = chunk_lines[c];
+        chunk_lines[c] = num_lines;
+        num_lines += t;
+    }
+
+    /* Initialise the sky model with enough space for every line. */
+    sky = oskar_sky_create(type, OSKAR_CPU, num_lines, status);
+
+    /* Parse the chunks in parallel, writing the sources in place. */
+    if (!*status)
+    {
+#pragma omp parallel
+        {
+            char* buffer = 0;
+            size_t buffer_size = 0;
+            int thread_status = 0;
+#pragma omp for schedule(dynamic, 1)
+            for (c = 0; c < num_chunks; ++c)
+            {
+                if (thread_status) continue;
+                chunk_sources[c] = parse_lines(data + chunk_start[c],
+                        data + chunk_start[c + 1], sky, chunk_lines[c],
+                        &buffer, &buffer_size, &thread_status);
+            }
+            free(buffer);
+            if (thread_status)
+            {
+#pragma omp critical (oskar_sky_load)
+                *status = thread_status;
+            }
+        }
+    }
+
+    /* Close up the gaps left by blank lines and comments. */
+    if (!*status)
+    {
+        for (c = 0; c < num_chunks; ++c)
+        {
+            move_sources(sky, num_sources, chunk_lines[c], chunk_sources[c]);
+            num_sources += chunk_sources[c];
+        }
+    }
 
     /* Set the size to be the actual number of elements loaded. */
-    oskar_sky_resize(sky, n, status);
+    oskar_sky_resize(sky, num_sources, status);
 
-    /* Free the line buffer and close the file. */
-    if (line) free(line);
-    fclose(file);
+    /* Free scratch memory and unmap the file. */
+    free(chunk_start);
+    free(chunk_lines);
+    free(chunk_sources);
+    unmap_file(data, size);
 
     /* Check if an error occurred. */
     if (*status)
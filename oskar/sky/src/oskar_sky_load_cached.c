@@ -0,0 +1,205 @@
+/*
+ * Copyright (c) 2020, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "sky/oskar_sky.h"
+#include "binary/oskar_binary.h"
+#include "binary/oskar_crc.h"
+#include "utility/oskar_thread.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#ifdef OSKAR_OS_WIN
+#include <process.h>
+#define getpid _getpid
+#else
+#include <unistd.h>
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define CRC_BLOCK_SIZE (4 * 1024 * 1024)
+
+struct SourceFileKey
+{
+    double size, mtime;
+    unsigned int crc;
+};
+typedef struct SourceFileKey SourceFileKey;
+
+static void get_key(const char* filename, SourceFileKey* key, int* status)
+{
+    int first = 1;
+    size_t num_read = 0;
+    unsigned long crc = 0;
+    unsigned char* block = 0;
+    oskar_CRC* crc_data = 0;
+    FILE* file = 0;
+#ifdef OSKAR_OS_WIN
+    struct _stat64 st;
+    if (_stat64(filename, &st) != 0)
+#else
+    struct stat st;
+    if (stat(filename, &st) != 0)
+#endif
+    {
+        *status = OSKAR_ERR_FILE_IO;
+        return;
+    }
+    key->size = (double) st.st_size;
+    key->mtime = (double) st.st_mtime;
+
+    /* Compute the checksum of the file contents. */
+    file = fopen(filename, "rb");
+    if (!file)
+    {
+        *status = OSKAR_ERR_FILE_IO;
+        return;
+    }
+    block = (unsigned char*) malloc(CRC_BLOCK_SIZE);
+    crc_data = oskar_crc_create(OSKAR_CRC_32C);
+    while ((num_read = fread(block, 1, CRC_BLOCK_SIZE, file)) > 0)
+    {
+        crc = first ? oskar_crc_compute(crc_data, block, num_read) :
+                oskar_crc_update(crc_data, crc, block, num_read);
+        first = 0;
+    }
+    if (ferror(file)) *status = OSKAR_ERR_FILE_IO;
+    key->crc = (unsigned int) crc;
+    oskar_crc_free(crc_data);
+    free(block);
+    fclose(file);
+}
+
+static int cache_is_valid(const char* cache_filename, int type,
+        const SourceFileKey* key)
+{
+    int status = 0, cache_type = 0;
+    const unsigned char group = OSKAR_TAG_GROUP_SKY_MODEL;
+    SourceFileKey cache_key;
+    oskar_Binary* h = oskar_binary_create(cache_filename, 'r', &status);
+    oskar_binary_read_int(h, group, OSKAR_SKY_TAG_DATA_TYPE, 0,
+            &cache_type, &status);
+    oskar_binary_read_double(h, group, OSKAR_SKY_TAG_SOURCE_FILE_SIZE, 0,
+            &cache_key.size, &status);
+    oskar_binary_read_double(h, group, OSKAR_SKY_TAG_SOURCE_FILE_MTIME, 0,
+            &cache_key.mtime, &status);
+    oskar_binary_read(h, OSKAR_INT, group, OSKAR_SKY_TAG_SOURCE_FILE_CRC, 0,
+            sizeof(unsigned int), &cache_key.crc, &status);
+    oskar_binary_free(h);
+    return (!status && cache_type == type && cache_key.size == key->size &&
+            cache_key.mtime == key->mtime && cache_key.crc == key->crc);
+}
+
+static void write_cache(const char* cache_filename, const oskar_Sky* sky,
+        const SourceFileKey* key)
+{
+    int status = 0;
+    const unsigned char group = OSKAR_TAG_GROUP_SKY_MODEL;
+    oskar_Binary* h = 0;
+
+    /* Write to a temporary file first, so that another process can never
+     * see an incomplete cache. The key goes at the end of the file.
+     * The temporary name is unique to this process and call, so that
+     * simulators writing the same cache at the same time do not write
+     * to the same file. */
+    static volatile int save_counter = 0;
+    char* temp_filename = (char*) calloc(strlen(cache_filename) + 40, 1);
+    if (!temp_filename) return;
+    sprintf(temp_filename, "%s.%d.%d.tmp", cache_filename, (int) getpid(),
+            oskar_atomic_fetch_add(&save_counter, 1));
+    oskar_sky_write(temp_filename, sky, &status);
+    h = oskar_binary_create(temp_filename, 'a', &status);
+    oskar_binary_write_double(h, group, OSKAR_SKY_TAG_SOURCE_FILE_SIZE, 0,
+            key->size, &status);
+    oskar_binary_write_double(h, group, OSKAR_SKY_TAG_SOURCE_FILE_MTIME, 0,
+            key->mtime, &status);
+    oskar_binary_write(h, OSKAR_INT, group, OSKAR_SKY_TAG_SOURCE_FILE_CRC, 0,
+            sizeof(unsigned int), &key->crc, &status);
+    oskar_binary_free(h);
+#ifdef OSKAR_OS_WIN
+    if (!status) remove(cache_filename);
+#endif
+    if (status || rename(temp_filename, cache_filename) != 0)
+        remove(temp_filename);
+    free(temp_filename);
+}
+
+oskar_Sky* oskar_sky_load_cached(const char* filename,
+        const char* cache_filename, int type, int* status)
+{
+    SourceFileKey key;
+    char* default_cache_filename = 0;
+    oskar_Sky* sky = 0;
+    if (*status) return 0;
+
+    /* Get the cache filename. */
+    if (!cache_filename || strlen(cache_filename) == 0)
+    {
+        const size_t len = strlen(filename);
+        default_cache_filename = (char*) calloc(len + 7, 1);
+        if (!default_cache_filename)
+        {
+            *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+            return 0;
+        }
+        memcpy(default_cache_filename, filename, len);
+        memcpy(default_cache_filename + len, ".cache", 6);
+        cache_filename = default_cache_filename;
+    }
+
+    /* Read the cache if it matches the text file. */
+    get_key(filename, &key, status);
+    if (!*status && cache_is_valid(cache_filename, type, &key))
+    {
+        int read_status = 0;
+        sky = oskar_sky_read(cache_filename, OSKAR_CPU, &read_status);
+        if (read_status)
+        {
+            oskar_sky_free(sky, &read_status);
+            sky = 0;
+        }
+    }
+
+    /* Otherwise, load the text file and write a new cache. */
+    if (!sky && !*status)
+    {
+        sky = oskar_sky_load(filename, type, status);
+        if (sky) write_cache(cache_filename, sky, &key);
+    }
+    free(default_cache_filename);
+    return sky;
+}
+
+#ifdef __cplusplus
+}
+#endif
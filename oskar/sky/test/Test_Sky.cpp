@@ -1152,6 +1152,129 @@ TEST(SkyModel, load_ascii)
 }
 
 
+TEST(SkyModel, load_ascii_mixed_formats)
+{
+    int status = 0;
+    const double deg2rad = 1.74532925199432957692369e-2;
+    const double arcsec2rad = 4.84813681109535993589914e-6;
+    const char* filename = "temp_test_sources_mixed.osm";
+
+    // Write a file large enough to be split into many chunks, with a
+    // mixture of line formats, comments and blank lines.
+    const int num_sources = 50000;
+    FILE* file = fopen(filename, "w");
+    if (!file) FAIL() << "Unable to create test file";
+    for (int i = 0; i < num_sources; ++i)
+    {
+        if (i % 7 == 0) fprintf(file, "# comment %d\n", i);
+        if (i % 11 == 0) fprintf(file, "\n");
+        if (i % 3 == 0)
+            fprintf(file, "%d, %d, %d\n", i, -i, i);
+        else if (i % 3 == 1)
+            fprintf(file, "%d %d %d 0 0 0 1e8 -0.7 50 40 %d # old\n",
+                    i, -i, i, i % 360);
+        else
+            fprintf(file, "%d %d %d 0 0 0 1e8 -0.7 2.5 50 40 %d",
+                    i, -i, i, i % 360);
+        if (i < num_sources - 1) fprintf(file, "\r\n");
+    }
+    fclose(file);
+
+    // Load the file and check the contents.
+    oskar_Sky* sky = oskar_sky_load(filename, OSKAR_DOUBLE, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    ASSERT_EQ(num_sources, oskar_sky_num_sources(sky));
+    const double* ra = oskar_mem_double_const(oskar_sky_ra_rad_const(sky),
+            &status);
+    const double* I = oskar_mem_double_const(oskar_sky_I_const(sky), &status);
+    const double* rm = oskar_mem_double_const(
+            oskar_sky_rotation_measure_rad_const(sky), &status);
+    const double* maj = oskar_mem_double_const(
+            oskar_sky_fwhm_major_rad_const(sky), &status);
+    const double* pa = oskar_mem_double_const(
+            oskar_sky_position_angle_rad_const(sky), &status);
+    for (int i = 0; i < num_sources; ++i)
+    {
+        ASSERT_DOUBLE_EQ(i * deg2rad, ra[i]);
+        ASSERT_DOUBLE_EQ((double) i, I[i]);
+        if (i % 3 == 0)
+        {
+            ASSERT_DOUBLE_EQ(0.0, maj[i]);
+            ASSERT_DOUBLE_EQ(0.0, rm[i]);
+        }
+        else
+        {
+            ASSERT_DOUBLE_EQ(50.0 * arcsec2rad, maj[i]);
+            ASSERT_DOUBLE_EQ((i % 360) * deg2rad, pa[i]);
+            ASSERT_DOUBLE_EQ(i % 3 == 1 ? 0.0 : 2.5, rm[i]);
+        }
+    }
+    oskar_sky_free(sky, &status);
+
+    // Check that a line with 10 columns is an error.
+    file = fopen(filename, "a");
+    fprintf(file, "\n1 2 3 4 5 6 7 8 9 10\n2 3 4\n");
+    fclose(file);
+    sky = oskar_sky_load(filename, OSKAR_DOUBLE, &status);
+    EXPECT_EQ((int) OSKAR_ERR_BAD_SKY_FILE, status);
+    EXPECT_TRUE(sky == 0);
+    remove(filename);
+}
+
+
+TEST(SkyModel, load_cached)
+{
+    int status = 0;
+    const char* filename = "temp_test_sources_cached.osm";
+    const char* cache_filename = "temp_test_sources_cached.osm.cache";
+    remove(cache_filename);
+
+    // Write a text file.
+    const int num_sources = 1000;
+    FILE* file = fopen(filename, "w");
+    if (!file) FAIL() << "Unable to create test file";
+    for (int i = 0; i < num_sources; ++i)
+        fprintf(file, "%d %d %d\n", i, i, i);
+    fclose(file);
+
+    // Load it, which should create the cache.
+    oskar_Sky* sky = oskar_sky_load_cached(filename, 0, OSKAR_DOUBLE, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    ASSERT_EQ(num_sources, oskar_sky_num_sources(sky));
+    oskar_sky_free(sky, &status);
+    file = fopen(cache_filename, "rb");
+    ASSERT_TRUE(file != 0);
+    fclose(file);
+
+    // Load it again, this time from the cache.
+    sky = oskar_sky_load_cached(filename, 0, OSKAR_DOUBLE, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    ASSERT_EQ(num_sources, oskar_sky_num_sources(sky));
+    EXPECT_DOUBLE_EQ(999.0, oskar_mem_get_element(
+            oskar_sky_I_const(sky), num_sources - 1, &status));
+    oskar_sky_free(sky, &status);
+
+    // Change a value in the text file without changing its size.
+    file = fopen(filename, "r+");
+    fseek(file, -2, SEEK_END);
+    fprintf(file, "8");
+    fclose(file);
+    sky = oskar_sky_load_cached(filename, 0, OSKAR_DOUBLE, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    EXPECT_DOUBLE_EQ(998.0, oskar_mem_get_element(
+            oskar_sky_I_const(sky), num_sources - 1, &status));
+    oskar_sky_free(sky, &status);
+
+    // Check that a different precision is not taken from the cache.
+    sky = oskar_sky_load_cached(filename, 0, OSKAR_SINGLE, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    EXPECT_EQ((int) OSKAR_SINGLE, oskar_sky_precision(sky));
+    oskar_sky_free(sky, &status);
+    remove(filename);
+    remove(cache_filename);
+}
+
+
 TEST(SkyModel, read_write)
 {
     oskar_Sky *sky, *sky2;
@@ -198,6 +198,24 @@ double oskar_telescope_phase_centre_dec_rad(const oskar_Telescope* model);
 OSKAR_EXPORT
 double oskar_telescope_channel_bandwidth_hz(const oskar_Telescope* model);
 
+/**
+ * @brief
+ * Returns the smearing tolerance used to skip faint sources, in Jy.
+ *
+ * @details
+ * Returns the flux density below which a source is not correlated on a
+ * block of baselines, after the bandwidth, time and Gaussian smearing
+ * on those baselines has been taken into account.
+ * A value of zero means that no sources are skipped.
+ *
+ * @param[in] model   Pointer to telescope model.
+ *
+ * @return The smearing tolerance, in Jy.
+ */
+OSKAR_EXPORT
+double oskar_telescope_smearing_cull_tolerance_jy(
+        const oskar_Telescope* model);
+
 /**
  * @brief
  * Returns the TEC screen height, in km.
@@ -916,6 +934,28 @@ void oskar_telescope_set_polar_motion(oskar_Telescope* model,
 OSKAR_EXPORT
 void oskar_telescope_set_station_ids(oskar_Telescope* model);
 
+/**
+ * @brief
+ * Sets the smearing tolerance used to skip faint sources.
+ *
+ * @details
+ * Sets the flux density below which a source is not correlated on a
+ * block of baselines, after the bandwidth, time and Gaussian smearing
+ * on those baselines has been taken into account.
+ *
+ * The bound used does not include the amplitude of the station beams,
+ * so the tolerance should be set relative to normalised beams.
+ * Set to zero (the default) to correlate all sources on all baselines.
+ *
+ * This is currently only used by the CPU versions of the correlator.
+ *
+ * @param[in] model            Pointer to telescope model.
+ * @param[in] tolerance_jy     Smearing tolerance, in Jy.
+ */
+OSKAR_EXPORT
+void oskar_telescope_set_smearing_cull_tolerance(oskar_Telescope* model,
+        double tolerance_jy);
+
 /**
  * @brief
  * Sets the type of stations within the telescope model.
@@ -95,6 +95,12 @@ double oskar_telescope_channel_bandwidth_hz(const oskar_Telescope* model)
     return model->channel_bandwidth_hz;
 }
 
+double oskar_telescope_smearing_cull_tolerance_jy(
+        const oskar_Telescope* model)
+{
+    return model->smearing_cull_tolerance_jy;
+}
+
 double oskar_telescope_tec_screen_height_km(const oskar_Telescope* model)
 {
     return model->tec_screen_height_km;
@@ -495,6 +501,12 @@ void oskar_telescope_set_channel_bandwidth(oskar_Telescope* model,
     model->channel_bandwidth_hz = bandwidth_hz;
 }
 
+void oskar_telescope_set_smearing_cull_tolerance(oskar_Telescope* model,
+        double tolerance_jy)
+{
+    model->smearing_cull_tolerance_jy = tolerance_jy;
+}
+
 void oskar_telescope_set_time_average(oskar_Telescope* model,
         double time_average_sec)
 {
@@ -67,6 +67,7 @@ oskar_Telescope* oskar_telescope_create_copy(const oskar_Telescope* src,
     telescope->phase_centre_dec_rad = src->phase_centre_dec_rad;
     telescope->channel_bandwidth_hz = src->channel_bandwidth_hz;
     telescope->time_average_sec = src->time_average_sec;
+    telescope->smearing_cull_tolerance_jy = src->smearing_cull_tolerance_jy;
     telescope->uv_filter_min = src->uv_filter_min;
     telescope->uv_filter_max = src->uv_filter_max;
     telescope->uv_filter_units = src->uv_filter_units;
@@ -43,6 +43,14 @@ int oskar_element_different(const oskar_Element* a, const oskar_Element* b,
 
     if (a->precision != b->precision) return 1;
 
+    /* Check parameters used to evaluate the pattern. */
+    if (a->element_type != b->element_type) return 1;
+    if (a->taper_type != b->taper_type) return 1;
+    if (a->dipole_length != b->dipole_length) return 1;
+    if (a->dipole_length_units != b->dipole_length_units) return 1;
+    if (a->cosine_power != b->cosine_power) return 1;
+    if (a->gaussian_fwhm_rad != b->gaussian_fwhm_rad) return 1;
+
     if (a->coord_sys != b->coord_sys) return 1;
     if (a->max_radius_rad != b->max_radius_rad) return 1;
     if (a->x_element_type != b->x_element_type) return 1;
@@ -65,6 +73,8 @@ int oskar_element_different(const oskar_Element* a, const oskar_Element* b,
     for (i = 0; i < b->num_freq; ++i)
     {
         if (a->freqs_hz[i] != b->freqs_hz[i]) return 1;
+        if (a->l_max[i] != b->l_max[i]) return 1;
+        if (a->common_phi_coords[i] != b->common_phi_coords[i]) return 1;
         if (oskar_mem_different(a->filename_x[i], b->filename_x[i], 0, status))
             return 1;
         if (oskar_mem_different(a->filename_y[i], b->filename_y[i], 0, status))
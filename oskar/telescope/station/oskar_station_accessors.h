@@ -270,6 +270,17 @@ const int* oskar_station_element_types_cpu_const(const oskar_Station* model);
 OSKAR_EXPORT
 const char* oskar_station_element_mount_types_const(const oskar_Station* model);
 
+OSKAR_EXPORT
+const oskar_Mem* oskar_station_element_lattice_idx_const(
+        const oskar_Station* model);
+
+OSKAR_EXPORT
+const double* oskar_station_element_lattice_const(const oskar_Station* model);
+
+OSKAR_EXPORT
+const int* oskar_station_element_lattice_dims_const(
+        const oskar_Station* model);
+
 OSKAR_EXPORT
 int oskar_station_has_child(const oskar_Station* model);
 
@@ -280,6 +291,9 @@ OSKAR_EXPORT
 const oskar_Station* oskar_station_child_const(const oskar_Station* model,
         int i);
 
+OSKAR_EXPORT
+int oskar_station_child_equivalent(const oskar_Station* model, int i);
+
 OSKAR_EXPORT
 int oskar_station_has_element(const oskar_Station* model);
 
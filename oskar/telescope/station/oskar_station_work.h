@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2012-2019, The University of Oxford
+ * Copyright (c) 2012-2020, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -35,6 +35,7 @@
 
 #include <oskar_global.h>
 #include <mem/oskar_mem.h>
+#include <telescope/station/element/oskar_element.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -107,6 +108,59 @@ const oskar_Mem* oskar_station_work_evaluate_tec_screen(oskar_StationWork* work,
         double station_u_m, double station_v_m, int time_index,
         double frequency_hz, int* status);
 
+/**
+ * @brief Sets the directions used for cached element patterns.
+ * @details
+ * Element patterns evaluated using oskar_station_work_evaluate_element()
+ * are cached for the given set of ENU direction cosines, and the cache is
+ * cleared only if the directions change. This allows the patterns to be
+ * reused between stations, child stations and channels that share the
+ * same element model, orientation and frequency.
+ * @param[in,out] work        Pointer to work buffer structure.
+ * @param[in]     num_points  Number of directions.
+ * @param[in]     x           ENU x direction cosines.
+ * @param[in]     y           ENU y direction cosines.
+ * @param[in]     z           ENU z direction cosines.
+ * @param[in,out] status      Status return code.
+ */
+OSKAR_EXPORT
+void oskar_station_work_set_element_cache_directions(oskar_StationWork* work,
+        int num_points, const oskar_Mem* x, const oskar_Mem* y,
+        const oskar_Mem* z, int* status);
+
+/**
+ * @brief Evaluates an element pattern, using the cache if possible.
+ * @details
+ * Parameters are as for oskar_element_evaluate(), which is called if the
+ * pattern is not already cached for the directions set using
+ * oskar_station_work_set_element_cache_directions().
+ *
+ * Elements are matched by content using oskar_element_different(),
+ * not by address, so patterns are shared between copies of an element.
+ */
+OSKAR_EXPORT
+void oskar_station_work_evaluate_element(oskar_StationWork* work,
+        const oskar_Element* element, int normalise, int swap_xy,
+        double orientation_x, double orientation_y, int offset_points,
+        int num_points, const oskar_Mem* x, const oskar_Mem* y,
+        const oskar_Mem* z, double frequency_hz, int offset_out,
+        oskar_Mem* output, int* status);
+
+/**
+ * @brief Returns element pattern cache counters.
+ * @details
+ * Returns the number of element patterns that were copied from the cache,
+ * and the number that had to be evaluated, since the work buffer was created.
+ * Isotropic elements with no taper are not cached, and are not counted.
+ * Either pointer may be NULL if the value is not required.
+ * @param[in]  work        Pointer to work buffer structure.
+ * @param[out] num_hits    Number of patterns copied from the cache.
+ * @param[out] num_misses  Number of patterns evaluated.
+ */
+OSKAR_EXPORT
+void oskar_station_work_element_cache_counters(const oskar_StationWork* work,
+        size_t* num_hits, size_t* num_misses);
+
 OSKAR_EXPORT
 oskar_Mem* oskar_station_work_beam_out(oskar_StationWork* work,
         const oskar_Mem* output_beam, size_t length, int* status);
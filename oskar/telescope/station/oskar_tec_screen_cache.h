@@ -0,0 +1,126 @@
+/*
+ * Copyright (c) 2020, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef OSKAR_TEC_SCREEN_CACHE_H_
+#define OSKAR_TEC_SCREEN_CACHE_H_
+
+/**
+ * @file oskar_tec_screen_cache.h
+ */
+
+#include <oskar_global.h>
+#include <mem/oskar_mem.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct oskar_TecScreenCache;
+#ifndef OSKAR_TEC_SCREEN_CACHE_TYPEDEF_
+#define OSKAR_TEC_SCREEN_CACHE_TYPEDEF_
+typedef struct oskar_TecScreenCache oskar_TecScreenCache;
+#endif /* OSKAR_TEC_SCREEN_CACHE_TYPEDEF_ */
+
+/**
+ * @brief
+ * Returns a handle to the shared cache for a TEC screen FITS file.
+ *
+ * @details
+ * Returns a handle to the process-wide cache of time slices read from the
+ * given TEC screen FITS file, creating it if necessary.
+ * All callers using the same file and data type share the same cache,
+ * so each time slice is read from disk only once, regardless of how many
+ * station work buffers (or compute devices) need it.
+ *
+ * The cache is reference-counted: each call to this function must be
+ * matched by a call to oskar_tec_screen_cache_release().
+ *
+ * @param[in] path          Path to the TEC screen FITS file.
+ * @param[in] type          Enumerated data type (OSKAR_SINGLE or OSKAR_DOUBLE).
+ * @param[in,out] status    Status return code.
+ *
+ * @return A handle to the cache.
+ */
+OSKAR_EXPORT
+oskar_TecScreenCache* oskar_tec_screen_cache_acquire(const char* path,
+        int type, int* status);
+
+/**
+ * @brief
+ * Releases a handle to a TEC screen cache.
+ *
+ * @details
+ * Releases a handle returned by oskar_tec_screen_cache_acquire().
+ * The cache is freed when the last handle to it is released.
+ *
+ * @param[in] cache  Handle to the cache.
+ */
+OSKAR_EXPORT
+void oskar_tec_screen_cache_release(oskar_TecScreenCache* cache);
+
+/**
+ * @brief
+ * Copies one time slice of the TEC screen into the given array.
+ *
+ * @details
+ * Copies one time slice of the TEC screen into the given array, which may
+ * be in any memory location, and will be resized if necessary.
+ *
+ * If the slice is not already in the cache, it is read from the file
+ * together with the next few slices, in anticipation of their use.
+ * Time indices beyond the end of the screen use the last slice.
+ *
+ * This function is thread-safe.
+ *
+ * @param[in] cache         Handle to the cache.
+ * @param[in] time_index    Time index of the slice to return.
+ * @param[out] slice        Array to fill with the screen pixels.
+ * @param[in,out] status    Status return code.
+ */
+OSKAR_EXPORT
+void oskar_tec_screen_cache_copy_slice(oskar_TecScreenCache* cache,
+        int time_index, oskar_Mem* slice, int* status);
+
+/**
+ * @brief
+ * Returns the number of pixels along each dimension of the screen.
+ *
+ * @param[in] cache  Handle to the cache.
+ * @param[out] num_pixels_x  Number of pixels along the x-dimension.
+ * @param[out] num_pixels_y  Number of pixels along the y-dimension.
+ * @param[out] num_pixels_t  Number of time slices.
+ */
+OSKAR_EXPORT
+void oskar_tec_screen_cache_dims(const oskar_TecScreenCache* cache,
+        int* num_pixels_x, int* num_pixels_y, int* num_pixels_t);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* include guard */
@@ -92,7 +92,11 @@ struct oskar_Station
     oskar_Mem* element_types;     /* Integer array of element types (default 0). */
     oskar_Mem* element_types_cpu; /* Integer array of element types guaranteed to be in CPU memory (default 0). */
     oskar_Mem* element_mount_types_cpu; /* Char array of element mount types guaranteed to be in CPU memory. */
+    oskar_Mem* element_lattice_idx; /* Lattice index pairs of element positions (auto determined; NULL if not a regular lattice). */
+    double element_lattice[9];    /* Lattice origin and vectors of element positions, in metres (auto determined). */
+    int element_lattice_dims[2];  /* Number of lattice points along each lattice vector (auto determined). */
     oskar_Station** child;        /* Array of child station handles (pointer is NULL if none). */
+    int* child_equivalent;        /* Index of first child station identical to each child (auto determined; NULL if none). */
     oskar_Element** element;      /* Array of element models per element type (pointer is NULL if there are child stations). */
 
     /* Data used only for aperture array stations with fixed beams. */
@@ -30,6 +30,19 @@
 #define OSKAR_PRIVATE_STATION_WORK_H_
 
 #include <mem/oskar_mem.h>
+#include <telescope/station/oskar_tec_screen_cache.h>
+#include <telescope/station/element/oskar_element.h>
+
+/* Element pattern evaluated for one set of parameters. */
+struct oskar_ElementCacheEntry
+{
+    int element_index; /* Index into element_cache_models. */
+    int direction_set;
+    int normalise, swap_xy, offset_points, num_points;
+    double orientation_x, orientation_y, frequency_hz;
+    oskar_Mem* pattern;
+};
+typedef struct oskar_ElementCacheEntry oskar_ElementCacheEntry;
 
 struct oskar_StationWork
 {
@@ -56,6 +69,17 @@ struct oskar_StationWork
     double screen_time_interval_sec;
     oskar_Mem *tec_screen_path, *tec_screen;
     oskar_Mem *screen_output;
+    oskar_TecScreenCache* screen_cache; /* Shared with other work buffers. */
+
+    /* Element pattern cache, valid for the directions in cache_x/y/z.
+     * Patterns are keyed on copies of the distinct element models seen,
+     * so they are shared by stations holding identical elements. */
+    int element_cache_capacity, element_cache_used;
+    int element_cache_num_models, element_cache_direction_set;
+    size_t element_cache_bytes, element_cache_hits, element_cache_misses;
+    oskar_Element** element_cache_models;
+    oskar_ElementCacheEntry* element_cache;
+    oskar_Mem *cache_x, *cache_y, *cache_z;
 
     int num_depths;
     oskar_Mem** beam;            /* For hierarchical stations. */
@@ -30,12 +30,13 @@
 
 #include "telescope/station/oskar_evaluate_beam_horizon_direction.h"
 #include "telescope/station/oskar_station_evaluate_element_weights.h"
-#include "telescope/station/element/oskar_element_evaluate.h"
 #include "telescope/station/oskar_blank_below_horizon.h"
+#include "telescope/station/oskar_station_work.h"
 #include "telescope/station/private_station_work.h"
 
 #include "math/oskar_cmath.h"
 #include "math/oskar_dftw.h"
+#include "math/oskar_dftw_lattice.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -49,6 +50,12 @@ static void oskar_evaluate_station_beam_aperture_array_private(
         const oskar_Mem* z, int time_index, double gast, double frequency_hz,
         int depth, int offset_out, oskar_Mem* beam, int* status);
 
+static void array_pattern(const oskar_Station* s, int feed,
+        double wavenumber, const oskar_Mem* weights, int offset_points,
+        int num_points, const oskar_Mem* x, const oskar_Mem* y,
+        const oskar_Mem* z, const oskar_Mem* data_idx, const oskar_Mem* data,
+        int eval_x, int eval_y, int offset_out, oskar_Mem* beam, int* status);
+
 
 void oskar_evaluate_station_beam_aperture_array(oskar_Mem* beam,
         const oskar_Station* station, int num_points, const oskar_Mem* x,
@@ -58,6 +65,10 @@ void oskar_evaluate_station_beam_aperture_array(oskar_Mem* beam,
 {
     if (*status) return;
 
+    /* Reuse element patterns evaluated for the same directions. */
+    oskar_station_work_set_element_cache_directions(work,
+            num_points, x, y, z, status);
+
     /* Evaluate beam directly if there are no child stations. */
     if (!oskar_station_has_child(station))
         oskar_evaluate_station_beam_aperture_array_private(station, work,
@@ -87,7 +98,7 @@ static void oskar_evaluate_station_beam_aperture_array_private(
         int depth, int offset_out, oskar_Mem* beam, int* status)
 {
     double beam_x, beam_y, beam_z;
-    oskar_Mem *signal, *theta, *phi_x, *phi_y;
+    oskar_Mem *signal;
     const oskar_Mem* element_types_ptr = 0;
     int i;
     if (*status) return;
@@ -95,14 +106,10 @@ static void oskar_evaluate_station_beam_aperture_array_private(
     const double wavenumber = 2.0 * M_PI * frequency_hz / 299792458.0;
     const int swap_xy       = oskar_station_swap_xy(s);
     const int is_3d         = oskar_station_array_is_3d(s);
-    const int norm_array    = oskar_station_normalise_array_pattern(s);
     const int norm_element  = oskar_station_normalise_element_pattern(s);
     const int num_elements  = oskar_station_num_elements(s);
     const int num_feeds     = (oskar_station_common_pol_beams(s) ||
             !oskar_mem_is_matrix(beam)) ? 1 : 2;
-    theta = work->theta_modified;
-    phi_x = work->phi_x;
-    phi_y = work->phi_y;
 
     /* Compute direction cosines for the beam for this station. */
     oskar_evaluate_beam_horizon_direction(&beam_x, &beam_y, &beam_z, s,
@@ -120,13 +127,13 @@ static void oskar_evaluate_station_beam_aperture_array_private(
             signal = oskar_station_work_beam(work, beam,
                     num_element_types * (num_points + 1), 0, status);
             for (i = 0; i < num_element_types; ++i)
-                oskar_element_evaluate(
+                oskar_station_work_evaluate_element(work,
                         oskar_station_element_const(s, i),
                         norm_element, swap_xy,
                         oskar_station_element_euler_index_rad(s, 0, 0, 0) + M_PI/2.0, /* FIXME Will change: This matches the old convention. */
                         oskar_station_element_euler_index_rad(s, 1, 0, 0),
                         offset_points, num_points, x, y, z, frequency_hz,
-                        theta, phi_x, phi_y, i * num_points, signal, status);
+                        i * num_points, signal, status);
         }
         else
         {
@@ -141,13 +148,13 @@ static void oskar_evaluate_station_beam_aperture_array_private(
                     *status = OSKAR_ERR_OUT_OF_RANGE;
                     break;
                 }
-                oskar_element_evaluate(
+                oskar_station_work_evaluate_element(work,
                         oskar_station_element_const(s, element_type[i]),
                         norm_element, swap_xy,
                         oskar_station_element_euler_index_rad(s, 0, 0, i) + M_PI/2.0, /* FIXME Will change: This matches the old convention. */
                         oskar_station_element_euler_index_rad(s, 1, 0, i),
                         offset_points, num_points, x, y, z, frequency_hz,
-                        theta, phi_x, phi_y, i * num_points, signal, status);
+                        i * num_points, signal, status);
             }
         }
         if (oskar_station_enable_array_pattern(s))
@@ -159,10 +166,7 @@ static void oskar_evaluate_station_beam_aperture_array_private(
                 oskar_station_evaluate_element_weights(s, i, wavenumber,
                         beam_x, beam_y, beam_z, time_index,
                         work->weights, work->weights_scratch, status);
-                oskar_dftw(norm_array, num_elements, wavenumber, work->weights,
-                        oskar_station_element_true_enu_metres_const(s, i, 0),
-                        oskar_station_element_true_enu_metres_const(s, i, 1),
-                        oskar_station_element_true_enu_metres_const(s, i, 2),
+                array_pattern(s, i, wavenumber, work->weights,
                         offset_points, num_points, x, y, (is_3d ? z : 0),
                         element_types_ptr, signal, eval_x, eval_y,
                         offset_out, beam, status);
@@ -204,11 +208,21 @@ static void oskar_evaluate_station_beam_aperture_array_private(
         }
         else
         {
+            /* Evaluate the beam once for each class of identical child
+             * stations, and copy it to the others in the class. */
             for (i = 0; i < num_elements; ++i)
-                oskar_evaluate_station_beam_aperture_array_private(
-                        oskar_station_child_const(s, i), work, offset_points,
-                        num_points, x, y, z, time_index, gast, frequency_hz,
-                        depth + 1, i * num_points, signal, status);
+            {
+                const int j = oskar_station_child_equivalent(s, i);
+                if (j == i)
+                    oskar_evaluate_station_beam_aperture_array_private(
+                            oskar_station_child_const(s, i), work,
+                            offset_points, num_points, x, y, z, time_index,
+                            gast, frequency_hz, depth + 1, i * num_points,
+                            signal, status);
+                else
+                    oskar_mem_copy_contents(signal, signal, i * num_points,
+                            j * num_points, num_points, status);
+            }
         }
         for (i = 0; i < num_feeds; ++i)
         {
@@ -217,16 +231,42 @@ static void oskar_evaluate_station_beam_aperture_array_private(
             oskar_station_evaluate_element_weights(s, i, wavenumber,
                     beam_x, beam_y, beam_z, time_index,
                     work->weights, work->weights_scratch, status);
-            oskar_dftw(norm_array, num_elements, wavenumber, work->weights,
-                    oskar_station_element_true_enu_metres_const(s, i, 0),
-                    oskar_station_element_true_enu_metres_const(s, i, 1),
-                    oskar_station_element_true_enu_metres_const(s, i, 2),
+            array_pattern(s, i, wavenumber, work->weights,
                     offset_points, num_points, x, y, (is_3d ? z : 0), 0,
                     signal, eval_x, eval_y, offset_out, beam, status);
         }
     }
 }
 
+static void array_pattern(const oskar_Station* s, int feed,
+        double wavenumber, const oskar_Mem* weights, int offset_points,
+        int num_points, const oskar_Mem* x, const oskar_Mem* y,
+        const oskar_Mem* z, const oskar_Mem* data_idx, const oskar_Mem* data,
+        int eval_x, int eval_y, int offset_out, oskar_Mem* beam, int* status)
+{
+    const oskar_Mem* lattice_idx = oskar_station_element_lattice_idx_const(s);
+    if (lattice_idx && oskar_mem_location(beam) == OSKAR_CPU)
+    {
+        /* Use phase recurrence if elements are on a regular lattice. */
+        oskar_dftw_lattice(oskar_station_normalise_array_pattern(s),
+                oskar_station_num_elements(s), wavenumber, weights,
+                oskar_station_element_lattice_const(s),
+                oskar_station_element_lattice_dims_const(s), lattice_idx,
+                offset_points, num_points, x, y, z, data_idx, data,
+                eval_x, eval_y, offset_out, beam, status);
+    }
+    else
+    {
+        oskar_dftw(oskar_station_normalise_array_pattern(s),
+                oskar_station_num_elements(s), wavenumber, weights,
+                oskar_station_element_true_enu_metres_const(s, feed, 0),
+                oskar_station_element_true_enu_metres_const(s, feed, 1),
+                oskar_station_element_true_enu_metres_const(s, feed, 2),
+                offset_points, num_points, x, y, z, data_idx, data,
+                eval_x, eval_y, offset_out, beam, status);
+    }
+}
+
 #ifdef __cplusplus
 }
 #endif
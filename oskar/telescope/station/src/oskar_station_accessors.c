@@ -406,6 +406,23 @@ const char* oskar_station_element_mount_types_const(const oskar_Station* model)
     return oskar_mem_char_const(model->element_mount_types_cpu);
 }
 
+const oskar_Mem* oskar_station_element_lattice_idx_const(
+        const oskar_Station* model)
+{
+    return model ? model->element_lattice_idx : 0;
+}
+
+const double* oskar_station_element_lattice_const(const oskar_Station* model)
+{
+    return model ? model->element_lattice : 0;
+}
+
+const int* oskar_station_element_lattice_dims_const(
+        const oskar_Station* model)
+{
+    return model ? model->element_lattice_dims : 0;
+}
+
 int oskar_station_has_child(const oskar_Station* model)
 {
     return model ? (model->child ? 1 : 0) : 0;
@@ -416,6 +433,11 @@ oskar_Station* oskar_station_child(oskar_Station* model, int i)
     return model ? model->child[i] : 0;
 }
 
+int oskar_station_child_equivalent(const oskar_Station* model, int i)
+{
+    return (model && model->child_equivalent) ? model->child_equivalent[i] : i;
+}
+
 const oskar_Station* oskar_station_child_const(const oskar_Station* model,
         int i)
 {
@@ -28,13 +28,18 @@
 
 #include "telescope/station/private_station.h"
 #include "telescope/station/oskar_station.h"
+#include "math/oskar_dftw_lattice.h"
 
+#include <float.h>
+#include <math.h>
 #include <stdlib.h>
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+static void find_element_lattice(oskar_Station* station, int* status);
+
 void oskar_station_analyse(oskar_Station* station,
         int* finished_identical_station_check, int* status)
 {
@@ -210,6 +215,9 @@ void oskar_station_analyse(oskar_Station* station,
         }
     }
 
+    /* Check if the element positions lie on a regular lattice. */
+    find_element_lattice(station, status);
+
     /* Check if station has child stations. */
     if (oskar_station_has_child(station))
     {
@@ -220,26 +228,201 @@ void oskar_station_analyse(oskar_Station* station,
                     finished_identical_station_check, status);
         }
 
-        /* Check if we need to examine every station. */
-        if (*finished_identical_station_check)
+        /* Find the first equivalent child station for each child.
+         * Each child only needs to be compared against the first station
+         * in each equivalence class found so far. */
+        free(station->child_equivalent);
+        station->child_equivalent = (int*) malloc(num_elements * sizeof(int));
+        if (!station->child_equivalent)
         {
-            station->identical_children = 0;
+            *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+            return;
         }
-        else
+        station->identical_children = !*finished_identical_station_check;
+        for (i = 0; i < num_elements; ++i)
         {
-            /* Check if child stations are identical. */
-            station->identical_children = 1;
-            for (i = 1; i < num_elements; ++i)
+            int j;
+            station->child_equivalent[i] = i;
+
+            /* Check if we need to examine every station. */
+            if (*finished_identical_station_check) continue;
+            for (j = 0; j < i; ++j)
             {
-                if (oskar_station_different(
-                        oskar_station_child_const(station, 0),
+                if (station->child_equivalent[j] != j) continue;
+                if (!oskar_station_different(
+                        oskar_station_child_const(station, j),
                         oskar_station_child_const(station, i), status))
                 {
-                    station->identical_children = 0;
+                    station->child_equivalent[i] = j;
+                    break;
                 }
             }
         }
+        for (i = 0; i < num_elements; ++i)
+        {
+            if (station->child_equivalent[i] != 0)
+            {
+                station->identical_children = 0;
+                break;
+            }
+        }
+    }
+}
+
+static double dot3(const double* a, const double* b)
+{
+    return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+}
+
+static void fit_element_lattice(oskar_Station* station,
+        const double* const pos[3], int* status)
+{
+    int i, k, i_a = -1, i_b = -1, i_centre = 0, *idx;
+    int min_a = 0, max_a = 0, min_b = 0, max_b = 0;
+    double a[3], b[3], c[3] = {0.0, 0.0, 0.0}, d[3];
+    double len_a = 0.0, len_b = 0.0, r2_min = 0.0, max_r = 0.0;
+    const int num_elements = station->num_elements;
+
+    /* Use the element closest to the centroid as the origin. */
+    for (i = 0; i < num_elements; ++i)
+        for (k = 0; k < 3; ++k) c[k] += pos[k][i] / num_elements;
+    for (i = 0; i < num_elements; ++i)
+    {
+        double r2 = 0.0;
+        for (k = 0; k < 3; ++k)
+        {
+            r2 += (pos[k][i] - c[k]) * (pos[k][i] - c[k]);
+            if (fabs(pos[k][i]) > max_r) max_r = fabs(pos[k][i]);
+        }
+        if (i == 0 || r2 < r2_min)
+        {
+            i_centre = i;
+            r2_min = r2;
+        }
+    }
+    for (k = 0; k < 3; ++k) c[k] = pos[k][i_centre];
+
+    /* The first lattice vector is the shortest separation from the origin,
+     * and the second is the shortest one that is not parallel to it. */
+    for (i = 0; i < num_elements; ++i)
+    {
+        for (k = 0; k < 3; ++k) d[k] = pos[k][i] - c[k];
+        const double len = sqrt(dot3(d, d));
+        if (len > 0.0 && (i_a < 0 || len < len_a))
+        {
+            i_a = i;
+            len_a = len;
+        }
+    }
+    if (i_a < 0) return;
+    for (k = 0; k < 3; ++k) a[k] = pos[k][i_a] - c[k];
+    for (i = 0; i < num_elements; ++i)
+    {
+        double cross[3];
+        for (k = 0; k < 3; ++k) d[k] = pos[k][i] - c[k];
+        const double len = sqrt(dot3(d, d));
+        cross[0] = a[1] * d[2] - a[2] * d[1];
+        cross[1] = a[2] * d[0] - a[0] * d[2];
+        cross[2] = a[0] * d[1] - a[1] * d[0];
+        if (len == 0.0 ||
+                sqrt(dot3(cross, cross)) < 1e-3 * len_a * len) continue;
+        if (i_b < 0 || len < len_b)
+        {
+            i_b = i;
+            len_b = len;
+        }
+    }
+    if (i_b < 0) return;
+    for (k = 0; k < 3; ++k) b[k] = pos[k][i_b] - c[k];
+
+    /* Check every element is within tolerance of a lattice point,
+     * allowing for the precision of the stored coordinates. */
+    double tol = 1e-6 * len_a;
+    if (station->precision == OSKAR_SINGLE) tol += 4.0 * FLT_EPSILON * max_r;
+    const double aa = dot3(a, a), ab = dot3(a, b), bb = dot3(b, b);
+    const double det = aa * bb - ab * ab;
+    idx = (int*) malloc(2 * num_elements * sizeof(int));
+    if (!idx)
+    {
+        *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+        return;
+    }
+    for (i = 0; i < num_elements; ++i)
+    {
+        double r[3];
+        for (k = 0; k < 3; ++k) d[k] = pos[k][i] - c[k];
+        const double ad = dot3(a, d), bd = dot3(b, d);
+        const double s = floor((bb * ad - ab * bd) / det + 0.5);
+        const double t = floor((aa * bd - ab * ad) / det + 0.5);
+        if (fabs(s) > OSKAR_DFTW_LATTICE_MAX_DIM ||
+                fabs(t) > OSKAR_DFTW_LATTICE_MAX_DIM) break;
+        for (k = 0; k < 3; ++k) r[k] = d[k] - s * a[k] - t * b[k];
+        if (sqrt(dot3(r, r)) > tol) break;
+        idx[2 * i] = (int) s;
+        idx[2 * i + 1] = (int) t;
+        if (i == 0 || idx[2 * i] < min_a) min_a = idx[2 * i];
+        if (i == 0 || idx[2 * i] > max_a) max_a = idx[2 * i];
+        if (i == 0 || idx[2 * i + 1] < min_b) min_b = idx[2 * i + 1];
+        if (i == 0 || idx[2 * i + 1] > max_b) max_b = idx[2 * i + 1];
+    }
+
+    /* Store the lattice if it contains all the elements, and is filled
+     * densely enough for the phase recurrence to be worthwhile. */
+    const int num_a = max_a - min_a + 1, num_b = max_b - min_b + 1;
+    if (i == num_elements && num_a + num_b < num_elements &&
+            num_a <= OSKAR_DFTW_LATTICE_MAX_DIM &&
+            num_b <= OSKAR_DFTW_LATTICE_MAX_DIM)
+    {
+        int* out;
+        station->element_lattice_idx = oskar_mem_create(OSKAR_INT,
+                OSKAR_CPU, 2 * num_elements, status);
+        out = oskar_mem_int(station->element_lattice_idx, status);
+        if (!*status)
+        {
+            for (i = 0; i < num_elements; ++i)
+            {
+                out[2 * i] = idx[2 * i] - min_a;
+                out[2 * i + 1] = idx[2 * i + 1] - min_b;
+            }
+        }
+        for (k = 0; k < 3; ++k)
+        {
+            station->element_lattice[k] = c[k] + min_a * a[k] + min_b * b[k];
+            station->element_lattice[k + 3] = a[k];
+            station->element_lattice[k + 6] = b[k];
+        }
+        station->element_lattice_dims[0] = num_a;
+        station->element_lattice_dims[1] = num_b;
+    }
+    free(idx);
+}
+
+static void find_element_lattice(oskar_Station* station, int* status)
+{
+    int k;
+    oskar_Mem* xyz[3];
+    const double* pos[3];
+
+    /* The lattice is found again whenever the station is analysed. */
+    oskar_mem_free(station->element_lattice_idx, status);
+    station->element_lattice_idx = 0;
+
+    /* Only use a lattice for stations with enough elements, where
+     * the element positions are the same for both polarisations. */
+    if (*status || station->num_elements < 16 ||
+            station->element_true_enu_metres[1][0] ||
+            station->element_true_enu_metres[1][1] ||
+            station->element_true_enu_metres[1][2]) return;
+
+    /* Fit the lattice using element positions in double precision. */
+    for (k = 0; k < 3; ++k)
+    {
+        xyz[k] = oskar_mem_convert_precision(
+                station->element_true_enu_metres[0][k], OSKAR_DOUBLE, status);
+        pos[k] = oskar_mem_double_const(xyz[k], status);
     }
+    if (!*status) fit_element_lattice(station, pos, status);
+    for (k = 0; k < 3; ++k) oskar_mem_free(xyz[k], status);
 }
 
 #ifdef __cplusplus
@@ -34,6 +34,7 @@
 #include <stdlib.h>
 #include <stddef.h>
 #include <stdio.h>
+#include <string.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -120,6 +121,15 @@ oskar_Station* oskar_station_create_copy(const oskar_Station* src,
     oskar_mem_copy(dst->element_mount_types_cpu, src->element_mount_types_cpu, status);
     oskar_mem_copy(dst->permitted_beam_az_rad, src->permitted_beam_az_rad, status);
     oskar_mem_copy(dst->permitted_beam_el_rad, src->permitted_beam_el_rad, status);
+    if (src->element_lattice_idx)
+    {
+        dst->element_lattice_idx = oskar_mem_create_copy(
+                src->element_lattice_idx, location, status);
+        memcpy(dst->element_lattice, src->element_lattice,
+                sizeof(src->element_lattice));
+        dst->element_lattice_dims[0] = src->element_lattice_dims[0];
+        dst->element_lattice_dims[1] = src->element_lattice_dims[1];
+    }
 
     /* Copy element models, if set. */
     if (oskar_station_has_element(src))
@@ -153,6 +163,20 @@ oskar_Station* oskar_station_create_copy(const oskar_Station* src,
         }
     }
 
+    /* Copy the child station equivalence classes. */
+    if (src->child_equivalent)
+    {
+        dst->child_equivalent = (int*) malloc(
+                src->num_elements * sizeof(int));
+        if (!dst->child_equivalent)
+        {
+            *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+            return dst;
+        }
+        memcpy(dst->child_equivalent, src->child_equivalent,
+                src->num_elements * sizeof(int));
+    }
+
     return dst;
 }
 
@@ -59,6 +59,7 @@ void oskar_station_free(oskar_Station* model, int* status)
     oskar_mem_free(model->element_types, status);
     oskar_mem_free(model->element_types_cpu, status);
     oskar_mem_free(model->element_mount_types_cpu, status);
+    oskar_mem_free(model->element_lattice_idx, status);
     oskar_mem_free(model->permitted_beam_az_rad, status);
     oskar_mem_free(model->permitted_beam_el_rad, status);
 
@@ -89,6 +90,7 @@ void oskar_station_free(oskar_Station* model, int* status)
         /* Free the child station handle array. */
         free(model->child);
     }
+    free(model->child_equivalent);
 
     /* Free the structure itself. */
     free(model);
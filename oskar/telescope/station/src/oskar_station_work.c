@@ -29,13 +29,21 @@
 #include "telescope/station/oskar_station_work.h"
 #include "telescope/station/private_station_work.h"
 #include "telescope/station/oskar_evaluate_tec_screen.h"
+#include "telescope/station/element/oskar_element.h"
 
+#include <stdlib.h>
 #include <string.h>
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+/* Maximum memory used by the element pattern cache in each work buffer. */
+#define MAX_ELEMENT_CACHE_BYTES ((size_t)64 * 1024 * 1024)
+
+/* Maximum number of distinct element models in the cache. */
+#define MAX_ELEMENT_CACHE_MODELS 64
+
 static void get_mem_from_template(oskar_Mem** b, const oskar_Mem* a,
         size_t length, int* status);
 
@@ -62,6 +70,9 @@ oskar_StationWork* oskar_station_work_create(int type,
     work->tec_screen = oskar_mem_create(type, location, 0, status);
     work->tec_screen_path = oskar_mem_create(OSKAR_CHAR, OSKAR_CPU, 0, status);
     work->screen_output = oskar_mem_create(complex_type, location, 0, status);
+    work->cache_x = oskar_mem_create(type, OSKAR_CPU, 0, status);
+    work->cache_y = oskar_mem_create(type, OSKAR_CPU, 0, status);
+    work->cache_z = oskar_mem_create(type, OSKAR_CPU, 0, status);
     work->screen_type = 'N'; /* None */
     work->previous_time_index = -1;
     return work;
@@ -85,6 +96,16 @@ void oskar_station_work_free(oskar_StationWork* work, int* status)
     oskar_mem_free(work->tec_screen, status);
     oskar_mem_free(work->tec_screen_path, status);
     oskar_mem_free(work->screen_output, status);
+    oskar_tec_screen_cache_release(work->screen_cache);
+    oskar_mem_free(work->cache_x, status);
+    oskar_mem_free(work->cache_y, status);
+    oskar_mem_free(work->cache_z, status);
+    for (i = 0; i < work->element_cache_capacity; ++i)
+        oskar_mem_free(work->element_cache[i].pattern, status);
+    free(work->element_cache);
+    for (i = 0; i < work->element_cache_num_models; ++i)
+        oskar_element_free(work->element_cache_models[i], status);
+    free(work->element_cache_models);
     for (i = 0; i < work->num_depths; ++i)
         oskar_mem_free(work->beam[i], status);
     free(work);
@@ -132,6 +153,16 @@ void oskar_station_work_set_tec_screen_path(oskar_StationWork* work,
     const size_t len = 1 + strlen(path);
     oskar_mem_realloc(work->tec_screen_path, len, &status);
     memcpy(oskar_mem_void(work->tec_screen_path), path, len);
+
+    /* Use the shared cache for this screen. */
+    oskar_tec_screen_cache_release(work->screen_cache);
+    work->screen_cache = oskar_tec_screen_cache_acquire(path,
+            oskar_mem_precision(work->tec_screen), &status);
+    if (work->screen_cache)
+        oskar_tec_screen_cache_dims(work->screen_cache,
+                &work->screen_num_pixels_x, &work->screen_num_pixels_y,
+                &work->screen_num_pixels_t);
+    work->previous_time_index = -1;
 }
 
 /* FIXME(FD) Pass in a time coordinate here so we use the correct screen. */
@@ -145,32 +176,18 @@ const oskar_Mem* oskar_station_work_evaluate_tec_screen(oskar_StationWork* work,
         return 0;
     else if (work->screen_type == 'E')
     {
-        /* External phase screen. */
-        if (work->screen_num_pixels_x == 0 || work->screen_num_pixels_y == 0)
+        /* External phase screen, read through the shared cache. */
+        if (!work->screen_cache)
         {
-            int num_axes = 0;
-            int* axis_size = 0;
-            oskar_mem_read_fits(0, 0, 0,
-                    oskar_mem_char_const(work->tec_screen_path), 0, 0,
-                    &num_axes, &axis_size, 0, status);
-            work->screen_num_pixels_x = axis_size[0];
-            work->screen_num_pixels_y = axis_size[1];
-            work->screen_num_pixels_t = axis_size[2];
-            free(axis_size);
+            *status = OSKAR_ERR_FILE_IO;
+            return 0;
         }
         if (time_index != work->previous_time_index)
         {
+            /* FIXME(FD) Work out which time index to use here! */
             work->previous_time_index = time_index;
-            const size_t num_pixels =
-                    work->screen_num_pixels_x * work->screen_num_pixels_y;
-            /* FIXME(FD) Work out which time index to use here!
-             * Also consider loading a few at once? */
-            int start_index[3] = {0, 0, time_index};
-            if (time_index >= work->screen_num_pixels_t)
-                start_index[2] = work->screen_num_pixels_t - 1;
-            oskar_mem_read_fits(work->tec_screen, 0, num_pixels,
-                    oskar_mem_char_const(work->tec_screen_path),
-                    3, start_index, 0, 0, 0, status);
+            oskar_tec_screen_cache_copy_slice(work->screen_cache,
+                    time_index, work->tec_screen, status);
         }
     }
     oskar_mem_ensure(work->screen_output, (size_t) num_points, status);
@@ -182,6 +199,148 @@ const oskar_Mem* oskar_station_work_evaluate_tec_screen(oskar_StationWork* work,
     return work->screen_output;
 }
 
+void oskar_station_work_set_element_cache_directions(oskar_StationWork* work,
+        int num_points, const oskar_Mem* x, const oskar_Mem* y,
+        const oskar_Mem* z, int* status)
+{
+    if (*status) return;
+
+    /* Keep the cached patterns if the directions have not changed.
+     * Directions can only be compared in host memory, so patterns in
+     * device memory are only reused within one station beam evaluation. */
+    const int on_cpu = (oskar_mem_location(x) == OSKAR_CPU);
+    if (on_cpu && work->element_cache_used > 0 &&
+            (int) oskar_mem_length(work->cache_x) == num_points &&
+            !oskar_mem_different(x, work->cache_x, num_points, status) &&
+            !oskar_mem_different(y, work->cache_y, num_points, status) &&
+            !oskar_mem_different(z, work->cache_z, num_points, status))
+        return;
+    work->element_cache_direction_set++;
+    work->element_cache_used = 0;
+    work->element_cache_bytes = 0;
+    const size_t num_cached = on_cpu ? (size_t) num_points : 0;
+    oskar_mem_realloc(work->cache_x, num_cached, status);
+    oskar_mem_realloc(work->cache_y, num_cached, status);
+    oskar_mem_realloc(work->cache_z, num_cached, status);
+    oskar_mem_copy_contents(work->cache_x, x, 0, 0, num_cached, status);
+    oskar_mem_copy_contents(work->cache_y, y, 0, 0, num_cached, status);
+    oskar_mem_copy_contents(work->cache_z, z, 0, 0, num_cached, status);
+}
+
+static int element_cache_model_index(oskar_StationWork* work,
+        const oskar_Element* element, int* status)
+{
+    int i;
+    oskar_Element** models;
+    for (i = 0; i < work->element_cache_num_models; ++i)
+        if (!oskar_element_different(element,
+                work->element_cache_models[i], status))
+            return i;
+    if (*status || i == MAX_ELEMENT_CACHE_MODELS) return -1;
+
+    /* Keep a copy of the element, so that it can be matched by content. */
+    models = (oskar_Element**) realloc(work->element_cache_models,
+            (i + 1) * sizeof(oskar_Element*));
+    if (!models)
+    {
+        *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+        return -1;
+    }
+    work->element_cache_models = models;
+    models[i] = oskar_element_create(oskar_element_precision(element),
+            OSKAR_CPU, status);
+    oskar_element_copy(models[i], element, status);
+    work->element_cache_num_models++;
+    return *status ? -1 : i;
+}
+
+void oskar_station_work_evaluate_element(oskar_StationWork* work,
+        const oskar_Element* element, int normalise, int swap_xy,
+        double orientation_x, double orientation_y, int offset_points,
+        int num_points, const oskar_Mem* x, const oskar_Mem* y,
+        const oskar_Mem* z, double frequency_hz, int offset_out,
+        oskar_Mem* output, int* status)
+{
+    int i, element_index = -1;
+    oskar_ElementCacheEntry* entry = 0;
+    if (*status) return;
+
+    /* Copy the pattern from the cache if it has already been evaluated.
+     * Isotropic elements with no taper are trivial to evaluate. */
+    const int type = oskar_mem_type(output);
+    const int location = oskar_mem_location(output);
+    if (!oskar_element_is_isotropic(element) ||
+            oskar_element_taper_type(element) != OSKAR_ELEMENT_TAPER_NONE)
+        element_index = element_cache_model_index(work, element, status);
+    for (i = 0; element_index >= 0 && i < work->element_cache_used; ++i)
+    {
+        entry = &work->element_cache[i];
+        if (entry->element_index == element_index &&
+                entry->direction_set == work->element_cache_direction_set &&
+                entry->normalise == normalise &&
+                entry->swap_xy == swap_xy &&
+                entry->offset_points == offset_points &&
+                entry->num_points == num_points &&
+                entry->orientation_x == orientation_x &&
+                entry->orientation_y == orientation_y &&
+                entry->frequency_hz == frequency_hz &&
+                oskar_mem_type(entry->pattern) == type &&
+                oskar_mem_location(entry->pattern) == location)
+        {
+            oskar_mem_ensure(output, offset_out + num_points, status);
+            oskar_mem_copy_contents(output, entry->pattern,
+                    offset_out, 0, num_points, status);
+            work->element_cache_hits++;
+            return;
+        }
+    }
+
+    /* Evaluate the pattern. */
+    oskar_element_evaluate(element, normalise, swap_xy,
+            orientation_x, orientation_y, offset_points, num_points,
+            x, y, z, frequency_hz, work->theta_modified,
+            work->phi_x, work->phi_y, offset_out, output, status);
+    if (element_index < 0) return;
+    work->element_cache_misses++;
+
+    /* Store it, unless the cache is full. */
+    const size_t bytes = num_points * oskar_mem_element_size(type);
+    if (*status || work->element_cache_bytes + bytes > MAX_ELEMENT_CACHE_BYTES)
+        return;
+    if (work->element_cache_used == work->element_cache_capacity)
+    {
+        const int old_capacity = work->element_cache_capacity;
+        oskar_ElementCacheEntry* entries = (oskar_ElementCacheEntry*) realloc(
+                work->element_cache, (old_capacity + 8) *
+                sizeof(oskar_ElementCacheEntry));
+        if (!entries) return;
+        memset(entries + old_capacity, 0, 8 * sizeof(oskar_ElementCacheEntry));
+        work->element_cache = entries;
+        work->element_cache_capacity += 8;
+    }
+    entry = &work->element_cache[work->element_cache_used++];
+    entry->element_index = element_index;
+    entry->direction_set = work->element_cache_direction_set;
+    entry->normalise = normalise;
+    entry->swap_xy = swap_xy;
+    entry->offset_points = offset_points;
+    entry->num_points = num_points;
+    entry->orientation_x = orientation_x;
+    entry->orientation_y = orientation_y;
+    entry->frequency_hz = frequency_hz;
+    get_mem_from_template(&entry->pattern, output, num_points, status);
+    oskar_mem_copy_contents(entry->pattern, output,
+            0, offset_out, num_points, status);
+    work->element_cache_bytes += bytes;
+}
+
+void oskar_station_work_element_cache_counters(const oskar_StationWork* work,
+        size_t* num_hits, size_t* num_misses)
+{
+    if (num_hits) *num_hits = work->element_cache_hits;
+    if (num_misses) *num_misses = work->element_cache_misses;
+}
+
 oskar_Mem* oskar_station_work_beam_out(oskar_StationWork* work,
         const oskar_Mem* output_beam, size_t length, int* status)
 {
@@ -0,0 +1,247 @@
+/*
+ * Copyright (c) 2020, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "telescope/station/oskar_tec_screen_cache.h"
+#include "utility/oskar_thread.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/* Maximum number of time slices read after the one requested. */
+#define MAX_READ_AHEAD 4
+
+/* Maximum number of time slices held in each cache. */
+#define MAX_SLICES (2 * (MAX_READ_AHEAD + 1))
+
+/* Maximum memory used by the slices and the read buffer in each cache.
+ * Only exceeded if a single slice is larger than a third of this. */
+#define MAX_CACHE_BYTES ((size_t) 512 * 1024 * 1024)
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct oskar_TecScreenCache
+{
+    char* path;
+    int type, ref_count, num_slices, read_ahead;
+    int num_pixels_x, num_pixels_y, num_pixels_t;
+    int slice_index[MAX_SLICES];
+    unsigned int slice_last_used[MAX_SLICES], use_counter;
+    oskar_Mem *slice[MAX_SLICES], *read_buffer;
+    oskar_Mutex* mutex;
+    oskar_TecScreenCache* next;
+};
+
+/* Process-wide list of caches, one for each file and data type.
+ * The list is guarded by a spin lock, which is only held briefly. */
+static oskar_TecScreenCache* cache_list = 0;
+static volatile int cache_list_lock = 0;
+
+static oskar_TecScreenCache* find_cache(const char* path, int type)
+{
+    oskar_TecScreenCache* c;
+    for (c = cache_list; c; c = c->next)
+    {
+        if (c->type == type && !strcmp(c->path, path))
+        {
+            c->ref_count++;
+            return c;
+        }
+    }
+    return 0;
+}
+
+oskar_TecScreenCache* oskar_tec_screen_cache_acquire(const char* path,
+        int type, int* status)
+{
+    int i, num_axes = 0, *axis_size = 0;
+    oskar_TecScreenCache *c, *existing;
+    if (*status || !path) return 0;
+
+    /* Return an existing cache if there is one. */
+    oskar_spin_lock(&cache_list_lock);
+    c = find_cache(path, type);
+    oskar_spin_unlock(&cache_list_lock);
+    if (c) return c;
+
+    /* Get the screen dimensions. */
+    oskar_mem_read_fits(0, 0, 0, path, 0, 0, &num_axes, &axis_size, 0, status);
+    if (*status || num_axes < 2)
+    {
+        if (!*status) *status = OSKAR_ERR_FILE_IO;
+        free(axis_size);
+        return 0;
+    }
+
+    /* Create a new cache. */
+    c = (oskar_TecScreenCache*) calloc(1, sizeof(oskar_TecScreenCache));
+    c->path = (char*) calloc(1 + strlen(path), 1);
+    strcpy(c->path, path);
+    c->type = type;
+    c->ref_count = 1;
+    c->num_pixels_x = axis_size[0];
+    c->num_pixels_y = axis_size[1];
+    c->num_pixels_t = num_axes > 2 ? axis_size[2] : 1;
+    free(axis_size);
+    c->mutex = oskar_mutex_create();
+    c->read_buffer = oskar_mem_create(type, OSKAR_CPU, 0, status);
+
+    /* Limit the number of slices held if they are large.
+     * The read buffer holds half as many slices again. */
+    const size_t slice_bytes = (size_t) c->num_pixels_x * c->num_pixels_y *
+            oskar_mem_element_size(type);
+    const size_t max_slices = slice_bytes > 0 ?
+            2 * (MAX_CACHE_BYTES / slice_bytes) / 3 : MAX_SLICES;
+    c->num_slices = MAX_SLICES;
+    if (max_slices < MAX_SLICES)
+        c->num_slices = (int) max_slices;
+    if (c->num_slices < 2) c->num_slices = 2;
+    c->read_ahead = c->num_slices / 2 - 1;
+    for (i = 0; i < c->num_slices; ++i)
+    {
+        c->slice_index[i] = -1;
+        c->slice[i] = oskar_mem_create(type, OSKAR_CPU, 0, status);
+    }
+
+    /* Add it to the list, unless another thread got there first. */
+    oskar_spin_lock(&cache_list_lock);
+    existing = find_cache(path, type);
+    if (!existing)
+    {
+        c->next = cache_list;
+        cache_list = c;
+    }
+    oskar_spin_unlock(&cache_list_lock);
+    if (existing)
+    {
+        oskar_tec_screen_cache_release(c);
+        c = existing;
+    }
+    return c;
+}
+
+void oskar_tec_screen_cache_release(oskar_TecScreenCache* cache)
+{
+    int i, status = 0;
+    oskar_TecScreenCache** p;
+    if (!cache) return;
+    oskar_spin_lock(&cache_list_lock);
+    if (--cache->ref_count > 0)
+    {
+        oskar_spin_unlock(&cache_list_lock);
+        return;
+    }
+    for (p = &cache_list; *p; p = &(*p)->next)
+    {
+        if (*p == cache)
+        {
+            *p = cache->next;
+            break;
+        }
+    }
+    oskar_spin_unlock(&cache_list_lock);
+    for (i = 0; i < cache->num_slices; ++i)
+        oskar_mem_free(cache->slice[i], &status);
+    oskar_mem_free(cache->read_buffer, &status);
+    oskar_mutex_free(cache->mutex);
+    free(cache->path);
+    free(cache);
+}
+
+void oskar_tec_screen_cache_copy_slice(oskar_TecScreenCache* cache,
+        int time_index, oskar_Mem* slice, int* status)
+{
+    int i, j, i_slot = -1;
+    if (*status || !cache) return;
+    const size_t num_pixels =
+            (size_t) cache->num_pixels_x * cache->num_pixels_y;
+    if (time_index >= cache->num_pixels_t)
+        time_index = cache->num_pixels_t - 1;
+    if (time_index < 0) time_index = 0;
+    oskar_mutex_lock(cache->mutex);
+    for (i = 0; i < cache->num_slices; ++i)
+    {
+        if (cache->slice_index[i] == time_index)
+        {
+            i_slot = i;
+            break;
+        }
+    }
+    if (i_slot < 0)
+    {
+        /* Read the requested slice and the next few in one go. */
+        int num_to_read = 1 + cache->read_ahead;
+        int start_index[3] = {0, 0, 0};
+        if (time_index + num_to_read > cache->num_pixels_t)
+            num_to_read = cache->num_pixels_t - time_index;
+        start_index[2] = time_index;
+        oskar_mem_read_fits(cache->read_buffer, 0, num_pixels * num_to_read,
+                cache->path, 3, start_index, 0, 0, 0, status);
+        for (j = 0; j < num_to_read && !*status; ++j)
+        {
+            int i_oldest = 0, found = 0;
+            for (i = 0; i < cache->num_slices; ++i)
+            {
+                if (cache->slice_index[i] == time_index + j) found = 1;
+                if (cache->slice_last_used[i] <
+                        cache->slice_last_used[i_oldest])
+                    i_oldest = i;
+            }
+            if (found) continue;
+
+            /* Replace the least recently used slice. */
+            oskar_mem_ensure(cache->slice[i_oldest], num_pixels, status);
+            oskar_mem_copy_contents(cache->slice[i_oldest],
+                    cache->read_buffer, 0, j * num_pixels, num_pixels, status);
+            cache->slice_index[i_oldest] = time_index + j;
+            cache->slice_last_used[i_oldest] = ++cache->use_counter;
+            if (j == 0) i_slot = i_oldest;
+        }
+    }
+    if (i_slot >= 0 && !*status)
+    {
+        cache->slice_last_used[i_slot] = ++cache->use_counter;
+        oskar_mem_ensure(slice, num_pixels, status);
+        oskar_mem_copy_contents(slice, cache->slice[i_slot],
+                0, 0, num_pixels, status);
+    }
+    oskar_mutex_unlock(cache->mutex);
+}
+
+void oskar_tec_screen_cache_dims(const oskar_TecScreenCache* cache,
+        int* num_pixels_x, int* num_pixels_y, int* num_pixels_t)
+{
+    *num_pixels_x = cache->num_pixels_x;
+    *num_pixels_y = cache->num_pixels_y;
+    *num_pixels_t = cache->num_pixels_t;
+}
+
+#ifdef __cplusplus
+}
+#endif
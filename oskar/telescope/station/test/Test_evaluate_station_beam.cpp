@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2011-2019, The University of Oxford
+ * Copyright (c) 2011-2020, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -315,3 +315,347 @@ TEST(evaluate_station_beam, gaussian)
         oskar_mem_free(beam, &error);
     }
 }
+
+static double max_abs_diff(const oskar_Mem* a, const oskar_Mem* b, int* status)
+{
+    const double* pa = oskar_mem_double_const(a, status);
+    const double* pb = oskar_mem_double_const(b, status);
+    const size_t n = 8 * oskar_mem_length(a);
+    double max_diff = 0.0;
+    for (size_t i = 0; i < n; ++i)
+        if (fabs(pa[i] - pb[i]) > max_diff) max_diff = fabs(pa[i] - pb[i]);
+    return max_diff;
+}
+
+TEST(evaluate_station_beam, element_cache)
+{
+    int status = 0, num_points = 1000;
+    const int type = OSKAR_DOUBLE;
+    const double freq_hz = 100e6;
+    const double orientation[] = {0.0, M_PI / 4.0};
+    size_t hits = 0, misses = 0;
+    oskar_Element* element = oskar_element_create(type, OSKAR_CPU, &status);
+    oskar_element_set_element_type(element, "Dipole", &status);
+    oskar_Element* copy = oskar_element_create(type, OSKAR_CPU, &status);
+    oskar_element_copy(copy, element, &status);
+    oskar_StationWork* work = oskar_station_work_create(type,
+            OSKAR_CPU, &status);
+    oskar_Mem* x = oskar_mem_create(type, OSKAR_CPU, num_points, &status);
+    oskar_Mem* y = oskar_mem_create(type, OSKAR_CPU, num_points, &status);
+    oskar_Mem* z = oskar_mem_create(type, OSKAR_CPU, num_points, &status);
+    oskar_Mem* theta = oskar_mem_create(type, OSKAR_CPU, 0, &status);
+    oskar_Mem* phi_x = oskar_mem_create(type, OSKAR_CPU, 0, &status);
+    oskar_Mem* phi_y = oskar_mem_create(type, OSKAR_CPU, 0, &status);
+    oskar_Mem* ref = oskar_mem_create(type | OSKAR_COMPLEX | OSKAR_MATRIX,
+            OSKAR_CPU, num_points, &status);
+    oskar_Mem* out = oskar_mem_create(type | OSKAR_COMPLEX | OSKAR_MATRIX,
+            OSKAR_CPU, num_points, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+
+    for (int pass = 0; pass < 2; ++pass)
+    {
+        // Generate directions above the horizon; change them on pass 1.
+        double* px = oskar_mem_double(x, &status);
+        double* py = oskar_mem_double(y, &status);
+        double* pz = oskar_mem_double(z, &status);
+        for (int i = 0; i < num_points; ++i)
+        {
+            const double phi = 2.0 * M_PI * i / num_points;
+            const double theta = (0.05 + pass * 0.3) + 1.2 * i / num_points;
+            px[i] = sin(theta) * cos(phi);
+            py[i] = sin(theta) * sin(phi);
+            pz[i] = cos(theta);
+        }
+        oskar_station_work_set_element_cache_directions(work,
+                num_points, x, y, z, &status);
+
+        // Evaluate each orientation twice, so the second call is cached.
+        // The second call uses a copy of the element, which should match.
+        for (int k = 0; k < 4; ++k)
+        {
+            const double o = orientation[k % 2];
+            oskar_element_evaluate(element, 0, 0, o, o + M_PI / 2.0,
+                    0, num_points, x, y, z, freq_hz, theta, phi_x, phi_y,
+                    0, ref, &status);
+            oskar_mem_clear_contents(out, &status);
+            oskar_station_work_evaluate_element(work, k < 2 ? element : copy,
+                    0, 0, o, o + M_PI / 2.0, 0, num_points, x, y, z, freq_hz,
+                    0, out, &status);
+            ASSERT_EQ(0, status) << oskar_get_error_string(status);
+            EXPECT_EQ(0.0, max_abs_diff(ref, out, &status));
+        }
+        oskar_station_work_element_cache_counters(work, &hits, &misses);
+        EXPECT_EQ((size_t) (2 * (pass + 1)), hits);
+        EXPECT_EQ((size_t) (2 * (pass + 1)), misses);
+    }
+
+    // Changing the element should not return the old pattern.
+    oskar_element_set_taper_type(element, "Cosine", &status);
+    oskar_element_set_cosine_power(element, 2.0);
+    oskar_element_evaluate(element, 0, 0, 0.0, M_PI / 2.0,
+            0, num_points, x, y, z, freq_hz, theta, phi_x, phi_y,
+            0, ref, &status);
+    oskar_station_work_evaluate_element(work, element, 0, 0,
+            0.0, M_PI / 2.0, 0, num_points, x, y, z, freq_hz,
+            0, out, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    EXPECT_EQ(0.0, max_abs_diff(ref, out, &status));
+    oskar_station_work_element_cache_counters(work, &hits, &misses);
+    EXPECT_EQ((size_t) 4, hits);
+    EXPECT_EQ((size_t) 5, misses);
+
+    oskar_element_free(element, &status);
+    oskar_element_free(copy, &status);
+    oskar_station_work_free(work, &status);
+    oskar_mem_free(x, &status);
+    oskar_mem_free(y, &status);
+    oskar_mem_free(z, &status);
+    oskar_mem_free(theta, &status);
+    oskar_mem_free(phi_x, &status);
+    oskar_mem_free(phi_y, &status);
+    oskar_mem_free(ref, &status);
+    oskar_mem_free(out, &status);
+}
+
+static oskar_Station* create_tiled_station(int type, int num_tiles,
+        int tile_dim, double spacing_m, int* status)
+{
+    const int num_elements = tile_dim * tile_dim;
+    oskar_Station* station = oskar_station_create(type, OSKAR_CPU,
+            num_tiles, status);
+    oskar_station_set_position(station, 0.0, M_PI / 2.0, 0.0, 0.0, 0.0, 0.0);
+    oskar_station_set_phase_centre(station,
+            OSKAR_SPHERICAL_TYPE_EQUATORIAL, 0.0, M_PI / 2.0);
+    oskar_station_create_child_stations(station, status);
+    for (int t = 0; t < num_tiles; ++t)
+    {
+        const double tile_xyz[] = {4.0 * tile_dim * spacing_m * t, 0.0, 0.0};
+        oskar_station_set_element_coords(station, 0, t,
+                tile_xyz, tile_xyz, status);
+        oskar_Station* tile = oskar_station_child(station, t);
+        oskar_station_resize(tile, num_elements, status);
+        oskar_station_resize_element_types(tile, 1, status);
+        oskar_station_set_phase_centre(tile,
+                OSKAR_SPHERICAL_TYPE_EQUATORIAL, 0.0, M_PI / 2.0);
+        for (int i = 0; i < num_elements; ++i)
+        {
+            const double xyz[] = {
+                    spacing_m * (i % tile_dim), spacing_m * (i / tile_dim), 0.0
+            };
+            oskar_station_set_element_coords(tile, 0, i, xyz, xyz, status);
+        }
+    }
+    return station;
+}
+
+TEST(evaluate_station_beam, child_equivalence)
+{
+    int status = 0, num_points = 500, finished = 0;
+    const int type = OSKAR_DOUBLE, num_tiles = 6;
+    const double freq_hz = 100e6;
+
+    // Create two copies of a tiled station.
+    oskar_Station* shared = create_tiled_station(type, num_tiles, 4, 1.5,
+            &status);
+    oskar_Station* unshared = create_tiled_station(type, num_tiles, 4, 1.5,
+            &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+
+    // Make tiles 2 and 5 different from the others, but identical to
+    // each other.
+    oskar_station_set_element_errors(oskar_station_child(shared, 2),
+            0, 3, 0.5, 0.0, 10.0, 0.0, &status);
+    oskar_station_set_element_errors(oskar_station_child(shared, 5),
+            0, 3, 0.5, 0.0, 10.0, 0.0, &status);
+    oskar_station_set_element_errors(oskar_station_child(unshared, 2),
+            0, 3, 0.5, 0.0, 10.0, 0.0, &status);
+    oskar_station_set_element_errors(oskar_station_child(unshared, 5),
+            0, 3, 0.5, 0.0, 10.0, 0.0, &status);
+
+    // Check the equivalence classes of the child stations.
+    oskar_station_analyse(shared, &finished, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    EXPECT_EQ(0, oskar_station_identical_children(shared));
+    const int expected[] = {0, 0, 2, 0, 0, 2};
+    for (int i = 0; i < num_tiles; ++i)
+        EXPECT_EQ(expected[i], oskar_station_child_equivalent(shared, i));
+
+    // Analyse the other copy as if stations could never be identical,
+    // so that every child station is evaluated separately.
+    finished = 1;
+    oskar_station_analyse(unshared, &finished, &status);
+    for (int i = 0; i < num_tiles; ++i)
+        EXPECT_EQ(i, oskar_station_child_equivalent(unshared, i));
+
+    // Generate directions above the horizon.
+    oskar_Mem* x = oskar_mem_create(type, OSKAR_CPU, num_points, &status);
+    oskar_Mem* y = oskar_mem_create(type, OSKAR_CPU, num_points, &status);
+    oskar_Mem* z = oskar_mem_create(type, OSKAR_CPU, num_points, &status);
+    double* px = oskar_mem_double(x, &status);
+    double* py = oskar_mem_double(y, &status);
+    double* pz = oskar_mem_double(z, &status);
+    for (int i = 0; i < num_points; ++i)
+    {
+        const double phi = 2.0 * M_PI * i / num_points;
+        const double theta = 1.4 * i / num_points;
+        px[i] = sin(theta) * cos(phi);
+        py[i] = sin(theta) * sin(phi);
+        pz[i] = cos(theta);
+    }
+
+    // Evaluate both beams and check they are the same.
+    oskar_Mem* ref = oskar_mem_create(type | OSKAR_COMPLEX | OSKAR_MATRIX,
+            OSKAR_CPU, num_points, &status);
+    oskar_Mem* out = oskar_mem_create(type | OSKAR_COMPLEX | OSKAR_MATRIX,
+            OSKAR_CPU, num_points, &status);
+    oskar_StationWork* work = oskar_station_work_create(type,
+            OSKAR_CPU, &status);
+    oskar_evaluate_station_beam_aperture_array(ref, unshared,
+            num_points, x, y, z, 0.0, freq_hz, work, 0, &status);
+    oskar_evaluate_station_beam_aperture_array(out, shared,
+            num_points, x, y, z, 0.0, freq_hz, work, 0, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    EXPECT_EQ(0.0, max_abs_diff(ref, out, &status));
+
+    oskar_station_free(shared, &status);
+    oskar_station_free(unshared, &status);
+    oskar_station_work_free(work, &status);
+    oskar_mem_free(x, &status);
+    oskar_mem_free(y, &status);
+    oskar_mem_free(z, &status);
+    oskar_mem_free(ref, &status);
+    oskar_mem_free(out, &status);
+}
+
+TEST(evaluate_station_beam, element_cache_stations)
+{
+    int status = 0, num_points = 500, finished = 1;
+    const int type = OSKAR_DOUBLE, num_tiles = 6;
+    const double freq_hz[] = {100e6, 120e6};
+    size_t hits = 0, misses = 0;
+
+    // Create a tiled station and a copy of it, and analyse both so that
+    // every child station is evaluated separately.
+    oskar_Station* a = create_tiled_station(type, num_tiles, 4, 1.5, &status);
+    oskar_Station* b = oskar_station_create_copy(a, OSKAR_CPU, &status);
+    oskar_station_analyse(a, &finished, &status);
+    finished = 1;
+    oskar_station_analyse(b, &finished, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+
+    // Generate directions above the horizon.
+    oskar_Mem* x = oskar_mem_create(type, OSKAR_CPU, num_points, &status);
+    oskar_Mem* y = oskar_mem_create(type, OSKAR_CPU, num_points, &status);
+    oskar_Mem* z = oskar_mem_create(type, OSKAR_CPU, num_points, &status);
+    double* px = oskar_mem_double(x, &status);
+    double* py = oskar_mem_double(y, &status);
+    double* pz = oskar_mem_double(z, &status);
+    for (int i = 0; i < num_points; ++i)
+    {
+        const double phi = 2.0 * M_PI * i / num_points;
+        const double theta = 1.4 * i / num_points;
+        px[i] = sin(theta) * cos(phi);
+        py[i] = sin(theta) * sin(phi);
+        pz[i] = cos(theta);
+    }
+    oskar_Mem* ref = oskar_mem_create(type | OSKAR_COMPLEX | OSKAR_MATRIX,
+            OSKAR_CPU, num_points, &status);
+    oskar_Mem* out = oskar_mem_create(type | OSKAR_COMPLEX | OSKAR_MATRIX,
+            OSKAR_CPU, num_points, &status);
+    oskar_StationWork* work = oskar_station_work_create(type,
+            OSKAR_CPU, &status);
+
+    // The element pattern should be evaluated once for the first tile,
+    // and then reused for the other tiles, which hold copies of it.
+    oskar_evaluate_station_beam_aperture_array(ref, a,
+            num_points, x, y, z, 0.0, freq_hz[0], work, 0, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    oskar_station_work_element_cache_counters(work, &hits, &misses);
+    EXPECT_EQ((size_t) (num_tiles - 1), hits);
+    EXPECT_EQ((size_t) 1, misses);
+
+    // An identical station should reuse the pattern for every tile.
+    oskar_evaluate_station_beam_aperture_array(out, b,
+            num_points, x, y, z, 0.0, freq_hz[0], work, 0, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    EXPECT_EQ(0.0, max_abs_diff(ref, out, &status));
+    oskar_station_work_element_cache_counters(work, &hits, &misses);
+    EXPECT_EQ((size_t) (2 * num_tiles - 1), hits);
+    EXPECT_EQ((size_t) 1, misses);
+
+    // A new frequency needs a new pattern, but a later channel at the
+    // first frequency should still be cached.
+    oskar_evaluate_station_beam_aperture_array(out, a,
+            num_points, x, y, z, 0.0, freq_hz[1], work, 0, &status);
+    oskar_station_work_element_cache_counters(work, &hits, &misses);
+    EXPECT_EQ((size_t) (3 * num_tiles - 2), hits);
+    EXPECT_EQ((size_t) 2, misses);
+    oskar_evaluate_station_beam_aperture_array(out, b,
+            num_points, x, y, z, 0.0, freq_hz[0], work, 0, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    EXPECT_EQ(0.0, max_abs_diff(ref, out, &status));
+    oskar_station_work_element_cache_counters(work, &hits, &misses);
+    EXPECT_EQ((size_t) (4 * num_tiles - 2), hits);
+    EXPECT_EQ((size_t) 2, misses);
+
+    oskar_station_free(a, &status);
+    oskar_station_free(b, &status);
+    oskar_station_work_free(work, &status);
+    oskar_mem_free(x, &status);
+    oskar_mem_free(y, &status);
+    oskar_mem_free(z, &status);
+    oskar_mem_free(ref, &status);
+    oskar_mem_free(out, &status);
+}
+
+TEST(evaluate_station_beam, element_lattice)
+{
+    int status = 0, finished = 0;
+    const int type = OSKAR_SINGLE, num_x = 10, num_y = 8;
+    oskar_Station* station = oskar_station_create(type, OSKAR_CPU,
+            num_x * num_y, &status);
+    oskar_station_resize_element_types(station, 1, &status);
+
+    // Elements on a rotated rectangular grid should be found on a lattice.
+    const double angle = 0.3;
+    for (int i = 0; i < num_x * num_y; ++i)
+    {
+        const double x = 1.25 * (i % num_x - 4.5);
+        const double y = 1.5 * (i / num_x - 3.5);
+        const double xyz[] = {
+                x * cos(angle) - y * sin(angle),
+                x * sin(angle) + y * cos(angle), 0.0
+        };
+        oskar_station_set_element_coords(station, 0, i, xyz, xyz, &status);
+    }
+    oskar_station_analyse(station, &finished, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    ASSERT_TRUE(oskar_station_element_lattice_idx_const(station) != 0);
+    const int* dims = oskar_station_element_lattice_dims_const(station);
+    EXPECT_EQ(num_x * num_y, dims[0] * dims[1]);
+
+    // Check lattice positions match the element positions.
+    const double* lattice = oskar_station_element_lattice_const(station);
+    const int* idx = oskar_mem_int_const(
+            oskar_station_element_lattice_idx_const(station), &status);
+    for (int i = 0; i < num_x * num_y; ++i)
+    {
+        for (int k = 0; k < 3; ++k)
+        {
+            const double pos = lattice[k] +
+                    idx[2 * i] * lattice[k + 3] +
+                    idx[2 * i + 1] * lattice[k + 6];
+            EXPECT_NEAR(oskar_mem_get_element(
+                    oskar_station_element_true_enu_metres_const(
+                            station, 0, k), i, &status), pos, 1e-5);
+        }
+    }
+
+    // Moving one element off the grid should disable the lattice.
+    const double xyz[] = {0.1, 0.2, 0.0};
+    oskar_station_set_element_coords(station, 0, 17, xyz, xyz, &status);
+    oskar_station_analyse(station, &finished, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    EXPECT_TRUE(oskar_station_element_lattice_idx_const(station) == 0);
+    oskar_station_free(station, &status);
+}
@@ -0,0 +1,108 @@
+/*
+ * Copyright (c) 2020, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <gtest/gtest.h>
+
+#include "telescope/station/oskar_tec_screen_cache.h"
+
+#include <cstdio>
+
+TEST(tec_screen_cache, read_slices)
+{
+    int status = 0, nx = 0, ny = 0, nt = 0;
+    const int width = 16, height = 12, num_times = 11;
+    const size_t num_pixels = width * height;
+    const char* filename = "temp_test_tec_screen_cache.fits";
+
+    // Write a screen where each pixel value encodes its time index.
+    oskar_Mem* cube = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU,
+            num_pixels * num_times, &status);
+    double* p = oskar_mem_double(cube, &status);
+    for (int t = 0; t < num_times; ++t)
+        for (size_t i = 0; i < num_pixels; ++i)
+            p[t * num_pixels + i] = t * 1000.0 + i;
+    oskar_mem_write_fits_cube(cube, filename, width, height, num_times, -1,
+            &status);
+    ASSERT_EQ(0, status);
+
+    // Check that the same cache is shared.
+    oskar_TecScreenCache* c1 = oskar_tec_screen_cache_acquire(filename,
+            OSKAR_DOUBLE, &status);
+    oskar_TecScreenCache* c2 = oskar_tec_screen_cache_acquire(filename,
+            OSKAR_DOUBLE, &status);
+    oskar_TecScreenCache* c3 = oskar_tec_screen_cache_acquire(filename,
+            OSKAR_SINGLE, &status);
+    ASSERT_EQ(0, status);
+    EXPECT_EQ(c1, c2);
+    EXPECT_NE(c1, c3);
+    oskar_tec_screen_cache_dims(c1, &nx, &ny, &nt);
+    EXPECT_EQ(width, nx);
+    EXPECT_EQ(height, ny);
+    EXPECT_EQ(num_times, nt);
+
+    // Read slices in an interleaved order, including past the end.
+    const int order[] = {0, 5, 1, 10, 2, 0, 7, 3, 15, 9, 4, 6, 8};
+    oskar_Mem* slice = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, 0, &status);
+    oskar_Mem* slice_f = oskar_mem_create(OSKAR_SINGLE, OSKAR_CPU, 0, &status);
+    for (size_t k = 0; k < sizeof(order) / sizeof(int); ++k)
+    {
+        const int t = order[k] < num_times ? order[k] : num_times - 1;
+        oskar_tec_screen_cache_copy_slice(c2, order[k], slice, &status);
+        oskar_tec_screen_cache_copy_slice(c3, order[k], slice_f, &status);
+        ASSERT_EQ(0, status);
+        ASSERT_EQ(num_pixels, oskar_mem_length(slice));
+        const double* s = oskar_mem_double_const(slice, &status);
+        const float* s_f = oskar_mem_float_const(slice_f, &status);
+        for (size_t i = 0; i < num_pixels; ++i)
+        {
+            ASSERT_DOUBLE_EQ(t * 1000.0 + i, s[i]);
+            ASSERT_FLOAT_EQ((float)(t * 1000.0 + i), s_f[i]);
+        }
+    }
+    oskar_tec_screen_cache_release(c1);
+    oskar_tec_screen_cache_release(c2);
+    oskar_tec_screen_cache_release(c3);
+
+    // Check that the cache is re-created after being released.
+    c1 = oskar_tec_screen_cache_acquire(filename, OSKAR_DOUBLE, &status);
+    oskar_tec_screen_cache_copy_slice(c1, 3, slice, &status);
+    EXPECT_EQ(0, status);
+    EXPECT_DOUBLE_EQ(3000.0, oskar_mem_double(slice, &status)[0]);
+    oskar_tec_screen_cache_release(c1);
+
+    // Check that a missing file is reported.
+    c1 = oskar_tec_screen_cache_acquire("temp_test_missing_screen.fits",
+            OSKAR_DOUBLE, &status);
+    EXPECT_NE(0, status);
+    EXPECT_TRUE(c1 == 0);
+
+    oskar_mem_free(cube, &status);
+    oskar_mem_free(slice, &status);
+    oskar_mem_free(slice_f, &status);
+    remove(filename);
+}
@@ -0,0 +1,95 @@
+/*
+ * Copyright (c) 2020, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef OSKAR_CPU_SIMD_LEVEL_H_
+#define OSKAR_CPU_SIMD_LEVEL_H_
+
+/**
+ * @file oskar_cpu_simd_level.h
+ */
+
+#include <oskar_global.h>
+
+enum OSKAR_CPU_SIMD_LEVEL
+{
+    OSKAR_CPU_SIMD_NONE = 0,
+    OSKAR_CPU_SIMD_AVX2 = 1,
+    OSKAR_CPU_SIMD_AVX512 = 2
+};
+
+/*
+ * Function attributes used to compile CPU code paths for specific
+ * instruction sets. These are only defined if the compiler supports them,
+ * and the code paths must only be called if oskar_cpu_simd_level()
+ * says the instructions are available.
+ */
+#if !defined(OSKAR_NO_CPU_SIMD) && !defined(__CUDACC__) && \
+        (defined(__GNUC__) || defined(__clang__)) && \
+        (defined(__x86_64__) || defined(__i386__))
+#define OSKAR_HAVE_CPU_SIMD 1
+#define OSKAR_TARGET_AVX2 __attribute__((target("avx2,fma")))
+#define OSKAR_TARGET_AVX512 __attribute__((target("avx512f,avx512dq,avx2,fma")))
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief
+ * Returns the widest SIMD instruction set usable on this CPU.
+ *
+ * @details
+ * Returns the widest SIMD instruction set that is both supported by the
+ * CPU (checked once using CPUID) and compiled into the library,
+ * as a value from the OSKAR_CPU_SIMD_LEVEL enumeration.
+ *
+ * The returned value is capped by oskar_cpu_simd_set_max_level().
+ */
+OSKAR_EXPORT
+int oskar_cpu_simd_level(void);
+
+/**
+ * @brief
+ * Sets the maximum SIMD instruction set that may be used.
+ *
+ * @details
+ * Sets the maximum SIMD instruction set that may be used by CPU code paths.
+ * This can be used to force use of the scalar code paths by setting it to
+ * OSKAR_CPU_SIMD_NONE.
+ *
+ * @param[in] level Value from the OSKAR_CPU_SIMD_LEVEL enumeration.
+ */
+OSKAR_EXPORT
+void oskar_cpu_simd_set_max_level(int level);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OSKAR_CPU_SIMD_LEVEL_H_ */
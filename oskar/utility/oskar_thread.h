@@ -40,9 +40,11 @@ extern "C" {
 #endif
 
 struct oskar_Mutex;
+struct oskar_ConditionVar;
 struct oskar_Thread;
 struct oskar_Barrier;
 typedef struct oskar_Mutex oskar_Mutex;
+typedef struct oskar_ConditionVar oskar_ConditionVar;
 typedef struct oskar_Thread oskar_Thread;
 typedef struct oskar_Barrier oskar_Barrier;
 
@@ -118,6 +120,114 @@ void oskar_thread_free(oskar_Thread* thread);
 OSKAR_EXPORT
 void oskar_thread_join(oskar_Thread* thread);
 
+/**
+ * @brief Creates a condition variable.
+ *
+ * @details
+ * Creates a condition variable, with its own mutex.
+ */
+OSKAR_EXPORT
+oskar_ConditionVar* oskar_condition_create(void);
+
+/**
+ * @brief Destroys the condition variable.
+ *
+ * @details
+ * Destroys the condition variable.
+ *
+ * @param[in,out] var Pointer to condition variable.
+ */
+OSKAR_EXPORT
+void oskar_condition_free(oskar_ConditionVar* var);
+
+/**
+ * @brief Locks the mutex of the condition variable.
+ *
+ * @details
+ * Locks the mutex of the condition variable.
+ *
+ * @param[in,out] var Pointer to condition variable.
+ */
+OSKAR_EXPORT
+void oskar_condition_lock(oskar_ConditionVar* var);
+
+/**
+ * @brief Unlocks the mutex of the condition variable.
+ *
+ * @details
+ * Unlocks the mutex of the condition variable.
+ *
+ * @param[in,out] var Pointer to condition variable.
+ */
+OSKAR_EXPORT
+void oskar_condition_unlock(oskar_ConditionVar* var);
+
+/**
+ * @brief Wakes all threads waiting on the condition variable.
+ *
+ * @details
+ * Wakes all threads waiting on the condition variable.
+ *
+ * @param[in,out] var Pointer to condition variable.
+ */
+OSKAR_EXPORT
+void oskar_condition_notify_all(oskar_ConditionVar* var);
+
+/**
+ * @brief Waits on the condition variable.
+ *
+ * @details
+ * Releases the mutex, which must be locked by the caller, and blocks
+ * until notified. The mutex is locked again on return.
+ *
+ * Spurious wake-ups are possible, so the caller should check its
+ * condition in a loop.
+ *
+ * @param[in,out] var Pointer to condition variable.
+ */
+OSKAR_EXPORT
+void oskar_condition_wait(oskar_ConditionVar* var);
+
+/**
+ * @brief Atomically adds a value to an integer.
+ *
+ * @details
+ * Atomically adds a value to an integer, and returns the value it had
+ * before the addition.
+ *
+ * @param[in,out] value     Pointer to integer to update.
+ * @param[in]     increment Value to add.
+ */
+OSKAR_EXPORT
+int oskar_atomic_fetch_add(volatile int* value, int increment);
+
+/**
+ * @brief Acquires a spin lock.
+ *
+ * @details
+ * Acquires a spin lock held in an integer, which must be initialised to
+ * zero. The lock is taken using an atomic test-and-set, and the caller
+ * yields the processor while waiting for the lock to become free.
+ *
+ * Spin locks need no creation, so they can be used to guard static data,
+ * but they should only be held for a few instructions.
+ *
+ * @param[in,out] lock Pointer to the lock.
+ */
+OSKAR_EXPORT
+void oskar_spin_lock(volatile int* lock);
+
+/**
+ * @brief Releases a spin lock.
+ *
+ * @details
+ * Releases a spin lock acquired by oskar_spin_lock().
+ *
+ * @param[in,out] lock Pointer to the lock.
+ */
+OSKAR_EXPORT
+void oskar_spin_unlock(volatile int* lock);
+
 /**
  * @brief Creates a barrier.
  *
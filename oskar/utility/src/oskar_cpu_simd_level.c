@@ -0,0 +1,67 @@
+/*
+ * Copyright (c) 2020, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "utility/oskar_cpu_simd_level.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+static int max_level_ = OSKAR_CPU_SIMD_AVX512;
+
+int oskar_cpu_simd_level(void)
+{
+    int level = OSKAR_CPU_SIMD_NONE;
+#ifdef OSKAR_HAVE_CPU_SIMD
+    static int detected_level_ = -1;
+    if (detected_level_ < 0)
+    {
+        int detected = OSKAR_CPU_SIMD_NONE;
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+        {
+            detected = OSKAR_CPU_SIMD_AVX2;
+            if (__builtin_cpu_supports("avx512f") &&
+                    __builtin_cpu_supports("avx512dq"))
+                detected = OSKAR_CPU_SIMD_AVX512;
+        }
+        detected_level_ = detected;
+    }
+    level = detected_level_;
+#endif
+    return level < max_level_ ? level : max_level_;
+}
+
+void oskar_cpu_simd_set_max_level(int level)
+{
+    max_level_ = level;
+}
+
+#ifdef __cplusplus
+}
+#endif
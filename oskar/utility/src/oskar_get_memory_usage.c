@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2015-2019, The University of Oxford
+ * Copyright (c) 2015-2020, The University of Oxford
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -27,6 +27,7 @@
  */
 
 #include "utility/oskar_get_memory_usage.h"
+#include "mem/oskar_mem_allocator.h"
 
 #include <stdio.h>
 #include <stddef.h>
@@ -250,6 +251,7 @@ void oskar_log_mem(oskar_Log* log)
     const size_t mem_resident = oskar_get_memory_usage();
     const size_t mem_free = oskar_get_free_physical_memory();
     const size_t mem_used = mem_total - mem_free;
+    size_t num_allocated = 0, num_reused = 0, num_in_place = 0;
     oskar_log_message(log, 'M', 0,
             "System memory is %.1f%% (%.1f GB/%.1f GB) used.",
             100. * (double) mem_used / mem_total,
@@ -258,6 +260,12 @@ void oskar_log_mem(oskar_Log* log)
     oskar_log_message(log, 'M', 0,
             "System memory used by current process: %.1f MB.",
             (double) mem_resident / (1024. * 1024.));
+    oskar_mem_allocator_counters(&num_allocated, &num_reused, &num_in_place);
+    oskar_log_message(log, 'M', 0,
+            "Host memory blocks allocated: %lu "
+            "(%lu reused, %lu resized in place).",
+            (unsigned long) num_allocated, (unsigned long) num_reused,
+            (unsigned long) num_in_place);
 }
 
 #ifdef __cplusplus
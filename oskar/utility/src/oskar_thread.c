@@ -35,6 +35,7 @@
 #include <process.h>
 #else
 #include <pthread.h>
+#include <sched.h>
 #endif
 
 
@@ -120,7 +121,6 @@ struct oskar_ConditionVar
     pthread_cond_t var;
 #endif
 };
-typedef struct oskar_ConditionVar oskar_ConditionVar;
 
 static void oskar_condition_init(oskar_ConditionVar* var)
 {
@@ -142,17 +142,32 @@ static void oskar_condition_uninit(oskar_ConditionVar* var)
 #endif
 }
 
-static void oskar_condition_lock(oskar_ConditionVar* var)
+oskar_ConditionVar* oskar_condition_create(void)
+{
+    oskar_ConditionVar* var;
+    var = (oskar_ConditionVar*) calloc(1, sizeof(oskar_ConditionVar));
+    oskar_condition_init(var);
+    return var;
+}
+
+void oskar_condition_free(oskar_ConditionVar* var)
+{
+    if (!var) return;
+    oskar_condition_uninit(var);
+    free(var);
+}
+
+void oskar_condition_lock(oskar_ConditionVar* var)
 {
     oskar_mutex_lock(&var->lock);
 }
 
-static void oskar_condition_unlock(oskar_ConditionVar* var)
+void oskar_condition_unlock(oskar_ConditionVar* var)
 {
     oskar_mutex_unlock(&var->lock);
 }
 
-static void oskar_condition_notify_all(oskar_ConditionVar* var)
+void oskar_condition_notify_all(oskar_ConditionVar* var)
 {
 #if defined(OSKAR_OS_WIN)
     WakeAllConditionVariable(&var->var);
@@ -161,7 +176,7 @@ static void oskar_condition_notify_all(oskar_ConditionVar* var)
 #endif
 }
 
-static void oskar_condition_wait(oskar_ConditionVar* var)
+void oskar_condition_wait(oskar_ConditionVar* var)
 {
 #if defined(OSKAR_OS_WIN)
     SleepConditionVariableCS(&var->var, &(var->lock.lock), INFINITE);
@@ -171,6 +186,41 @@ static void oskar_condition_wait(oskar_ConditionVar* var)
 }
 
 
+/* =========================================================================
+ *  ATOMIC
+ * =========================================================================*/
+
+int oskar_atomic_fetch_add(volatile int* value, int increment)
+{
+#ifdef OSKAR_OS_WIN
+    return (int) InterlockedExchangeAdd((volatile LONG*) value,
+            (LONG) increment);
+#else
+    return __sync_fetch_and_add(value, increment);
+#endif
+}
+
+void oskar_spin_lock(volatile int* lock)
+{
+#ifdef OSKAR_OS_WIN
+    while (InterlockedExchange((volatile LONG*) lock, 1) != 0)
+        while (*lock) SwitchToThread();
+#else
+    while (__sync_lock_test_and_set(lock, 1) != 0)
+        while (*lock) sched_yield();
+#endif
+}
+
+void oskar_spin_unlock(volatile int* lock)
+{
+#ifdef OSKAR_OS_WIN
+    InterlockedExchange((volatile LONG*) lock, 0);
+#else
+    __sync_lock_release(lock);
+#endif
+}
+
+
 /* =========================================================================
  *  THREAD
  * =========================================================================*/
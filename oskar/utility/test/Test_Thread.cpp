@@ -124,3 +124,101 @@ TEST(thread, barriers)
     free(args);
     free(threads);
 }
+
+struct CounterArgs
+{
+    volatile int* counter;
+    oskar_ConditionVar* var;
+    int* num_finished;
+};
+typedef struct CounterArgs CounterArgs;
+
+void* thread_atomic_add(void* arg)
+{
+    CounterArgs* args = (CounterArgs*) arg;
+    for (int i = 0; i < 10000; ++i)
+        oskar_atomic_fetch_add(args->counter, 1);
+    oskar_condition_lock(args->var);
+    (*args->num_finished)++;
+    oskar_condition_notify_all(args->var);
+    oskar_condition_unlock(args->var);
+    return 0;
+}
+
+TEST(thread, atomic_add_and_condition)
+{
+    // Set the number of threads.
+    int num_threads = 8, num_finished = 0;
+    volatile int counter = 0;
+
+    // Create the shared condition variable.
+    CounterArgs args;
+    args.counter = &counter;
+    args.var = oskar_condition_create();
+    args.num_finished = &num_finished;
+
+    // Start all the threads.
+    oskar_Thread** threads = (oskar_Thread**)
+            calloc((size_t) num_threads, sizeof(oskar_Thread*));
+    for (int i = 0; i < num_threads; ++i)
+        threads[i] = oskar_thread_create(thread_atomic_add, (void*)&args, 0);
+
+    // Wait for the threads to say they have finished.
+    oskar_condition_lock(args.var);
+    while (num_finished < num_threads)
+        oskar_condition_wait(args.var);
+    oskar_condition_unlock(args.var);
+    EXPECT_EQ(num_threads * 10000, counter);
+
+    // Clean up.
+    for (int i = 0; i < num_threads; ++i)
+    {
+        oskar_thread_join(threads[i]);
+        oskar_thread_free(threads[i]);
+    }
+    oskar_condition_free(args.var);
+    free(threads);
+}
+
+struct SpinArgs
+{
+    volatile int* lock;
+    int* counter;
+};
+typedef struct SpinArgs SpinArgs;
+
+void* thread_spin_lock(void* arg)
+{
+    SpinArgs* args = (SpinArgs*) arg;
+    for (int i = 0; i < 10000; ++i)
+    {
+        oskar_spin_lock(args->lock);
+        (*args->counter)++;
+        oskar_spin_unlock(args->lock);
+    }
+    return 0;
+}
+
+TEST(thread, spin_lock)
+{
+    // Set the number of threads.
+    int num_threads = 8, counter = 0;
+    volatile int lock = 0;
+    SpinArgs args;
+    args.lock = &lock;
+    args.counter = &counter;
+
+    // Start all the threads, and wait for them to finish.
+    oskar_Thread** threads = (oskar_Thread**)
+            calloc((size_t) num_threads, sizeof(oskar_Thread*));
+    for (int i = 0; i < num_threads; ++i)
+        threads[i] = oskar_thread_create(thread_spin_lock, (void*)&args, 0);
+    for (int i = 0; i < num_threads; ++i)
+    {
+        oskar_thread_join(threads[i]);
+        oskar_thread_free(threads[i]);
+    }
+    EXPECT_EQ(num_threads * 10000, counter);
+    EXPECT_EQ(0, lock);
+    free(threads);
+}
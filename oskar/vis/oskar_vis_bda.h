@@ -0,0 +1,67 @@
+/*
+ * Copyright (c) 2020, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef OSKAR_VIS_BDA_H_
+#define OSKAR_VIS_BDA_H_
+
+/**
+ * @file oskar_vis_bda.h
+ */
+
+/* Public interface. */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct oskar_VisBda;
+#ifndef OSKAR_VIS_BDA_TYPEDEF_
+#define OSKAR_VIS_BDA_TYPEDEF_
+typedef struct oskar_VisBda oskar_VisBda;
+#endif /* OSKAR_VIS_BDA_TYPEDEF_ */
+
+struct oskar_VisBdaAverager;
+#ifndef OSKAR_VIS_BDA_AVERAGER_TYPEDEF_
+#define OSKAR_VIS_BDA_AVERAGER_TYPEDEF_
+typedef struct oskar_VisBdaAverager oskar_VisBdaAverager;
+#endif /* OSKAR_VIS_BDA_AVERAGER_TYPEDEF_ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#include <vis/oskar_vis_bda_accessors.h>
+#include <vis/oskar_vis_bda_averager.h>
+#include <vis/oskar_vis_bda_create.h>
+#include <vis/oskar_vis_bda_free.h>
+#include <vis/oskar_vis_bda_read.h>
+#include <vis/oskar_vis_bda_resize.h>
+#include <vis/oskar_vis_bda_write.h>
+#include <vis/oskar_vis_bda_write_ms.h>
+
+#endif /* OSKAR_VIS_BDA_H_ */
@@ -0,0 +1,131 @@
+/*
+ * Copyright (c) 2020, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef OSKAR_VIS_BDA_AVERAGER_H_
+#define OSKAR_VIS_BDA_AVERAGER_H_
+
+/**
+ * @file oskar_vis_bda_averager.h
+ */
+
+#include <oskar_global.h>
+#include <vis/oskar_vis_block.h>
+#include <vis/oskar_vis_header.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief
+ * Creates a baseline-dependent averager for blocks described by a header.
+ *
+ * @details
+ * Consecutive time samples on each baseline are averaged until the
+ * baseline would move further in the uvw-plane than allowed by the
+ * amplitude loss limit, or until the maximum averaging time is reached.
+ * Short baselines therefore use longer averages than long baselines.
+ *
+ * The largest uvw distance allowed in an average is set so that the
+ * amplitude of a source at the edge of the field of view is not reduced
+ * by more than a factor of \p max_fact at the highest frequency in
+ * the header.
+ *
+ * The averager must be deallocated using oskar_vis_bda_averager_free()
+ * when it is no longer required.
+ *
+ * @param[in] hdr            Pointer to populated visibility header data.
+ * @param[in] max_fact       Maximum allowed amplitude loss factor (> 1).
+ * @param[in] fov_deg        Field of view, in degrees.
+ * @param[in] max_time_sec   Maximum averaging time, in seconds (0 = none).
+ * @param[in,out] status     Status return code.
+ *
+ * @return A handle to the new averager.
+ */
+OSKAR_EXPORT
+oskar_VisBdaAverager* oskar_vis_bda_averager_create(
+        const oskar_VisHeader* hdr, double max_fact, double fov_deg,
+        double max_time_sec, int* status);
+
+/**
+ * @brief
+ * Frees memory held by a baseline-dependent averager.
+ *
+ * @param[in,out] h       Handle to averager.
+ * @param[in,out] status  Status return code.
+ */
+OSKAR_EXPORT
+void oskar_vis_bda_averager_free(oskar_VisBdaAverager* h, int* status);
+
+/**
+ * @brief
+ * Returns the largest uvw distance allowed in an average, in metres.
+ *
+ * @param[in] h           Handle to averager.
+ */
+OSKAR_EXPORT
+double oskar_vis_bda_averager_max_duvw_metres(const oskar_VisBdaAverager* h);
+
+/**
+ * @brief
+ * Adds a block of visibilities to the averager.
+ *
+ * @details
+ * The cross-correlations in the block are added to the running average
+ * for each baseline, and the averages that are complete are returned as
+ * rows in \p out, which is resized as needed.
+ *
+ * Blocks must be supplied in time order. If \p flush is set (for the last
+ * block), all remaining partial averages are also returned, and the
+ * averager is reset ready for the next observation.
+ *
+ * @param[in,out] h       Handle to averager.
+ * @param[in]     block   Block of visibilities in CPU memory.
+ * @param[in]     flush   If true, return all remaining averages.
+ * @param[out]    out     Completed averages.
+ * @param[in,out] status  Status return code.
+ */
+OSKAR_EXPORT
+void oskar_vis_bda_averager_add_block(oskar_VisBdaAverager* h,
+        const oskar_VisBlock* block, int flush, oskar_VisBda* out,
+        int* status);
+
+/**
+ * @brief
+ * Discards all partial averages held by the averager.
+ *
+ * @param[in,out] h       Handle to averager.
+ */
+OSKAR_EXPORT
+void oskar_vis_bda_averager_reset(oskar_VisBdaAverager* h);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OSKAR_VIS_BDA_AVERAGER_H_ */
@@ -0,0 +1,72 @@
+/*
+ * Copyright (c) 2020, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef OSKAR_VIS_BDA_CREATE_H_
+#define OSKAR_VIS_BDA_CREATE_H_
+
+/**
+ * @file oskar_vis_bda_create.h
+ */
+
+#include <oskar_global.h>
+#include <vis/oskar_vis_header.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief
+ * Creates a new structure to hold baseline-dependent averaged visibilities.
+ *
+ * @details
+ * This function creates a new, empty structure to hold rows of
+ * baseline-dependent averaged cross-correlations, with the data types and
+ * the number of channels and stations given in the visibility header.
+ *
+ * Each row holds the data for one baseline over all channels, averaged
+ * over one or more consecutive time samples. The amplitude data are
+ * ordered by row, then channel, then (implicit) polarisation.
+ *
+ * The structure must be deallocated using oskar_vis_bda_free() when it is
+ * no longer required.
+ *
+ * @param[in] hdr              Pointer to populated visibility header data.
+ * @param[in,out]  status      Status return code.
+ *
+ * @return A handle to the new data structure.
+ */
+OSKAR_EXPORT
+oskar_VisBda* oskar_vis_bda_create_from_header(const oskar_VisHeader* hdr,
+        int* status);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OSKAR_VIS_BDA_CREATE_H_ */
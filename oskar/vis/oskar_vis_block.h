@@ -54,7 +54,18 @@ enum OSKAR_VIS_BLOCK_TAGS
     OSKAR_VIS_BLOCK_TAG_CROSS_CORRELATIONS    = 3,
     OSKAR_VIS_BLOCK_TAG_BASELINE_UU           = 4,
     OSKAR_VIS_BLOCK_TAG_BASELINE_VV           = 5,
-    OSKAR_VIS_BLOCK_TAG_BASELINE_WW           = 6
+    OSKAR_VIS_BLOCK_TAG_BASELINE_WW           = 6,
+
+    /* Used instead of tags 3-6 if the header has baseline-dependent
+     * averaging enabled (see oskar_vis_bda.h). */
+    OSKAR_VIS_BLOCK_TAG_BDA_ANTENNA1          = 7,
+    OSKAR_VIS_BLOCK_TAG_BDA_ANTENNA2          = 8,
+    OSKAR_VIS_BLOCK_TAG_BDA_NUM_SAMPLES       = 9,
+    OSKAR_VIS_BLOCK_TAG_BDA_TIME_CENTROID     = 10,
+    OSKAR_VIS_BLOCK_TAG_BDA_BASELINE_UU       = 11,
+    OSKAR_VIS_BLOCK_TAG_BDA_BASELINE_VV       = 12,
+    OSKAR_VIS_BLOCK_TAG_BDA_BASELINE_WW       = 13,
+    OSKAR_VIS_BLOCK_TAG_BDA_CROSS_CORRELATIONS = 14
 };
 
 #ifdef __cplusplus
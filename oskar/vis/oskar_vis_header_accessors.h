@@ -89,6 +89,9 @@ int oskar_vis_header_num_stations(const oskar_VisHeader* vis);
 OSKAR_EXPORT
 int oskar_vis_header_pol_type(const oskar_VisHeader* vis);
 
+OSKAR_EXPORT
+int oskar_vis_header_bda(const oskar_VisHeader* vis);
+
 OSKAR_EXPORT
 int oskar_vis_header_phase_centre_coord_type(const oskar_VisHeader* vis);
 
@@ -180,6 +183,21 @@ OSKAR_EXPORT
 void oskar_vis_header_set_pol_type(oskar_VisHeader* vis, int value,
         int* status);
 
+/**
+ * @brief
+ * Sets whether blocks hold baseline-dependent averaged rows.
+ *
+ * @details
+ * If set, each block in the binary file stores the cross-correlation rows
+ * of an oskar_VisBda structure instead of the full time-baseline grid,
+ * and the number of tags per block is updated accordingly.
+ *
+ * @param[in,out] vis   Pointer to header.
+ * @param[in]     value If true, blocks hold baseline-dependent averaged rows.
+ */
+OSKAR_EXPORT
+void oskar_vis_header_set_bda(oskar_VisHeader* vis, int value);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,108 @@
+/*
+ * Copyright (c) 2020, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef OSKAR_PRIVATE_VIS_BDA_H_
+#define OSKAR_PRIVATE_VIS_BDA_H_
+
+#include <mem/oskar_mem.h>
+
+/*
+ * This structure holds baseline-dependent averaged (BDA) cross-correlation
+ * data generated from one visibility block.
+ *
+ * Each row holds the average of one or more consecutive time samples on
+ * one baseline, for all channels. The polarisation dimension is implicit
+ * in the data type (matrix or scalar) and is therefore the fastest varying.
+ * From slowest to fastest varying, the remaining dimensions are:
+ *
+ * - Row (slowest)
+ * - Channel (fastest)
+ *
+ * This is the same as the row-channel-polarisation order of the
+ * Measurement Set DATA column.
+ */
+struct oskar_VisBda
+{
+    /* Global start time index, start channel index,
+     * and dimension sizes: time, channel, row, station.
+     * The time dimensions are those of the block that was averaged. */
+    int dim_start_size[6];
+
+    /* Row arrays have size num_rows. */
+    oskar_Mem* antenna1;           /* [int] First station index of row. */
+    oskar_Mem* antenna2;           /* [int] Second station index of row. */
+    oskar_Mem* num_samples;        /* [int] No. time samples averaged. */
+    oskar_Mem* time_centroid;      /* [double] Centroid, MJD(UTC) seconds. */
+    oskar_Mem* baseline_uu_metres; /* [real] Mean baseline coordinates. */
+    oskar_Mem* baseline_vv_metres; /* [real] Mean baseline coordinates. */
+    oskar_Mem* baseline_ww_metres; /* [real] Mean baseline coordinates. */
+
+    /* Amplitude array has size num_rows * num_channels. */
+    /* [complex / complex matrix] */
+    oskar_Mem* cross_correlations; /* Mean visibility amplitudes. */
+};
+
+#ifndef OSKAR_VIS_BDA_TYPEDEF_
+#define OSKAR_VIS_BDA_TYPEDEF_
+typedef struct oskar_VisBda oskar_VisBda;
+#endif /* OSKAR_VIS_BDA_TYPEDEF_ */
+
+/*
+ * Holds the state of baseline-dependent averaging between blocks.
+ * Samples are accumulated for each baseline until the baseline has moved
+ * further than allowed in the uvw-plane, or until the maximum averaging
+ * time is reached. Arrays here are always in CPU memory.
+ */
+struct oskar_VisBdaAverager
+{
+    int amp_type, coord_precision;
+    int num_stations, num_baselines, num_channels;
+    double time_start_mjd_utc_sec; /* Start time [MJD(UTC) seconds]. */
+    double time_inc_sec;           /* Time increment of input samples [s]. */
+    double max_duvw_metres;        /* Maximum uvw distance in an average. */
+    int max_samples;               /* Maximum samples in an average. */
+
+    /* Per-baseline state, with size num_baselines (x3 for coordinates). */
+    int *station1, *station2;      /* Station indices of each baseline. */
+    int *count;                    /* No. samples in current average. */
+    int *flush;                    /* Scratch: output row index, or -1. */
+    double *duvw;                  /* uvw distance moved in average [m]. */
+    double *time_sum;              /* Sum of sample time indices. */
+    double *uvw_sum;               /* Sum of sample coordinates [m]. */
+    double *uvw_last;              /* Coordinates of last sample [m]. */
+
+    /* Sum of amplitudes, with size num_baselines * num_channels. */
+    oskar_Mem* vis_sum;
+};
+
+#ifndef OSKAR_VIS_BDA_AVERAGER_TYPEDEF_
+#define OSKAR_VIS_BDA_AVERAGER_TYPEDEF_
+typedef struct oskar_VisBdaAverager oskar_VisBdaAverager;
+#endif /* OSKAR_VIS_BDA_AVERAGER_TYPEDEF_ */
+
+#endif /* OSKAR_PRIVATE_VIS_BDA_H_ */
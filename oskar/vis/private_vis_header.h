@@ -51,6 +51,7 @@ struct oskar_VisHeader
     int num_channels_total;          /* Total no. channels. */
     int num_stations;                /* No. interferometer stations. */
     int pol_type;                    /* Polarisation type enumerator. */
+    int bda;                         /* True if blocks hold averaged rows. */
 
     int phase_centre_type;           /* Phase centre coordinate type. */
     double phase_centre_deg[2];      /* Phase centre coordinates [deg]. */
@@ -0,0 +1,157 @@
+/*
+ * Copyright (c) 2020, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "vis/private_vis_bda.h"
+#include "vis/oskar_vis_bda.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+int oskar_vis_bda_num_channels(const oskar_VisBda* vis)
+{
+    return vis->dim_start_size[3];
+}
+
+int oskar_vis_bda_num_pols(const oskar_VisBda* vis)
+{
+    return oskar_mem_is_matrix(vis->cross_correlations) ? 4 : 1;
+}
+
+int oskar_vis_bda_num_rows(const oskar_VisBda* vis)
+{
+    return vis->dim_start_size[4];
+}
+
+int oskar_vis_bda_num_stations(const oskar_VisBda* vis)
+{
+    return vis->dim_start_size[5];
+}
+
+int oskar_vis_bda_num_times(const oskar_VisBda* vis)
+{
+    return vis->dim_start_size[2];
+}
+
+int oskar_vis_bda_start_channel_index(const oskar_VisBda* vis)
+{
+    return vis->dim_start_size[1];
+}
+
+int oskar_vis_bda_start_time_index(const oskar_VisBda* vis)
+{
+    return vis->dim_start_size[0];
+}
+
+oskar_Mem* oskar_vis_bda_antenna1(oskar_VisBda* vis)
+{
+    return vis->antenna1;
+}
+
+const oskar_Mem* oskar_vis_bda_antenna1_const(const oskar_VisBda* vis)
+{
+    return vis->antenna1;
+}
+
+oskar_Mem* oskar_vis_bda_antenna2(oskar_VisBda* vis)
+{
+    return vis->antenna2;
+}
+
+const oskar_Mem* oskar_vis_bda_antenna2_const(const oskar_VisBda* vis)
+{
+    return vis->antenna2;
+}
+
+oskar_Mem* oskar_vis_bda_num_samples(oskar_VisBda* vis)
+{
+    return vis->num_samples;
+}
+
+const oskar_Mem* oskar_vis_bda_num_samples_const(const oskar_VisBda* vis)
+{
+    return vis->num_samples;
+}
+
+oskar_Mem* oskar_vis_bda_time_centroid(oskar_VisBda* vis)
+{
+    return vis->time_centroid;
+}
+
+const oskar_Mem* oskar_vis_bda_time_centroid_const(const oskar_VisBda* vis)
+{
+    return vis->time_centroid;
+}
+
+oskar_Mem* oskar_vis_bda_baseline_uu_metres(oskar_VisBda* vis)
+{
+    return vis->baseline_uu_metres;
+}
+
+const oskar_Mem* oskar_vis_bda_baseline_uu_metres_const(
+        const oskar_VisBda* vis)
+{
+    return vis->baseline_uu_metres;
+}
+
+oskar_Mem* oskar_vis_bda_baseline_vv_metres(oskar_VisBda* vis)
+{
+    return vis->baseline_vv_metres;
+}
+
+const oskar_Mem* oskar_vis_bda_baseline_vv_metres_const(
+        const oskar_VisBda* vis)
+{
+    return vis->baseline_vv_metres;
+}
+
+oskar_Mem* oskar_vis_bda_baseline_ww_metres(oskar_VisBda* vis)
+{
+    return vis->baseline_ww_metres;
+}
+
+const oskar_Mem* oskar_vis_bda_baseline_ww_metres_const(
+        const oskar_VisBda* vis)
+{
+    return vis->baseline_ww_metres;
+}
+
+oskar_Mem* oskar_vis_bda_cross_correlations(oskar_VisBda* vis)
+{
+    return vis->cross_correlations;
+}
+
+const oskar_Mem* oskar_vis_bda_cross_correlations_const(
+        const oskar_VisBda* vis)
+{
+    return vis->cross_correlations;
+}
+
+#ifdef __cplusplus
+}
+#endif
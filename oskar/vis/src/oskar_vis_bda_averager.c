@@ -0,0 +1,414 @@
+/*
+ * Copyright (c) 2020, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "vis/private_vis_bda.h"
+#include "vis/oskar_vis_bda.h"
+#include "math/oskar_cmath.h"
+
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+static double inv_sinc(double value);
+static void get_uvw(const oskar_VisBlock* block, int i, double* uvw,
+        int* status);
+static void add_sample(oskar_VisBdaAverager* h, const oskar_VisBlock* block,
+        int time_index, int baseline, int* status);
+static void write_row(oskar_VisBdaAverager* h, int baseline, int row,
+        oskar_VisBda* out, int* status);
+
+oskar_VisBdaAverager* oskar_vis_bda_averager_create(
+        const oskar_VisHeader* hdr, double max_fact, double fov_deg,
+        double max_time_sec, int* status)
+{
+    oskar_VisBdaAverager* h = 0;
+    int i, j, b;
+    if (*status) return 0;
+
+    /* Check parameters. */
+    const int num_channels = oskar_vis_header_num_channels_total(hdr);
+    const double freq_start_hz = oskar_vis_header_freq_start_hz(hdr);
+    const double freq_end_hz = freq_start_hz +
+            (num_channels - 1) * oskar_vis_header_freq_inc_hz(hdr);
+    const double freq_max_hz = freq_end_hz > freq_start_hz ?
+            freq_end_hz : freq_start_hz;
+    const double time_inc_sec = oskar_vis_header_time_inc_sec(hdr);
+    if (max_fact <= 1.0 || fov_deg <= 0.0 || max_time_sec < 0.0 ||
+            freq_max_hz <= 0.0 || time_inc_sec <= 0.0)
+    {
+        *status = OSKAR_ERR_INVALID_ARGUMENT;
+        return 0;
+    }
+    if (!oskar_vis_header_write_cross_correlations(hdr) ||
+            oskar_vis_header_max_channels_per_block(hdr) != num_channels)
+    {
+        *status = OSKAR_ERR_DIMENSION_MISMATCH;
+        return 0;
+    }
+
+    /* Allocate the structure. */
+    h = (oskar_VisBdaAverager*) calloc(1, sizeof(oskar_VisBdaAverager));
+    if (!h)
+    {
+        *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+        return 0;
+    }
+    h->amp_type = oskar_vis_header_amp_type(hdr);
+    h->coord_precision = oskar_vis_header_coord_precision(hdr);
+    h->num_stations = oskar_vis_header_num_stations(hdr);
+    h->num_baselines = h->num_stations * (h->num_stations - 1) / 2;
+    h->num_channels = num_channels;
+    h->time_start_mjd_utc_sec =
+            oskar_vis_header_time_start_mjd_utc(hdr) * 86400.0;
+    h->time_inc_sec = time_inc_sec;
+
+    /* Convert the amplitude loss limit to a baseline length change,
+     * at the shortest wavelength. */
+    h->max_duvw_metres = inv_sinc(1.0 / max_fact) /
+            (fov_deg * (M_PI / 180.0)) * (299792458.0 / freq_max_hz);
+    h->max_samples = INT_MAX;
+    if (max_time_sec > 0.0)
+    {
+        h->max_samples = (int) floor(max_time_sec / time_inc_sec);
+        if (h->max_samples < 1) h->max_samples = 1;
+    }
+
+    /* Allocate per-baseline state. */
+    const size_t nb = (size_t) h->num_baselines;
+    h->station1 = (int*) calloc(nb, sizeof(int));
+    h->station2 = (int*) calloc(nb, sizeof(int));
+    h->count    = (int*) calloc(nb, sizeof(int));
+    h->flush    = (int*) calloc(nb, sizeof(int));
+    h->duvw     = (double*) calloc(nb, sizeof(double));
+    h->time_sum = (double*) calloc(nb, sizeof(double));
+    h->uvw_sum  = (double*) calloc(3 * nb, sizeof(double));
+    h->uvw_last = (double*) calloc(3 * nb, sizeof(double));
+    h->vis_sum  = oskar_mem_create(h->amp_type, OSKAR_CPU,
+            nb * num_channels, status);
+    oskar_mem_clear_contents(h->vis_sum, status);
+    if (nb > 0 && (!h->station1 || !h->station2 || !h->count || !h->flush ||
+            !h->duvw || !h->time_sum || !h->uvw_sum || !h->uvw_last))
+    {
+        *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+        return h;
+    }
+    for (b = 0, i = 0; i < h->num_stations; ++i)
+    {
+        for (j = i + 1; j < h->num_stations; ++j, ++b)
+        {
+            h->station1[b] = i;
+            h->station2[b] = j;
+        }
+    }
+    return h;
+}
+
+void oskar_vis_bda_averager_free(oskar_VisBdaAverager* h, int* status)
+{
+    if (!h) return;
+    oskar_mem_free(h->vis_sum, status);
+    free(h->station1);
+    free(h->station2);
+    free(h->count);
+    free(h->flush);
+    free(h->duvw);
+    free(h->time_sum);
+    free(h->uvw_sum);
+    free(h->uvw_last);
+    free(h);
+}
+
+double oskar_vis_bda_averager_max_duvw_metres(const oskar_VisBdaAverager* h)
+{
+    return h->max_duvw_metres;
+}
+
+void oskar_vis_bda_averager_reset(oskar_VisBdaAverager* h)
+{
+    int status = 0;
+    const size_t nb = (size_t) h->num_baselines;
+    memset(h->count, 0, nb * sizeof(int));
+    memset(h->duvw, 0, nb * sizeof(double));
+    memset(h->time_sum, 0, nb * sizeof(double));
+    memset(h->uvw_sum, 0, 3 * nb * sizeof(double));
+    oskar_mem_clear_contents(h->vis_sum, &status);
+}
+
+void oskar_vis_bda_averager_add_block(oskar_VisBdaAverager* h,
+        const oskar_VisBlock* block, int flush, oskar_VisBda* out,
+        int* status)
+{
+    int b, t, num_rows = 0;
+    if (*status) return;
+
+    /* Check the block is compatible. */
+    const int num_baselines = h->num_baselines;
+    const int num_times = oskar_vis_block_num_times(block);
+    if (oskar_vis_block_location(block) != OSKAR_CPU)
+    {
+        *status = OSKAR_ERR_BAD_LOCATION;
+        return;
+    }
+    if (!oskar_vis_block_has_cross_correlations(block) ||
+            oskar_vis_block_num_baselines(block) != num_baselines ||
+            oskar_vis_block_num_channels(block) != h->num_channels ||
+            oskar_vis_bda_num_channels(out) != h->num_channels)
+    {
+        *status = OSKAR_ERR_DIMENSION_MISMATCH;
+        return;
+    }
+    if (oskar_mem_type(oskar_vis_block_cross_correlations_const(block)) !=
+            h->amp_type ||
+            oskar_mem_type(oskar_vis_bda_cross_correlations(out)) !=
+            h->amp_type)
+    {
+        *status = OSKAR_ERR_TYPE_MISMATCH;
+        return;
+    }
+
+    /* Every baseline can finish at most one average per time sample,
+     * plus one more if flushing. */
+    out->dim_start_size[0] = oskar_vis_block_start_time_index(block);
+    out->dim_start_size[1] = oskar_vis_block_start_channel_index(block);
+    out->dim_start_size[2] = num_times;
+    out->dim_start_size[5] = h->num_stations;
+    oskar_vis_bda_resize(out, num_baselines * (num_times + 1), status);
+    if (*status) return;
+
+    for (t = 0; t < num_times; ++t)
+    {
+        /* Find the baselines where this sample starts a new average. */
+#pragma omp parallel for private(b)
+        for (b = 0; b < num_baselines; ++b)
+        {
+            double uvw[3], du, dv, dw, d;
+            double* last = &h->uvw_last[3 * b];
+            get_uvw(block, t * num_baselines + b, uvw, status);
+            du = uvw[0] - last[0];
+            dv = uvw[1] - last[1];
+            dw = uvw[2] - last[2];
+            d = sqrt(du*du + dv*dv + dw*dw);
+            h->flush[b] = 0;
+            if (h->count[b] > 0)
+            {
+                if (h->count[b] >= h->max_samples ||
+                        h->duvw[b] + d > h->max_duvw_metres)
+                {
+                    h->flush[b] = 1;
+                    h->duvw[b] = 0.0;
+                }
+                else
+                    h->duvw[b] += d;
+            }
+            last[0] = uvw[0];
+            last[1] = uvw[1];
+            last[2] = uvw[2];
+        }
+
+        /* Assign output rows in baseline order. */
+        for (b = 0; b < num_baselines; ++b)
+            h->flush[b] = h->flush[b] ? num_rows++ : -1;
+
+        /* Write the finished averages and add the new samples. */
+#pragma omp parallel for private(b)
+        for (b = 0; b < num_baselines; ++b)
+        {
+            if (h->flush[b] >= 0)
+                write_row(h, b, h->flush[b], out, status);
+            add_sample(h, block, t, b, status);
+        }
+    }
+
+    /* Write any remaining averages if this is the last block. */
+    if (flush)
+    {
+        for (b = 0; b < num_baselines; ++b)
+            h->flush[b] = h->count[b] > 0 ? num_rows++ : -1;
+#pragma omp parallel for private(b)
+        for (b = 0; b < num_baselines; ++b)
+        {
+            if (h->flush[b] >= 0)
+                write_row(h, b, h->flush[b], out, status);
+            h->duvw[b] = 0.0;
+        }
+    }
+    oskar_vis_bda_resize(out, num_rows, status);
+}
+
+static void get_uvw(const oskar_VisBlock* block, int i, double* uvw,
+        int* status)
+{
+    const oskar_Mem *uu, *vv, *ww;
+    uu = oskar_vis_block_baseline_uu_metres_const(block);
+    vv = oskar_vis_block_baseline_vv_metres_const(block);
+    ww = oskar_vis_block_baseline_ww_metres_const(block);
+    if (oskar_mem_precision(uu) == OSKAR_DOUBLE)
+    {
+        uvw[0] = oskar_mem_double_const(uu, status)[i];
+        uvw[1] = oskar_mem_double_const(vv, status)[i];
+        uvw[2] = oskar_mem_double_const(ww, status)[i];
+    }
+    else
+    {
+        uvw[0] = oskar_mem_float_const(uu, status)[i];
+        uvw[1] = oskar_mem_float_const(vv, status)[i];
+        uvw[2] = oskar_mem_float_const(ww, status)[i];
+    }
+}
+
+static void add_sample(oskar_VisBdaAverager* h, const oskar_VisBlock* block,
+        int time_index, int baseline, int* status)
+{
+    int c, k;
+    const int b = baseline;
+    const int num_real = 2 * oskar_vis_block_num_pols(block);
+    const int num_channels = h->num_channels;
+    const int num_baselines = h->num_baselines;
+    const oskar_Mem* vis = oskar_vis_block_cross_correlations_const(block);
+    h->count[b]++;
+    h->time_sum[b] += oskar_vis_block_start_time_index(block) + time_index;
+    h->uvw_sum[3 * b + 0] += h->uvw_last[3 * b + 0];
+    h->uvw_sum[3 * b + 1] += h->uvw_last[3 * b + 1];
+    h->uvw_sum[3 * b + 2] += h->uvw_last[3 * b + 2];
+    if (oskar_mem_precision(vis) == OSKAR_DOUBLE)
+    {
+        const double* in = oskar_mem_double_const(vis, status);
+        double* sum = oskar_mem_double(h->vis_sum, status) +
+                (size_t) b * num_channels * num_real;
+        for (c = 0; c < num_channels; ++c, sum += num_real)
+        {
+            const double* p = in + num_real * ((size_t)
+                    (time_index * num_channels + c) * num_baselines + b);
+            for (k = 0; k < num_real; ++k) sum[k] += p[k];
+        }
+    }
+    else
+    {
+        const float* in = oskar_mem_float_const(vis, status);
+        float* sum = oskar_mem_float(h->vis_sum, status) +
+                (size_t) b * num_channels * num_real;
+        for (c = 0; c < num_channels; ++c, sum += num_real)
+        {
+            const float* p = in + num_real * ((size_t)
+                    (time_index * num_channels + c) * num_baselines + b);
+            for (k = 0; k < num_real; ++k) sum[k] += p[k];
+        }
+    }
+}
+
+static void write_row(oskar_VisBdaAverager* h, int baseline, int row,
+        oskar_VisBda* out, int* status)
+{
+    size_t k;
+    const int b = baseline;
+    const double scale = 1.0 / h->count[b];
+    const size_t num_real = (size_t) h->num_channels *
+            2 * oskar_vis_bda_num_pols(out);
+
+    /* Row metadata. */
+    oskar_mem_int(out->antenna1, status)[row] = h->station1[b];
+    oskar_mem_int(out->antenna2, status)[row] = h->station2[b];
+    oskar_mem_int(out->num_samples, status)[row] = h->count[b];
+    oskar_mem_double(out->time_centroid, status)[row] =
+            h->time_start_mjd_utc_sec +
+            (h->time_sum[b] * scale + 0.5) * h->time_inc_sec;
+
+    /* Mean coordinates and amplitudes. */
+    if (h->coord_precision == OSKAR_DOUBLE)
+    {
+        oskar_mem_double(out->baseline_uu_metres, status)[row] =
+                h->uvw_sum[3 * b + 0] * scale;
+        oskar_mem_double(out->baseline_vv_metres, status)[row] =
+                h->uvw_sum[3 * b + 1] * scale;
+        oskar_mem_double(out->baseline_ww_metres, status)[row] =
+                h->uvw_sum[3 * b + 2] * scale;
+    }
+    else
+    {
+        oskar_mem_float(out->baseline_uu_metres, status)[row] =
+                (float) (h->uvw_sum[3 * b + 0] * scale);
+        oskar_mem_float(out->baseline_vv_metres, status)[row] =
+                (float) (h->uvw_sum[3 * b + 1] * scale);
+        oskar_mem_float(out->baseline_ww_metres, status)[row] =
+                (float) (h->uvw_sum[3 * b + 2] * scale);
+    }
+    if (oskar_mem_precision(h->vis_sum) == OSKAR_DOUBLE)
+    {
+        double* sum = oskar_mem_double(h->vis_sum, status) + b * num_real;
+        double* p = oskar_mem_double(out->cross_correlations, status) +
+                row * num_real;
+        for (k = 0; k < num_real; ++k)
+        {
+            p[k] = sum[k] * scale;
+            sum[k] = 0.0;
+        }
+    }
+    else
+    {
+        const float scale_f = (float) scale;
+        float* sum = oskar_mem_float(h->vis_sum, status) + b * num_real;
+        float* p = oskar_mem_float(out->cross_correlations, status) +
+                row * num_real;
+        for (k = 0; k < num_real; ++k)
+        {
+            p[k] = sum[k] * scale_f;
+            sum[k] = 0.0f;
+        }
+    }
+
+    /* Start a new average. */
+    h->count[b] = 0;
+    h->time_sum[b] = 0.0;
+    h->uvw_sum[3 * b + 0] = 0.0;
+    h->uvw_sum[3 * b + 1] = 0.0;
+    h->uvw_sum[3 * b + 2] = 0.0;
+}
+
+/* Returns x such that sin(pi x) / (pi x) = value, using Newton's method. */
+static double inv_sinc(double value)
+{
+    int i;
+    double x1 = 0.001;
+    for (i = 0; i < 1000; ++i)
+    {
+        const double x0 = x1;
+        const double a = x0 * M_PI;
+        x1 = x0 - ((sin(a) / a) - value) /
+                ((a * cos(a) - M_PI * sin(a)) / (a * a));
+        if (fabs(x1 - x0) < 1.0e-6) break;
+    }
+    return x1;
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,80 @@
+/*
+ * Copyright (c) 2020, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "vis/private_vis_bda.h"
+#include "vis/oskar_vis_bda.h"
+#include <stdlib.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+oskar_VisBda* oskar_vis_bda_create_from_header(const oskar_VisHeader* hdr,
+        int* status)
+{
+    oskar_VisBda* vis = 0;
+    if (*status) return 0;
+
+    /* Check type. */
+    const int amp_type = oskar_vis_header_amp_type(hdr);
+    const int coord_type = oskar_vis_header_coord_precision(hdr);
+    if (!oskar_type_is_complex(amp_type))
+    {
+        *status = OSKAR_ERR_BAD_DATA_TYPE;
+        return 0;
+    }
+
+    /* Allocate the structure. */
+    vis = (oskar_VisBda*) calloc(1, sizeof(oskar_VisBda));
+    if (!vis)
+    {
+        *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+        return 0;
+    }
+
+    /* Set dimensions. */
+    vis->dim_start_size[3] = oskar_vis_header_max_channels_per_block(hdr);
+    vis->dim_start_size[5] = oskar_vis_header_num_stations(hdr);
+
+    /* Create arrays. */
+    vis->antenna1 = oskar_mem_create(OSKAR_INT, OSKAR_CPU, 0, status);
+    vis->antenna2 = oskar_mem_create(OSKAR_INT, OSKAR_CPU, 0, status);
+    vis->num_samples = oskar_mem_create(OSKAR_INT, OSKAR_CPU, 0, status);
+    vis->time_centroid = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, 0, status);
+    vis->baseline_uu_metres = oskar_mem_create(coord_type, OSKAR_CPU, 0, status);
+    vis->baseline_vv_metres = oskar_mem_create(coord_type, OSKAR_CPU, 0, status);
+    vis->baseline_ww_metres = oskar_mem_create(coord_type, OSKAR_CPU, 0, status);
+    vis->cross_correlations = oskar_mem_create(amp_type, OSKAR_CPU, 0, status);
+
+    /* Return handle to structure. */
+    return vis;
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,91 @@
+/*
+ * Copyright (c) 2020, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "vis/private_vis_bda.h"
+#include "vis/oskar_vis_bda.h"
+#include "vis/oskar_vis_block.h"
+#include "binary/oskar_binary.h"
+#include "mem/oskar_binary_read_mem.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void oskar_vis_bda_read(oskar_VisBda* vis, const oskar_VisHeader* hdr,
+        oskar_Binary* h, int block_index, int* status)
+{
+    const unsigned char grp = OSKAR_TAG_GROUP_VIS_BLOCK;
+
+    /* Check if safe to proceed. */
+    if (*status) return;
+    if (!oskar_vis_header_bda(hdr))
+    {
+        *status = OSKAR_ERR_INVALID_ARGUMENT;
+        return;
+    }
+
+    /* Set query start index. */
+    oskar_binary_set_query_search_start(h,
+            block_index * oskar_vis_header_num_tags_per_block(hdr), status);
+
+    /* Read visibility metadata. */
+    oskar_binary_read(h, OSKAR_INT, grp,
+            OSKAR_VIS_BLOCK_TAG_DIM_START_AND_SIZE, block_index,
+            sizeof(int) * 6, vis->dim_start_size, status);
+
+    /* Read the row metadata. */
+    oskar_binary_read_mem(h, vis->antenna1, grp,
+            OSKAR_VIS_BLOCK_TAG_BDA_ANTENNA1, block_index, status);
+    oskar_binary_read_mem(h, vis->antenna2, grp,
+            OSKAR_VIS_BLOCK_TAG_BDA_ANTENNA2, block_index, status);
+    oskar_binary_read_mem(h, vis->num_samples, grp,
+            OSKAR_VIS_BLOCK_TAG_BDA_NUM_SAMPLES, block_index, status);
+    oskar_binary_read_mem(h, vis->time_centroid, grp,
+            OSKAR_VIS_BLOCK_TAG_BDA_TIME_CENTROID, block_index, status);
+
+    /* Read the baseline coordinate data. */
+    oskar_binary_read_mem(h, vis->baseline_uu_metres, grp,
+            OSKAR_VIS_BLOCK_TAG_BDA_BASELINE_UU, block_index, status);
+    oskar_binary_read_mem(h, vis->baseline_vv_metres, grp,
+            OSKAR_VIS_BLOCK_TAG_BDA_BASELINE_VV, block_index, status);
+    oskar_binary_read_mem(h, vis->baseline_ww_metres, grp,
+            OSKAR_VIS_BLOCK_TAG_BDA_BASELINE_WW, block_index, status);
+
+    /* Read the cross-correlation data. */
+    oskar_binary_read_mem(h, vis->cross_correlations, grp,
+            OSKAR_VIS_BLOCK_TAG_BDA_CROSS_CORRELATIONS, block_index, status);
+
+    /* Check the dimensions are consistent. */
+    if (!*status && oskar_mem_length(vis->cross_correlations) !=
+            (size_t) vis->dim_start_size[3] * vis->dim_start_size[4])
+        *status = OSKAR_ERR_DIMENSION_MISMATCH;
+}
+
+#ifdef __cplusplus
+}
+#endif
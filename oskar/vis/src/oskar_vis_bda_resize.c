@@ -0,0 +1,54 @@
+/*
+ * Copyright (c) 2020, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "vis/private_vis_bda.h"
+#include "vis/oskar_vis_bda.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void oskar_vis_bda_resize(oskar_VisBda* vis, int num_rows, int* status)
+{
+    if (*status) return;
+    const size_t n = (size_t) num_rows;
+    vis->dim_start_size[4] = num_rows;
+    oskar_mem_realloc(vis->antenna1, n, status);
+    oskar_mem_realloc(vis->antenna2, n, status);
+    oskar_mem_realloc(vis->num_samples, n, status);
+    oskar_mem_realloc(vis->time_centroid, n, status);
+    oskar_mem_realloc(vis->baseline_uu_metres, n, status);
+    oskar_mem_realloc(vis->baseline_vv_metres, n, status);
+    oskar_mem_realloc(vis->baseline_ww_metres, n, status);
+    oskar_mem_realloc(vis->cross_correlations,
+            n * vis->dim_start_size[3], status);
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,176 @@
+/*
+ * Copyright (c) 2020, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "ms/oskar_measurement_set.h"
+#include "vis/oskar_vis_bda.h"
+#include "vis/oskar_vis_header.h"
+#include "math/oskar_cmath.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define D2R (M_PI / 180.0)
+
+void oskar_vis_bda_write_ms(const oskar_VisBda* vis,
+        const oskar_VisHeader* header, oskar_MeasurementSet* ms, int* status)
+{
+    const oskar_Mem* in_xcorr;
+    oskar_Mem* temp_vis = 0;
+    double exposure_sec, interval_sec, ra_rad, dec_rad, freq_start_hz;
+    unsigned int num_channels, num_pols_in, num_pols_out, num_rows;
+    unsigned int i, num_values, prec, start_chan_index, start_row;
+    const void* in = 0;
+
+    /* Check if safe to proceed. */
+    if (*status) return;
+
+    /* Pull data from visibility structures. */
+    num_pols_out     = oskar_ms_num_pols(ms);
+    num_pols_in      = oskar_vis_bda_num_pols(vis);
+    num_channels     = oskar_vis_bda_num_channels(vis);
+    num_rows         = oskar_vis_bda_num_rows(vis);
+    in_xcorr         = oskar_vis_bda_cross_correlations_const(vis);
+    start_chan_index = oskar_vis_bda_start_channel_index(vis);
+    ra_rad           = oskar_vis_header_phase_centre_ra_deg(header) * D2R;
+    dec_rad          = oskar_vis_header_phase_centre_dec_deg(header) * D2R;
+    exposure_sec     = oskar_vis_header_time_average_sec(header);
+    interval_sec     = oskar_vis_header_time_inc_sec(header);
+    freq_start_hz    = oskar_vis_header_freq_start_hz(header);
+    prec             = oskar_mem_precision(in_xcorr);
+
+    /* Check that there is something to write. */
+    if (num_rows == 0) return;
+
+    /* Check polarisation dimension consistency:
+     * num_pols_in can be less than num_pols_out, but not vice-versa. */
+    if (num_pols_in > num_pols_out)
+    {
+        *status = OSKAR_ERR_DIMENSION_MISMATCH;
+        return;
+    }
+
+    /* Check the dimensions match. */
+    if (oskar_ms_num_stations(ms) !=
+            (unsigned int) oskar_vis_bda_num_stations(vis))
+    {
+        *status = OSKAR_ERR_DIMENSION_MISMATCH;
+        return;
+    }
+
+    /* Check the reference frequencies match. */
+    if (fabs(oskar_ms_freq_start_hz(ms) - freq_start_hz) > 1e-10)
+    {
+        *status = OSKAR_ERR_VALUE_MISMATCH;
+        return;
+    }
+
+    /* Check the phase centres are the same. */
+    if (fabs(oskar_ms_phase_centre_ra_rad(ms) - ra_rad) > 1e-10 ||
+            fabs(oskar_ms_phase_centre_dec_rad(ms) - dec_rad) > 1e-10)
+    {
+        *status = OSKAR_ERR_VALUE_MISMATCH;
+        return;
+    }
+
+    /* Expand scalar amplitudes to XX and YY if required. */
+    in = oskar_mem_void_const(in_xcorr);
+    num_values = num_rows * num_channels;
+    if (num_pols_in != num_pols_out)
+    {
+        temp_vis = oskar_mem_create(prec | OSKAR_COMPLEX, OSKAR_CPU,
+                num_values * num_pols_out, status);
+        oskar_mem_clear_contents(temp_vis, status);
+        if (*status)
+        {
+            oskar_mem_free(temp_vis, status);
+            return;
+        }
+        if (prec == OSKAR_DOUBLE)
+        {
+            const double2* in_ = (const double2*) in;
+            double2* out_ = oskar_mem_double2(temp_vis, status);
+            for (i = 0; i < num_values; ++i)
+            {
+                out_[4 * i + 0] = in_[i];  /* XX */
+                out_[4 * i + 3] = in_[i];  /* YY */
+            }
+        }
+        else
+        {
+            const float2* in_ = (const float2*) in;
+            float2* out_ = oskar_mem_float2(temp_vis, status);
+            for (i = 0; i < num_values; ++i)
+            {
+                out_[4 * i + 0] = in_[i];  /* XX */
+                out_[4 * i + 3] = in_[i];  /* YY */
+            }
+        }
+        in = oskar_mem_void_const(temp_vis);
+    }
+
+    /* Append the rows to the main table. */
+    start_row = oskar_ms_num_rows(ms);
+    if (prec == OSKAR_DOUBLE)
+        oskar_ms_write_rows_d(ms, start_row, num_rows,
+                start_chan_index, num_channels,
+                oskar_mem_int_const(oskar_vis_bda_antenna1_const(vis), status),
+                oskar_mem_int_const(oskar_vis_bda_antenna2_const(vis), status),
+                oskar_mem_int_const(
+                        oskar_vis_bda_num_samples_const(vis), status),
+                oskar_mem_double_const(
+                        oskar_vis_bda_time_centroid_const(vis), status),
+                oskar_mem_double_const(
+                        oskar_vis_bda_baseline_uu_metres_const(vis), status),
+                oskar_mem_double_const(
+                        oskar_vis_bda_baseline_vv_metres_const(vis), status),
+                oskar_mem_double_const(
+                        oskar_vis_bda_baseline_ww_metres_const(vis), status),
+                exposure_sec, interval_sec, (const double*) in);
+    else
+        oskar_ms_write_rows_f(ms, start_row, num_rows,
+                start_chan_index, num_channels,
+                oskar_mem_int_const(oskar_vis_bda_antenna1_const(vis), status),
+                oskar_mem_int_const(oskar_vis_bda_antenna2_const(vis), status),
+                oskar_mem_int_const(
+                        oskar_vis_bda_num_samples_const(vis), status),
+                oskar_mem_double_const(
+                        oskar_vis_bda_time_centroid_const(vis), status),
+                oskar_mem_float_const(
+                        oskar_vis_bda_baseline_uu_metres_const(vis), status),
+                oskar_mem_float_const(
+                        oskar_vis_bda_baseline_vv_metres_const(vis), status),
+                oskar_mem_float_const(
+                        oskar_vis_bda_baseline_ww_metres_const(vis), status),
+                exposure_sec, interval_sec, (const float*) in);
+    oskar_mem_free(temp_vis, status);
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -115,6 +115,11 @@ int oskar_vis_header_pol_type(const oskar_VisHeader* vis)
     return vis->pol_type;
 }
 
+int oskar_vis_header_bda(const oskar_VisHeader* vis)
+{
+    return vis->bda;
+}
+
 int oskar_vis_header_phase_centre_coord_type(const oskar_VisHeader* vis)
 {
     return vis->phase_centre_type;
@@ -285,6 +290,14 @@ void oskar_vis_header_set_pol_type(oskar_VisHeader* vis, int value,
     }
 }
 
+void oskar_vis_header_set_bda(oskar_VisHeader* vis, int value)
+{
+    vis->bda = value;
+    vis->num_tags_per_block = 1;
+    if (vis->write_crosscorr) vis->num_tags_per_block += (value ? 8 : 4);
+    if (vis->write_autocorr) vis->num_tags_per_block += 1;
+}
+
 #ifdef __cplusplus
 }
 #endif
@@ -84,6 +84,7 @@ oskar_VisHeader* oskar_vis_header_create(int amp_type, int coord_precision,
     /* Initialise meta-data. */
     hdr->write_autocorr = write_autocorr;
     hdr->write_crosscorr = write_crosscor;
+    hdr->bda = 0;
     hdr->freq_start_hz = 0.0;
     hdr->freq_inc_hz = 0.0;
     hdr->channel_bandwidth_hz = 0.0;
@@ -49,6 +49,7 @@ oskar_VisHeader* oskar_vis_header_create_copy(const oskar_VisHeader* other,
             status);
 
     /* Copy meta-data. */
+    oskar_vis_header_set_bda(hdr, other->bda);
     hdr->pol_type = other->pol_type;
     hdr->freq_start_hz = other->freq_start_hz;
     hdr->freq_inc_hz = other->freq_inc_hz;
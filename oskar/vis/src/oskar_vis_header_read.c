@@ -97,6 +97,11 @@ oskar_VisHeader* oskar_vis_header_read(oskar_Binary* h, int* status)
     /* Read other visibility metadata. */
     oskar_binary_read_int(h, grp, OSKAR_VIS_HEADER_TAG_POL_TYPE, 0,
             &vis->pol_type, status);
+
+    /* Optionally read the averaging flag (ignore the error code). */
+    tag_error = 0;
+    oskar_binary_read_int(h, grp, OSKAR_VIS_HEADER_TAG_BDA, 0,
+            &vis->bda, &tag_error);
     oskar_binary_read_int(h, grp,
             OSKAR_VIS_HEADER_TAG_PHASE_CENTRE_COORD_TYPE, 0,
             &vis->phase_centre_type, status);
@@ -133,6 +133,9 @@ oskar_Binary* oskar_vis_header_write(const oskar_VisHeader* hdr,
     /* Write other visibility metadata. */
     oskar_binary_write_int(h, grp,
             OSKAR_VIS_HEADER_TAG_POL_TYPE, 0, hdr->pol_type, status);
+    if (hdr->bda)
+        oskar_binary_write_int(h, grp,
+                OSKAR_VIS_HEADER_TAG_BDA, 0, hdr->bda, status);
     oskar_binary_write_int(h, grp,
             OSKAR_VIS_HEADER_TAG_PHASE_CENTRE_COORD_TYPE, 0,
             hdr->phase_centre_type, status);
@@ -0,0 +1,245 @@
+/*
+ * Copyright (c) 2020, The University of Oxford
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of the University of Oxford nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#include <gtest/gtest.h>
+
+#include "vis/oskar_vis_bda.h"
+#include "vis/oskar_vis_block.h"
+#include "vis/oskar_vis_header.h"
+#include "utility/oskar_get_error_string.h"
+
+#include <cstdio>
+
+static oskar_VisHeader* create_header(int num_times, int max_times_per_block,
+        int num_stations, int* status)
+{
+    oskar_VisHeader* hdr = oskar_vis_header_create(OSKAR_DOUBLE_COMPLEX,
+            OSKAR_DOUBLE, max_times_per_block, num_times, 1, 1,
+            num_stations, 0, 1, status);
+    oskar_vis_header_set_freq_start_hz(hdr, 100e6);
+    oskar_vis_header_set_freq_inc_hz(hdr, 1e6);
+    oskar_vis_header_set_time_start_mjd_utc(hdr, 50000.0);
+    oskar_vis_header_set_time_inc_sec(hdr, 10.0);
+    return hdr;
+}
+
+// Baseline 0 does not move, so it is averaged over the whole observation.
+// All other baselines move too far for any averaging.
+static void fill_block(oskar_VisBlock* blk, int i_block, int* status)
+{
+    const int num_baselines = oskar_vis_block_num_baselines(blk);
+    const int num_times = oskar_vis_block_num_times(blk);
+    double2* v_ = oskar_mem_double2(
+            oskar_vis_block_cross_correlations(blk), status);
+    double* uu = oskar_mem_double(oskar_vis_block_baseline_uu_metres(blk), status);
+    double* vv = oskar_mem_double(oskar_vis_block_baseline_vv_metres(blk), status);
+    double* ww = oskar_mem_double(oskar_vis_block_baseline_ww_metres(blk), status);
+    oskar_vis_block_set_start_time_index(blk, i_block * num_times);
+    for (int i = 0, t = 0; t < num_times; ++t)
+    {
+        const double time_index = (double)(t + i_block * num_times);
+        for (int b = 0; b < num_baselines; ++b, ++i)
+        {
+            v_[i].x = time_index;
+            v_[i].y = (double)b;
+            uu[i] = 1.0 + 1000.0 * b * time_index;
+            vv[i] = 2.0;
+            ww[i] = 3.0;
+        }
+    }
+}
+
+TEST(VisBda, average_write_read)
+{
+    int status = 0;
+    const int num_times = 12, max_times_per_block = 4, num_stations = 4;
+    const int num_blocks = num_times / max_times_per_block;
+    const int num_baselines = num_stations * (num_stations - 1) / 2;
+    const char* filename = "temp_test_vis_bda.dat";
+
+    // Write averaged visibilities.
+    {
+        oskar_VisHeader* hdr = create_header(num_times, max_times_per_block,
+                num_stations, &status);
+        oskar_vis_header_set_bda(hdr, 1);
+        oskar_VisBlock* blk = oskar_vis_block_create_from_header(
+                OSKAR_CPU, hdr, &status);
+        oskar_VisBda* out = oskar_vis_bda_create_from_header(hdr, &status);
+        oskar_VisBdaAverager* avg = oskar_vis_bda_averager_create(
+                hdr, 1.01, 1.0, 0.0, &status);
+        ASSERT_EQ(0, status) << oskar_get_error_string(status);
+        EXPECT_GT(oskar_vis_bda_averager_max_duvw_metres(avg), 1.0);
+        EXPECT_LT(oskar_vis_bda_averager_max_duvw_metres(avg), 1000.0);
+        oskar_Binary* h = oskar_vis_header_write(hdr, filename, &status);
+        for (int i_block = 0; i_block < num_blocks; ++i_block)
+        {
+            fill_block(blk, i_block, &status);
+            oskar_vis_bda_averager_add_block(avg, blk,
+                    i_block == num_blocks - 1, out, &status);
+            oskar_vis_bda_write(out, h, i_block, &status);
+            ASSERT_EQ(0, status) << oskar_get_error_string(status);
+        }
+        oskar_binary_free(h);
+        oskar_vis_bda_averager_free(avg, &status);
+        oskar_vis_bda_free(out, &status);
+        oskar_vis_block_free(blk, &status);
+        oskar_vis_header_free(hdr, &status);
+    }
+
+    // Read averaged visibilities and check them.
+    {
+        oskar_Binary* h = oskar_binary_create(filename, 'r', &status);
+        oskar_VisHeader* hdr = oskar_vis_header_read(h, &status);
+        ASSERT_EQ(0, status) << oskar_get_error_string(status);
+        ASSERT_EQ(1, oskar_vis_header_bda(hdr));
+        ASSERT_EQ(num_blocks, oskar_vis_header_num_blocks(hdr));
+        oskar_VisBda* vis = oskar_vis_bda_create_from_header(hdr, &status);
+        int total_rows = 0, found_static = 0;
+        for (int i_block = 0; i_block < num_blocks; ++i_block)
+        {
+            oskar_vis_bda_read(vis, hdr, h, i_block, &status);
+            ASSERT_EQ(0, status) << oskar_get_error_string(status);
+            ASSERT_EQ(1, oskar_vis_bda_num_pols(vis));
+            ASSERT_EQ(num_stations, oskar_vis_bda_num_stations(vis));
+            const int num_rows = oskar_vis_bda_num_rows(vis);
+            const int* a1 = oskar_mem_int_const(
+                    oskar_vis_bda_antenna1_const(vis), &status);
+            const int* a2 = oskar_mem_int_const(
+                    oskar_vis_bda_antenna2_const(vis), &status);
+            const int* n = oskar_mem_int_const(
+                    oskar_vis_bda_num_samples_const(vis), &status);
+            const double* t = oskar_mem_double_const(
+                    oskar_vis_bda_time_centroid_const(vis), &status);
+            const double* uu = oskar_mem_double_const(
+                    oskar_vis_bda_baseline_uu_metres_const(vis), &status);
+            const double2* v_ = oskar_mem_double2_const(
+                    oskar_vis_bda_cross_correlations_const(vis), &status);
+            for (int r = 0; r < num_rows; ++r)
+            {
+                const double time_index = (t[r] - 50000.0 * 86400.0) / 10.0;
+                if (a1[r] == 0 && a2[r] == 1)
+                {
+                    // The static baseline is averaged over all times.
+                    ++found_static;
+                    EXPECT_EQ(num_blocks - 1, i_block);
+                    EXPECT_EQ(num_times, n[r]);
+                    EXPECT_DOUBLE_EQ(0.5 * num_times, time_index);
+                    EXPECT_DOUBLE_EQ(1.0, uu[r]);
+                    EXPECT_DOUBLE_EQ(0.5 * (num_times - 1), v_[r].x);
+                    EXPECT_DOUBLE_EQ(0.0, v_[r].y);
+                }
+                else
+                {
+                    EXPECT_EQ(1, n[r]);
+                    EXPECT_DOUBLE_EQ(v_[r].x + 0.5, time_index);
+                }
+            }
+            total_rows += num_rows;
+        }
+        EXPECT_EQ(1, found_static);
+        EXPECT_EQ(1 + (num_baselines - 1) * num_times, total_rows);
+        oskar_vis_bda_free(vis, &status);
+        oskar_vis_header_free(hdr, &status);
+        oskar_binary_free(h);
+    }
+    remove(filename);
+}
+
+TEST(VisBda, max_time)
+{
+    int status = 0;
+    const int num_times = 12, max_times_per_block = 12, num_stations = 2;
+    oskar_VisHeader* hdr = create_header(num_times, max_times_per_block,
+            num_stations, &status);
+    oskar_vis_header_set_bda(hdr, 1);
+    oskar_VisBlock* blk = oskar_vis_block_create_from_header(
+            OSKAR_CPU, hdr, &status);
+    oskar_VisBda* out = oskar_vis_bda_create_from_header(hdr, &status);
+    oskar_VisBdaAverager* avg = oskar_vis_bda_averager_create(
+            hdr, 1.01, 1.0, 50.0, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+
+    // Averages on the static baseline are limited to 5 samples.
+    fill_block(blk, 0, &status);
+    oskar_vis_bda_averager_add_block(avg, blk, 0, out, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    ASSERT_EQ(2, oskar_vis_bda_num_rows(out));
+    const int* n = oskar_mem_int_const(
+            oskar_vis_bda_num_samples_const(out), &status);
+    EXPECT_EQ(5, n[0]);
+    EXPECT_EQ(5, n[1]);
+
+    // Flushing returns the remainder.
+    oskar_vis_bda_averager_reset(avg);
+    oskar_vis_bda_averager_add_block(avg, blk, 1, out, &status);
+    ASSERT_EQ(3, oskar_vis_bda_num_rows(out));
+    n = oskar_mem_int_const(oskar_vis_bda_num_samples_const(out), &status);
+    EXPECT_EQ(2, n[2]);
+    oskar_vis_bda_averager_free(avg, &status);
+    oskar_vis_bda_free(out, &status);
+    oskar_vis_block_free(blk, &status);
+    oskar_vis_header_free(hdr, &status);
+}
+
+TEST(VisBda, empty_block)
+{
+    int status = 0;
+    const char* filename = "temp_test_vis_bda_empty.dat";
+    oskar_VisHeader* hdr = create_header(4, 4, 2, &status);
+    oskar_vis_header_set_bda(hdr, 1);
+    oskar_VisBlock* blk = oskar_vis_block_create_from_header(
+            OSKAR_CPU, hdr, &status);
+    oskar_VisBda* out = oskar_vis_bda_create_from_header(hdr, &status);
+    oskar_VisBdaAverager* avg = oskar_vis_bda_averager_create(
+            hdr, 1.01, 1.0, 0.0, &status);
+
+    // Nothing is complete until the averages are flushed.
+    fill_block(blk, 0, &status);
+    oskar_vis_bda_averager_add_block(avg, blk, 0, out, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    ASSERT_EQ(0, oskar_vis_bda_num_rows(out));
+
+    // Check an empty block can be written and read back.
+    oskar_Binary* h = oskar_vis_header_write(hdr, filename, &status);
+    oskar_vis_bda_write(out, h, 0, &status);
+    oskar_binary_free(h);
+    h = oskar_binary_create(filename, 'r', &status);
+    oskar_VisHeader* hdr2 = oskar_vis_header_read(h, &status);
+    oskar_vis_bda_resize(out, 5, &status);
+    oskar_vis_bda_read(out, hdr2, h, 0, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    EXPECT_EQ(0, oskar_vis_bda_num_rows(out));
+    oskar_binary_free(h);
+    remove(filename);
+    oskar_vis_bda_averager_free(avg, &status);
+    oskar_vis_bda_free(out, &status);
+    oskar_vis_block_free(blk, &status);
+    oskar_vis_header_free(hdr, &status);
+    oskar_vis_header_free(hdr2, &status);
+}
@@ -713,6 +713,42 @@ class Imager(object):
         self.capsule_ensure()
         _imager_lib.finalise_plane(self._capsule, plane, plane_norm)
 
+    def plane(self, index):
+        """Returns an array reference to one of the imager's planes.
+
+        The returned array is a view of the imager's own memory, not a copy,
+        so it reflects the visibilities gridded by
+        :meth:`update() <oskar.Imager.update>` so far, without normalisation
+        (see :meth:`plane_norm() <oskar.Imager.plane_norm>`).
+
+        While the returned array, or any array derived from it, is still
+        alive, calls that would release the planes raise a RuntimeError.
+        These include :meth:`finalise() <oskar.Imager.finalise>`,
+        :meth:`reset_cache() <oskar.Imager.reset_cache>` and changes to the
+        algorithm or image size, so delete the views before calling them.
+        Planes are not available if gridding on a GPU.
+
+        Args:
+            index (int): Zero-based plane index.
+
+        Returns:
+            array: Two-dimensional array reference to the plane.
+        """
+        self.capsule_ensure()
+        return _imager_lib.plane(self._capsule, index)
+
+    def plane_norm(self, index):
+        """Returns the current normalisation factor of one of the planes.
+
+        Args:
+            index (int): Zero-based plane index.
+
+        Returns:
+            float: Plane normalisation factor.
+        """
+        self.capsule_ensure()
+        return _imager_lib.plane_norm(self._capsule, index)
+
     def reset_cache(self):
         """Low-level function to reset the imager's internal memory.
 
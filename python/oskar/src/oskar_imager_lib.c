@@ -40,6 +40,7 @@
 static const char module_doc[] =
         "This module provides an interface to the OSKAR imager.";
 static const char name[] = "oskar_Imager";
+static const char plane_view_name[] = "oskar_Imager_plane_view";
 
 static void* get_handle(PyObject* capsule, const char* name)
 {
@@ -62,6 +63,47 @@ static void imager_free(PyObject* capsule)
 {
     int status = 0;
     oskar_imager_free((oskar_Imager*) get_handle(capsule, name), &status);
+    free(PyCapsule_GetContext(capsule));
+}
+
+
+/* Returns the number of arrays returned by plane() that are still alive.
+ * The count is held in the context of the imager capsule. */
+static int* plane_view_count(PyObject* capsule, int create)
+{
+    int* count = (int*) PyCapsule_GetContext(capsule);
+    if (!count && create)
+    {
+        count = (int*) calloc(1, sizeof(int));
+        PyCapsule_SetContext(capsule, count);
+    }
+    return count;
+}
+
+
+/* Sets an exception and returns 1 if any plane views are still alive,
+ * as their memory would be released by the caller. */
+static int plane_views_alive(PyObject* capsule)
+{
+    const int* count = plane_view_count(capsule, 0);
+    if (count && *count > 0)
+    {
+        PyErr_SetString(PyExc_RuntimeError, "Imager planes cannot be "
+                "released while arrays returned by plane() still exist.");
+        return 1;
+    }
+    return 0;
+}
+
+
+/* Called when the last array using a plane view is deleted. */
+static void plane_view_free(PyObject* view)
+{
+    PyObject* capsule = (PyObject*) PyCapsule_GetPointer(view,
+            plane_view_name);
+    int* count = plane_view_count(capsule, 0);
+    if (count) (*count)--;
+    Py_DECREF(capsule);
 }
 
 
@@ -239,6 +281,7 @@ static PyObject* finalise(PyObject* self, PyObject* args)
             &capsule, &return_images, &return_grids))
         return 0;
     if (!(h = (oskar_Imager*) get_handle(capsule, name))) return 0;
+    if (plane_views_alive(capsule)) return 0;
 
     /* Create a dictionary to return any outputs. */
     dict = PyDict_New();
@@ -487,6 +530,60 @@ static PyObject* output_root(PyObject* self, PyObject* args)
 }
 
 
+static PyObject* plane(PyObject* self, PyObject* args)
+{
+    oskar_Imager* h = 0;
+    oskar_Mem* m = 0;
+    PyObject *capsule = 0, *view = 0;
+    PyArrayObject *array = 0;
+    int index = 0;
+    npy_intp dims[2];
+    if (!PyArg_ParseTuple(args, "Oi", &capsule, &index)) return 0;
+    if (!(h = (oskar_Imager*) get_handle(capsule, name))) return 0;
+    if (!(m = oskar_imager_plane(h, index)))
+    {
+        PyErr_SetString(PyExc_RuntimeError,
+                "Plane is not available in host memory.");
+        return 0;
+    }
+
+    /* Return an array reference to Python. Its base object holds the
+     * imager, and counts the views so that the planes are not released
+     * while any array using them is still alive. */
+    dims[0] = oskar_imager_plane_size(h);
+    dims[1] = dims[0];
+    array = (PyArrayObject*)PyArray_SimpleNewFromData(2, dims,
+            numpy_type_from_oskar(oskar_mem_type(m)), oskar_mem_void(m));
+    if (!array) return 0;
+    view = PyCapsule_New((void*)capsule, plane_view_name,
+            (PyCapsule_Destructor)plane_view_free);
+    if (!view)
+    {
+        Py_DECREF(array);
+        return 0;
+    }
+    Py_INCREF(capsule);
+    (*plane_view_count(capsule, 1))++;
+    if (PyArray_SetBaseObject(array, view) < 0)
+    {
+        Py_DECREF(array);
+        return 0;
+    }
+    return Py_BuildValue("N", array); /* Don't increment refcount. */
+}
+
+
+static PyObject* plane_norm(PyObject* self, PyObject* args)
+{
+    oskar_Imager* h = 0;
+    PyObject* capsule = 0;
+    int index = 0;
+    if (!PyArg_ParseTuple(args, "Oi", &capsule, &index)) return 0;
+    if (!(h = (oskar_Imager*) get_handle(capsule, name))) return 0;
+    return Py_BuildValue("d", oskar_imager_plane_norm(h, index));
+}
+
+
 static PyObject* plane_size(PyObject* self, PyObject* args)
 {
     oskar_Imager* h = 0;
@@ -504,6 +601,7 @@ static PyObject* reset_cache(PyObject* self, PyObject* args)
     int status = 0;
     if (!PyArg_ParseTuple(args, "O", &capsule)) return 0;
     if (!(h = (oskar_Imager*) get_handle(capsule, name))) return 0;
+    if (plane_views_alive(capsule)) return 0;
     oskar_imager_reset_cache(h, &status);
 
     /* Check for errors. */
@@ -655,6 +753,7 @@ static PyObject* run(PyObject* self, PyObject* args)
             &capsule, &return_images, &return_grids))
         return 0;
     if (!(h = (oskar_Imager*) get_handle(capsule, name))) return 0;
+    if (plane_views_alive(capsule)) return 0;
 
     /* Create a dictionary to return any outputs. */
     dict = PyDict_New();
@@ -749,6 +848,7 @@ static PyObject* set_algorithm(PyObject* self, PyObject* args)
     const char* type = 0;
     if (!PyArg_ParseTuple(args, "Os", &capsule, &type)) return 0;
     if (!(h = (oskar_Imager*) get_handle(capsule, name))) return 0;
+    if (plane_views_alive(capsule)) return 0;
     oskar_imager_set_algorithm(h, type, &status);
 
     /* Check for errors. */
@@ -932,6 +1032,7 @@ static PyObject* set_image_size(PyObject* self, PyObject* args)
     int size = 0, status = 0;
     if (!PyArg_ParseTuple(args, "Oi", &capsule, &size)) return 0;
     if (!(h = (oskar_Imager*) get_handle(capsule, name))) return 0;
+    if (plane_views_alive(capsule)) return 0;
     oskar_imager_set_image_size(h, size, &status);
 
     /* Check for errors. */
@@ -1075,6 +1176,7 @@ static PyObject* set_size(PyObject* self, PyObject* args)
     int size = 0, status = 0;
     if (!PyArg_ParseTuple(args, "Oi", &capsule, &size)) return 0;
     if (!(h = (oskar_Imager*) get_handle(capsule, name))) return 0;
+    if (plane_views_alive(capsule)) return 0;
     oskar_imager_set_size(h, size, &status);
 
     /* Check for errors. */
@@ -1822,6 +1924,9 @@ static PyMethodDef methods[] =
                 METH_VARARGS, "num_w_planes()"},
         {"output_root", (PyCFunction)output_root,
                 METH_VARARGS, "output_root()"},
+        {"plane", (PyCFunction)plane, METH_VARARGS, "plane(index)"},
+        {"plane_norm", (PyCFunction)plane_norm,
+                METH_VARARGS, "plane_norm(index)"},
         {"plane_size", (PyCFunction)plane_size, METH_VARARGS, "plane_size()"},
         {"reset_cache", (PyCFunction)reset_cache,
                 METH_VARARGS, "reset_cache()"},
@@ -85,7 +85,9 @@ static PyObject* check_init(PyObject* self, PyObject* args)
     int status = 0;
     if (!PyArg_ParseTuple(args, "O", &capsule)) return 0;
     if (!(h = (oskar_Interferometer*) get_handle(capsule, name))) return 0;
+    Py_BEGIN_ALLOW_THREADS
     oskar_interferometer_check_init(h, &status);
+    Py_END_ALLOW_THREADS
 
     /* Check for errors. */
     if (status)
@@ -258,7 +260,9 @@ static PyObject* run(PyObject* self, PyObject* args)
     int status = 0;
     if (!PyArg_ParseTuple(args, "O", &capsule)) return 0;
     if (!(h = (oskar_Interferometer*) get_handle(capsule, name))) return 0;
+    Py_BEGIN_ALLOW_THREADS
     oskar_interferometer_run(h, &status);
+    Py_END_ALLOW_THREADS
 
     /* Check for errors. */
     if (status)
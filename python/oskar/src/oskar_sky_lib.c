@@ -280,8 +280,10 @@ static PyObject* append_file(PyObject* self, PyObject* args)
     if (!(h = (oskar_Sky*) get_handle(capsule, name))) return 0;
 
     /* Load the sky model. */
+    Py_BEGIN_ALLOW_THREADS
     temp = oskar_sky_load(filename, oskar_sky_precision(h), &status);
     oskar_sky_append(h, temp, &status);
+    Py_END_ALLOW_THREADS
     oskar_sky_free(temp, &status);
 
     /* Check for errors. */
@@ -591,7 +593,9 @@ static PyObject* load(PyObject* self, PyObject* args)
     const char *filename = 0, *type = 0;
     if (!PyArg_ParseTuple(args, "ss", &filename, &type)) return 0;
     prec = (type[0] == 'S' || type[0] == 's') ? OSKAR_SINGLE : OSKAR_DOUBLE;
+    Py_BEGIN_ALLOW_THREADS
     h = oskar_sky_load(filename, prec, &status);
+    Py_END_ALLOW_THREADS
 
     /* Check for errors. */
     if (status)
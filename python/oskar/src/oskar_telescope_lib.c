@@ -100,7 +100,9 @@ static PyObject* load(PyObject* self, PyObject* args)
     const char* dir_name;
     if (!PyArg_ParseTuple(args, "Os", &capsule, &dir_name)) return 0;
     if (!(h = (oskar_Telescope*) get_handle(capsule, name))) return 0;
+    Py_BEGIN_ALLOW_THREADS
     oskar_telescope_load(h, dir_name, 0, &status);
+    Py_END_ALLOW_THREADS
 
     /* Check for errors. */
     if (status)
@@ -63,12 +63,34 @@ static void vis_block_free(PyObject* capsule)
 }
 
 
+static PyObject* array_view(PyObject* capsule, oskar_Mem* m,
+        int nd, npy_intp* dims)
+{
+    PyArrayObject* array = 0;
+    int typenum = oskar_mem_is_double(m) ? NPY_DOUBLE : NPY_FLOAT;
+    if (oskar_mem_is_complex(m))
+        typenum = oskar_mem_is_double(m) ? NPY_CDOUBLE : NPY_CFLOAT;
+
+    /* Wrap the block memory without copying it, and make the array hold a
+     * reference to the capsule so the block outlives the array. */
+    array = (PyArrayObject*)PyArray_SimpleNewFromData(nd, dims, typenum,
+            oskar_mem_void(m));
+    if (!array) return 0;
+    Py_INCREF(capsule);
+    if (PyArray_SetBaseObject(array, capsule) < 0)
+    {
+        Py_DECREF(array);
+        return 0;
+    }
+    return Py_BuildValue("N", array); /* Don't increment refcount. */
+}
+
+
 static PyObject* auto_correlations(PyObject* self, PyObject* args)
 {
     oskar_VisBlock* h = 0;
     oskar_Mem* m = 0;
     PyObject *capsule = 0;
-    PyArrayObject *array = 0;
     npy_intp dims[4];
     if (!PyArg_ParseTuple(args, "O", &capsule)) return 0;
     if (!(h = (oskar_VisBlock*) get_handle(capsule, name))) return 0;
@@ -86,10 +108,7 @@ static PyObject* auto_correlations(PyObject* self, PyObject* args)
     dims[1] = oskar_vis_block_num_channels(h);
     dims[2] = oskar_vis_block_num_stations(h);
     dims[3] = oskar_vis_block_num_pols(h);
-    array = (PyArrayObject*)PyArray_SimpleNewFromData(4, dims,
-            (oskar_mem_is_double(m) ? NPY_CDOUBLE : NPY_CFLOAT),
-            oskar_mem_void(m));
-    return Py_BuildValue("N", array); /* Don't increment refcount. */
+    return array_view(capsule, m, 4, dims);
 }
 
 
@@ -127,7 +146,6 @@ static PyObject* baseline_uu_metres(PyObject* self, PyObject* args)
     oskar_VisBlock* h = 0;
     oskar_Mem* m = 0;
     PyObject *capsule = 0;
-    PyArrayObject *array = 0;
     npy_intp dims[2];
     if (!PyArg_ParseTuple(args, "O", &capsule)) return 0;
     if (!(h = (oskar_VisBlock*) get_handle(capsule, name))) return 0;
@@ -143,10 +161,7 @@ static PyObject* baseline_uu_metres(PyObject* self, PyObject* args)
     m = oskar_vis_block_baseline_uu_metres(h);
     dims[0] = oskar_vis_block_num_times(h);
     dims[1] = oskar_vis_block_num_baselines(h);
-    array = (PyArrayObject*)PyArray_SimpleNewFromData(2, dims,
-            (oskar_mem_is_double(m) ? NPY_DOUBLE : NPY_FLOAT),
-            oskar_mem_void(m));
-    return Py_BuildValue("N", array); /* Don't increment refcount. */
+    return array_view(capsule, m, 2, dims);
 }
 
 
@@ -155,7 +170,6 @@ static PyObject* baseline_vv_metres(PyObject* self, PyObject* args)
     oskar_VisBlock* h = 0;
     oskar_Mem* m = 0;
     PyObject *capsule = 0;
-    PyArrayObject *array = 0;
     npy_intp dims[2];
     if (!PyArg_ParseTuple(args, "O", &capsule)) return 0;
     if (!(h = (oskar_VisBlock*) get_handle(capsule, name))) return 0;
@@ -171,10 +185,7 @@ static PyObject* baseline_vv_metres(PyObject* self, PyObject* args)
     m = oskar_vis_block_baseline_vv_metres(h);
     dims[0] = oskar_vis_block_num_times(h);
     dims[1] = oskar_vis_block_num_baselines(h);
-    array = (PyArrayObject*)PyArray_SimpleNewFromData(2, dims,
-            (oskar_mem_is_double(m) ? NPY_DOUBLE : NPY_FLOAT),
-            oskar_mem_void(m));
-    return Py_BuildValue("N", array); /* Don't increment refcount. */
+    return array_view(capsule, m, 2, dims);
 }
 
 
@@ -183,7 +194,6 @@ static PyObject* baseline_ww_metres(PyObject* self, PyObject* args)
     oskar_VisBlock* h = 0;
     oskar_Mem* m = 0;
     PyObject *capsule = 0;
-    PyArrayObject *array = 0;
     npy_intp dims[2];
     if (!PyArg_ParseTuple(args, "O", &capsule)) return 0;
     if (!(h = (oskar_VisBlock*) get_handle(capsule, name))) return 0;
@@ -199,10 +209,7 @@ static PyObject* baseline_ww_metres(PyObject* self, PyObject* args)
     m = oskar_vis_block_baseline_ww_metres(h);
     dims[0] = oskar_vis_block_num_times(h);
     dims[1] = oskar_vis_block_num_baselines(h);
-    array = (PyArrayObject*)PyArray_SimpleNewFromData(2, dims,
-            (oskar_mem_is_double(m) ? NPY_DOUBLE : NPY_FLOAT),
-            oskar_mem_void(m));
-    return Py_BuildValue("N", array); /* Don't increment refcount. */
+    return array_view(capsule, m, 2, dims);
 }
 
 
@@ -211,7 +218,6 @@ static PyObject* cross_correlations(PyObject* self, PyObject* args)
     oskar_VisBlock* h = 0;
     oskar_Mem* m = 0;
     PyObject *capsule = 0;
-    PyArrayObject *array = 0;
     npy_intp dims[4];
     if (!PyArg_ParseTuple(args, "O", &capsule)) return 0;
     if (!(h = (oskar_VisBlock*) get_handle(capsule, name))) return 0;
@@ -229,10 +235,7 @@ static PyObject* cross_correlations(PyObject* self, PyObject* args)
     dims[1] = oskar_vis_block_num_channels(h);
     dims[2] = oskar_vis_block_num_baselines(h);
     dims[3] = oskar_vis_block_num_pols(h);
-    array = (PyArrayObject*)PyArray_SimpleNewFromData(4, dims,
-            (oskar_mem_is_double(m) ? NPY_CDOUBLE : NPY_CFLOAT),
-            oskar_mem_void(m));
-    return Py_BuildValue("N", array); /* Don't increment refcount. */
+    return array_view(capsule, m, 4, dims);
 }
 
 
@@ -108,7 +108,14 @@ class VisBlock(object):
     """
 
     def __init__(self):
-        """Constructs a handle to a visibility block."""
+        """Constructs a handle to a visibility block.
+
+        Arrays returned by the data accessors are views of the block's
+        memory, not copies, and they keep the block alive while they exist.
+        A block returned by the simulator is reused for later blocks, so its
+        arrays must be copied if they are needed after the block has been
+        processed.
+        """
         if _vis_block_lib is None:
             raise RuntimeError("OSKAR library not found.")
         self._capsule = None